@@ -69,28 +69,38 @@
 #endif
 
 #include <algorithm>
+#include <cctype>
 #include <cstring> // required for std::memcpy
-#include <future>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <numeric>
 #include <sstream>
+#include <type_traits>
 #include <vector>
 
 #include "internal/Backends.hpp"
 #include "internal/CLAPBackend.hpp"
+#include "internal/CompletionReactor.hpp"
 #include "internal/Constants.hpp"
+#include "internal/DeviceCopyEngine.hpp"
 #include "internal/Exceptions.hpp"
 #include "internal/Expected.hpp"
 #include "internal/Memory.hpp"
+#include "internal/MemoryPool.hpp"
+#include "internal/MemoryView.hpp"
 #include "internal/Timer.hpp"
 #include "internal/Types.hpp"
 #include "internal/Utils.hpp"
 
 #ifndef EMBEDDED_XILINX
 #include "internal/AlignmentAllocator.hpp"
-#include "internal/SoloRunWarden.hpp"
+#include "internal/AsyncTransfer.hpp"
+#include "internal/DeviceLock.hpp"
+#include "internal/FileTransfer.hpp"
+#include "internal/StreamRing.hpp"
 #endif
 
 namespace clap
@@ -107,7 +117,8 @@ protected:
 
 	virtual ~CLAPManaged();
 
-	internal::CLAPBasePtr CLAP()
+	// Returned by reference to avoid the reference counting of a shared_ptr copy on every register access
+	const internal::CLAPBasePtr& CLAP()
 	{
 		checkCLAPValid();
 		return m_pClap;
@@ -163,6 +174,14 @@ public:
 
 	virtual void AddPollAddress(const uint64_t& addr) = 0;
 
+	virtual bool SupportsRegisterBursts() const                                                      = 0;
+	virtual void WriteRegisters(const uint64_t& addr, const uint32_t* pData, const std::size_t& count) = 0;
+
+	virtual void* GetRegisterWindow([[maybe_unused]] const uint64_t& addr, [[maybe_unused]] uint64_t& sizeInByte)
+	{
+		return nullptr;
+	}
+
 	uint32_t GetDevNum() const
 	{
 		return m_devNum;
@@ -210,6 +229,8 @@ private:
 
 class CLAP : virtual public internal::CLAPBase
 {
+	DISABLE_COPY_ASSIGN_MOVE(CLAP)
+
 public:
 	enum class MemoryType
 	{
@@ -223,6 +244,8 @@ public:
 		MemoryType type;
 		uint64_t baseAddress;
 		uint64_t size;
+		AllocStrategy strategy = AllocStrategy::FirstFit;
+		Coherency coherency    = Coherency::NonCoherent;
 	};
 
 	using MemoryRegions = std::vector<MemoryRegion>;
@@ -271,17 +294,35 @@ private:
 		bool m_polling      = false;
 	};
 
-	explicit CLAP(internal::CLAPBackendPtr pBackend, const bool& disableWarden = false) :
+protected:
+	explicit CLAP(internal::CLAPBackendPtr pBackend, const DeviceAccess& access = DeviceAccess::Exclusive) :
 		CLAPBase(pBackend->GetDevNum()),
 		m_pBackend(std::move(pBackend)),
+#ifndef EMBEDDED_XILINX
+		m_pReactor(std::make_shared<internal::CompletionReactor>()),
+		m_pTransferPool(std::make_shared<internal::TransferPool>(m_pBackend)),
+		m_pMetrics(std::make_shared<internal::MetricsRegistry>()),
+#endif
 		m_memories(),
+		m_regionPolicies(),
+		m_nextRegion(),
 		m_rwMtx(),
 		m_pollAddrMtx(),
-		m_memMtx()
+		m_memMtx(),
+		m_copyMtx()
+#ifndef EMBEDDED_XILINX
+		,
+		m_placementMtx()
+#endif
 	{
 #ifndef EMBEDDED_XILINX
-		if (!disableWarden)
-			internal::SoloRunWarden::GetInstance();
+		if (access != DeviceAccess::Unlocked)
+			m_pDeviceLock = internal::DeviceLock::Acquire(m_pBackend->GetBackendName(), m_devNum, access);
+
+		m_pReactor->SetMetricsRegistry(m_pMetrics);
+
+		// Places the internal threads on the node of the device, if the backend reports one
+		SetNumaNode(m_pBackend->GetNumaNode());
 #endif
 
 		m_memories.insert(MemoryPair(MemoryType::DDR, internal::MemoryManagerVec()));
@@ -304,31 +345,174 @@ public:
 	/// @tparam T Type of the backend to use
 	/// @return A shared pointer to the new CLAP instance
 	/// @param deviceNum Device number of the CLAP device
-	/// @param channelNum Channel number of the CLAP device
-	/// @param disableWarden Disables the SoloRunWarden if set to true
+	/// @param channelNum Channel number of the CLAP device, XDMA_ALL_CHANNELS opens all available channels
+	/// @param disableWarden Opens the device without locking it if set to true, otherwise the device is locked exclusively
 	template<typename T>
 	static CLAPPtr Create(const uint32_t& deviceNum = 0, const uint32_t& channelNum = 0, const bool& disableWarden = false)
+	{
+		return Create<T>(deviceNum, channelNum, (disableWarden ? DeviceAccess::Unlocked : DeviceAccess::Exclusive));
+	}
+
+	/// @brief Creates a new CLAP instance
+	/// @tparam T Type of the backend to use
+	/// @return A shared pointer to the new CLAP instance
+	/// @param deviceNum Device number of the CLAP device
+	/// @param channelNum Channel number of the CLAP device, XDMA_ALL_CHANNELS opens all available channels
+	/// @param access Access to the device, throws if another process holds a conflicting lock on the device
+	template<typename T>
+	static CLAPPtr Create(const uint32_t& deviceNum, const uint32_t& channelNum, const DeviceAccess& access)
 	{
 		// We have to use the result of new here, because the constructor is private
 		// and can therefore, not be called from make_shared
-		return CLAPPtr(new CLAP(std::make_shared<T>(deviceNum, channelNum), disableWarden));
+		return CLAPPtr(new CLAP(std::make_shared<T>(deviceNum, channelNum), access));
 	}
 
 	~CLAP() override
 	{
 	}
 
+#ifndef EMBEDDED_XILINX
+	/// @brief Locks the given address range of the device across processes, e.g., the register space of the IP cores used by this process.
+	///        Allows multiple processes to drive disjoint IP cores of a device opened with DeviceAccess::Shared.
+	/// @param addr Base address of the range
+	/// @param sizeInByte Size of the range in bytes
+	/// @return Lock of the range, the range is unlocked once the lock is destroyed, throws if the range is already locked
+	AddressRangeLock LockAddressRange(const uint64_t& addr, const uint64_t& sizeInByte)
+	{
+		if (!m_pDeviceLock)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Unable to lock an address range of a device opened with DeviceAccess::Unlocked";
+			throw CLAPException(ss.str());
+		}
+
+		return m_pDeviceLock->LockRange(addr, sizeInByte);
+	}
+#endif
+
 	internal::UserInterruptPtr MakeUserInterrupt()
 	{
 		return m_pBackend->MakeUserInterrupt();
 	}
 
+	/// @brief Returns the reactor detecting the completion of all IP cores attached to this CLAP instance
+	/// @return Shared pointer to the reactor, nullptr on bare metal
+	internal::CompletionReactorPtr GetCompletionReactor() const
+	{
+#ifndef EMBEDDED_XILINX
+		return m_pReactor;
+#else
+		return nullptr;
+#endif
+	}
+
+#ifndef EMBEDDED_XILINX
+	/// @brief Returns the NUMA node used to place the node-local buffers and the internal threads of this instance
+	/// @return NUMA node, by default the node reported by the backend (e.g., the node of the PCIe device), NUMA_NODE_UNKNOWN if unknown
+	int32_t GetNumaNode()
+	{
+		std::lock_guard<std::mutex> lock(m_placementMtx);
+		return m_numaNode;
+	}
+
+	/// @brief Overrides the NUMA node of this instance, the internal transfer, stream, and completion threads are pinned to its CPUs
+	/// @param node NUMA node, NUMA_NODE_UNKNOWN removes the placement, allowing the threads to run on all online CPUs
+	void SetNumaNode(const int32_t& node)
+	{
+		std::lock_guard<std::mutex> lock(m_placementMtx);
+		m_numaNode       = node;
+		m_threadAffinity = numa::GetNodeCPUs(node);
+		applyThreadAffinity();
+
+		if (node != NUMA_NODE_UNKNOWN)
+			CLAP_CLASS_LOG_VERBOSE << "Placing the internal threads on NUMA node " << node << " (" << m_threadAffinity.size() << " CPUs)" << std::endl;
+	}
+
+	/// @brief Pins the internal transfer, stream, and completion threads to the given CPUs instead of the CPUs of the NUMA node
+	/// @param cpus CPUs to run on, an empty set allows all online CPUs
+	void SetThreadAffinity(const CpuSet& cpus)
+	{
+		std::lock_guard<std::mutex> lock(m_placementMtx);
+		m_threadAffinity = cpus;
+		applyThreadAffinity();
+	}
+
+	/// @brief Returns the CPUs the internal threads are pinned to, empty if they are not pinned
+	CpuSet GetThreadAffinity()
+	{
+		std::lock_guard<std::mutex> lock(m_placementMtx);
+		return m_threadAffinity;
+	}
+
+	/// @brief Allocates a host buffer whose pages are placed on the NUMA node of this instance,
+	///        without a known node the buffer is allocated like a regular CLAPBuffer
+	/// @tparam T Type of the buffer elements
+	/// @param elements Number of elements
+	/// @return Node-local buffer, can be used with all transfer methods accepting a std::vector
+	template<typename T>
+	CLAPNumaBuffer<T> CreateNodeLocalBuffer(const std::size_t& elements)
+	{
+		return CLAPNumaBuffer<T>(elements, internal::NumaAllocator<T>(GetNumaNode()));
+	}
+#endif
+
+	/// @brief Returns a snapshot of the transfer metrics of the backend and the completion metrics of all IP cores.
+	///        The metrics are collected using atomic counters, taking a snapshot does not block any transfer.
+	///        IP core metrics are grouped by the name of their WatchDogs and are not available on bare metal.
+	///        On bare metal, the latencies are reported as 0, as the timer is not implemented there, and
+	///        register accesses of IP cores bypass the backend and are not counted.
+	/// @return Snapshot of the metrics since the creation of the instance or the last call to ResetMetrics
+	Metrics GetMetrics() const
+	{
+		Metrics metrics;
+		metrics.read     = m_pBackend->GetTransferMetrics(internal::CLAPBackend::TYPE::READ);
+		metrics.write    = m_pBackend->GetTransferMetrics(internal::CLAPBackend::TYPE::WRITE);
+		metrics.readCtrl = m_pBackend->GetTransferMetrics(internal::CLAPBackend::TYPE::CONTROL);
+#ifndef EMBEDDED_XILINX
+		metrics.cores = m_pMetrics->Snapshot();
+#endif
+		return metrics;
+	}
+
+	/// @brief Resets all counters and histograms reported by GetMetrics
+	void ResetMetrics()
+	{
+		m_pBackend->ResetTransferMetrics();
+#ifndef EMBEDDED_XILINX
+		m_pMetrics->Reset();
+#endif
+	}
+
 	void AddPollAddress(const uint64_t& addr) override
 	{
 		std::lock_guard<std::mutex> lock(m_pollAddrMtx);
 		m_pBackend->AddPollAddr(addr);
 	}
 
+	/// @brief Returns whether the backend writes consecutive registers faster as a single burst
+	bool SupportsRegisterBursts() const override
+	{
+		return m_pBackend->SupportsRegisterBursts();
+	}
+
+	/// @brief Writes consecutive 32-bit registers, as a single burst if supported by the backend
+	/// @param addr Address of the first register
+	/// @param pData Pointer to the register values
+	/// @param count Number of registers to write
+	void WriteRegisters(const uint64_t& addr, const uint32_t* pData, const std::size_t& count) override
+	{
+		m_pBackend->WriteRegisters(addr, pData, count);
+	}
+
+	/// @brief Returns a pointer to the given address within a persistent register mapping of the backend, used by IP cores to access their registers directly
+	/// @param addr Address of the first register
+	/// @param sizeInByte Set to the number of bytes accessible starting at addr
+	/// @return Pointer to the mapped register, nullptr if the backend does not support direct register access at the given address
+	void* GetRegisterWindow(const uint64_t& addr, uint64_t& sizeInByte) override
+	{
+		return m_pBackend->GetRegisterWindow(addr, sizeInByte);
+	}
+
 	void SetLogByteThreshold(const uint64_t& threshold)
 	{
 		m_pBackend->SetLogByteThreshold(threshold);
@@ -339,20 +523,187 @@ public:
 		return m_pBackend->GetLogByteThreshold();
 	}
 
+	/// @brief Configures the cache of persistently mapped windows used by backends accessing a memory device (PetaLinux /dev/mem mode)
+	/// @param windowSize Size of a single mapped window in byte, has to be a power of two and a multiple of the page size
+	/// @param maxWindows Maximum number of windows kept mapped at once, the least recently used window is evicted first
+	void ConfigureMapCache(const uint64_t& windowSize, const std::size_t& maxWindows)
+	{
+		m_pBackend->ConfigureMapCache(windowSize, maxWindows);
+	}
+
+	/// @brief Configures the striping of large transfers across multiple DMA channels (PCIe backend created with XDMA_ALL_CHANNELS)
+	/// @param minStripeSize Minimum size of a single stripe in byte, transfers smaller than two stripes use a single channel
+	void ConfigureStriping(const uint64_t& minStripeSize)
+	{
+		m_pBackend->ConfigureStriping(minStripeSize);
+	}
+
+	/// @brief Selects the kernels used to copy bulk data from/to memory-mapped device memory (PetaLinux and bare-metal backends)
+	/// @param readKernel Kernel used for device to host transfers
+	/// @param writeKernel Kernel used for host to device transfers
+	void ConfigureCopyKernels(const CopyKernel& readKernel, const CopyKernel& writeKernel)
+	{
+		m_pBackend->ConfigureCopyKernels(readKernel, writeKernel);
+	}
+
+#ifndef EMBEDDED_XILINX
+	/// @brief Measures the throughput of all copy kernels supported by the CPU on the given device memory, the memory is overwritten
+	/// @param addr Address of the device memory, has to be mappable by the backend
+	/// @param sizeInByte Size of a single transfer
+	/// @param iterations Number of transfers per kernel and direction
+	/// @return Read and write throughput of every kernel in MB/s
+	CopyKernelResults BenchmarkCopyKernels(const uint64_t& addr, const uint64_t& sizeInByte, const uint32_t& iterations = 16)
+	{
+		void* pMem = m_pBackend->MapMemory(addr, sizeInByte);
+		if (pMem == nullptr)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "The " << m_pBackend->GetBackendName() << " backend does not support mapping device memory";
+			throw CLAPException(ss.str());
+		}
+
+		CopyKernelResults results;
+
+		try
+		{
+			results = internal::BenchmarkCopyKernels(pMem, sizeInByte, iterations);
+		}
+		catch (...)
+		{
+			m_pBackend->UnmapMemory(addr, pMem, sizeInByte);
+			throw;
+		}
+
+		m_pBackend->UnmapMemory(addr, pMem, sizeInByte);
+		return results;
+	}
+
+	/// @brief Benchmarks all copy kernels on the given device memory and configures the fastest one for each direction,
+	///        the memory used for the benchmark should be of the same type as the memory the application transfers data to
+	/// @param addr Address of the device memory, has to be mappable by the backend
+	/// @param sizeInByte Size of a single transfer, should match the typical transfer size of the application
+	/// @return Results of the benchmark
+	CopyKernelResults SelectCopyKernels(const uint64_t& addr, const uint64_t& sizeInByte)
+	{
+		const CopyKernelResults results = BenchmarkCopyKernels(addr, sizeInByte);
+
+		const auto fastestRead  = std::max_element(results.begin(), results.end(), [](const CopyKernelResult& a, const CopyKernelResult& b) { return a.readMBs < b.readMBs; });
+		const auto fastestWrite = std::max_element(results.begin(), results.end(), [](const CopyKernelResult& a, const CopyKernelResult& b) { return a.writeMBs < b.writeMBs; });
+
+		ConfigureCopyKernels(fastestRead->kernel, fastestWrite->kernel);
+
+		CLAP_CLASS_LOG_VERBOSE << "Selected copy kernels, read: " << fastestRead->kernel << " (" << fastestRead->readMBs << " MB/s), write: " << fastestWrite->kernel << " (" << fastestWrite->writeMBs << " MB/s)" << std::endl;
+
+		return results;
+	}
+#endif
+
+	/// @brief Switches the DMA channels of the PCIe backend to positional I/O (pread/pwrite), allowing multiple threads to issue
+	///        independent transfers concurrently without locking a channel. Has to be called before any transfer is issued.
+	/// @param fdsPerChannel Number of handles opened per DMA channel, used round-robin by concurrent transfers
+	void ConfigurePositionalIO(const uint32_t& fdsPerChannel = 1)
+	{
+		m_pBackend->ConfigurePositionalIO(fdsPerChannel);
+	}
+
+	/// @brief Maps the AXI-Lite master BAR of the XDMA (PCIe backend) and serves register sized accesses within the window by direct MMIO loads and stores,
+	///        larger transfers and accesses outside of the window still use the DMA channels. Has to be called before the registers are accessed.
+	/// @param axiBaseAddr AXI address the start of the BAR is translated to, i.e., the PCIe to AXI-Lite master translation configured in the XDMA IP
+	/// @param sizeInByte Size of the window to map, has to be covered by the BAR
+	/// @param bypass Map the DMA bypass BAR (/dev/xdmaN_bypass) instead of the AXI-Lite master BAR (/dev/xdmaN_user)
+	/// @note IP cores resolve their register window on construction, cores created before the call still access the BAR through the backend.
+	///       The BAR can only be mapped once, a second call throws a CLAPException.
+	void ConfigureRegisterBAR(const uint64_t& axiBaseAddr, const uint64_t& sizeInByte, const bool& bypass = false)
+	{
+		m_pBackend->ConfigureRegisterBAR(axiBaseAddr, sizeInByte, bypass);
+	}
+
 	/// @brief Adds a memory region to the CLAP instance
 	/// @param type Type of memory
 	/// @param baseAddr Base address of the memory region
 	/// @param size Size of the memory region in bytes
-	void AddMemoryRegion(const MemoryType& type, const uint64_t& baseAddr, const uint64_t& size)
+	/// @param strategy Allocation strategy used for the memory region
+	/// @param coherency Coherency of the memory region with the CPU caches, transfers skip the cache maintenance for Coherency::Coherent
+	///                  and Coherency::Explicit regions, the latter are maintained by the application using Sync
+	void AddMemoryRegion(const MemoryType& type, const uint64_t& baseAddr, const uint64_t& size, const AllocStrategy& strategy = AllocStrategy::FirstFit, const Coherency& coherency = Coherency::NonCoherent)
 	{
 		std::lock_guard<std::mutex> lock(m_memMtx);
-		m_memories[type].push_back(std::make_shared<internal::MemoryManager>(baseAddr, size));
+		m_memories[type].push_back(std::make_shared<internal::MemoryManager>(baseAddr, size, strategy));
+		m_pBackend->SetCoherency(baseAddr, size, coherency);
 	}
 
 	void AddMemoryRegion(const MemoryRegion& region)
+	{
+		AddMemoryRegion(region.type, region.baseAddress, region.size, region.strategy, region.coherency);
+	}
+
+	/// @brief Adds a memory region whose allocations are shared with all processes adding the same region of the same device,
+	///        i.e., the processes allocate from a common pool instead of statically partitioned slices. The allocation metadata
+	///        is stored in a shared-memory segment (CLAP_SHM_DIR) and the blocks of terminated processes are reclaimed.
+	///        Only supported on Linux, the device is typically opened with DeviceAccess::Shared.
+	/// @param type Type of memory
+	/// @param baseAddr Base address of the memory region
+	/// @param size Size of the memory region in bytes, has to be the same in all processes
+	/// @param name Name of the shared-memory segment, by default derived from the backend, the device number, and the region
+	/// @param coherency Coherency of the memory region with the CPU caches, see AddMemoryRegion
+	/// @param mode Permissions of a newly created segment, e.g., 0660 to share it with the group, an existing segment is only
+	///        used if it does not grant more permissions and is owned by the effective user (or the effective group for 0660)
+	void AddSharedMemoryRegion(const MemoryType& type, const uint64_t& baseAddr, const uint64_t& size, const std::string& name = "", const Coherency& coherency = Coherency::NonCoherent, const uint32_t& mode = internal::SharedAllocator::DEFAULT_MODE)
+	{
+		std::string segName = name;
+
+		if (segName.empty())
+		{
+			std::stringstream ss;
+			ss << "clap_" << m_pBackend->GetBackendName() << "_" << m_devNum << "_" << std::hex << baseAddr << "_" << size << ".alloc";
+			segName = ss.str();
+		}
+
+		for (char& c : segName)
+		{
+			if (!std::isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '-')
+				c = '_';
+		}
+
+		std::lock_guard<std::mutex> lock(m_memMtx);
+		m_memories[type].push_back(std::make_shared<internal::MemoryManager>(baseAddr, size, segName, mode));
+		m_pBackend->SetCoherency(baseAddr, size, coherency);
+	}
+
+	/// @brief Sets the policy used to select the memory region for allocations that do not specify a region index
+	/// @param type Type of memory
+	/// @param policy Region selection policy, by default RegionPolicy::FirstFit is used for all memory types
+	void SetRegionPolicy(const MemoryType& type, const RegionPolicy& policy)
+	{
+		std::lock_guard<std::mutex> lock(m_memMtx);
+		m_regionPolicies[type] = policy;
+	}
+
+	/// @brief Returns the number of memory regions of the specified type
+	/// @param type Type of memory
+	/// @return Number of memory regions
+	std::size_t GetMemoryRegionCount(const MemoryType& type)
+	{
+		std::lock_guard<std::mutex> lock(m_memMtx);
+		return m_memories[type].size();
+	}
+
+	/// @brief Returns a report on the free and used blocks of the specified memory region
+	/// @param type Type of memory
+	/// @param memIdx Index of the memory region
+	/// @return Fragmentation report of the memory region
+	FragmentationReport GetFragmentationReport(const MemoryType& type, const uint32_t& memIdx = 0)
 	{
 		std::lock_guard<std::mutex> lock(m_memMtx);
-		AddMemoryRegion(region.type, region.baseAddress, region.size);
+
+		if (m_memories[type].size() <= memIdx)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Specified memory region " << std::dec << memIdx << " does not exist.";
+			throw CLAPException(ss.str());
+		}
+
+		return m_memories[type][memIdx]->GetFragmentationReport();
 	}
 
 	/// @brief Allocates a memory block of the specified size and type
@@ -366,11 +717,9 @@ public:
 
 		if (memIdx == -1)
 		{
-			for (internal::MemoryManagerPtr& mem : m_memories[type])
-			{
-				if (mem->GetAvailableSpace() >= byteSize)
-					return mem->AllocMemory(byteSize);
-			}
+			const internal::MemoryManagerVec regions = selectRegions(type, byteSize, 1);
+			if (!regions.empty())
+				return regions.front()->AllocMemory(byteSize);
 		}
 		else
 		{
@@ -389,6 +738,93 @@ public:
 		throw CLAPException(ss.str());
 	}
 
+	/// @brief Creates a pool of fixed-size slots, the memory of all slots is allocated once and returned when the pool is destroyed
+	/// @param type Type of memory to allocate
+	/// @param slotSize Size of a single slot in bytes, slots are placed at MemoryPool::SLOT_ALIGNMENT aligned offsets
+	/// @param slotCount Number of slots
+	/// @param memIdx Index of the memory region to allocate from
+	/// @return Pointer to the memory pool, slots are acquired using MemoryPool::Acquire
+	MemoryPoolPtr CreateMemoryPool(const MemoryType& type, const uint64_t& slotSize, const uint32_t& slotCount, const int32_t& memIdx = -1)
+	{
+		if (slotSize == 0 || slotCount == 0 || MemoryPool::GetSlotStride(slotSize) > std::numeric_limits<uint64_t>::max() / slotCount)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Invalid memory pool of " << std::dec << slotCount << " slots of " << slotSize << " byte.";
+			throw CLAPException(ss.str());
+		}
+
+		const uint64_t byteSize = MemoryPool::GetSlotStride(slotSize) * slotCount;
+
+		std::lock_guard<std::mutex> lock(m_memMtx);
+
+		if (memIdx == -1)
+		{
+			const internal::MemoryManagerVec regions = selectRegions(type, byteSize, 1);
+			if (!regions.empty())
+				return makeMemoryPool(regions.front(), byteSize, slotSize, slotCount);
+		}
+		else
+		{
+			if (m_memories[type].size() <= static_cast<uint32_t>(memIdx))
+			{
+				std::stringstream ss;
+				ss << CLASS_TAG_AUTO << "Specified memory region " << std::dec << memIdx << " does not exist.";
+				throw CLAPException(ss.str());
+			}
+
+			return makeMemoryPool(m_memories[type][memIdx], byteSize, slotSize, slotCount);
+		}
+
+		std::stringstream ss;
+		ss << CLASS_TAG_AUTO << "No memory region found with enough space left to allocate a pool of " << std::dec << byteSize << " byte.";
+		throw CLAPException(ss.str());
+	}
+
+	/// @brief Allocates a memory block striped across multiple memory regions, e.g., to access multiple HBM pseudo-channels in parallel
+	/// @param type Type of memory to allocate
+	/// @param byteSize Total size of the memory block in bytes, bank i holds the i-th contiguous part of the block
+	/// @param bankCount Number of memory regions to stripe the block across, the regions are selected using the region policy of the memory type
+	/// @return Allocated striped memory block
+	StripedMemory AllocStripedMemory(const MemoryType& type, const uint64_t& byteSize, const uint32_t& bankCount)
+	{
+		const uint64_t stripeSize = (bankCount == 0 ? 0 : ROUND_UP_DIV(byteSize, static_cast<uint64_t>(bankCount)));
+
+		if (bankCount == 0 || stripeSize * (bankCount - 1) >= byteSize)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Unable to stripe " << std::dec << byteSize << " byte across " << bankCount << " memory regions.";
+			throw CLAPException(ss.str());
+		}
+
+		std::lock_guard<std::mutex> lock(m_memMtx);
+
+		const internal::MemoryManagerVec regions = selectRegions(type, stripeSize, bankCount);
+
+		if (regions.size() < bankCount)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Only " << std::dec << regions.size() << " of the requested " << bankCount << " memory regions have enough space left to allocate " << stripeSize << " byte.";
+			throw CLAPException(ss.str());
+		}
+
+		std::vector<Memory> banks;
+
+		try
+		{
+			for (uint32_t i = 0; i < bankCount; i++)
+				banks.push_back(regions[i]->AllocMemory(i == bankCount - 1 ? byteSize - stripeSize * i : stripeSize));
+		}
+		catch (...)
+		{
+			for (std::size_t i = 0; i < banks.size(); i++)
+				regions[i]->FreeMemory(banks[i]);
+
+			throw;
+		}
+
+		return StripedMemory(std::move(banks), byteSize, stripeSize);
+	}
+
 	/// @brief Allocates a memory block for n-elements
 	/// @param type Type of memory to allocate
 	/// @param elements Number of elements to allocate
@@ -473,6 +909,16 @@ public:
 		}
 	}
 
+	/// @brief Frees all banks of the specified striped memory block
+	/// @param mem Striped memory block to free
+	void FreeMemory(StripedMemory& mem)
+	{
+		for (Memory& bank : mem.m_banks)
+			FreeMemory(bank);
+
+		mem = StripedMemory();
+	}
+
 	/// @brief Resets the specified memory region
 	/// @param type Type of memory
 	/// @param memIdx Index of the memory region to reset
@@ -534,6 +980,16 @@ public:
 		}
 	}
 
+	/// @brief Maps the given memory object into the address space of the host (UIO, /dev/mem and bare metal backends)
+	/// @tparam T Type of the elements of the view
+	/// @param mem Memory object to map
+	/// @return View of the memory, the memory stays mapped until the view is destroyed
+	template<typename T = uint8_t>
+	MemoryView<T> MapMemory(const Memory& mem)
+	{
+		return MemoryView<T>(m_pBackend, mem);
+	}
+
 	////////////////////////////////////////////////////////////////////////////
 	///                      Read Methods                                    ///
 	////////////////////////////////////////////////////////////////////////////
@@ -564,6 +1020,33 @@ public:
 		Read(mem.GetBaseAddr(), pData, size);
 	}
 
+	/// @brief Reads data from the specified striped memory object into a contiguous data buffer
+	/// @param mem Striped memory object to read from
+	/// @param pData Pointer to the data buffer
+	/// @param sizeInByte Size of the data buffer in bytes
+	void Read(const StripedMemory& mem, void* pData, const uint64_t& sizeInByte = USE_MEMORY_SIZE)
+	{
+		const uint64_t size = (sizeInByte == USE_MEMORY_SIZE ? mem.GetSize() : sizeInByte);
+		if (size > mem.GetSize())
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << m_pBackend->GetName(internal::CLAPBackend::TYPE::READ) << ", specified size (0x" << std::hex << size << ") exceeds size of the given memory (0x" << std::hex << mem.GetSize() << ")";
+			throw CLAPException(ss.str());
+		}
+
+		uint8_t* pBytes = static_cast<uint8_t*>(pData);
+		uint64_t offset = 0;
+
+		for (const Memory& bank : mem.GetBanks())
+		{
+			if (offset >= size) break;
+
+			const uint64_t part = std::min(bank.GetSize(), size - offset);
+			Read(bank.GetBaseAddr(), pBytes + offset, part);
+			offset += part;
+		}
+	}
+
 	/// @brief Reads data from the given memory object into the given CLAP buffer
 	/// @tparam T Type of the data to read
 	/// @param mem Memory object to read from
@@ -646,6 +1129,35 @@ public:
 		return buffer;
 	}
 
+	/// @brief Reads data from the specified address into the given reusable vector, resizing it to hold sizeInByte bytes
+	/// @note The vector only reallocates if its capacity is too small, reading into the same vector (e.g., a CLAPHugeBuffer)
+	/// repeatedly therefore avoids the allocation and page faults of a new buffer for every transfer
+	/// @tparam T Type of the data to read
+	/// @tparam A The allocator used for the vector
+	/// @param addr Address to read from
+	/// @param buffer Vector to read into
+	/// @param sizeInByte Number of bytes to read
+	template<class T, class A = CLAPBufferAllocator<T>>
+	void ReadInto(const uint64_t& addr, std::vector<T, A>& buffer, const uint64_t& sizeInByte)
+	{
+		buffer.resize(ROUND_UP_DIV(sizeInByte, sizeof(T)));
+		Read(addr, buffer.data(), sizeInByte);
+	}
+
+	/// @brief Reads data from the given memory object into the given reusable vector, resizing it to hold the read data
+	/// @tparam T Type of the data to read
+	/// @tparam A The allocator used for the vector
+	/// @param mem Memory object to read from
+	/// @param buffer Vector to read into
+	/// @param sizeInByte Number of bytes to read, defaults to the size of the memory object
+	template<class T, class A = CLAPBufferAllocator<T>>
+	void ReadInto(const Memory& mem, std::vector<T, A>& buffer, const uint64_t& sizeInByte = USE_MEMORY_SIZE)
+	{
+		const uint64_t size = (sizeInByte == USE_MEMORY_SIZE ? mem.GetSize() : sizeInByte);
+		buffer.resize(ROUND_UP_DIV(size, sizeof(T)));
+		Read(mem, buffer.data(), size);
+	}
+
 	/// @brief Reads data from the specified address and returns it as an object of the template type T
 	/// @tparam T Type of the object into which the data will be read
 	/// @param addr Address to read from
@@ -653,11 +1165,8 @@ public:
 	template<typename T>
 	T Read(const uint64_t& addr)
 	{
-		const uint32_t size = static_cast<uint32_t>(sizeof(T));
-
-		CLAPBuffer<uint8_t> data = Read<uint8_t>(addr, size);
 		T res;
-		std::memcpy(&res, data.data(), size);
+		Read<T>(addr, res);
 		return res;
 	}
 
@@ -668,9 +1177,15 @@ public:
 	template<typename T>
 	void Read(const uint64_t& addr, T& buffer)
 	{
-		const uint32_t size      = static_cast<uint32_t>(sizeof(T));
-		CLAPBuffer<uint8_t> data = Read<uint8_t>(addr, size);
-		std::memcpy(&buffer, data.data(), size);
+		const uint32_t size = static_cast<uint32_t>(sizeof(T));
+
+		if constexpr (isScalar<T>())
+			m_pBackend->ReadScalar(addr, &buffer, size);
+		else
+		{
+			CLAPBuffer<uint8_t> data = Read<uint8_t>(addr, size);
+			std::memcpy(&buffer, data.data(), size);
+		}
 	}
 
 	/// @brief Reads data from the specified address and writes it into the given vector
@@ -779,12 +1294,39 @@ public:
 		Write(mem.GetBaseAddr(), pData, size);
 	}
 
-	/// @brief Writes data to the specified memory object
-	/// @tparam T Type of the data to write
-	/// @param mem Memory object to write to
-	/// @param buffer CLAP buffer containing the data to write
+	/// @brief Writes a contiguous data buffer to the specified striped memory object
+	/// @param mem Striped memory object to write to
+	/// @param pData Pointer to the data buffer
 	/// @param sizeInByte Size of the data buffer in bytes
-	template<typename T>
+	void Write(const StripedMemory& mem, const void* pData, const uint64_t& sizeInByte = USE_MEMORY_SIZE)
+	{
+		const uint64_t size = (sizeInByte == USE_MEMORY_SIZE ? mem.GetSize() : sizeInByte);
+		if (size > mem.GetSize())
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << m_pBackend->GetName(internal::CLAPBackend::TYPE::WRITE) << ", specified size (0x" << std::hex << size << ") exceeds size of the given memory (0x" << std::hex << mem.GetSize() << ")";
+			throw CLAPException(ss.str());
+		}
+
+		const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+		uint64_t offset       = 0;
+
+		for (const Memory& bank : mem.GetBanks())
+		{
+			if (offset >= size) break;
+
+			const uint64_t part = std::min(bank.GetSize(), size - offset);
+			Write(bank.GetBaseAddr(), pBytes + offset, part);
+			offset += part;
+		}
+	}
+
+	/// @brief Writes data to the specified memory object
+	/// @tparam T Type of the data to write
+	/// @param mem Memory object to write to
+	/// @param buffer CLAP buffer containing the data to write
+	/// @param sizeInByte Size of the data buffer in bytes
+	template<typename T>
 	void Write(const Memory& mem, const CLAPBuffer<T>& buffer, const uint64_t& sizeInByte = USE_MEMORY_SIZE)
 	{
 		uint64_t size = (sizeInByte == USE_MEMORY_SIZE ? mem.GetSize() : sizeInByte);
@@ -867,9 +1409,14 @@ public:
 	template<typename T>
 	void Write(const uint64_t& addr, const T& data)
 	{
-		// Create a temporary CLAPBuffer containing the data, in order to properly align the data
-		const CLAPBuffer<T> tmp = CLAPBuffer<T>(1, data);
-		Write<T>(addr, tmp);
+		if constexpr (isScalar<T>())
+			m_pBackend->WriteScalar(addr, &data, sizeof(T));
+		else
+		{
+			// Create a temporary CLAPBuffer containing the data, in order to properly align the data
+			const CLAPBuffer<T> tmp = CLAPBuffer<T>(1, data);
+			Write<T>(addr, tmp);
+		}
 	}
 
 	/// @brief Writes data from a vector to the specified address
@@ -947,6 +1494,218 @@ public:
 		write<uint64_t>(mem, data);
 	}
 
+	////////////////////////////////////////////////////////////////////////////
+	///                      Device Copy Methods                             ///
+	////////////////////////////////////////////////////////////////////////////
+
+	/// @brief Sets the engine used by CopyMemory, an AxiCDMA core sets itself on creation if no engine is set yet
+	/// @param pEngine Copy engine, nullptr moves the data of all following copies through the host
+	void SetCopyEngine(internal::DeviceCopyEngine* pEngine)
+	{
+		std::lock_guard<std::mutex> lock(m_copyMtx);
+		m_pCopyEngine = pEngine;
+	}
+
+	/// @brief Unsets the engine used by CopyMemory if it is the given one, waits for a copy currently executed by it
+	/// @param pEngine Copy engine to unset
+	void ReleaseCopyEngine(const internal::DeviceCopyEngine* pEngine)
+	{
+		std::lock_guard<std::mutex> lock(m_copyMtx);
+		if (m_pCopyEngine == pEngine)
+			m_pCopyEngine = nullptr;
+	}
+
+	bool HasCopyEngine()
+	{
+		std::lock_guard<std::mutex> lock(m_copyMtx);
+		return (m_pCopyEngine != nullptr);
+	}
+
+	/// @brief Copies data between two device memory objects. If a copy engine is set, e.g., an AxiCDMA core, the data is
+	///        copied by the device itself, otherwise it is read into a host buffer and written back in chunks.
+	/// @param src Memory object to copy from
+	/// @param dst Memory object to copy to, must not overlap with the copied range of src
+	/// @param sizeInByte Number of bytes to copy
+	void CopyMemory(const Memory& src, const Memory& dst, const uint64_t& sizeInByte = USE_MEMORY_SIZE)
+	{
+		const uint64_t size = (sizeInByte == USE_MEMORY_SIZE ? src.GetSize() : sizeInByte);
+		if (size > src.GetSize() || size > dst.GetSize())
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Specified size (0x" << std::hex << size << ") exceeds size of the source (0x" << src.GetSize() << ") or destination (0x" << dst.GetSize() << ") memory";
+			throw CLAPException(ss.str());
+		}
+
+		if (size == 0) return;
+
+		const uint64_t srcAddr = src.GetBaseAddr();
+		const uint64_t dstAddr = dst.GetBaseAddr();
+
+		if (srcAddr < dstAddr + size && dstAddr < srcAddr + size)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Source (0x" << std::hex << srcAddr << ") and destination (0x" << dstAddr << ") overlap for a copy of 0x" << size << " byte";
+			throw CLAPException(ss.str());
+		}
+
+		{
+			// The lock is held during the copy, the engine therefore cannot be released while in use
+			std::lock_guard<std::mutex> lock(m_copyMtx);
+			if (m_pCopyEngine)
+			{
+				m_pCopyEngine->CopyDeviceMemory(srcAddr, dstAddr, size);
+				return;
+			}
+		}
+
+		CLAP_CLASS_LOG_DEBUG << "No copy engine set, copying 0x" << std::hex << size << std::dec << " byte through the host" << std::endl;
+
+		CLAPBuffer<uint8_t> buffer(static_cast<std::size_t>(std::min(size, COPY_BOUNCE_BUFFER_SIZE)));
+
+		for (uint64_t offset = 0; offset < size; offset += buffer.size())
+		{
+			const uint64_t part = std::min(static_cast<uint64_t>(buffer.size()), size - offset);
+			Read(srcAddr + offset, buffer.data(), part);
+			Write(dstAddr + offset, buffer.data(), part);
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	///                      Cache Maintenance Methods                       ///
+	////////////////////////////////////////////////////////////////////////////
+
+	/// @brief Maintains the CPU caches of all given memory objects in a single batch, e.g., once for all buffers of a kernel launch.
+	///        Required for memory objects of regions added with Coherency::Explicit, memory objects of coherent regions are skipped.
+	/// @param dir SyncDirection::ToDevice after the host wrote the memory objects, SyncDirection::FromDevice before the host reads data written by the device
+	/// @param mems Memory objects to synchronize
+	void Sync(const SyncDirection& dir, const std::vector<Memory>& mems)
+	{
+		std::vector<internal::DeviceRange> ranges;
+		ranges.reserve(mems.size());
+
+		for (const Memory& mem : mems)
+		{
+			if (m_pBackend->GetCoherency(mem.GetBaseAddr()) != Coherency::Coherent)
+				ranges.push_back({ mem.GetBaseAddr(), mem.GetSize() });
+		}
+
+		if (ranges.empty()) return;
+
+		// Adjacent and overlapping memory objects are merged to maintain every cache line only once
+		std::sort(ranges.begin(), ranges.end(), [](const internal::DeviceRange& a, const internal::DeviceRange& b) { return a.addr < b.addr; });
+
+		std::vector<internal::DeviceRange> merged = { ranges.front() };
+
+		for (std::size_t i = 1; i < ranges.size(); i++)
+		{
+			internal::DeviceRange& last = merged.back();
+
+			if (ranges[i].addr <= last.addr + last.size)
+				last.size = std::max(last.size, ranges[i].addr + ranges[i].size - last.addr);
+			else
+				merged.push_back(ranges[i]);
+		}
+
+		m_pBackend->SyncRanges(merged, dir);
+	}
+
+	/// @brief Maintains the CPU caches of a single memory object, see Sync(dir, mems)
+	void Sync(const SyncDirection& dir, const Memory& mem)
+	{
+		Sync(dir, std::vector<Memory>{ mem });
+	}
+
+#ifndef EMBEDDED_XILINX
+	////////////////////////////////////////////////////////////////////////////
+	///                      Asynchronous Transfer Methods                   ///
+	////////////////////////////////////////////////////////////////////////////
+
+	/// @brief Creates an empty batch of transfers executed by the transfer pool of this CLAP instance
+	/// @return Transfer batch, transfers are added using TransferBatch::Read and TransferBatch::Write
+	TransferBatch CreateTransferBatch()
+	{
+		return TransferBatch(m_pTransferPool);
+	}
+
+	/// @brief Asynchronously reads data from the specified address into a data buffer, the buffer has to remain valid until the transfer finished
+	/// @param addr Address to read from
+	/// @param pData Pointer to the data buffer
+	/// @param sizeInByte Size of the data buffer in bytes
+	/// @return Handle to wait for the completion of the read
+	TransferHandle ReadAsync(const uint64_t& addr, void* pData, const uint64_t& sizeInByte)
+	{
+		return TransferHandle(m_pTransferPool->Submit({ { internal::CLAPBackend::TYPE::READ, addr, pData, sizeInByte } }));
+	}
+
+	/// @brief Asynchronously reads data from the given memory object into the given CLAP buffer, the buffer has to remain valid until the transfer finished
+	/// @tparam T Type of the data to read
+	/// @param mem Memory object to read from
+	/// @param buffer CLAP buffer to read into
+	/// @param sizeInByte Number of bytes to read
+	/// @return Handle to wait for the completion of the read
+	template<typename T>
+	TransferHandle ReadAsync(const Memory& mem, CLAPBuffer<T>& buffer, const uint64_t& sizeInByte = USE_MEMORY_SIZE)
+	{
+		return CreateTransferBatch().Read(mem, 0, buffer, sizeInByte).Submit();
+	}
+
+	/// @brief Asynchronously writes data to the specified address, the buffer has to remain valid until the transfer finished
+	/// @param addr Address to write to
+	/// @param pData Pointer to the data buffer
+	/// @param sizeInByte Size of the data buffer in bytes
+	/// @return Handle to wait for the completion of the write
+	TransferHandle WriteAsync(const uint64_t& addr, const void* pData, const uint64_t& sizeInByte)
+	{
+		return TransferHandle(m_pTransferPool->Submit({ { internal::CLAPBackend::TYPE::WRITE, addr, const_cast<void*>(pData), sizeInByte } }));
+	}
+
+	/// @brief Asynchronously writes data to the specified memory object, the buffer has to remain valid until the transfer finished
+	/// @tparam T Type of the data to write
+	/// @param mem Memory object to write to
+	/// @param buffer CLAP buffer containing the data to write
+	/// @param sizeInByte Number of bytes to write
+	/// @return Handle to wait for the completion of the write
+	template<typename T>
+	TransferHandle WriteAsync(const Memory& mem, const CLAPBuffer<T>& buffer, const uint64_t& sizeInByte = USE_MEMORY_SIZE)
+	{
+		return CreateTransferBatch().Write(mem, 0, buffer, sizeInByte).Submit();
+	}
+
+	////////////////////////////////////////////////////////////////////////////
+	///                      File Transfer Methods                           ///
+	////////////////////////////////////////////////////////////////////////////
+
+	/// @brief Writes the content of a file to the specified memory object, the file is streamed through a ring of staging buffers
+	///        whose reads overlap with the transfers to the device. Backends that map the device memory read the file directly into the mapping.
+	/// @param mem Memory object to write to
+	/// @param fileName Path of the file to read from
+	/// @param fileOffset Offset in the file in bytes, direct I/O is only used if it is a multiple of ALIGNMENT
+	/// @param sizeInByte Number of bytes to transfer, the file has to contain them starting at fileOffset
+	/// @param options Size and number of the staging buffers and whether the page cache is bypassed
+	void WriteFromFile(const Memory& mem, const std::string& fileName, const uint64_t& fileOffset = 0, const uint64_t& sizeInByte = USE_MEMORY_SIZE, const FileTransferOptions& options = FileTransferOptions())
+	{
+		const uint64_t size = checkFileTransferSize(mem, sizeInByte, internal::CLAPBackend::TYPE::WRITE);
+		if (size == 0) return;
+
+		internal::FileStager(m_pBackend, m_pTransferPool, options).ToDevice(fileName, fileOffset, mem.GetBaseAddr(), size);
+	}
+
+	/// @brief Reads the specified memory object into a file, the reads from the device overlap with the writes of the previous chunks to the file.
+	///        The file is created if it does not exist, existing files are not truncated, i.e., only the given range is overwritten.
+	/// @param mem Memory object to read from
+	/// @param fileName Path of the file to write to
+	/// @param fileOffset Offset in the file in bytes, direct I/O is only used if it is a multiple of ALIGNMENT
+	/// @param sizeInByte Number of bytes to transfer
+	/// @param options Size and number of the staging buffers and whether the page cache is bypassed
+	void ReadToFile(const Memory& mem, const std::string& fileName, const uint64_t& fileOffset = 0, const uint64_t& sizeInByte = USE_MEMORY_SIZE, const FileTransferOptions& options = FileTransferOptions())
+	{
+		const uint64_t size = checkFileTransferSize(mem, sizeInByte, internal::CLAPBackend::TYPE::READ);
+		if (size == 0) return;
+
+		internal::FileStager(m_pBackend, m_pTransferPool, options).FromDevice(fileName, fileOffset, mem.GetBaseAddr(), size);
+	}
+#endif
+
 	////////////////////////////////////////////////////////////////////////////
 	///                      UIO Property Methods                            ///
 	////////////////////////////////////////////////////////////////////////////
@@ -980,6 +1739,25 @@ public:
 	///                      Streaming Methods                               ///
 	////////////////////////////////////////////////////////////////////////////
 
+#ifndef EMBEDDED_XILINX
+	/// @brief Creates a ring of stream buffers that are transferred back-to-back in the background
+	/// @param direction Direction of the stream
+	/// @param chunkSize Maximum size of a single transfer in bytes, StreamRing::USE_BUFFER_SIZE transfers each buffer at once
+	/// @return Pointer to the stream ring, buffers are added using StreamRing::AddBuffer
+	StreamRingPtr CreateStreamRing(const StreamDirection& direction, const uint64_t& chunkSize = StreamRing::USE_BUFFER_SIZE)
+	{
+		if (!m_info.IsStreaming())
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "The XDMA endpoint is not in streaming mode";
+			throw CLAPException(ss.str());
+		}
+
+		StreamRingPtr pRing = std::make_shared<StreamRing>(m_pBackend, direction, chunkSize);
+		pRing->SetThreadAffinity(GetThreadAffinity());
+		return pRing;
+	}
+
 	/// @brief Starts a streaming read, reading sizeInByte bytes into the specified CLAP buffer
 	/// @tparam T Type of the CLAP buffer into which the data will be read
 	/// @param buffer CLAP buffer to read into
@@ -1029,21 +1807,15 @@ public:
 	/// @brief Waits for the read stream operation to finish
 	void WaitForReadStream()
 	{
-		if (m_readFuture.valid())
-		{
-			m_readFuture.wait();
-			m_readFuture.get();
-		}
+		if (m_pReadStream)
+			m_pReadStream->WaitForAll();
 	}
 
 	/// @brief Waits for the write stream operation to finish
 	void WaitForWriteStream()
 	{
-		if (m_writeFuture.valid())
-		{
-			m_writeFuture.wait();
-			m_writeFuture.get();
-		}
+		if (m_pWriteStream)
+			m_pWriteStream->WaitForAll();
 	}
 
 	/// @brief Waits for the read and write stream operations to finish
@@ -1057,17 +1829,25 @@ public:
 	/// @return Runtime in milliseconds
 	double GetReadStreamRuntime() const
 	{
-		return m_readStreamTimer.GetElapsedTimeInMilliSec();
+		return (m_pReadStream ? m_pReadStream->GetRuntime() : 0.0);
 	}
 
 	/// @brief Returns the runtime of the last write stream operation in milliseconds
 	/// @return Runtime in milliseconds
 	double GetWriteStreamRuntime() const
 	{
-		return m_writeStreamTimer.GetElapsedTimeInMilliSec();
+		return (m_pWriteStream ? m_pWriteStream->GetRuntime() : 0.0);
 	}
+#endif
 
 private:
+	// Types that can be transferred using the allocation-free scalar path of the backend
+	template<typename T>
+	static constexpr bool isScalar()
+	{
+		return std::is_trivially_copyable<T>::value && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+	}
+
 	template<typename T>
 	T read(const Memory& mem)
 	{
@@ -1094,89 +1874,34 @@ private:
 		return Write<T>(mem.GetBaseAddr(), data);
 	}
 
+#ifndef EMBEDDED_XILINX
+	// The classic stream API is a single-buffer stream ring that transfers the buffer in ALIGNMENT sized chunks
 	void startReadStream(void* pData, const uint64_t& sizeInByte)
 	{
-		if (!m_info.IsStreaming())
-		{
-			std::stringstream ss;
-			ss << CLASS_TAG_AUTO << "The XDMA endpoint is not in streaming mode";
-			throw CLAPException(ss.str());
-		}
-
-		if (m_readFuture.valid())
+		if (m_pReadStream && m_pReadStream->IsBusy())
 		{
 			std::stringstream ss;
 			ss << CLASS_TAG_AUTO << "Read stream is already running";
 			throw CLAPException(ss.str());
 		}
 
-		m_readFuture = std::async(&CLAP::readStream, this, pData, sizeInByte);
+		m_pReadStream = CreateStreamRing(StreamDirection::Read, ALIGNMENT);
+		m_pReadStream->Submit(m_pReadStream->AddBuffer(pData, sizeInByte));
 	}
 
 	void startWriteStream(const void* pData, const uint64_t& sizeInByte)
 	{
-		if (!m_info.IsStreaming())
-		{
-			std::stringstream ss;
-			ss << CLASS_TAG_AUTO << "The XDMA endpoint is not in streaming mode";
-			throw CLAPException(ss.str());
-		}
-
-		if (m_writeFuture.valid())
+		if (m_pWriteStream && m_pWriteStream->IsBusy())
 		{
 			std::stringstream ss;
 			ss << CLASS_TAG_AUTO << "Write stream is already running";
 			throw CLAPException(ss.str());
 		}
 
-		m_writeFuture = std::async(&CLAP::writeStream, this, pData, sizeInByte);
-	}
-
-	void writeStream(const void* pData, const uint64_t& size)
-	{
-		// Due to the AXI data width of the XDMA write size has to be a multiple of 512-Bit (64-Byte)
-		if (size % internal::XDMA_AXI_DATA_WIDTH != 0)
-		{
-			std::stringstream ss;
-			ss << CLASS_TAG_AUTO << "Size (" << size << ") is not a multiple of the XDMA AXI data width (" << internal::XDMA_AXI_DATA_WIDTH << ").";
-			throw CLAPException(ss.str());
-		}
-
-		uint64_t curSize = 0;
-		m_writeStreamTimer.Start();
-
-		while (curSize < size)
-		{
-			uint64_t writeSize = std::min(size - curSize, static_cast<uint64_t>(ALIGNMENT));
-			Write(internal::XDMA_STREAM_OFFSET, reinterpret_cast<const uint8_t*>(pData) + curSize, writeSize);
-			curSize += writeSize;
-		}
-
-		m_writeStreamTimer.Stop();
-	}
-
-	void readStream(void* pData, const uint64_t& size)
-	{
-		// Due to the AXI data width of the XDMA read size has to be a multiple of 512-Bit (64-Byte)
-		if (size % internal::XDMA_AXI_DATA_WIDTH != 0)
-		{
-			std::stringstream ss;
-			ss << CLASS_TAG_AUTO << "Size (" << size << ") is not a multiple of the XDMA AXI data width (" << internal::XDMA_AXI_DATA_WIDTH << ").";
-			throw CLAPException(ss.str());
-		}
-
-		uint64_t curSize = 0;
-		m_readStreamTimer.Start();
-
-		while (curSize < size)
-		{
-			uint64_t readSize = std::min(size - curSize, static_cast<uint64_t>(ALIGNMENT));
-			Read(internal::XDMA_STREAM_OFFSET, reinterpret_cast<uint8_t*>(pData) + curSize, readSize);
-			curSize += readSize;
-		}
-
-		m_readStreamTimer.Stop();
+		m_pWriteStream = CreateStreamRing(StreamDirection::Write, ALIGNMENT);
+		m_pWriteStream->Submit(m_pWriteStream->AddBuffer(pData, sizeInByte));
 	}
+#endif
 
 	// --------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
@@ -1208,6 +1933,90 @@ private:
 		return static_cast<T>(tmp);
 	}
 
+#ifndef EMBEDDED_XILINX
+	// Has to be called with m_placementMtx held
+	void applyThreadAffinity()
+	{
+		m_pReactor->SetThreadAffinity(m_threadAffinity);
+		m_pTransferPool->SetThreadAffinity(m_threadAffinity);
+		m_pBackend->ConfigureThreadAffinity(m_threadAffinity);
+
+		if (m_pReadStream) m_pReadStream->SetThreadAffinity(m_threadAffinity);
+		if (m_pWriteStream) m_pWriteStream->SetThreadAffinity(m_threadAffinity);
+	}
+
+	uint64_t checkFileTransferSize(const Memory& mem, const uint64_t& sizeInByte, const internal::CLAPBackend::TYPE& type) const
+	{
+		const uint64_t size = (sizeInByte == USE_MEMORY_SIZE ? mem.GetSize() : sizeInByte);
+		if (size > mem.GetSize())
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << m_pBackend->GetName(type) << ", specified size (0x" << std::hex << size << ") exceeds size of the given memory (0x" << std::hex << mem.GetSize() << ")";
+			throw CLAPException(ss.str());
+		}
+
+		return size;
+	}
+#endif
+
+	// The region is returned to the memory manager if the pool cannot be created. Has to be called with m_memMtx held.
+	MemoryPoolPtr makeMemoryPool(const internal::MemoryManagerPtr& pManager, const uint64_t& byteSize, const uint64_t& slotSize, const uint32_t& slotCount)
+	{
+		Memory region = pManager->AllocMemory(byteSize);
+
+		try
+		{
+			return std::make_shared<MemoryPool>(pManager, region, slotSize, slotCount);
+		}
+		catch (...)
+		{
+			pManager->FreeMemory(region);
+			throw;
+		}
+	}
+
+	// Returns up to count distinct regions with at least byteSize byte left, ordered by the region policy of the memory type.
+	// Has to be called with m_memMtx held.
+	internal::MemoryManagerVec selectRegions(const MemoryType& type, const uint64_t& byteSize, const std::size_t& count)
+	{
+		const internal::MemoryManagerVec& memories = m_memories[type];
+		const RegionPolicy policy                  = m_regionPolicies[type];
+		internal::MemoryManagerVec regions;
+
+		if (memories.empty()) return regions;
+
+		std::vector<std::size_t> order(memories.size());
+		std::iota(order.begin(), order.end(), 0);
+
+		if (policy == RegionPolicy::RoundRobin)
+			std::rotate(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(m_nextRegion[type] % memories.size()), order.end());
+		else if (policy == RegionPolicy::LeastUsed)
+		{
+			const auto usage = [&memories](const std::size_t& idx) {
+				const internal::MemoryManagerPtr& mem = memories[idx];
+				return (mem->GetSize() == 0 ? 1.0 : 1.0 - static_cast<double>(mem->GetAvailableSpace()) / static_cast<double>(mem->GetSize()));
+			};
+
+			std::stable_sort(order.begin(), order.end(), [&usage](const std::size_t& a, const std::size_t& b) { return usage(a) < usage(b); });
+		}
+
+		std::size_t lastIdx = 0;
+
+		for (const std::size_t& idx : order)
+		{
+			if (regions.size() == count) break;
+			if (!memories[idx]->HasSpaceLeft(byteSize)) continue;
+
+			regions.push_back(memories[idx]);
+			lastIdx = idx;
+		}
+
+		if (policy == RegionPolicy::RoundRobin && !regions.empty())
+			m_nextRegion[type] = lastIdx + 1;
+
+		return regions;
+	}
+
 	void readInfo()
 	{
 		try
@@ -1224,19 +2033,153 @@ private:
 
 private:
 	internal::CLAPBackendPtr m_pBackend;
+#ifndef EMBEDDED_XILINX
+	internal::CompletionReactorPtr m_pReactor;
+	internal::TransferPoolPtr m_pTransferPool;
+	internal::MetricsRegistryPtr m_pMetrics;
+#endif
 	std::map<MemoryType, internal::MemoryManagerVec> m_memories;
-	std::future<void> m_readFuture  = {};
-	std::future<void> m_writeFuture = {};
-	Timer m_readStreamTimer         = {};
-	Timer m_writeStreamTimer        = {};
+	std::map<MemoryType, RegionPolicy> m_regionPolicies;
+	std::map<MemoryType, std::size_t> m_nextRegion;
+#ifndef EMBEDDED_XILINX
+	StreamRingPtr m_pReadStream                         = nullptr;
+	StreamRingPtr m_pWriteStream                        = nullptr;
+	std::shared_ptr<internal::DeviceLock> m_pDeviceLock = nullptr;
+#endif
 
 	XDMAInfo m_info = {};
 
 	std::mutex m_rwMtx;
 	std::mutex m_pollAddrMtx;
 	std::mutex m_memMtx;
+	std::mutex m_copyMtx;
+
+	internal::DeviceCopyEngine* m_pCopyEngine = nullptr;
+#ifndef EMBEDDED_XILINX
+	std::mutex m_placementMtx;
+	int32_t m_numaNode      = NUMA_NODE_UNKNOWN;
+	CpuSet m_threadAffinity = {};
+#endif
+	// Size of the host buffer used by CopyMemory without a copy engine
+	static inline const uint64_t COPY_BOUNCE_BUFFER_SIZE = 4 * 1024 * 1024;
+};
+
+/// @brief CLAP instance whose backend type is known at compile time. Scalar accesses call the backend non-virtually,
+///        allowing the compiler to inline them down to the final load or store, e.g., for tight control loops.
+///        Converts to a CLAPPtr, i.e., it can be used everywhere a regular CLAP instance is expected.
+/// @tparam Backend Type of the backend
+template<typename Backend>
+class TypedCLAP final : public CLAP
+{
+	static_assert(std::is_base_of_v<internal::CLAPBackend, Backend>, "Backend has to be derived from CLAPBackend");
+
+	explicit TypedCLAP(std::shared_ptr<Backend> pBackend, const DeviceAccess& access) :
+		CLAPBase(pBackend->GetDevNum()),
+		CLAP(pBackend, access),
+		m_backend(*pBackend)
+	{}
+
+public:
+	DISABLE_COPY_ASSIGN_MOVE(TypedCLAP)
+
+	/// @brief Creates a new CLAP instance with a statically typed backend
+	/// @return A shared pointer to the new CLAP instance
+	/// @param deviceNum Device number of the CLAP device
+	/// @param channelNum Channel number of the CLAP device, XDMA_ALL_CHANNELS opens all available channels
+	/// @param disableWarden Opens the device without locking it if set to true, otherwise the device is locked exclusively
+	static std::shared_ptr<TypedCLAP> Create(const uint32_t& deviceNum = 0, const uint32_t& channelNum = 0, const bool& disableWarden = false)
+	{
+		return Create(deviceNum, channelNum, (disableWarden ? DeviceAccess::Unlocked : DeviceAccess::Exclusive));
+	}
+
+	/// @brief Creates a new CLAP instance with a statically typed backend
+	/// @return A shared pointer to the new CLAP instance
+	/// @param deviceNum Device number of the CLAP device
+	/// @param channelNum Channel number of the CLAP device, XDMA_ALL_CHANNELS opens all available channels
+	/// @param access Access to the device, throws if another process holds a conflicting lock on the device
+	static std::shared_ptr<TypedCLAP> Create(const uint32_t& deviceNum, const uint32_t& channelNum, const DeviceAccess& access)
+	{
+		return std::shared_ptr<TypedCLAP>(new TypedCLAP(std::make_shared<Backend>(deviceNum, channelNum), access));
+	}
+
+	/// @brief Returns the backend, e.g., to call backend specific methods
+	Backend& GetBackend()
+	{
+		return m_backend;
+	}
+
+	using CLAP::Read8;
+	using CLAP::Read16;
+	using CLAP::Read32;
+	using CLAP::Read64;
+	using CLAP::Write8;
+	using CLAP::Write16;
+	using CLAP::Write32;
+	using CLAP::Write64;
+
+	uint8_t Read8(const uint64_t& addr) override
+	{
+		return read<uint8_t>(addr);
+	}
+
+	uint16_t Read16(const uint64_t& addr) override
+	{
+		return read<uint16_t>(addr);
+	}
+
+	uint32_t Read32(const uint64_t& addr) override
+	{
+		return read<uint32_t>(addr);
+	}
+
+	uint64_t Read64(const uint64_t& addr) override
+	{
+		return read<uint64_t>(addr);
+	}
+
+	void Write8(const uint64_t& addr, const uint8_t& data) override
+	{
+		write<uint8_t>(addr, data);
+	}
+
+	void Write16(const uint64_t& addr, const uint16_t& data) override
+	{
+		write<uint16_t>(addr, data);
+	}
+
+	void Write32(const uint64_t& addr, const uint32_t& data) override
+	{
+		write<uint32_t>(addr, data);
+	}
+
+	void Write64(const uint64_t& addr, const uint64_t& data) override
+	{
+		write<uint64_t>(addr, data);
+	}
+
+private:
+	// The qualified calls bypass the virtual dispatch of the backend
+	template<typename T>
+	T read(const uint64_t& addr)
+	{
+		T data;
+		m_backend.Backend::ReadScalar(addr, &data, sizeof(T));
+		return data;
+	}
+
+	template<typename T>
+	void write(const uint64_t& addr, const T& data)
+	{
+		m_backend.Backend::WriteScalar(addr, &data, sizeof(T));
+	}
+
+private:
+	Backend& m_backend;
 };
 
+template<typename Backend>
+using TypedCLAPPtr = std::shared_ptr<TypedCLAP<Backend>>;
+
 #ifndef _WIN32
 // TODO: Add backend classes for Pio
 // NOTE: PIO is used for the AXI-Lite interface of the XDMA -- But currently not fully supported by this API
@@ -1327,6 +2270,17 @@ public:
 		write<uint64_t>(addr, data);
 	}
 
+	bool SupportsRegisterBursts() const override
+	{
+		return false;
+	}
+
+	void WriteRegisters(const uint64_t& addr, const uint32_t* pData, const std::size_t& count) override
+	{
+		for (std::size_t i = 0; i < count; i++)
+			write<uint32_t>(addr + i * sizeof(uint32_t), pData[i]);
+	}
+
 private:
 	template<typename T>
 	T read(const uint64_t& addr)
@@ -1422,9 +2376,7 @@ inline CLAPManaged::~CLAPManaged()
 
 inline void Cleanup()
 {
-#ifndef EMBEDDED_XILINX
-	internal::SoloRunWarden::Cleanup();
-#endif
+	// Device locks are released by the kernel once the process terminates, nothing has to be cleaned up anymore
 }
 
 } // namespace clap
\ No newline at end of file
@@ -0,0 +1,374 @@
+/*
+ *  File: CLAPDevicePool.hpp
+ *  Copyright (c) 2024 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#ifdef EMBEDDED_XILINX
+#error "The CLAPDevicePool requires threads and is not supported in Baremetal setups"
+#endif
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "CLAP.hpp"
+
+namespace clap
+{
+class CLAPDevicePool;
+
+using CLAPDevicePoolPtr = std::shared_ptr<CLAPDevicePool>;
+
+// Set of devices with identical bitstreams sharing a job scheduler. Every device has its own job queue
+// and worker threads, jobs without a device preference are placed on the least loaded device, and idle
+// workers steal stealable jobs from the queue of the most loaded device.
+class CLAPDevicePool
+{
+	DISABLE_COPY_ASSIGN_MOVE(CLAPDevicePool)
+
+public:
+	// Device index within the pool and the CLAP instance of the device executing the job
+	using JobFunc = std::function<void(const std::size_t&, const CLAPPtr&)>;
+
+	struct DeviceStats
+	{
+		std::size_t queued  = 0;
+		std::size_t running = 0;
+		uint64_t completed  = 0;
+		uint64_t stolen     = 0; // Jobs of other devices executed by this device
+	};
+
+	/// @brief Opens the given devices and creates a pool for them
+	/// @tparam T Type of the backend to use
+	/// @param deviceNums Device numbers of the devices, all devices have to contain the same design
+	/// @param channelNum Channel number used for all devices
+	/// @param workersPerDevice Number of jobs executed concurrently per device
+	/// @param access Access to the devices
+	/// @return A shared pointer to the new device pool
+	template<typename T>
+	static CLAPDevicePoolPtr Create(const std::vector<uint32_t>& deviceNums, const uint32_t& channelNum = 0, const std::size_t& workersPerDevice = 1, const DeviceAccess& access = DeviceAccess::Exclusive)
+	{
+		std::vector<CLAPPtr> devices;
+
+		for (const uint32_t& devNum : deviceNums)
+			devices.push_back(CLAP::Create<T>(devNum, channelNum, access));
+
+		return std::make_shared<CLAPDevicePool>(std::move(devices), workersPerDevice);
+	}
+
+	CLAPDevicePool(std::vector<CLAPPtr> devices, const std::size_t& workersPerDevice = 1) :
+		m_devices(std::move(devices)),
+		m_queues(m_devices.size()),
+		m_stats(m_devices.size())
+	{
+		if (m_devices.empty() || workersPerDevice == 0)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "A device pool requires at least one device and one worker per device";
+			throw CLAPException(ss.str());
+		}
+
+		try
+		{
+			for (std::size_t dev = 0; dev < m_devices.size(); dev++)
+			{
+				// Workers run next to the internal threads of their device, e.g., on the NUMA node of the PCIe device
+				const CpuSet cpus = m_devices[dev]->GetThreadAffinity();
+
+				for (std::size_t i = 0; i < workersPerDevice; i++)
+				{
+					m_workers.emplace_back(&CLAPDevicePool::run, this, dev);
+
+					if (!cpus.empty())
+						numa::PinThread(m_workers.back(), cpus);
+				}
+			}
+		}
+		catch (...)
+		{
+			// The already started workers have to be joined before the members are destroyed
+			shutdown();
+			throw;
+		}
+	}
+
+	~CLAPDevicePool()
+	{
+		shutdown();
+	}
+
+	std::size_t GetDeviceCount() const
+	{
+		return m_devices.size();
+	}
+
+	const CLAPPtr& GetDevice(const std::size_t& deviceIdx) const
+	{
+		checkDevice(deviceIdx);
+		return m_devices[deviceIdx];
+	}
+
+	/// @brief Creates one instance of the given IP core (or any other type constructed from a CLAPPtr) per device
+	/// @tparam T Type of the IP core, e.g., HLSCore or AxiDMA<uint64_t>
+	/// @param args Arguments passed to the constructor after the CLAP instance, e.g., the control offset and name
+	/// @return One instance per device, indexed by the device index passed to the jobs
+	template<typename T, typename... Args>
+	std::vector<std::shared_ptr<T>> Replicate(const Args&... args) const
+	{
+		std::vector<std::shared_ptr<T>> replicas;
+		replicas.reserve(m_devices.size());
+
+		for (const CLAPPtr& pClap : m_devices)
+			replicas.push_back(std::make_shared<T>(pClap, args...));
+
+		return replicas;
+	}
+
+	/// @brief Submits a job to the least loaded device, the job can be stolen by any idle device
+	/// @param job Job to execute, receives the index and the CLAP instance of the executing device
+	/// @return Future of the job, rethrows the exception thrown by the job
+	std::future<void> Submit(JobFunc job)
+	{
+		checkJob(job);
+
+		std::lock_guard<std::mutex> lock(m_mtx);
+		return enqueue(leastLoaded(), std::move(job), true);
+	}
+
+	/// @brief Submits a job to the given device, e.g., because its input data already resides in the memory of that device
+	/// @param deviceIdx Index of the device within the pool
+	/// @param job Job to execute, receives the index and the CLAP instance of the executing device
+	/// @param allowStealing Allows other devices to execute the job if they are idle, only valid if the job does not depend on device local data
+	/// @return Future of the job, rethrows the exception thrown by the job
+	std::future<void> Submit(const std::size_t& deviceIdx, JobFunc job, const bool& allowStealing = false)
+	{
+		checkDevice(deviceIdx);
+		checkJob(job);
+
+		std::lock_guard<std::mutex> lock(m_mtx);
+		return enqueue(deviceIdx, std::move(job), allowStealing);
+	}
+
+	/// @brief Waits until all submitted jobs have finished
+	void WaitIdle()
+	{
+		std::unique_lock<std::mutex> lock(m_mtx);
+		m_idleCv.wait(lock, [this] { return m_outstanding == 0; });
+	}
+
+	std::vector<DeviceStats> GetStats() const
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+
+		std::vector<DeviceStats> stats = m_stats;
+		for (std::size_t dev = 0; dev < m_queues.size(); dev++)
+			stats[dev].queued = m_queues[dev].size();
+
+		return stats;
+	}
+
+private:
+	struct Job
+	{
+		JobFunc func               = {};
+		std::promise<void> promise = {};
+		bool stealable             = false;
+	};
+
+	void checkDevice(const std::size_t& deviceIdx) const
+	{
+		if (deviceIdx < m_devices.size()) return;
+
+		std::stringstream ss;
+		ss << CLASS_TAG_AUTO << "Device index " << deviceIdx << " exceeds the number of devices in the pool (" << m_devices.size() << ")";
+		throw CLAPException(ss.str());
+	}
+
+	void shutdown()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			m_stop = true;
+		}
+
+		m_cv.notify_all();
+
+		// Workers drain the queues before exiting
+		for (std::thread& t : m_workers)
+			t.join();
+	}
+
+	// An empty job would never fulfill its promise, leaving WaitIdle and the destructor blocked forever
+	void checkJob(const JobFunc& job) const
+	{
+		if (job) return;
+
+		std::stringstream ss;
+		ss << CLASS_TAG_AUTO << "Submitted job is empty";
+		throw CLAPException(ss.str());
+	}
+
+	// Has to be called with the mutex locked
+	std::size_t load(const std::size_t& dev) const
+	{
+		return m_queues[dev].size() + m_stats[dev].running;
+	}
+
+	// Has to be called with the mutex locked
+	std::size_t leastLoaded() const
+	{
+		std::size_t best = 0;
+		for (std::size_t dev = 1; dev < m_devices.size(); dev++)
+		{
+			if (load(dev) < load(best))
+				best = dev;
+		}
+
+		return best;
+	}
+
+	// Has to be called with the mutex locked
+	std::future<void> enqueue(const std::size_t& dev, JobFunc func, const bool& stealable)
+	{
+		Job job;
+		job.func      = std::move(func);
+		job.stealable = stealable;
+
+		std::future<void> future = job.promise.get_future();
+
+		m_queues[dev].push_back(std::move(job));
+		m_outstanding++;
+		m_cv.notify_all();
+
+		return future;
+	}
+
+	// Has to be called with the mutex locked, picks the next job of the own queue or steals the
+	// most recently queued stealable job of the device with the longest queue
+	bool takeJob(const std::size_t& dev, Job& job)
+	{
+		if (!m_queues[dev].empty())
+		{
+			job = std::move(m_queues[dev].front());
+			m_queues[dev].pop_front();
+			return true;
+		}
+
+		std::size_t victim      = dev;
+		std::size_t victimQueue = 0;
+
+		for (std::size_t other = 0; other < m_queues.size(); other++)
+		{
+			if (other == dev || m_queues[other].size() <= victimQueue) continue;
+
+			if (std::any_of(m_queues[other].begin(), m_queues[other].end(), [](const Job& j) { return j.stealable; }))
+			{
+				victim      = other;
+				victimQueue = m_queues[other].size();
+			}
+		}
+
+		if (victim == dev) return false;
+
+		std::deque<Job>& queue = m_queues[victim];
+		for (auto it = queue.rbegin(); it != queue.rend(); ++it)
+		{
+			if (!it->stealable) continue;
+
+			job = std::move(*it);
+			queue.erase(std::next(it).base());
+			m_stats[dev].stolen++;
+			return true;
+		}
+
+		return false;
+	}
+
+	void run(const std::size_t dev)
+	{
+		while (true)
+		{
+			Job job;
+
+			{
+				std::unique_lock<std::mutex> lock(m_mtx);
+				m_cv.wait(lock, [this, dev, &job] { return takeJob(dev, job) || (m_stop && m_outstanding == 0); });
+
+				if (!job.func) return;
+
+				m_stats[dev].running++;
+			}
+
+			try
+			{
+				job.func(dev, m_devices[dev]);
+				job.promise.set_value();
+			}
+			catch (...)
+			{
+				job.promise.set_exception(std::current_exception());
+			}
+
+			bool drained = false;
+
+			{
+				std::lock_guard<std::mutex> lock(m_mtx);
+				m_stats[dev].running--;
+				m_stats[dev].completed++;
+				m_outstanding--;
+				drained = (m_outstanding == 0);
+			}
+
+			// Wakes WaitIdle and, on shutdown, the workers waiting for the jobs of other devices to finish
+			if (drained)
+			{
+				m_cv.notify_all();
+				m_idleCv.notify_all();
+			}
+		}
+	}
+
+private:
+	std::vector<CLAPPtr> m_devices;
+	std::vector<std::deque<Job>> m_queues;
+	std::vector<DeviceStats> m_stats;
+	std::vector<std::thread> m_workers = {};
+	mutable std::mutex m_mtx           = {};
+	std::condition_variable m_cv       = {};
+	std::condition_variable m_idleCv   = {};
+	std::size_t m_outstanding          = 0;
+	bool m_stop                        = false;
+};
+} // namespace clap
@@ -0,0 +1,422 @@
+/*
+ *  File: CLAPPipeline.hpp
+ *  Copyright (c) 2024 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#ifdef EMBEDDED_XILINX
+#error "The CLAPPipeline requires threads and is not supported in Baremetal setups"
+#endif
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CLAP.hpp"
+#include "IP_Cores/AxiDMA.hpp"
+#include "IP_Cores/HLSCore.hpp"
+
+namespace clap
+{
+class CLAPPipeline;
+
+using CLAPPipelinePtr = std::shared_ptr<CLAPPipeline>;
+
+// Device buffers of the batch a stage is processing. Every buffer added to the pipeline exists once per
+// buffer set, batch k uses set k % depth, i.e., the buffers of a batch are disjoint from the ones of the
+// depth - 1 batches processed concurrently by the other stages.
+class PipelineBatch
+{
+	friend class CLAPPipeline;
+
+public:
+	const uint64_t& GetIndex() const
+	{
+		return m_index;
+	}
+
+	const uint32_t& GetBufferSet() const
+	{
+		return m_set;
+	}
+
+	const Memory& GetMemory(const std::size_t& bufferIdx) const
+	{
+		if (bufferIdx >= m_pBuffers->size())
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Buffer index " << bufferIdx << " exceeds the number of pipeline buffers (" << m_pBuffers->size() << ")";
+			throw CLAPException(ss.str());
+		}
+
+		return (*m_pBuffers)[bufferIdx][m_set];
+	}
+
+	const CLAPPtr& GetClap() const
+	{
+		return m_pClap;
+	}
+
+private:
+	PipelineBatch(const CLAPPtr& pClap, const std::vector<std::vector<Memory>>* pBuffers, const uint64_t& index, const uint32_t& set) :
+		m_pClap(pClap),
+		m_pBuffers(pBuffers),
+		m_index(index),
+		m_set(set)
+	{}
+
+private:
+	const CLAPPtr& m_pClap;
+	const std::vector<std::vector<Memory>>* m_pBuffers;
+	uint64_t m_index;
+	uint32_t m_set;
+};
+
+// Statistics of a single stage, all times in microseconds. The occupancy is the fraction of the run
+// the stage was busy, the stage with the highest occupancy limits the throughput of the pipeline.
+struct PipelineStageStats
+{
+	std::string name = "";
+	uint64_t batches = 0;
+	double busyUS    = 0.0;
+	double waitUS    = 0.0; // Time spent waiting for the previous stage or a free buffer set
+	double runtimeUS = 0.0;
+
+	double GetAvgBusyUS() const
+	{
+		return (batches == 0 ? 0.0 : busyUS / static_cast<double>(batches));
+	}
+
+	double GetOccupancy() const
+	{
+		return (runtimeUS <= 0.0 ? 0.0 : busyUS / runtimeUS);
+	}
+
+	friend std::ostream& operator<<(std::ostream& stream, const PipelineStageStats& stats)
+	{
+		const std::ios::fmtflags flags  = stream.flags();
+		const std::streamsize precision = stream.precision();
+
+		stream << stats.name << " - Batches: " << stats.batches << std::fixed << std::setprecision(1)
+			   << ", Busy (total/avg): " << stats.busyUS << "/" << stats.GetAvgBusyUS() << " us"
+			   << ", Wait: " << stats.waitUS << " us, Occupancy: " << stats.GetOccupancy() * 100.0 << " %";
+
+		stream.flags(flags);
+		stream.precision(precision);
+		return stream;
+	}
+};
+
+// Executes batches through a sequence of stages, e.g., upload -> HLS kernel -> download. Every stage runs in
+// its own thread, stage i of batch k overlaps with stage i - 1 of batch k + 1, this way, the link and the
+// kernel are busy at the same time. The depth is the number of buffer sets and limits the batches in flight.
+class CLAPPipeline
+{
+	DISABLE_COPY_ASSIGN_MOVE(CLAPPipeline)
+
+public:
+	using StageFunc = std::function<void(const PipelineBatch&)>;
+	// Returns the host data to upload for the given batch, it has to remain valid until the upload finished
+	using SourceFunc = std::function<const void*(const uint64_t&)>;
+	// Returns the host buffer the given batch is downloaded into
+	using SinkFunc = std::function<void*(const uint64_t&)>;
+	// Sets the arguments of the core for the given batch, e.g., the addresses of its buffers
+	using BindFunc = std::function<void(HLSCore&, const PipelineBatch&)>;
+
+	/// @brief Creates a pipeline executed on the given device
+	/// @param pClap CLAP instance of the device
+	/// @param depth Number of buffer sets, i.e., the maximum number of batches in flight
+	/// @return A shared pointer to the new pipeline
+	static CLAPPipelinePtr Create(const CLAPPtr& pClap, const uint32_t& depth = 2)
+	{
+		return std::make_shared<CLAPPipeline>(pClap, depth);
+	}
+
+	CLAPPipeline(CLAPPtr pClap, const uint32_t& depth = 2) :
+		m_pClap(std::move(pClap)),
+		m_depth(depth)
+	{
+		if (m_depth == 0)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "A pipeline requires at least one buffer set";
+			throw CLAPException(ss.str());
+		}
+	}
+
+	~CLAPPipeline()
+	{
+		for (std::vector<Memory>& sets : m_buffers)
+		{
+			for (Memory& mem : sets)
+				m_pClap->FreeMemory(mem);
+		}
+	}
+
+	const uint32_t& GetDepth() const
+	{
+		return m_depth;
+	}
+
+	/// @brief Allocates a device buffer in every buffer set
+	/// @param type Type of the memory to allocate
+	/// @param byteSize Size of the buffer in bytes
+	/// @return Index of the buffer, used with PipelineBatch::GetMemory and the upload and download stages
+	std::size_t AddBuffer(const CLAP::MemoryType& type, const uint64_t& byteSize)
+	{
+		std::vector<Memory> sets;
+
+		try
+		{
+			for (uint32_t set = 0; set < m_depth; set++)
+				sets.push_back(m_pClap->AllocMemory(type, byteSize));
+		}
+		catch (...)
+		{
+			for (Memory& mem : sets)
+				m_pClap->FreeMemory(mem);
+
+			throw;
+		}
+
+		m_buffers.push_back(std::move(sets));
+		return m_buffers.size() - 1;
+	}
+
+	/// @brief Appends a stage executing the given function once per batch, batches are processed in order
+	/// @param name Name of the stage, used in the statistics
+	/// @param func Function executing the stage for a batch, exceptions abort the run
+	CLAPPipeline& AddStage(const std::string& name, StageFunc func)
+	{
+		m_stages.push_back({ name, std::move(func) });
+		return *this;
+	}
+
+	/// @brief Appends a stage writing the host data of the batch to the given buffer
+	/// @param bufferIdx Index of the buffer to write to
+	/// @param source Returns the host data of a batch
+	/// @param sizeInByte Number of bytes to write, USE_MEMORY_SIZE writes the entire buffer
+	CLAPPipeline& AddUpload(const std::size_t& bufferIdx, SourceFunc source, const uint64_t& sizeInByte = USE_MEMORY_SIZE)
+	{
+		checkBuffer(bufferIdx);
+
+		return AddStage("Upload " + std::to_string(bufferIdx), [source = std::move(source), bufferIdx, sizeInByte](const PipelineBatch& batch) {
+			batch.GetClap()->Write(batch.GetMemory(bufferIdx), source(batch.GetIndex()), sizeInByte);
+		});
+	}
+
+	/// @brief Appends a stage reading the given buffer into the host buffer of the batch
+	/// @param bufferIdx Index of the buffer to read from
+	/// @param sink Returns the host buffer of a batch
+	/// @param sizeInByte Number of bytes to read, USE_MEMORY_SIZE reads the entire buffer
+	CLAPPipeline& AddDownload(const std::size_t& bufferIdx, SinkFunc sink, const uint64_t& sizeInByte = USE_MEMORY_SIZE)
+	{
+		checkBuffer(bufferIdx);
+
+		return AddStage("Download " + std::to_string(bufferIdx), [sink = std::move(sink), bufferIdx, sizeInByte](const PipelineBatch& batch) {
+			batch.GetClap()->Read(batch.GetMemory(bufferIdx), sink(batch.GetIndex()), sizeInByte);
+		});
+	}
+
+	/// @brief Appends a stage running the given HLS core once per batch, the core has to outlive the pipeline
+	/// @param core HLS core to run
+	/// @param bind Sets the arguments of the core for a batch
+	CLAPPipeline& AddKernel(HLSCore& core, BindFunc bind)
+	{
+		return AddStage(core.GetName(), [&core, bind = std::move(bind)](const PipelineBatch& batch) {
+			bind(core, batch);
+
+			if (!core.Start())
+			{
+				std::stringstream ss;
+				ss << CLASS_TAG("CLAPPipeline") << "Failed to start HLS core \"" << core.GetName() << "\" for batch " << batch.GetIndex();
+				throw CLAPException(ss.str());
+			}
+
+			core.WaitForFinish();
+		});
+	}
+
+	/// @brief Appends a stage running both channels of the given AxiDMA once per batch, the DMA has to outlive the pipeline
+	/// @param dma AxiDMA to run
+	/// @param srcBufferIdx Index of the buffer read by the MM2S channel
+	/// @param dstBufferIdx Index of the buffer written by the S2MM channel
+	template<typename T>
+	CLAPPipeline& AddDMA(AxiDMA<T>& dma, const std::size_t& srcBufferIdx, const std::size_t& dstBufferIdx)
+	{
+		checkBuffer(srcBufferIdx);
+		checkBuffer(dstBufferIdx);
+
+		return AddStage("AxiDMA", [&dma, srcBufferIdx, dstBufferIdx](const PipelineBatch& batch) {
+			dma.Start(batch.GetMemory(srcBufferIdx), batch.GetMemory(dstBufferIdx));
+			dma.WaitForFinish();
+		});
+	}
+
+	std::size_t GetStageCount() const
+	{
+		return m_stages.size();
+	}
+
+	/// @brief Processes the given number of batches and waits until all of them passed the last stage
+	/// @param batchCount Number of batches to process
+	/// @return Statistics of every stage, in the order the stages were added
+	/// @throws The first exception thrown by a stage, the remaining stages are aborted
+	std::vector<PipelineStageStats> Run(const uint64_t& batchCount)
+	{
+		if (m_stages.empty())
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "The pipeline does not contain any stages";
+			throw CLAPException(ss.str());
+		}
+
+		m_done.assign(m_stages.size(), 0);
+		m_pError = nullptr;
+		m_stats.assign(m_stages.size(), PipelineStageStats());
+
+		const auto start = std::chrono::steady_clock::now();
+
+		// Stage threads run next to the internal threads of the device, e.g., on the NUMA node of the PCIe device
+		const CpuSet cpus = m_pClap->GetThreadAffinity();
+		std::vector<std::thread> threads;
+
+		for (std::size_t stage = 0; stage < m_stages.size(); stage++)
+		{
+			m_stats[stage].name = m_stages[stage].name;
+			threads.emplace_back(&CLAPPipeline::runStage, this, stage, batchCount);
+
+			if (!cpus.empty())
+				numa::PinThread(threads.back(), cpus);
+		}
+
+		for (std::thread& t : threads)
+			t.join();
+
+		const double runtimeUS = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+		for (PipelineStageStats& stats : m_stats)
+			stats.runtimeUS = runtimeUS;
+
+		if (m_pError) std::rethrow_exception(m_pError);
+
+		return m_stats;
+	}
+
+private:
+	struct Stage
+	{
+		std::string name = "";
+		StageFunc func   = {};
+	};
+
+	void checkBuffer(const std::size_t& bufferIdx) const
+	{
+		if (bufferIdx < m_buffers.size()) return;
+
+		std::stringstream ss;
+		ss << CLASS_TAG_AUTO << "Buffer index " << bufferIdx << " exceeds the number of pipeline buffers (" << m_buffers.size() << ")";
+		throw CLAPException(ss.str());
+	}
+
+	// Has to be called with the mutex locked. Batch k enters stage i once stage i - 1 finished it,
+	// the first stage additionally waits until the last stage released the buffer set of batch k - depth.
+	bool isReady(const std::size_t& stage, const uint64_t& batch) const
+	{
+		if (stage > 0) return (m_done[stage - 1] > batch);
+		return (batch < m_depth || m_done.back() > batch - m_depth);
+	}
+
+	void runStage(const std::size_t stage, const uint64_t batchCount)
+	{
+		using Duration = std::chrono::duration<double, std::micro>;
+
+		for (uint64_t batch = 0; batch < batchCount; batch++)
+		{
+			const auto waitStart = std::chrono::steady_clock::now();
+
+			{
+				std::unique_lock<std::mutex> lock(m_mtx);
+				m_cv.wait(lock, [this, stage, batch] { return m_pError || isReady(stage, batch); });
+
+				if (m_pError) return;
+			}
+
+			const auto busyStart = std::chrono::steady_clock::now();
+
+			try
+			{
+				m_stages[stage].func(PipelineBatch(m_pClap, &m_buffers, batch, static_cast<uint32_t>(batch % m_depth)));
+			}
+			catch (...)
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_mtx);
+					if (!m_pError) m_pError = std::current_exception();
+				}
+
+				m_cv.notify_all();
+				return;
+			}
+
+			const auto busyEnd = std::chrono::steady_clock::now();
+
+			{
+				std::lock_guard<std::mutex> lock(m_mtx);
+				m_done[stage] = batch + 1;
+			}
+
+			m_cv.notify_all();
+
+			// Only accessed by this thread until it is joined
+			PipelineStageStats& stats = m_stats[stage];
+			stats.batches++;
+			stats.waitUS += Duration(busyStart - waitStart).count();
+			stats.busyUS += Duration(busyEnd - busyStart).count();
+		}
+	}
+
+private:
+	CLAPPtr m_pClap;
+	uint32_t m_depth;
+	std::vector<std::vector<Memory>> m_buffers = {};
+	std::vector<Stage> m_stages                = {};
+	std::vector<uint64_t> m_done               = {}; // Number of batches finished per stage
+	std::vector<PipelineStageStats> m_stats    = {};
+	std::exception_ptr m_pError                = nullptr;
+	std::mutex m_mtx                           = {};
+	std::condition_variable m_cv               = {};
+};
+} // namespace clap
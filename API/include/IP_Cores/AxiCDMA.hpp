@@ -0,0 +1,757 @@
+/*
+ *  File: AxiCDMA.hpp
+ *  Copyright (c) 2024 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include "../internal/DeviceCopyEngine.hpp"
+#include "../internal/RegisterControl.hpp"
+#include "internal/WatchDog.hpp"
+
+#include "AxiInterruptController.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace clap
+{
+namespace internal
+{
+// Layout of the CDMASR register, polled while waiting for a transfer
+namespace axi_cdma_sr
+{
+CLAP_REG_FIELD(Idle, "Idle", 1, 1);
+CLAP_REG_FIELD(SGIncld, "SGIncld", 3, 3);
+CLAP_REG_FIELD(DMAIntErr, "DMAIntErr", 4, 4);
+CLAP_REG_FIELD(DMASlvErr, "DMASlvErr", 5, 5);
+CLAP_REG_FIELD(DMADecErr, "DMADecErr", 6, 6);
+CLAP_REG_FIELD(SGIntErr, "SGIntErr", 8, 8);
+CLAP_REG_FIELD(SGSlvErr, "SGSlvErr", 9, 9);
+CLAP_REG_FIELD(SGDecErr, "SGDecErr", 10, 10);
+CLAP_REG_FIELD(IOCIrq, "IOCIrq", 12, 12);
+CLAP_REG_FIELD(DlyIrq, "DlyIrq", 13, 13);
+CLAP_REG_FIELD(ErrIrq, "ErrIrq", 14, 14);
+CLAP_REG_FIELD(IRQThresholdSts, "IRQThresholdSts", 16, 23);
+CLAP_REG_FIELD(IRQDelaySts, "IRQDelaySts", 24, 31);
+
+using Layout = LayoutRegister<uint32_t, Idle, SGIncld, DMAIntErr, DMASlvErr, DMADecErr, SGIntErr, SGSlvErr, SGDecErr, IOCIrq, DlyIrq, ErrIrq, IRQThresholdSts, IRQDelaySts>;
+} // namespace axi_cdma_sr
+} // namespace internal
+
+// Driver for the AXI Central DMA, copying between two memory mapped addresses of the device, e.g., DDR and HBM,
+// without moving the data through the host. Copies exceeding GetMaxTransferLength() are split into chunks, which
+// are chained in hardware using BDs if the core is built in SG mode.
+// On creation the core is set as the copy engine of the CLAP instance, unless one is already set, i.e., it is used
+// by CLAP::CopyMemory.
+template<typename T>
+class AxiCDMA : public internal::RegisterControlBase, public internal::DeviceCopyEngine
+{
+	DISABLE_COPY_ASSIGN_MOVE(AxiCDMA)
+	enum REGISTER_MAP
+	{
+		CDMACR            = 0x00,
+		CDMASR            = 0x04,
+		CURDESC_PNTR      = 0x08,
+		CURDESC_PNTR_MSB  = 0x0C,
+		TAILDESC_PNTR     = 0x10,
+		TAILDESC_PNTR_MSB = 0x14,
+		SA                = 0x18,
+		SA_MSB            = 0x1C,
+		DA                = 0x20,
+		DA_MSB            = 0x24,
+		BTT               = 0x28
+	};
+
+	// Word offsets of the fields of a SG descriptor
+	enum BD_MAP
+	{
+		BD_NXTDESC     = 0,
+		BD_NXTDESC_MSB = 1,
+		BD_SA          = 2,
+		BD_SA_MSB      = 3,
+		BD_DA          = 4,
+		BD_DA_MSB      = 5,
+		BD_CONTROL     = 6,
+		BD_STATUS      = 7
+	};
+
+public:
+	enum CDMAInterrupts
+	{
+		INTR_ON_COMPLETE = 1 << 0,
+		INTR_ON_DELAY    = 1 << 1,
+		INTR_ON_ERROR    = 1 << 2,
+		INTR_ALL         = (1 << 3) - 1 // All bits set
+	};
+
+public:
+	AxiCDMA(const CLAPPtr& pClap, const uint64_t& ctrlOffset, const std::string& name = "") :
+		RegisterControlBase(pClap, ctrlOffset, name),
+		DeviceCopyEngine(),
+		m_pClap(pClap),
+		m_watchDog("AxiCDMA", pClap->MakeUserInterrupt(), pClap->GetCompletionReactor())
+	{
+		registerReg<uint32_t>(m_ctrlReg, CDMACR);
+		registerReg<uint32_t>(m_statReg, CDMASR);
+
+		// The current descriptor pointer is updated by the engine, only the source and destination are cached
+		registerCacheable(SA);
+		registerCacheable(DA);
+
+		m_watchDog.SetStatusRegister(&m_statReg);
+		m_watchDog.SetFinishCallback(std::bind(&AxiCDMA::OnFinished, this));
+
+		detectBufferLengthRegWidth();
+		detectDataWidth();
+		detectHasDRE();
+
+		if (!m_pClap->HasCopyEngine())
+			m_pClap->SetCopyEngine(this);
+	}
+
+	~AxiCDMA()
+	{
+		m_pClap->ReleaseCopyEngine(this);
+		m_watchDog.Stop();
+		releaseBdMemory();
+	}
+
+	// Called by the watchdog for every completed chunk, starts the next one and returns true once the copy is done or failed
+	bool OnFinished()
+	{
+		if (checkFailed() || m_remaining == 0)
+		{
+			m_active = false;
+			return true;
+		}
+
+		startNextChunk();
+		return false;
+	}
+
+	////////////////////////////////////////
+
+	////////////////////////////////////////
+
+	/// @brief Starts copying length bytes from srcAddr to dstAddr, WaitForFinish has to be called before the next copy is started
+	/// @param srcAddr Device address to copy from
+	/// @param dstAddr Device address to copy to
+	/// @param length Number of bytes to copy
+	void Start(const T& srcAddr, const T& dstAddr, const uint64_t& length)
+	{
+		if (m_active)
+			BUILD_IP_EXCEPTION(CLAPException, "A copy is still active");
+
+		if (!m_error.empty())
+			BUILD_IP_EXCEPTION(CLAPException, "The previous copy failed with: " << m_error << " - The core has to be reset before the next copy");
+
+		if (length == 0) return;
+
+		if (!m_hasDRE && ((srcAddr | dstAddr) & (m_dataWidth - 1)))
+			BUILD_IP_EXCEPTION(CLAPException, "Source (0x" << std::hex << srcAddr << ") and destination (0x" << dstAddr << std::dec << ") have to be aligned to the data width of " << m_dataWidth << " byte if the core does not include the DRE");
+
+		CLAP_IP_CORE_LOG_DEBUG << "Starting CDMA copy from 0x" << std::hex << srcAddr << " to 0x" << dstAddr << std::dec << " with length " << length << " byte" << std::endl;
+
+		m_nextSrc   = srcAddr;
+		m_nextDst   = dstAddr;
+		m_remaining = length;
+		m_active    = true;
+
+		// Clears interrupts left by a previous copy in polling mode, in interrupt mode they are cleared by the handler
+		if (!m_watchDog.IsInterruptSet())
+			m_statReg.ResetInterrupts(INTR_ALL);
+
+		// Chaining only pays off if the copy does not fit into a single chunk
+		m_useSG = (IsSGEnabled() && length > m_maxTransferLength);
+
+		// The first chunk is started before the watchdog, which otherwise might observe the completion of the previous copy
+		startNextChunk();
+
+		if (!m_watchDog.Start(true))
+			BUILD_IP_EXCEPTION(CLAPException, "Watchdog already running!");
+	}
+
+	/// @brief Starts copying the content of srcMem to dstMem
+	void Start(const Memory& srcMem, const Memory& dstMem)
+	{
+		if (srcMem.GetSize() > dstMem.GetSize())
+			BUILD_IP_EXCEPTION(CLAPException, "Destination memory (0x" << std::hex << dstMem.GetSize() << ") is smaller than the source memory (0x" << srcMem.GetSize() << ")" << std::dec);
+
+		Start(static_cast<T>(srcMem.GetBaseAddr()), static_cast<T>(dstMem.GetBaseAddr()), srcMem.GetSize());
+	}
+
+	bool WaitForFinish(const int32_t& timeoutMS = WAIT_INFINITE)
+	{
+		if (!m_watchDog.WaitForFinish(timeoutMS))
+			return false;
+#ifdef EMBEDDED_XILINX
+		// The watchdog only waits for a single completion, a chunked copy requires one per chunk
+		while (m_active)
+		{
+			if (!m_watchDog.WaitForFinish(timeoutMS))
+				return false;
+		}
+#endif
+
+		return true;
+	}
+
+	// Copies the data and blocks until the copy is completed, used by CLAP::CopyMemory
+	void CopyDeviceMemory(const uint64_t& srcAddr, const uint64_t& dstAddr, const uint64_t& sizeInByte) override
+	{
+		Start(static_cast<T>(srcAddr), static_cast<T>(dstAddr), sizeInByte);
+		WaitForFinish();
+
+		if (!m_error.empty())
+			BUILD_IP_EXCEPTION(CLAPException, "Copy from 0x" << std::hex << srcAddr << " to 0x" << dstAddr << std::dec << " failed with: " << m_error);
+	}
+
+	/// @brief Returns the errors reported by the core for the last copy, empty if it succeeded
+	const std::string& GetError() const
+	{
+		return m_error;
+	}
+
+	// Stops waiting for the current copy, the hardware itself is only halted by Reset()
+	void Stop()
+	{
+		m_watchDog.Stop();
+		m_remaining = 0;
+		m_active    = false;
+	}
+
+	////////////////////////////////////////
+
+	////////////////////////////////////////
+
+	void Reset()
+	{
+		Stop();
+		m_ctrlReg.DoReset();
+		m_error.clear();
+
+		// The reset restores the default values of all registers
+		InvalidateRegisterCache();
+	}
+
+	////////////////////////////////////////
+
+	////////////////////////////////////////
+
+	void UseInterruptController(AxiInterruptController& axiIntC)
+	{
+		m_watchDog.SetUserInterrupt(axiIntC.MakeUserInterrupt());
+	}
+
+	void EnableInterrupts(const uint32_t& eventNo = USE_AUTO_DETECT, const CDMAInterrupts& intr = INTR_ALL)
+	{
+		uint32_t intrID = eventNo;
+
+		if (eventNo == USE_AUTO_DETECT && m_detectedInterruptID == INTR_UNDEFINED)
+			AutoDetectInterruptID();
+
+		if (m_detectedInterruptID != INTR_UNDEFINED)
+			intrID = static_cast<uint32_t>(m_detectedInterruptID);
+
+		if (intrID == USE_AUTO_DETECT)
+		{
+			CLAP_IP_CORE_LOG_ERROR << "Interrupt ID was not automatically detected and no interrupt ID specified - Unable to setup interrupts for AxiCDMA at: 0x" << std::hex << m_ctrlOffset << std::dec << std::endl;
+			return;
+		}
+
+		m_ctrlReg.Update();
+		m_watchDog.InitInterrupt(getDevNum(), intrID, &m_statReg);
+		m_ctrlReg.EnableInterrupts(intr);
+	}
+
+	void DisableInterrupts(const CDMAInterrupts& intr = INTR_ALL)
+	{
+		m_watchDog.UnsetInterrupt();
+		m_ctrlReg.DisableInterrupts(intr);
+	}
+
+	////////////////////////////////////////
+
+	////////////////////////////////////////
+
+	/// @brief Sets the buffer length register width
+	/// @param width The buffer length register width in bits
+	void SetBufferLengthRegWidth(const uint32_t& width)
+	{
+		m_bufLenRegWidth = width;
+		updateMaxTransferLength();
+	}
+
+	/// @brief Sets the data width of the Axi CDMA in bytes
+	/// @param width The data width in bytes
+	void SetDataWidth(const uint32_t& width)
+	{
+		m_dataWidth = width;
+		updateMaxTransferLength();
+	}
+
+	/// @brief Sets the data width of the Axi CDMA in bits
+	/// @param width The data width in bits
+	void SetDataWidthBits(const uint32_t& width)
+	{
+		SetDataWidth(width / 8);
+	}
+
+	const uint32_t& GetDataWidth() const
+	{
+		return m_dataWidth;
+	}
+
+	void SetHasDRE(const bool& dre)
+	{
+		m_hasDRE = dre;
+	}
+
+	const bool& GetHasDRE() const
+	{
+		return m_hasDRE;
+	}
+
+	const uint32_t& GetMaxTransferLength() const
+	{
+		return m_maxTransferLength;
+	}
+
+	/// @brief Sets the BD memory used while the core is built in SG mode, without a memory set the BDs are allocated
+	///        from the DDR regions of the CLAP instance on first use.
+	/// @param memBD The BD memory, has to hold 64 byte per BD (up to 255 BDs are used at once) and must be accessible by the SG interface of the CDMA
+	void SetBdMemory(const Memory& memBD)
+	{
+		if (m_active)
+			BUILD_IP_EXCEPTION(CLAPException, "Cannot change the BD memory while a copy is active");
+
+		if (memBD.GetBaseAddr() % AXI_CDMA_BD_MINIMUM_ALIGNMENT)
+			BUILD_IP_EXCEPTION(CLAPException, "BD memory at 0x" << std::hex << memBD.GetBaseAddr() << std::dec << " is not aligned to " << AXI_CDMA_BD_MINIMUM_ALIGNMENT << " byte");
+
+		releaseBdMemory();
+
+		m_bdMem      = memBD;
+		m_bdMemOwned = false;
+	}
+
+	bool IsSGEnabled()
+	{
+		return m_statReg.IsSGEnabled();
+	}
+
+	////////////////////////////////////////
+
+	////////////////////////////////////////
+
+	double GetRuntime() const
+	{
+		return m_watchDog.GetRuntime();
+	}
+
+	void SetPollStrategy(const PollStrategy& strategy)
+	{
+		m_watchDog.SetPollStrategy(strategy);
+	}
+
+	CompletionStats GetCompletionStats() const
+	{
+		return m_watchDog.GetCompletionStats();
+	}
+
+	void ResetCompletionStats()
+	{
+		m_watchDog.ResetCompletionStats();
+	}
+
+	////////////////////////////////////////
+
+private:
+	// Starts the next chunk of the current copy, in SG mode a chunk consists of up to AXI_CDMA_MAX_IRQ_THRESHOLD BDs
+	// raising a single interrupt once all of them are completed
+	void startNextChunk()
+	{
+		m_statReg.Reset();
+
+		if (m_useSG)
+			startSGChunk();
+		else
+			startSimpleChunk();
+	}
+
+	void startSimpleChunk()
+	{
+		const uint32_t length = static_cast<uint32_t>(std::min(m_remaining, static_cast<uint64_t>(m_maxTransferLength)));
+
+		// Writes to SA, DA and BTT are ignored while the SG engine is enabled
+		m_ctrlReg.SetSGMode(false);
+
+		// Unchanged registers are skipped, BTT is written last as it starts the transfer
+		internal::RegisterTransaction tx(*this);
+
+		writeRegister<T>(SA, m_nextSrc);
+		writeRegister<T>(DA, m_nextDst);
+		writeRegisterOrdered<uint32_t>(BTT, length);
+
+		advance(length);
+	}
+
+	void startSGChunk()
+	{
+		const uint32_t numBds = static_cast<uint32_t>(std::min(ROUND_UP_DIV(m_remaining, static_cast<uint64_t>(m_maxTransferLength)), static_cast<uint64_t>(AXI_CDMA_MAX_IRQ_THRESHOLD)));
+		const uint64_t bdBase = bdMemory(numBds).GetBaseAddr();
+
+		// Aligned, as the backends only accept aligned host buffers for bulk transfers
+		CLAPBuffer<uint32_t> bds(static_cast<std::size_t>(numBds) * BD_WORDS, 0);
+
+		for (uint32_t i = 0; i < numBds; i++)
+		{
+			const uint32_t length  = static_cast<uint32_t>(std::min(m_remaining, static_cast<uint64_t>(m_maxTransferLength)));
+			const uint64_t nextBd  = bdBase + static_cast<uint64_t>((i + 1) % numBds) * AXI_CDMA_BD_MINIMUM_ALIGNMENT;
+			const uint64_t src     = static_cast<uint64_t>(m_nextSrc);
+			const uint64_t dst     = static_cast<uint64_t>(m_nextDst);
+			uint32_t* pBd          = &bds[static_cast<std::size_t>(i) * BD_WORDS];
+			pBd[BD_NXTDESC]        = static_cast<uint32_t>(nextBd);
+			pBd[BD_NXTDESC_MSB]    = static_cast<uint32_t>(nextBd >> 32);
+			pBd[BD_SA]             = static_cast<uint32_t>(src);
+			pBd[BD_SA_MSB]         = static_cast<uint32_t>(src >> 32);
+			pBd[BD_DA]             = static_cast<uint32_t>(dst);
+			pBd[BD_DA_MSB]         = static_cast<uint32_t>(dst >> 32);
+			pBd[BD_CONTROL]        = length & AXI_CDMA_BD_MAX_LENGTH_MASK;
+			pBd[BD_STATUS]         = 0;
+
+			advance(length);
+		}
+
+		// All BDs of the chunk are written with a single transfer
+		m_pClap->Write(bdBase, bds.data(), bds.size() * sizeof(uint32_t));
+
+		const T lastBd = static_cast<T>(bdBase + static_cast<uint64_t>(numBds - 1) * AXI_CDMA_BD_MINIMUM_ALIGNMENT);
+
+		CLAP_IP_CORE_LOG_VERBOSE << "Starting SG chunk with " << numBds << " BDs, " << m_remaining << " byte remaining" << std::endl;
+
+		// Toggling the SG mode resets the SG engine, i.e., the chain is fetched starting at the current descriptor
+		m_ctrlReg.SetSGMode(false);
+		m_ctrlReg.SetIrqThreshold(static_cast<uint8_t>(numBds));
+		m_ctrlReg.SetSGMode(true);
+
+		writeRegister<T>(CURDESC_PNTR, static_cast<T>(bdBase));
+		// Writing the tail descriptor starts the chain
+		writeRegisterOrdered<T>(TAILDESC_PNTR, lastBd);
+	}
+
+	void advance(const uint32_t& length)
+	{
+		m_nextSrc += static_cast<T>(length);
+		m_nextDst += static_cast<T>(length);
+		m_remaining -= length;
+	}
+
+	// The core halts on an error, the remaining chunks are therefore dropped
+	bool checkFailed()
+	{
+		m_error = m_statReg.GetErrorString();
+		if (m_error.empty()) return false;
+
+		CLAP_IP_CORE_LOG_ERROR << "Copy failed with: " << m_error << " - The core has to be reset before the next copy" << std::endl;
+		m_remaining = 0;
+
+		return true;
+	}
+
+	// Returns BD memory for at least numBds BDs, allocating it from the DDR regions if none was set by the user
+	const Memory& bdMemory(const uint32_t& numBds)
+	{
+		const uint64_t size = static_cast<uint64_t>(numBds) * AXI_CDMA_BD_MINIMUM_ALIGNMENT;
+
+		if (m_bdMem.IsValid() && m_bdMem.GetSize() >= size) return m_bdMem;
+
+		if (m_bdMem.IsValid() && !m_bdMemOwned)
+			BUILD_IP_EXCEPTION(CLAPException, "BD memory can only hold " << m_bdMem.GetSize() / AXI_CDMA_BD_MINIMUM_ALIGNMENT << " BDs, but the copy requires " << numBds);
+
+		releaseBdMemory();
+
+		// Always sized for a full chunk, later copies therefore reuse the memory
+		m_bdMem      = m_pClap->AllocMemory(CLAP::MemoryType::DDR, static_cast<uint64_t>(AXI_CDMA_MAX_IRQ_THRESHOLD) * AXI_CDMA_BD_MINIMUM_ALIGNMENT);
+		m_bdMemOwned = true;
+
+		return m_bdMem;
+	}
+
+	void releaseBdMemory()
+	{
+		if (m_bdMemOwned && m_bdMem.IsValid())
+			m_pClap->FreeMemory(m_bdMem);
+
+		m_bdMem      = Memory();
+		m_bdMemOwned = false;
+	}
+
+	////////////////////////////////////////
+
+	void detectBufferLengthRegWidth()
+	{
+		Expected<uint64_t> res = CLAP()->ReadUIOProperty(m_ctrlOffset, "xlnx,sg-length-width");
+		if (res)
+		{
+			m_bufLenRegWidth = static_cast<uint32_t>(res.Value());
+			CLAP_IP_CORE_LOG_INFO << "Detected buffer length register width: " << m_bufLenRegWidth << " bit" << std::endl;
+		}
+
+		updateMaxTransferLength();
+	}
+
+	void detectDataWidth()
+	{
+		Expected<uint64_t> res = CLAP()->ReadUIOProperty(m_ctrlOffset, buildPropertyString("xlnx,datawidth"));
+		if (res)
+		{
+			SetDataWidthBits(static_cast<uint32_t>(res.Value()));
+			CLAP_IP_CORE_LOG_INFO << "Detected data width: " << m_dataWidth << " byte" << std::endl;
+		}
+	}
+
+	void detectHasDRE()
+	{
+		const bool exists = CLAP()->CheckUIOPropertyExists(m_ctrlOffset, buildPropertyString("xlnx,include-dre"));
+		if (exists)
+		{
+			SetHasDRE(exists);
+			CLAP_IP_CORE_LOG_INFO << "Detected DRE: " << m_hasDRE << std::endl;
+		}
+	}
+
+	std::string buildPropertyString(const std::string& propName)
+	{
+		return std::string("/dma-channel@" + utils::Hex2Str(m_ctrlOffset) + "/" + propName);
+	}
+
+	// The chunk length is kept a multiple of the data width, following chunks therefore stay aligned
+	void updateMaxTransferLength()
+	{
+		m_maxTransferLength = static_cast<uint32_t>(((1ull << m_bufLenRegWidth) - 1) & ~static_cast<uint64_t>(m_dataWidth - 1));
+
+		CLAP_LOG_DEBUG << "Max transfer length: " << m_maxTransferLength << std::endl;
+	}
+
+	////////////////////////////////////////
+
+	class ControlRegister : public internal::Register<uint32_t>
+	{
+	public:
+		ControlRegister() :
+			Register("CDMA Control Register")
+		{
+			RegisterElement<bool>(&m_reset, "Reset", 2);
+			RegisterElement<bool>(&m_sgMode, "SGMode", 3);
+			RegisterElement<bool>(&m_keyPendRd, "KeyPendRd", 4);
+			RegisterElement<bool>(&m_keyPendWr, "KeyPendWr", 5);
+			RegisterElement<bool>(&m_cyclicBDEnable, "CyclicBDEnable", 6);
+			RegisterElement<bool>(&m_ioCIrqEn, "IOCIrqEn", 12);
+			RegisterElement<bool>(&m_dlyIrqEn, "DlyIrqEn", 13);
+			RegisterElement<bool>(&m_errIrqEn, "ErrIrqEn", 14);
+			RegisterElement<uint8_t>(&m_irqThreshold, "IRQThreshold", 16, 23);
+			RegisterElement<uint8_t>(&m_irqDelay, "IRQDelay", 24, 31);
+		}
+
+		void EnableInterrupts(const CDMAInterrupts& intr = INTR_ALL)
+		{
+			setInterrupts(true, intr);
+		}
+
+		void DisableInterrupts(const CDMAInterrupts& intr = INTR_ALL)
+		{
+			setInterrupts(false, intr);
+		}
+
+		void DoReset()
+		{
+			Update();
+			m_reset = 1;
+			Update(internal::Direction::WRITE);
+
+			// The Reset bit will be set to 0 once the reset has been completed
+			while (m_reset)
+				Update();
+		}
+
+		// Can only be changed while the core is idle
+		void SetSGMode(const bool& enable)
+		{
+			Update();
+			if (m_sgMode == enable) return;
+
+			m_sgMode = enable;
+			Update(internal::Direction::WRITE);
+		}
+
+		void SetIrqThreshold(const uint8_t& threshold)
+		{
+			Update();
+			m_irqThreshold = threshold;
+			Update(internal::Direction::WRITE);
+		}
+
+	private:
+		void setInterrupts(bool enable, const CDMAInterrupts& intr)
+		{
+			if (intr & INTR_ON_COMPLETE)
+				m_ioCIrqEn = enable;
+			if (intr & INTR_ON_DELAY)
+				m_dlyIrqEn = enable;
+			if (intr & INTR_ON_ERROR)
+				m_errIrqEn = enable;
+
+			Update(internal::Direction::WRITE);
+		}
+
+	private:
+		bool m_reset           = false;
+		bool m_sgMode          = false;
+		bool m_keyPendRd       = false;
+		bool m_keyPendWr       = false;
+		bool m_cyclicBDEnable  = false;
+		bool m_ioCIrqEn        = false;
+		bool m_dlyIrqEn        = false;
+		bool m_errIrqEn        = false;
+		uint8_t m_irqThreshold = 1;
+		uint8_t m_irqDelay     = 0;
+	};
+
+	class StatusRegister : public internal::axi_cdma_sr::Layout, public internal::HasInterrupt, public internal::HasStatus
+	{
+		using Idle    = internal::axi_cdma_sr::Idle;
+		using SGIncld = internal::axi_cdma_sr::SGIncld;
+		using IOCIrq  = internal::axi_cdma_sr::IOCIrq;
+		using DlyIrq  = internal::axi_cdma_sr::DlyIrq;
+		using ErrIrq  = internal::axi_cdma_sr::ErrIrq;
+
+	public:
+		StatusRegister() :
+			LayoutRegister("CDMA Status Register")
+		{}
+
+		void ClearInterrupts() override
+		{
+			m_lastInterrupt = GetInterrupts();
+			ResetInterrupts(INTR_ALL);
+		}
+
+		uint32_t GetInterrupts() override
+		{
+			Update();
+			uint32_t intr = 0;
+			intr |= Get<IOCIrq>() << (INTR_ON_COMPLETE >> 1);
+			intr |= Get<DlyIrq>() << (INTR_ON_DELAY >> 1);
+			intr |= Get<ErrIrq>() << (INTR_ON_ERROR >> 1);
+
+			return intr;
+		}
+
+		void ResetInterrupts(const CDMAInterrupts& intr)
+		{
+			if (intr & INTR_ON_COMPLETE)
+				Set<IOCIrq>(1);
+			if (intr & INTR_ON_DELAY)
+				Set<DlyIrq>(1);
+			if (intr & INTR_ON_ERROR)
+				Set<ErrIrq>(1);
+
+			Update(internal::Direction::WRITE);
+		}
+
+		bool IsSGEnabled()
+		{
+			Update();
+			return IsSet<SGIncld>();
+		}
+
+		// Returns the names of all set error bits, empty if no error occurred
+		std::string GetErrorString()
+		{
+			Update();
+			std::string errors;
+			appendError<internal::axi_cdma_sr::DMAIntErr>(errors);
+			appendError<internal::axi_cdma_sr::DMASlvErr>(errors);
+			appendError<internal::axi_cdma_sr::DMADecErr>(errors);
+			appendError<internal::axi_cdma_sr::SGIntErr>(errors);
+			appendError<internal::axi_cdma_sr::SGSlvErr>(errors);
+			appendError<internal::axi_cdma_sr::SGDecErr>(errors);
+
+			return errors;
+		}
+
+	protected:
+		void getStatus() override
+		{
+			Update();
+			if (!m_done && IsSet<Idle>())
+				m_done = true;
+		}
+
+	private:
+		template<typename F>
+		void appendError(std::string& errors)
+		{
+			if (!IsSet<F>()) return;
+
+			if (!errors.empty())
+				errors += ", ";
+
+			errors += F::FIELD_NAME;
+		}
+	};
+
+private:
+	static inline const uint32_t AXI_CDMA_BD_MINIMUM_ALIGNMENT = 0x40;
+	static inline const uint32_t AXI_CDMA_BD_MAX_LENGTH_MASK   = 0x3FFFFFF;
+	static inline const uint32_t AXI_CDMA_MAX_IRQ_THRESHOLD    = 0xFF;
+	static inline const std::size_t BD_WORDS                   = AXI_CDMA_BD_MINIMUM_ALIGNMENT / sizeof(uint32_t);
+
+	CLAPPtr m_pClap = nullptr;
+
+	ControlRegister m_ctrlReg = ControlRegister();
+	StatusRegister m_statReg  = StatusRegister();
+
+	internal::WatchDog m_watchDog;
+
+	uint32_t m_bufLenRegWidth    = 23; // Default AXI CDMA width of the buffer length register is 23 bits
+	uint32_t m_maxTransferLength = 0;
+	uint32_t m_dataWidth         = 4; // Default AXI CDMA data width is 32 bits
+	bool m_hasDRE                = false;
+
+	// Progress of the current copy
+	T m_nextSrc          = 0;
+	T m_nextDst          = 0;
+	uint64_t m_remaining = 0;
+	bool m_active        = false;
+	bool m_useSG         = false;
+	std::string m_error  = {};
+
+	Memory m_bdMem    = Memory();
+	bool m_bdMemOwned = false;
+};
+} // namespace clap
@@ -33,12 +33,47 @@
 
 #include <array>
 #include <cstdint>
+#include <cstring>
+#include <mutex>
 #include <queue>
 
 // TODO: Implement SG multi-channel support
 
+#define XAXIDMA_BD_CTRL_TXSOF_MASK   0x08000000
+#define XAXIDMA_BD_CTRL_TXEOF_MASK   0x04000000
+#define XAXIDMA_BD_CTRL_ALL_MASK     0x0C000000
+#define XAXIDMA_BD_WORDLEN_MASK      0xFF
+#define XAXIDMA_BD_HAS_DRE_MASK      0xF00
+#define XAXIDMA_BD_STS_COMPLETE_MASK 0x80000000
+#define XAXIDMA_BD_STS_ALL_ERR_MASK  0x70000000
+#define XAXIDMA_BD_STS_RXEOF_MASK    0x04000000
+
 namespace clap
 {
+namespace internal
+{
+// Layout of the MM2S_DMASR and S2MM_DMASR registers, polled while waiting for a transfer
+namespace axi_dma_sr
+{
+CLAP_REG_FIELD(Halted, "Halted", 0, 0);
+CLAP_REG_FIELD(Idle, "Idle", 1, 1);
+CLAP_REG_FIELD(SGIncld, "SGIncld", 3, 3);
+CLAP_REG_FIELD(DMAIntErr, "DMAIntErr", 4, 4);
+CLAP_REG_FIELD(DMASlvErr, "DMASlvErr", 5, 5);
+CLAP_REG_FIELD(DMADecErr, "DMADecErr", 6, 6);
+CLAP_REG_FIELD(SGIntErr, "SGIntErr", 8, 8);
+CLAP_REG_FIELD(SGSlvErr, "SGSlvErr", 9, 9);
+CLAP_REG_FIELD(SGDecErr, "SGDecErr", 10, 10);
+CLAP_REG_FIELD(IOCIrq, "IOCIrq", 12, 12);
+CLAP_REG_FIELD(DlyIrq, "DlyIrq", 13, 13);
+CLAP_REG_FIELD(ErrIrq, "ErrIrq", 14, 14);
+CLAP_REG_FIELD(IRQThresholdSts, "IRQThresholdSts", 16, 23);
+CLAP_REG_FIELD(IRQDelaySts, "IRQDelaySts", 24, 31);
+
+using Layout = LayoutRegister<uint32_t, Halted, Idle, SGIncld, DMAIntErr, DMASlvErr, DMADecErr, SGIntErr, SGSlvErr, SGDecErr, IOCIrq, DlyIrq, ErrIrq, IRQThresholdSts, IRQDelaySts>;
+} // namespace axi_dma_sr
+} // namespace internal
+
 template<typename T>
 class AxiDMA : public internal::RegisterControlBase
 {
@@ -82,6 +117,15 @@ class AxiDMA : public internal::RegisterControlBase
 		}
 	};
 
+	// Progress of a simple mode transfer split into chunks
+	struct ChunkProgress
+	{
+		uint32_t total     = 0;
+		uint32_t completed = 0;
+		// Set once a chunk completion was handled by the interrupt callback, the finish callback then only checks the progress
+		bool irqDriven = false;
+	};
+
 	enum class SGState
 	{
 		Idle = 0,
@@ -91,8 +135,6 @@ class AxiDMA : public internal::RegisterControlBase
 	static inline const std::string MM2S_INTR_NAME = "mm2s_introut";
 	static inline const std::string S2MM_INTR_NAME = "s2mm_introut";
 
-	static inline const uint32_t SG_IRQ_DELAY = 0;
-
 public:
 	enum DMAInterrupts
 	{
@@ -110,12 +152,25 @@ public:
 
 	using ChunkResults = std::vector<ChunkResult>;
 
+	// Interrupt coalescing of a channel in SG mode
+	struct IrqCoalescing
+	{
+		// Number of completed packets per interrupt, limited to 255 by the hardware, 0 raises a single interrupt per StartSG (one per 255 packets for larger transfers)
+		uint32_t threshold = 0;
+		// Raises an interrupt if no further packet completed within delay * 125 SG clock cycles after the last one, 0 disables the timeout
+		uint8_t delay = 0;
+	};
+
+	// Called for every buffer completed by a SG stream with the buffer address and the number of transferred bytes,
+	// returning false ends the stream
+	using SGStreamCallback = std::function<bool(const uint64_t&, const uint32_t&)>;
+
 public:
 	AxiDMA(const CLAPPtr& pClap, const uint64_t& ctrlOffset, const bool& mm2sPresent = true, const bool& s2mmPresent = true, const std::string& name = "") :
 		RegisterControlBase(pClap, ctrlOffset, name),
 		m_pClap(pClap),
-		m_watchDogMM2S("AxiDMA_MM2S", pClap->MakeUserInterrupt()),
-		m_watchDogS2MM("AxiDMA_S2MM", pClap->MakeUserInterrupt()),
+		m_watchDogMM2S("AxiDMA_MM2S", pClap->MakeUserInterrupt(), pClap->GetCompletionReactor()),
+		m_watchDogS2MM("AxiDMA_S2MM", pClap->MakeUserInterrupt(), pClap->GetCompletionReactor()),
 		m_mm2sPresent(mm2sPresent),
 		m_s2mmPresent(s2mmPresent)
 	{
@@ -126,18 +181,20 @@ public:
 		{
 			registerReg<uint32_t>(m_mm2sCtrlReg, MM2S_DMACR);
 			registerReg<uint32_t>(m_mm2sStatReg, MM2S_DMASR);
+			registerCacheable(MM2S_SA);
 
-			m_watchDogMM2S.SetStatusRegister(&m_mm2sStatReg);
-			m_watchDogMM2S.SetFinishCallback(std::bind(&AxiDMA::OnMM2SFinished, this));
+			resetWatchDog(DMAChannel::MM2S);
+			m_watchDogMM2S.RegisterInterruptCallback(std::bind(&AxiDMA::onChunkInterrupt, this, DMAChannel::MM2S));
 		}
 
 		if (m_s2mmPresent)
 		{
 			registerReg<uint32_t>(m_s2mmCtrlReg, S2MM_DMACR);
 			registerReg<uint32_t>(m_s2mmStatReg, S2MM_DMASR);
+			registerCacheable(S2MM_DA);
 
-			m_watchDogS2MM.SetStatusRegister(&m_s2mmStatReg);
-			m_watchDogS2MM.SetFinishCallback(std::bind(&AxiDMA::OnS2MMFinished, this));
+			resetWatchDog(DMAChannel::S2MM);
+			m_watchDogS2MM.RegisterInterruptCallback(std::bind(&AxiDMA::onChunkInterrupt, this, DMAChannel::S2MM));
 		}
 
 		detectBufferLengthRegWidth();
@@ -145,20 +202,27 @@ public:
 		detectHasDRE();
 	}
 
+	~AxiDMA()
+	{
+		releaseChainBdMemory(DMAChannel::MM2S);
+		releaseChainBdMemory(DMAChannel::S2MM);
+	}
+
 	////////////////////////////////////////
 
 	bool OnMM2SFinished()
 	{
 		CLAP_IP_CORE_LOG_DEBUG << "MM2S Transfer Finished" << std::endl;
 
-		// Check if there are more chunks to transfer
-		if (!m_mm2sChunks.empty())
-		{
-			startMM2STransfer();
+		if (m_chunkProgress[ch2Id(DMAChannel::MM2S)].total != 0)
+			return chunkedTransferDone(DMAChannel::MM2S);
+
+		// With coalescing a SG transfer raises multiple interrupts, it is only done once all BDs are completed
+		if (m_bdRingTx.runState == SGState::Running && !sgTransferDone(m_bdRingTx))
 			return false;
-		}
 
 		m_bdRingTx.runState = SGState::Idle;
+		finishChainedTransfer(DMAChannel::MM2S);
 
 		return true;
 	}
@@ -167,16 +231,14 @@ public:
 	{
 		CLAP_IP_CORE_LOG_DEBUG << "S2MM Transfer Finished" << std::endl;
 
-		m_s2mmChunkResults.push_back({ m_s2mmCurChunk.length, GetS2MMByteLength() });
+		if (m_chunkProgress[ch2Id(DMAChannel::S2MM)].total != 0)
+			return chunkedTransferDone(DMAChannel::S2MM);
 
-		// Check if there are more chunks to transfer
-		if (!m_s2mmChunks.empty())
-		{
-			startS2MMTransfer();
+		if (m_bdRingRx.runState == SGState::Running && !sgTransferDone(m_bdRingRx))
 			return false;
-		}
 
 		m_bdRingRx.runState = SGState::Idle;
+		finishChainedTransfer(DMAChannel::S2MM);
 
 		return true;
 	}
@@ -210,11 +272,16 @@ public:
 		Start(channel, static_cast<T>(mem.GetBaseAddr()), static_cast<uint32_t>(mem.GetSize()));
 	}
 
-	// Starts the specified channel
+	// Starts the specified channel, transfers exceeding GetMaxTransferLength() are split into chunks.
+	// In SG mode the chunks are chained in hardware using a BD ring (see SetChainBdMemory), otherwise
+	// every chunk is started straight from the interrupt callback, or the watchdog when polling.
 	void Start(const DMAChannel& channel, const T& addr, const uint32_t& length)
 	{
 		if (IsSGEnabled())
-			BUILD_IP_EXCEPTION(CLAPException, "SG mode is enabled, normal transfers not possible, use the StartSG method instead");
+		{
+			startChainedTransfer(channel, addr, length);
+			return;
+		}
 
 		CLAP_IP_CORE_LOG_DEBUG << "Starting DMA transfer on channel " << channel << " with address 0x" << std::hex << addr << std::dec << " and length " << length << " byte" << std::endl;
 
@@ -236,13 +303,16 @@ public:
 
 			CLAP_IP_CORE_LOG_VERBOSE << "MM2S chunks: " << m_mm2sChunks.size() << std::endl;
 
+			m_chunkProgress[ch2Id(channel)] = { static_cast<uint32_t>(m_mm2sChunks.size()), 0, false };
+
+			// The first chunk is started before the watchdog, which otherwise might observe the completion of the previous transfer
+			startMM2STransfer();
+
 			if (!m_watchDogMM2S.Start(true))
 			{
 				CLAP_IP_CORE_LOG_ERROR << "Watchdog for MM2S already running!" << std::endl;
 				return;
 			}
-
-			startMM2STransfer();
 		}
 
 		if (channel == DMAChannel::S2MM && m_s2mmPresent)
@@ -265,13 +335,16 @@ public:
 
 			CLAP_IP_CORE_LOG_VERBOSE << "S2MM chunks: " << m_s2mmChunks.size() << std::endl;
 
+			m_chunkProgress[ch2Id(channel)] = { static_cast<uint32_t>(m_s2mmChunks.size()), 0, false };
+
+			// The first chunk is started before the watchdog, which otherwise might observe the completion of the previous transfer
+			startS2MMTransfer();
+
 			if (!m_watchDogS2MM.Start(true))
 			{
 				CLAP_IP_CORE_LOG_ERROR << "Watchdog for S2MM already running!" << std::endl;
 				return;
 			}
-
-			startS2MMTransfer();
 		}
 	}
 
@@ -290,12 +363,24 @@ public:
 		{
 			m_mm2sCtrlReg.Stop();
 			m_watchDogMM2S.Stop();
+			m_mm2sChunks = {};
 		}
 		else if (channel == DMAChannel::S2MM && m_s2mmPresent)
 		{
 			m_s2mmCtrlReg.Stop();
 			m_watchDogS2MM.Stop();
+			m_s2mmChunks = {};
+		}
+
+		m_chunkProgress[ch2Id(channel)] = {};
+
+		if (m_chained[ch2Id(channel)])
+		{
+			m_chained[ch2Id(channel)] = false;
+			releaseChainedRing(channel);
 		}
+
+		finishSGStream(channel);
 	}
 
 	bool WaitForFinish(const int32_t& timeoutMS = WAIT_INFINITE)
@@ -315,6 +400,11 @@ public:
 		{
 			if (!m_watchDogMM2S.WaitForFinish(timeoutMS))
 				return false;
+#ifdef EMBEDDED_XILINX
+			// The watchdog only waits for a single completion, a chunked transfer requires one per chunk
+			while (m_chunkProgress[ch2Id(channel)].total != 0)
+				m_watchDogMM2S.WaitForFinish(timeoutMS);
+#endif
 
 			return true;
 		}
@@ -322,6 +412,11 @@ public:
 		{
 			if (!m_watchDogS2MM.WaitForFinish(timeoutMS))
 				return false;
+#ifdef EMBEDDED_XILINX
+			// See above
+			while (m_chunkProgress[ch2Id(channel)].total != 0)
+				m_watchDogS2MM.WaitForFinish(timeoutMS);
+#endif
 
 			return true;
 		}
@@ -353,6 +448,9 @@ public:
 			Stop(DMAChannel::S2MM);
 			m_s2mmCtrlReg.DoReset();
 		}
+
+		// The reset restores the default values of all registers
+		InvalidateRegisterCache();
 	}
 
 	////////////////////////////////////////
@@ -379,6 +477,17 @@ public:
 		EnableInterrupts(DMAChannel::S2MM, eventNoS2MM, intr);
 	}
 
+	/// @brief Enables the interrupts of the given channel and sets its interrupt coalescing for SG transfers
+	/// @param channel The channel to enable the interrupts for
+	/// @param eventNo The event number of the channel's interrupt
+	/// @param intr The interrupts to enable, the delay interrupt is required for the coalescing timeout
+	/// @param coalescing Interrupt coalescing used by the next SG transfers of the channel
+	void EnableInterrupts(const DMAChannel& channel, const uint32_t& eventNo, const DMAInterrupts& intr, const IrqCoalescing& coalescing)
+	{
+		SetInterruptCoalescing(channel, coalescing);
+		EnableInterrupts(channel, eventNo, intr);
+	}
+
 	void EnableInterrupts(const DMAChannel& channel, const uint32_t& eventNo = USE_AUTO_DETECT, const DMAInterrupts& intr = INTR_ALL)
 	{
 		if (channel == DMAChannel::MM2S && m_mm2sPresent)
@@ -528,10 +637,59 @@ public:
 		return m_maxTransferLengths[ch2Id(channel)];
 	}
 
+	/// @brief Sets the BD memory used by transfers started via Start() while the core is built in SG mode
+	///        Such transfers are chained in hardware using one BD per GetMaxTransferLength() bytes, without a
+	///        memory set the BDs are allocated from the DDR regions of the CLAP instance on first use.
+	/// @param channel The channel to set the BD memory for
+	/// @param memBD The BD memory, has to hold 64 byte per BD and must be accessible by the SG interface of the DMA
+	void SetChainBdMemory(const DMAChannel& channel, const Memory& memBD)
+	{
+		if ((channel == DMAChannel::MM2S ? m_bdRingTx : m_bdRingRx).runState != SGState::Idle)
+			BUILD_IP_EXCEPTION(CLAPException, "Cannot change the BD memory of channel " << channel << " while a SG transfer is active");
+
+		releaseChainBdMemory(channel);
+
+		m_chainBdMems[ch2Id(channel)]  = memBD;
+		m_chainBdOwned[ch2Id(channel)] = false;
+	}
+
 	////////////////////////////////////////
 
 	////////////////////////////////////////
 
+	/// @brief Sets the interrupt coalescing of the given channel, takes effect on the next SG transfer
+	///        A transfer started by StartSG() is only reported as finished once all of its BDs are completed,
+	///        independent of the number of interrupts raised. SG streams use their own threshold.
+	void SetInterruptCoalescing(const DMAChannel& channel, const IrqCoalescing& coalescing)
+	{
+		if (coalescing.threshold > AXI_DMA_MAX_IRQ_THRESHOLD)
+			BUILD_IP_EXCEPTION(CLAPException, "Interrupt coalescing threshold " << coalescing.threshold << " exceeds the hardware limit of " << AXI_DMA_MAX_IRQ_THRESHOLD);
+
+		m_coalescing[ch2Id(channel)] = coalescing;
+	}
+
+	const IrqCoalescing& GetInterruptCoalescing(const DMAChannel& channel) const
+	{
+		return m_coalescing[ch2Id(channel)];
+	}
+
+	/// @brief Returns the results of all BDs of the current SG transfer on the given channel that have been completed
+	///        since the last call as one batch, in the order they were handed to the hardware
+	///        The state of all outstanding BDs is fetched with a single bulk read if the host BD ring is used.
+	/// @param channel The channel of the SG transfer
+	/// @return Requested and transferred length of every completed BD
+	ChunkResults GetCompletedChunks(const DMAChannel& channel)
+	{
+		BdRing& bdRing = (channel == DMAChannel::MM2S ? m_bdRingTx : m_bdRingRx);
+		ChunkResults results;
+
+		std::lock_guard<std::mutex> lock(m_sgDoneMtx);
+		bdRingFromHw(bdRing);
+		std::swap(results, m_sgCompleted[ch2Id(channel)]);
+
+		return results;
+	}
+
 	const ChunkResults& GetS2MMChunkResults() const
 	{
 		return m_s2mmChunkResults;
@@ -560,6 +718,34 @@ public:
 		return m_watchDogS2MM.GetRuntime();
 	}
 
+	void SetPollStrategy(const PollStrategy& strategy)
+	{
+		SetPollStrategy(DMAChannel::MM2S, strategy);
+		SetPollStrategy(DMAChannel::S2MM, strategy);
+	}
+
+	void SetPollStrategy(const DMAChannel& channel, const PollStrategy& strategy)
+	{
+		if (channel == DMAChannel::MM2S)
+			m_watchDogMM2S.SetPollStrategy(strategy);
+		else
+			m_watchDogS2MM.SetPollStrategy(strategy);
+	}
+
+	CompletionStats GetCompletionStats(const DMAChannel& channel) const
+	{
+		if (channel == DMAChannel::MM2S)
+			return m_watchDogMM2S.GetCompletionStats();
+		else
+			return m_watchDogS2MM.GetCompletionStats();
+	}
+
+	void ResetCompletionStats()
+	{
+		m_watchDogMM2S.ResetCompletionStats();
+		m_watchDogS2MM.ResetCompletionStats();
+	}
+
 	////////////////////////////////////////
 	// SG
 	////////////////////////////////////////
@@ -574,13 +760,159 @@ public:
 		return false;
 	}
 
-	void StartSG(const Memory& memBDTx, const Memory& memBDRx, const Memory& memDataIn, const Memory& memDataOut, const uint32_t& maxPktByteLen, const uint8_t& numPkts = 1, const uint32_t& bdsPerPkt = 1)
+	/// @brief Enables or disables building the SG BD rings in a host-side shadow buffer
+	///        When enabled, the descriptors are prepared in host memory and uploaded to the BD memory
+	///        using a single bulk write, their status is fetched using a single bulk read
+	/// @param enable True to enable the host-side BD ring, false to access each descriptor field directly
+	void SetHostBdRing(const bool& enable)
+	{
+		if (m_bdRingTx.runState != SGState::Idle || m_bdRingRx.runState != SGState::Idle)
+			BUILD_IP_EXCEPTION(CLAPException, "Cannot change the BD ring mode while a SG transfer is active");
+
+		if (m_hostBdRing == enable) return;
+
+		m_hostBdRing = enable;
+
+		// Force a rebuild of the BD rings on the next transfer
+		m_bdRingTx.Reset();
+		m_bdRingRx.Reset();
+	}
+
+	bool IsHostBdRing() const
+	{
+		return m_hostBdRing;
+	}
+
+	void StartSG(const Memory& memBDTx, const Memory& memBDRx, const Memory& memDataIn, const Memory& memDataOut, const uint32_t& maxPktByteLen, const uint32_t& numPkts = 1, const uint32_t& bdsPerPkt = 1)
 	{
 		StartSG(DMAChannel::MM2S, memBDTx, memDataIn, maxPktByteLen, numPkts, bdsPerPkt);
 		StartSG(DMAChannel::S2MM, memBDRx, memDataOut, maxPktByteLen, numPkts, bdsPerPkt);
 	}
 
-	void StartSG(const DMAChannel& channel, const Memory& memBD, const Memory& memData, const uint32_t& maxPktByteLen, const uint8_t& numPkts = 1, const uint32_t& bdsPerPkt = 1)
+	/// @brief Starts a continuous scatter-gather stream on the given channel
+	///        memData is split into buffers of bufferSize bytes, each described by one BD in memBD. Completed buffers
+	///        are handed to the callback and afterwards re-armed by moving the tail descriptor forward, for MM2S the
+	///        callback can refill the buffer before it is sent again. The stream runs until the callback returns false
+	///        or StopSGStream() is called. Without reactor (bare-metal) ProcessSGStream() has to be called periodically.
+	/// @param channel The channel to stream on
+	/// @param memBD Memory for the BD ring, has to hold at least one BD (0x40 bytes) per buffer
+	/// @param memData Memory holding the data buffers, has to hold at least two buffers
+	/// @param bufferSize Size of a single buffer in bytes
+	/// @param callback Callback called for every completed buffer
+	/// @param irqThreshold Number of completed BDs per interrupt, is limited to 255 by the hardware
+	void StartSGStream(const DMAChannel& channel, const Memory& memBD, const Memory& memData, const uint32_t& bufferSize, SGStreamCallback callback, const uint32_t& irqThreshold = 1)
+	{
+		if ((channel == DMAChannel::MM2S && !m_mm2sPresent) || (channel == DMAChannel::S2MM && !m_s2mmPresent))
+			BUILD_IP_EXCEPTION(CLAPException, "Channel " << channel << " is not present");
+
+		if (!callback)
+			BUILD_IP_EXCEPTION(CLAPException, "No SG stream callback specified");
+
+		SGStream& stream = m_sgStreams[ch2Id(channel)];
+		BdRing& bdRing   = (channel == DMAChannel::MM2S ? m_bdRingTx : m_bdRingRx);
+
+		if (stream.active || bdRing.runState != SGState::Idle)
+			BUILD_IP_EXCEPTION(CLAPException, "DMA channel " << channel << " is still active");
+
+		if (bufferSize == 0)
+			BUILD_IP_EXCEPTION(CLAPException, "Invalid SG stream buffer size of 0 bytes");
+
+		const uint64_t numBuffers = memData.GetSize() / bufferSize;
+		const uint64_t maxBds     = memBD.GetSize() / AXI_DMA_BD_MINIMUM_ALIGNMENT;
+
+		if (numBuffers < 2)
+			BUILD_IP_EXCEPTION(CLAPException, "SG stream requires at least two buffers, the data memory only holds " << numBuffers);
+
+		if (numBuffers > maxBds)
+			BUILD_IP_EXCEPTION(CLAPException, "BD memory can only hold " << maxBds << " BDs, but the SG stream requires " << numBuffers);
+
+		const uint32_t bdCount = static_cast<uint32_t>(numBuffers);
+
+		if (!bdSetup(bdRing, memBD, irqThreshold, m_coalescing[ch2Id(channel)].delay, bdCount))
+			BUILD_IP_EXCEPTION(CLAPException, "SG stream setup failed");
+
+		if (bufferSize > bdRing.maxTransferLen)
+			BUILD_IP_EXCEPTION(CLAPException, "SG stream buffer size " << bufferSize << " exceeds the maximum transfer length " << bdRing.maxTransferLen);
+
+		SGDescriptor* pBd;
+
+		if (!bdRingAlloc(bdRing, bdCount, &pBd))
+			BUILD_IP_EXCEPTION(CLAPException, "SG stream BD alloc failed");
+
+		const uint32_t crBits = (bdRing.IsRxChannel() ? 0 : XAXIDMA_BD_CTRL_ALL_MASK);
+		uint64_t bufferAddr   = memData.GetBaseAddr();
+		SGDescriptor* pBdCur  = pBd;
+
+		for (uint32_t i = 0; i < bdCount; i++)
+		{
+			if (!pBdCur->SetBufferAddr(bufferAddr) || !pBdCur->SetLength(bufferSize, bdRing.maxTransferLen))
+				BUILD_IP_EXCEPTION(CLAPException, "SG stream BD setup failed for " << pBdCur->GetName());
+
+			pBdCur->SetControlBits(crBits);
+			pBdCur->SetId(i);
+
+			bufferAddr += bufferSize;
+			pBdCur = pBdCur->GetNextDesc();
+		}
+
+		if (!bdRingToHw(bdRing, bdCount, pBd))
+			BUILD_IP_EXCEPTION(CLAPException, "SG stream ToHw failed");
+
+		if (!startBdRing(bdRing))
+			BUILD_IP_EXCEPTION(CLAPException, "Failed to start SG stream BD ring");
+
+		stream.callback = std::move(callback);
+		stream.pHead    = pBd;
+		stream.buffers  = 0;
+		stream.active   = true;
+
+		internal::WatchDog& watchDog = (channel == DMAChannel::MM2S ? m_watchDogMM2S : m_watchDogS2MM);
+		watchDog.SetStatusRegister(&stream.monitor);
+		watchDog.SetFinishCallback([this, channel]() {
+			uint32_t processed = 0;
+			return processSGStream(channel, processed);
+		});
+
+		if (!watchDog.Start(true))
+			BUILD_IP_EXCEPTION(CLAPException, "Watchdog for " << channel << " already running!");
+	}
+
+	/// @brief Stops the SG stream on the given channel, buffers completed but not yet handed to the callback are dropped
+	/// @param channel The channel to stop the stream on
+	void StopSGStream(const DMAChannel& channel)
+	{
+		Stop(channel);
+	}
+
+	/// @brief Hands all completed buffers of the SG stream to its callback and re-arms them
+	///        Only required if the stream is not driven by the completion reactor, e.g., on bare-metal
+	/// @param channel The channel of the stream
+	/// @return Number of processed buffers
+	uint32_t ProcessSGStream(const DMAChannel& channel)
+	{
+		uint32_t processed = 0;
+		processSGStream(channel, processed);
+		return processed;
+	}
+
+	bool IsSGStreamActive(const DMAChannel& channel) const
+	{
+		return m_sgStreams[ch2Id(channel)].active;
+	}
+
+	/// @brief Returns the number of buffers completed by the current or last SG stream on the given channel
+	uint64_t GetSGStreamBufferCount(const DMAChannel& channel) const
+	{
+		return m_sgStreams[ch2Id(channel)].buffers;
+	}
+
+	void StartSG(const DMAChannel& channel, const Memory& memBD, const Memory& memData, const uint32_t& maxPktByteLen, const uint32_t& numPkts, const uint32_t& bdsPerPkt, const IrqCoalescing& coalescing)
+	{
+		SetInterruptCoalescing(channel, coalescing);
+		StartSG(channel, memBD, memData, maxPktByteLen, numPkts, bdsPerPkt);
+	}
+
+	void StartSG(const DMAChannel& channel, const Memory& memBD, const Memory& memData, const uint32_t& maxPktByteLen, const uint32_t& numPkts = 1, const uint32_t& bdsPerPkt = 1)
 	{
 		if (channel == DMAChannel::MM2S && m_mm2sPresent)
 		{
@@ -602,13 +934,7 @@ private:
 	static inline const uint32_t AXI_DMA_BD_MINIMUM_ALIGNMENT = 0x40;
 	static inline const uint32_t AXI_DMA_BD_HAS_DRE_SHIFT     = 8;
 	static inline const uint32_t AXI_DMA_BD_MAX_LENGTH_MASK   = 0x3FFFFFF;
-
-#define XAXIDMA_BD_CTRL_TXSOF_MASK   0x08000000
-#define XAXIDMA_BD_CTRL_TXEOF_MASK   0x04000000
-#define XAXIDMA_BD_CTRL_ALL_MASK     0x0C000000
-#define XAXIDMA_BD_WORDLEN_MASK      0xFF
-#define XAXIDMA_BD_HAS_DRE_MASK      0xF00
-#define XAXIDMA_BD_STS_COMPLETE_MASK 0x80000000
+	static inline const uint32_t AXI_DMA_MAX_IRQ_THRESHOLD    = 0xFF;
 
 	class SGDescriptor : public internal::RegisterControlBase
 	{
@@ -629,8 +955,11 @@ private:
 		};
 
 	public:
-		SGDescriptor(const CLAPPtr& pClap, const uint64_t& ctrlOffset, const std::string& name = "") :
-			RegisterControlBase(pClap, ctrlOffset, name)
+		// If pShadow is set, all field accesses go to the given host-side copy of the descriptor
+		// instead of the device, the owning BdRing is responsible for syncing it with the device
+		SGDescriptor(const CLAPPtr& pClap, const uint64_t& ctrlOffset, const std::string& name = "", uint8_t* pShadow = nullptr) :
+			RegisterControlBase(pClap, ctrlOffset, name),
+			m_pShadow(pShadow)
 		{
 			Reset();
 		}
@@ -654,18 +983,24 @@ private:
 			m_hasStsCtrlStrm = 0;
 			m_hasDRE         = 0;
 
-			writeRegister(SG_DESC_NXTDESC, m_nextDescAddr);
-			writeRegister(SG_DESC_BUFFER_ADDRESS, m_bufferAddr);
-			writeRegister(SG_DESC_CONTROL, m_control);
-			writeRegister(SG_DESC_STATUS, m_status);
-			writeRegister(SG_DESC_APP0, m_app0);
-			writeRegister(SG_DESC_APP1, m_app1);
-			writeRegister(SG_DESC_APP2, m_app2);
-			writeRegister(SG_DESC_APP3, m_app3);
-			writeRegister(SG_DESC_APP4, m_app4);
-			writeRegister(SG_DESC_ID, m_id);
-			writeRegister(SG_DESC_HAS_STS_CTRL_STRM, m_hasStsCtrlStrm);
-			writeRegister(SG_DESC_HAS_DRE, m_hasDRE);
+			if (m_pShadow)
+			{
+				std::memset(m_pShadow, 0, AXI_DMA_BD_MINIMUM_ALIGNMENT);
+				return;
+			}
+
+			setField(SG_DESC_NXTDESC, m_nextDescAddr);
+			setField(SG_DESC_BUFFER_ADDRESS, m_bufferAddr);
+			setField(SG_DESC_CONTROL, m_control);
+			setField(SG_DESC_STATUS, m_status);
+			setField(SG_DESC_APP0, m_app0);
+			setField(SG_DESC_APP1, m_app1);
+			setField(SG_DESC_APP2, m_app2);
+			setField(SG_DESC_APP3, m_app3);
+			setField(SG_DESC_APP4, m_app4);
+			setField(SG_DESC_ID, m_id);
+			setField(SG_DESC_HAS_STS_CTRL_STRM, m_hasStsCtrlStrm);
+			setField(SG_DESC_HAS_DRE, m_hasDRE);
 		}
 
 		void Print() const
@@ -692,7 +1027,7 @@ private:
 		void SetNextDescAddr(const uint64_t& addr)
 		{
 			m_nextDescAddr = addr;
-			writeRegister(SG_DESC_NXTDESC, m_nextDescAddr);
+			setField(SG_DESC_NXTDESC, m_nextDescAddr);
 		}
 
 		bool SetBufferAddr(const uint64_t& addr)
@@ -710,7 +1045,7 @@ private:
 			}
 
 			m_bufferAddr = addr;
-			writeRegister(SG_DESC_BUFFER_ADDRESS, m_bufferAddr);
+			setField(SG_DESC_BUFFER_ADDRESS, m_bufferAddr);
 
 			return true;
 		}
@@ -718,7 +1053,7 @@ private:
 		void SetControl(const uint32_t& ctrl)
 		{
 			m_control = ctrl;
-			writeRegister(SG_DESC_CONTROL, m_control);
+			setField(SG_DESC_CONTROL, m_control);
 		}
 
 		void SetControlBits(const uint32_t& bits)
@@ -751,60 +1086,65 @@ private:
 		void SetStatus(const uint32_t& sts)
 		{
 			m_status = sts;
-			writeRegister(SG_DESC_STATUS, m_status);
+			setField(SG_DESC_STATUS, m_status);
 		}
 
 		void SetApp0(const uint32_t& app)
 		{
 			m_app0 = app;
-			writeRegister(SG_DESC_APP0, m_app0);
+			setField(SG_DESC_APP0, m_app0);
 		}
 
 		void SetApp1(const uint32_t& app)
 		{
 			m_app1 = app;
-			writeRegister(SG_DESC_APP1, m_app1);
+			setField(SG_DESC_APP1, m_app1);
 		}
 
 		void SetApp2(const uint32_t& app)
 		{
 			m_app2 = app;
-			writeRegister(SG_DESC_APP2, m_app2);
+			setField(SG_DESC_APP2, m_app2);
 		}
 
 		void SetApp3(const uint32_t& app)
 		{
 			m_app3 = app;
-			writeRegister(SG_DESC_APP3, m_app3);
+			setField(SG_DESC_APP3, m_app3);
 		}
 
 		void SetApp4(const uint32_t& app)
 		{
 			m_app4 = app;
-			writeRegister(SG_DESC_APP4, m_app4);
+			setField(SG_DESC_APP4, m_app4);
 		}
 
 		void SetId(const uint32_t& id)
 		{
 			m_id = id;
-			writeRegister(SG_DESC_ID, m_id);
+			setField(SG_DESC_ID, m_id);
 		}
 
 		void SetHasStsCtrlStrm(const uint32_t& sts)
 		{
 			m_hasStsCtrlStrm = sts;
-			writeRegister(SG_DESC_HAS_STS_CTRL_STRM, m_hasStsCtrlStrm);
+			setField(SG_DESC_HAS_STS_CTRL_STRM, m_hasStsCtrlStrm);
 		}
 
 		void SetHasDRE(const uint32_t& dre)
 		{
 			m_hasDRE = dre;
-			writeRegister(SG_DESC_HAS_DRE, m_hasDRE);
+			setField(SG_DESC_HAS_DRE, m_hasDRE);
+		}
+
+		const uint64_t& GetBufferAddr() const
+		{
+			return m_bufferAddr;
 		}
 
 		const uint32_t& GetControl()
 		{
-			m_control = readRegister<uint32_t>(SG_DESC_CONTROL);
+			m_control = getField<uint32_t>(SG_DESC_CONTROL);
 			return m_control;
 		}
 
@@ -816,13 +1156,13 @@ private:
 
 		const uint32_t& GetStatus()
 		{
-			m_status = readRegister<uint32_t>(SG_DESC_STATUS);
+			m_status = getField<uint32_t>(SG_DESC_STATUS);
 			return m_status;
 		}
 
 		const uint32_t& GetHasDRE()
 		{
-			m_hasDRE = readRegister<uint32_t>(SG_DESC_HAS_DRE);
+			m_hasDRE = getField<uint32_t>(SG_DESC_HAS_DRE);
 			return m_hasDRE;
 		}
 
@@ -841,7 +1181,32 @@ private:
 			return GetStatus() & XAXIDMA_BD_STS_COMPLETE_MASK;
 		}
 
+		bool IsShadowed() const
+		{
+			return m_pShadow != nullptr;
+		}
+
 	private:
+		template<typename U>
+		void setField(const uint64_t& offset, const U& data)
+		{
+			if (m_pShadow)
+				std::memcpy(m_pShadow + offset, &data, sizeof(U));
+			else
+				writeRegister(offset, data);
+		}
+
+		template<typename U>
+		U getField(const uint64_t& offset)
+		{
+			if (!m_pShadow)
+				return readRegister<U>(offset);
+
+			U data;
+			std::memcpy(&data, m_pShadow + offset, sizeof(U));
+			return data;
+		}
+
 		uint64_t m_nextDescAddr   = 0; // 0-7
 		uint64_t m_bufferAddr     = 0; // 8-F
 		uint32_t m_reserved1      = 0; // 10-13
@@ -858,6 +1223,7 @@ private:
 		uint32_t m_hasDRE         = 0; // 3C-3F -- Whether the BD has DRE (allows unaligned transfers)
 
 		class SGDescriptor* m_pNextDesc = nullptr;
+		uint8_t* m_pShadow              = nullptr;
 	};
 
 	using SGDescriptors = std::vector<SGDescriptor*>;
@@ -883,6 +1249,10 @@ private:
 			if (cyclicBd) delete cyclicBd;
 
 			descriptors.clear();
+			shadow.clear();
+			shadow.shrink_to_fit();
+			bounce.clear();
+			bounce.shrink_to_fit();
 
 			runState        = SGState::Idle;
 			hasStsCntrlStrm = 0;
@@ -896,6 +1266,7 @@ private:
 			bdRestart = nullptr;
 			cyclicBd  = nullptr;
 
+			baseAddr  = 0;
 			freeCnt   = 0;
 			preCnt    = 0;
 			hwCnt     = 0;
@@ -921,6 +1292,7 @@ private:
 		{
 			freeHead = descriptors.front();
 			preHead  = descriptors.front();
+			hwHead   = descriptors.front();
 			hwTail   = descriptors.front();
 
 			bdRestart = descriptors.front();
@@ -935,8 +1307,23 @@ private:
 			return channel == DMAChannel::S2MM;
 		}
 
+		bool IsShadowed() const
+		{
+			return !shadow.empty();
+		}
+
+		uint64_t IndexOf(const SGDescriptor* pDesc) const
+		{
+			return (pDesc->Addr() - baseAddr) / separation;
+		}
+
 		SGDescriptors descriptors = {};
 
+		// Host-side copy of the whole BD ring, using the same layout as the BD memory on the device
+		CLAPBuffer<uint8_t> shadow = {};
+		// Aligned staging buffer for partial syncs, as the backends require aligned host buffers
+		CLAPBuffer<uint8_t> bounce = {};
+
 		DMAChannel channel = DMAChannel::MM2S;
 
 		SGState runState         = SGState::Idle;
@@ -947,10 +1334,12 @@ private:
 
 		SGDescriptor* freeHead  = nullptr;
 		SGDescriptor* preHead   = nullptr;
+		SGDescriptor* hwHead    = nullptr;
 		SGDescriptor* hwTail    = nullptr;
 		SGDescriptor* bdRestart = nullptr;
 		SGDescriptor* cyclicBd  = nullptr;
 
+		uint64_t baseAddr  = 0;
 		uint32_t freeCnt   = 0;
 		uint32_t preCnt    = 0;
 		uint32_t hwCnt     = 0;
@@ -961,27 +1350,62 @@ private:
 		const uint64_t separation = AXI_DMA_BD_MINIMUM_ALIGNMENT;
 	};
 
-	void startSGTransferMM2S(const Memory& memBD, const Memory& memData, const uint32_t& maxPktByteLen, const uint8_t& numPkts, const uint32_t& bdsPerPkt)
+	struct SGStream
+	{
+		SGStream(AxiDMA* pDMA, const DMAChannel& ch) :
+			monitor([pDMA, ch]() { return pDMA->pollSGStream(ch); })
+		{}
+
+		DISABLE_COPY_ASSIGN_MOVE(SGStream)
+
+		// Reports the stream as done as soon as its oldest BD has been completed by the hardware
+		internal::CallbackStatus monitor;
+		SGStreamCallback callback = nullptr;
+		SGDescriptor* pHead       = nullptr;
+		uint64_t buffers          = 0;
+		bool active               = false;
+	};
+
+	// Completion state of a transfer started by StartSG
+	struct SGTransfer
+	{
+		bool coalesced    = false;
+		uint32_t pktsLeft = 0;
+	};
+
+	void startSGTransferMM2S(const Memory& memBD, const Memory& memData, const uint32_t& maxPktByteLen, const uint32_t& numPkts, const uint32_t& bdsPerPkt)
 	{
 		if (m_bdRingTx.runState != SGState::Idle)
 			BUILD_IP_EXCEPTION(CLAPException, "DMA channel MM2S is still active");
 
-		if (!bdSetup(m_bdRingTx, memBD, numPkts, SG_IRQ_DELAY))
+		const IrqCoalescing& coalescing = m_coalescing[ch2Id(DMAChannel::MM2S)];
+		// The hardware limits the threshold, a transfer of more packets raises multiple interrupts even without coalescing
+		const uint32_t irqThreshold = std::min((coalescing.threshold == 0 ? numPkts : coalescing.threshold), AXI_DMA_MAX_IRQ_THRESHOLD);
+
+		if (!bdSetup(m_bdRingTx, memBD, irqThreshold, coalescing.delay))
 			BUILD_IP_EXCEPTION(CLAPException, "TXSetup failed");
 
-		if (!sendPackets(numPkts, maxPktByteLen, bdsPerPkt, memData))
+		resetCompletedChunks(m_bdRingTx, irqThreshold < numPkts, numPkts);
+
+		if (!sendPackets(numPkts, maxPktByteLen, bdsPerPkt, memData.GetBaseAddr(), memData.GetSize()))
 			BUILD_IP_EXCEPTION(CLAPException, "SendPackets failed");
 	}
 
-	void startSGTransferS2MM(const Memory& memBD, const Memory& memData, const uint32_t& maxPktByteLen, const uint8_t& numPkts)
+	void startSGTransferS2MM(const Memory& memBD, const Memory& memData, const uint32_t& maxPktByteLen, const uint32_t& numPkts)
 	{
 		if (m_bdRingRx.runState != SGState::Idle)
 			BUILD_IP_EXCEPTION(CLAPException, "DMA channel S2MM is still active");
 
-		if (!bdSetup(m_bdRingRx, memBD, numPkts, SG_IRQ_DELAY))
+		const IrqCoalescing& coalescing = m_coalescing[ch2Id(DMAChannel::S2MM)];
+		// The hardware limits the threshold, a transfer of more packets raises multiple interrupts even without coalescing
+		const uint32_t irqThreshold = std::min((coalescing.threshold == 0 ? numPkts : coalescing.threshold), AXI_DMA_MAX_IRQ_THRESHOLD);
+
+		if (!bdSetup(m_bdRingRx, memBD, irqThreshold, coalescing.delay))
 			BUILD_IP_EXCEPTION(CLAPException, "RXSetup failed");
 
-		if (!readPackets(maxPktByteLen, memData))
+		resetCompletedChunks(m_bdRingRx, irqThreshold < numPkts, numPkts);
+
+		if (!readPackets(maxPktByteLen, memData.GetBaseAddr(), memData.GetSize()))
 			BUILD_IP_EXCEPTION(CLAPException, "ReadPackets failed");
 	}
 
@@ -1019,9 +1443,17 @@ private:
 
 		std::vector<SGDescriptor*> descs;
 
+		if (m_hostBdRing)
+		{
+			bdRing.shadow.resize(bdCount * bdRing.separation, 0);
+			bdRing.bounce.resize(bdCount * bdRing.separation, 0);
+			bdRing.baseAddr = addr;
+		}
+
 		for (uint32_t i = 0; i < bdCount; i++)
 		{
-			SGDescriptor* d = new SGDescriptor(m_pClap, addr + (i * bdRing.separation), "SGDescriptor #" + std::to_string(i));
+			uint8_t* pShadow = bdRing.IsShadowed() ? bdRing.shadow.data() + (i * bdRing.separation) : nullptr;
+			SGDescriptor* d  = new SGDescriptor(m_pClap, addr + (i * bdRing.separation), "SGDescriptor #" + std::to_string(i), pShadow);
 
 			if (i < bdCount - 1)
 				d->SetNextDescAddr(addr + ((i + 1) * bdRing.separation));
@@ -1039,9 +1471,52 @@ private:
 
 		bdRing.Init(descs, bdCount);
 
+		// Upload the complete, linked ring in one go
+		syncBds(bdRing, bdRing.descriptors.front(), bdCount, internal::Direction::WRITE);
+
 		return true;
 	}
 
+	// Transfers numBd descriptors, starting at pFirst, between the host-side shadow ring and the BD memory on the device.
+	// Wraps around at the end of the ring, resulting in at most two bulk transfers. No-op for rings without a shadow.
+	// Ranges that do not start at an aligned position within the shadow are staged through the bounce buffer, only
+	// the requested descriptors are transferred, as the hardware might update the remaining ones concurrently.
+	void syncBds(BdRing& bdRing, const SGDescriptor* pFirst, const uint32_t& numBd, const internal::Direction& dir)
+	{
+		if (!bdRing.IsShadowed() || numBd == 0) return;
+
+		uint64_t index = bdRing.IndexOf(pFirst);
+		uint64_t count = std::min(static_cast<uint64_t>(numBd), static_cast<uint64_t>(bdRing.allCnt));
+
+		while (count > 0)
+		{
+			const uint64_t chunk  = std::min(count, bdRing.allCnt - index);
+			const uint64_t offset = index * bdRing.separation;
+			const uint64_t size   = chunk * bdRing.separation;
+
+			uint8_t* pShadow = bdRing.shadow.data() + offset;
+			const bool staged = !IS_ALIGNED(pShadow, ALIGNMENT);
+
+			if (dir == internal::Direction::WRITE)
+			{
+				if (staged)
+					std::memcpy(bdRing.bounce.data(), pShadow, size);
+
+				m_pClap->Write(bdRing.baseAddr + offset, staged ? bdRing.bounce.data() : pShadow, size);
+			}
+			else
+			{
+				m_pClap->Read(bdRing.baseAddr + offset, staged ? bdRing.bounce.data() : pShadow, size);
+
+				if (staged)
+					std::memcpy(pShadow, bdRing.bounce.data(), size);
+			}
+
+			count -= chunk;
+			index = 0;
+		}
+	}
+
 	bool setCoalesce(BdRing& bdRing, const uint8_t& counter, const uint8_t& timer)
 	{
 		if (counter == 0)
@@ -1094,6 +1569,9 @@ private:
 
 		if (!pStatusReg->IsStarted())
 		{
+			// Fetch the current state of all BDs with a single bulk read
+			syncBds(bdRing, bdRing.descriptors.front(), bdRing.allCnt, internal::Direction::READ);
+
 			SGDescriptor* pDesc = bdRing.bdRestart;
 
 			if (!pDesc->IsComplete())
@@ -1176,6 +1654,8 @@ private:
 					return true;
 				}
 
+				syncBds(bdRing, bdRing.hwTail, 1, internal::Direction::READ);
+
 				if (!bdRing.hwTail->IsComplete())
 				{
 					if (bdRing.IsRxChannel())
@@ -1307,10 +1787,16 @@ private:
 		for (uint32_t i = 0; i < numBd; i++)
 			bdRing.preHead = bdRing.preHead->GetNextDesc();
 
+		if (bdRing.hwCnt == 0)
+			bdRing.hwHead = pBdSet;
+
 		bdRing.preCnt -= numBd;
 		bdRing.hwTail = pCurBd;
 		bdRing.hwCnt += numBd;
 
+		// Hand the prepared BDs to the device with a single bulk write before moving the tail pointer
+		syncBds(bdRing, pBdSet, numBd, internal::Direction::WRITE);
+
 		if (bdRing.runState == SGState::Running)
 		{
 			if (bdRing.cyclic)
@@ -1333,34 +1819,119 @@ private:
 		return true;
 	}
 
-	bool bdSetup(BdRing& bdRing, const Memory& mem, const uint8_t& numPkts, const uint8_t& irqDelay)
+	// Moves the BDs completed by the hardware, starting at the oldest one, back to the free BDs and
+	// appends their results to the completed chunks of the channel, m_sgDoneMtx has to be held
+	uint32_t bdRingFromHw(BdRing& bdRing)
 	{
-		const uint32_t bdCount = ROUND_UP_DIV(mem.GetSize(), AXI_DMA_BD_MINIMUM_ALIGNMENT);
+		// SG streams re-arm their BDs themselves
+		if (bdRing.hwCnt == 0 || bdRing.cyclic || m_sgStreams[ch2Id(bdRing.channel)].active) return 0;
+
+		syncBds(bdRing, bdRing.hwHead, bdRing.hwCnt, internal::Direction::READ);
 
-		// If the BD ring count is the same as the previous one, we can reuse the BD ring
-		if (bdRing.allCnt == bdCount)
+		ChunkResults& results = m_sgCompleted[ch2Id(bdRing.channel)];
+		SGTransfer& transfer  = m_sgTransfers[ch2Id(bdRing.channel)];
+		SGDescriptor* pBd     = bdRing.hwHead;
+		uint32_t count        = 0;
+
+		while (count < bdRing.hwCnt && pBd->IsComplete())
 		{
-			CLAP_IP_CORE_LOG_DEBUG << "Reusing BD ring" << std::endl;
-			bdRing.ReInit();
+			const uint32_t sts = pBd->GetStatus();
+
+			if (sts & XAXIDMA_BD_STS_ALL_ERR_MASK)
+				CLAP_IP_CORE_LOG_ERROR << "Channel " << bdRing.channel << ": " << pBd->GetName() << " reported an error, status: 0x" << std::hex << sts << std::dec << std::endl;
+
+			if (bdRing.IsRxChannel() && (sts & XAXIDMA_BD_STS_RXEOF_MASK) && transfer.pktsLeft > 0)
+				transfer.pktsLeft--;
+
+			results.push_back({ pBd->GetLength(), sts & AXI_DMA_BD_MAX_LENGTH_MASK });
+
+			pBd = pBd->GetNextDesc();
+			count++;
+		}
+
+		bdRing.hwHead = pBd;
+		bdRing.hwCnt -= count;
+		bdRing.freeCnt += count;
+
+		return count;
+	}
+
+	// Clears the completed chunks of the channel before a new SG transfer
+	void resetCompletedChunks(const BdRing& bdRing, const bool& coalesced, const uint32_t& numPkts)
+	{
+		std::lock_guard<std::mutex> lock(m_sgDoneMtx);
+		m_sgCompleted[ch2Id(bdRing.channel)].clear();
+		m_sgTransfers[ch2Id(bdRing.channel)] = { coalesced, numPkts };
+	}
+
+	// Returns true if the SG transfer on the given ring is done, i.e., all BDs (MM2S) or packets (S2MM, the ring
+	// might hold more BDs than required) are completed or the channel halted. Without coalescing the single
+	// interrupt or the idle channel already marks the end of the transfer.
+	bool sgTransferDone(BdRing& bdRing)
+	{
+		std::lock_guard<std::mutex> lock(m_sgDoneMtx);
+		const SGTransfer& transfer = m_sgTransfers[ch2Id(bdRing.channel)];
+
+		if (!transfer.coalesced) return true;
+
+		bdRingFromHw(bdRing);
+
+		if (bdRing.hwCnt == 0 || (bdRing.IsRxChannel() && transfer.pktsLeft == 0)) return true;
+
+		StatusRegister& statusReg = (bdRing.channel == DMAChannel::MM2S ? static_cast<StatusRegister&>(m_mm2sStatReg) : static_cast<StatusRegister&>(m_s2mmStatReg));
+
+		if (!statusReg.IsStarted())
+		{
+			CLAP_IP_CORE_LOG_ERROR << "Channel " << bdRing.channel << " halted with " << bdRing.hwCnt << " outstanding BDs" << std::endl;
 			return true;
 		}
 
-		if (!initBdRing(bdRing, mem.GetBaseAddr(), bdCount))
+		return false;
+	}
+
+	// Sets up a BD ring of bdCount BDs in the given memory, a bdCount of 0 uses as many BDs as fit into the memory
+	bool bdSetup(BdRing& bdRing, const Memory& mem, const uint32_t& numPkts, const uint8_t& irqDelay, const uint32_t& bdCount = 0)
+	{
+		const uint32_t maxBdCount = static_cast<uint32_t>(mem.GetSize() / AXI_DMA_BD_MINIMUM_ALIGNMENT);
+		const uint32_t ringSize   = (bdCount == 0 ? ROUND_UP_DIV(mem.GetSize(), AXI_DMA_BD_MINIMUM_ALIGNMENT) : bdCount);
+
+		if (bdCount > maxBdCount)
+		{
+			CLAP_IP_CORE_LOG_ERROR << "bdSetup: " << bdCount << " BDs do not fit into the BD memory (max: " << maxBdCount << ")" << std::endl;
+			return false;
+		}
+
+		if (ringSize == 0)
+		{
+			CLAP_IP_CORE_LOG_ERROR << "bdSetup: The BD memory is empty" << std::endl;
+			return false;
+		}
+
+		// If the BD ring count and location are the same as the previous one, we can reuse the BD ring
+		if (!bdRing.descriptors.empty() && bdRing.allCnt == ringSize && bdRing.descriptors.front()->Addr() == mem.GetBaseAddr())
+		{
+			CLAP_IP_CORE_LOG_DEBUG << "Reusing BD ring" << std::endl;
+			bdRing.ReInit();
+		}
+		else if (!initBdRing(bdRing, mem.GetBaseAddr(), ringSize))
 		{
 			CLAP_IP_CORE_LOG_ERROR << "Failed to initialize BD ring" << std::endl;
 			return false;
 		}
 
-		if (!setCoalesce(bdRing, numPkts, irqDelay))
+		// The IRQ threshold register is only 8 bit wide
+		const uint8_t threshold = static_cast<uint8_t>(std::min(numPkts, AXI_DMA_MAX_IRQ_THRESHOLD));
+
+		if (!setCoalesce(bdRing, threshold, irqDelay))
 		{
-			CLAP_IP_CORE_LOG_ERROR << "Failed set coalescing " << static_cast<uint32_t>(numPkts) << "/" << static_cast<uint32_t>(irqDelay) << std::endl;
+			CLAP_IP_CORE_LOG_ERROR << "Failed set coalescing " << static_cast<uint32_t>(threshold) << "/" << static_cast<uint32_t>(irqDelay) << std::endl;
 			return false;
 		}
 
 		return true;
 	}
 
-	bool readPackets(const uint32_t& maxPktByteLen, const Memory& mem)
+	bool readPackets(const uint32_t& maxPktByteLen, const uint64_t& dataAddr, const uint64_t& dataSize)
 	{
 		int32_t freeBdCount = m_bdRingRx.freeCnt;
 		SGDescriptor* pBd;
@@ -1372,8 +1943,8 @@ private:
 		}
 
 		SGDescriptor* pBdCur   = pBd;
-		uint64_t pRxBuffer     = mem.GetBaseAddr();
-		uint64_t remainingSize = mem.GetSize();
+		uint64_t pRxBuffer     = dataAddr;
+		uint64_t remainingSize = dataSize;
 
 		for (int32_t i = 0; i < freeBdCount; i++)
 		{
@@ -1415,7 +1986,101 @@ private:
 		return true;
 	}
 
-	bool sendPackets(const uint8_t& numPkts, const uint32_t maxPktByteLen, const uint32_t& bdsPerPkt, const Memory& mem)
+	// Returns true if the oldest BD of the SG stream on the given channel has been completed
+	bool pollSGStream(const DMAChannel& channel)
+	{
+		SGStream& stream = m_sgStreams[ch2Id(channel)];
+		BdRing& bdRing   = (channel == DMAChannel::MM2S ? m_bdRingTx : m_bdRingRx);
+
+		if (!stream.active) return true;
+
+		syncBds(bdRing, stream.pHead, 1, internal::Direction::READ);
+		return stream.pHead->IsComplete();
+	}
+
+	// Hands the completed buffers of the SG stream to its callback, re-arms their BDs with a single
+	// bulk upload and moves the tail descriptor forward. Returns true if the stream has ended.
+	bool processSGStream(const DMAChannel& channel, uint32_t& processed)
+	{
+		SGStream& stream = m_sgStreams[ch2Id(channel)];
+		BdRing& bdRing   = (channel == DMAChannel::MM2S ? m_bdRingTx : m_bdRingRx);
+
+		processed = 0;
+
+		if (!stream.active) return true;
+
+		// One bulk read for the status of the whole ring, starting at the oldest BD
+		syncBds(bdRing, stream.pHead, bdRing.allCnt, internal::Direction::READ);
+
+		SGDescriptor* pFirst = stream.pHead;
+		SGDescriptor* pLast  = nullptr;
+		bool proceed         = true;
+		bool failed          = false;
+
+		while (proceed && processed < bdRing.allCnt && stream.pHead->IsComplete())
+		{
+			SGDescriptor* pBd   = stream.pHead;
+			const uint32_t sts = pBd->GetStatus();
+
+			if (sts & XAXIDMA_BD_STS_ALL_ERR_MASK)
+			{
+				CLAP_IP_CORE_LOG_ERROR << "SG stream on channel " << channel << ": " << pBd->GetName() << " reported an error, status: 0x" << std::hex << sts << std::dec << std::endl;
+				failed = true;
+				break;
+			}
+
+			proceed = stream.callback(pBd->GetBufferAddr(), sts & AXI_DMA_BD_MAX_LENGTH_MASK);
+
+			pBd->SetStatus(0);
+
+			pLast        = pBd;
+			stream.pHead = pBd->GetNextDesc();
+			stream.buffers++;
+			processed++;
+		}
+
+		if (!proceed || failed)
+		{
+			finishSGStream(channel);
+			return true;
+		}
+
+		if (pLast == nullptr) return false;
+
+		syncBds(bdRing, pFirst, processed, internal::Direction::WRITE);
+
+		bdRing.hwTail = pLast;
+		writeRegister(channel == DMAChannel::MM2S ? MM2S_TAILDESC : S2MM_TAILDESC, pLast->Addr());
+
+		return false;
+	}
+
+	// Halts the channel and restores its watchdog after the SG stream ended
+	void finishSGStream(const DMAChannel& channel)
+	{
+		SGStream& stream = m_sgStreams[ch2Id(channel)];
+
+		if (!stream.active) return;
+
+		stream.active = false;
+
+		if (channel == DMAChannel::MM2S)
+		{
+			m_mm2sCtrlReg.Stop();
+			m_bdRingTx.runState = SGState::Idle;
+		}
+		else
+		{
+			m_s2mmCtrlReg.Stop();
+			m_bdRingRx.runState = SGState::Idle;
+		}
+
+		resetWatchDog(channel);
+
+		CLAP_IP_CORE_LOG_DEBUG << "SG stream on channel " << channel << " finished after " << stream.buffers << " buffers" << std::endl;
+	}
+
+	bool sendPackets(const uint32_t& numPkts, const uint32_t maxPktByteLen, const uint32_t& bdsPerPkt, const uint64_t& dataAddr, const uint64_t& dataSize)
 	{
 		if (!startBdRing(m_bdRingTx))
 		{
@@ -1441,10 +2106,10 @@ private:
 			return false;
 		}
 
-		uint64_t bufferAddr  = mem.GetBaseAddr();
+		uint64_t bufferAddr  = dataAddr;
 		SGDescriptor* pBdCur = pBd;
 
-		uint64_t remainingSize = mem.GetSize();
+		uint64_t remainingSize = dataSize;
 
 		for (uint32_t i = 0; i < numPkts; i++)
 		{
@@ -1569,6 +2234,9 @@ private:
 
 		m_mm2sStatReg.Reset();
 
+		// Unchanged registers are skipped, the length is written last as it starts the transfer
+		internal::RegisterTransaction tx(*this);
+
 		// Set the RunStop bit
 		m_mm2sCtrlReg.Start();
 		// Set the source address
@@ -1590,6 +2258,8 @@ private:
 
 		m_s2mmStatReg.Reset();
 
+		internal::RegisterTransaction tx(*this);
+
 		// Set the RunStop bit
 		m_s2mmCtrlReg.Start();
 		// Set the destination address
@@ -1598,6 +2268,168 @@ private:
 		setS2MMByteLength(m_s2mmCurChunk.length);
 	}
 
+	// Handles the completion of a chunk of the current simple mode transfer and immediately starts the next
+	// queued chunk, returns true once all chunks are completed
+	bool chunkCompleted(const DMAChannel& channel)
+	{
+		ChunkProgress& progress = m_chunkProgress[ch2Id(channel)];
+		progress.completed++;
+
+		if (channel == DMAChannel::MM2S)
+		{
+			if (!m_mm2sChunks.empty())
+				startMM2STransfer();
+		}
+		else
+		{
+			// The length register has to be read before it is overwritten by the next chunk
+			m_s2mmChunkResults.push_back({ m_s2mmCurChunk.length, GetS2MMByteLength() });
+
+			if (!m_s2mmChunks.empty())
+				startS2MMTransfer();
+		}
+
+		return (progress.completed == progress.total);
+	}
+
+	// Interrupt callback of both channels, called before the completion reactor processes the interrupt (or from
+	// the interrupt handler on bare-metal). Starting the next chunk here avoids the round trip through the watchdog.
+	void onChunkInterrupt(const DMAChannel& channel)
+	{
+		ChunkProgress& progress = m_chunkProgress[ch2Id(channel)];
+
+		// No simple mode transfer active, e.g., a SG transfer or interrupts cleared during the initialization
+		if (progress.completed == progress.total) return;
+
+		progress.irqDriven = true;
+		chunkCompleted(channel);
+	}
+
+	// Called by the watchdog for every completion of a simple mode transfer, returns true once the transfer is done
+	bool chunkedTransferDone(const DMAChannel& channel)
+	{
+		ChunkProgress& progress = m_chunkProgress[ch2Id(channel)];
+		const bool done         = (progress.irqDriven ? progress.completed == progress.total : chunkCompleted(channel));
+
+		if (done)
+			progress = {};
+
+		return done;
+	}
+
+	// Executes a simple mode transfer on a core built in SG mode by chaining its chunks in a BD ring
+	void startChainedTransfer(const DMAChannel& channel, const T& addr, const uint32_t& length)
+	{
+		if ((channel == DMAChannel::MM2S && !m_mm2sPresent) || (channel == DMAChannel::S2MM && !m_s2mmPresent)) return;
+
+		const uint32_t id = ch2Id(channel);
+		BdRing& bdRing    = (channel == DMAChannel::MM2S ? m_bdRingTx : m_bdRingRx);
+
+		if (bdRing.runState != SGState::Idle)
+			BUILD_IP_EXCEPTION(CLAPException, "DMA channel " << channel << " is still active");
+
+		// The BD length has to stay below the limit of the buffer length register while keeping the next BD aligned
+		const uint32_t bdLength = std::min(m_maxTransferLengths[id], (1u << m_bufLenRegWidth) - m_dataWidths[id]);
+		const uint32_t numBds   = std::max(static_cast<uint32_t>(ROUND_UP_DIV(static_cast<uint64_t>(length), bdLength)), 1u);
+
+		CLAP_IP_CORE_LOG_DEBUG << "Starting chained DMA transfer on channel " << channel << " with address 0x" << std::hex << addr << std::dec << " and length " << length << " byte using " << numBds << " BDs" << std::endl;
+
+		// An interrupt per BD, the transfer is only reported as finished once all BDs are completed
+		if (!bdSetup(bdRing, chainBdMemory(channel, numBds), 1, 0, numBds))
+			BUILD_IP_EXCEPTION(CLAPException, "Chained transfer setup failed on channel " << channel);
+
+		resetCompletedChunks(bdRing, numBds > 1, numBds);
+
+		m_chained[id] = true;
+
+		// The status register latches the completion of the previous transfer, as for simple mode transfers
+		// the watchdog is only started once the hardware is running
+		if (channel == DMAChannel::MM2S)
+		{
+			m_mm2sStatReg.Reset();
+
+			if (!sendPackets(numBds, bdLength, 1, addr, length))
+				BUILD_IP_EXCEPTION(CLAPException, "Chained transfer failed on channel " << channel);
+		}
+		else
+		{
+			m_s2mmStatReg.Reset();
+			m_s2mmChunkResults.clear();
+
+			if (!readPackets(bdLength, addr, length))
+				BUILD_IP_EXCEPTION(CLAPException, "Chained transfer failed on channel " << channel);
+		}
+
+		if (!(channel == DMAChannel::MM2S ? m_watchDogMM2S : m_watchDogS2MM).Start(true))
+			BUILD_IP_EXCEPTION(CLAPException, "Watchdog for " << channel << " already running!");
+	}
+
+	// Provides the results of a finished chained transfer the same way as for simple mode transfers
+	void finishChainedTransfer(const DMAChannel& channel)
+	{
+		const uint32_t id = ch2Id(channel);
+
+		if (!m_chained[id]) return;
+
+		m_chained[id] = false;
+
+		if (channel == DMAChannel::S2MM)
+		{
+			std::lock_guard<std::mutex> lock(m_sgDoneMtx);
+			bdRingFromHw(m_bdRingRx);
+			m_s2mmChunkResults = std::move(m_sgCompleted[id]);
+			m_sgCompleted[id].clear();
+		}
+
+		releaseChainedRing(channel);
+	}
+
+	// Halts the channel and drops its BD ring, the next transfer therefore starts again at the first BD of a fresh ring
+	void releaseChainedRing(const DMAChannel& channel)
+	{
+		if (channel == DMAChannel::MM2S)
+		{
+			m_mm2sCtrlReg.Stop();
+			m_bdRingTx.Reset();
+		}
+		else
+		{
+			m_s2mmCtrlReg.Stop();
+			m_bdRingRx.Reset();
+		}
+	}
+
+	// Returns BD memory for at least numBds BDs, allocating it from the DDR regions if none was set by the user
+	const Memory& chainBdMemory(const DMAChannel& channel, const uint32_t& numBds)
+	{
+		const uint32_t id   = ch2Id(channel);
+		const uint64_t size = static_cast<uint64_t>(numBds) * AXI_DMA_BD_MINIMUM_ALIGNMENT;
+		Memory& mem         = m_chainBdMems[id];
+
+		if (mem.IsValid() && mem.GetSize() >= size) return mem;
+
+		if (mem.IsValid() && !m_chainBdOwned[id])
+			BUILD_IP_EXCEPTION(CLAPException, "BD memory of channel " << channel << " can only hold " << mem.GetSize() / AXI_DMA_BD_MINIMUM_ALIGNMENT << " BDs, but the transfer requires " << numBds);
+
+		releaseChainBdMemory(channel);
+
+		mem                = m_pClap->AllocMemory(CLAP::MemoryType::DDR, size);
+		m_chainBdOwned[id] = true;
+
+		return mem;
+	}
+
+	void releaseChainBdMemory(const DMAChannel& channel)
+	{
+		const uint32_t id = ch2Id(channel);
+
+		if (m_chainBdOwned[id] && m_chainBdMems[id].IsValid())
+			m_pClap->FreeMemory(m_chainBdMems[id]);
+
+		m_chainBdMems[id]  = Memory();
+		m_chainBdOwned[id] = false;
+	}
+
 	////////////////////////////////////////
 
 	void setMM2SSrcAddr(const T& addr)
@@ -1616,12 +2448,12 @@ private:
 
 	void setMM2SByteLength(const uint32_t& length)
 	{
-		writeRegister<uint32_t>(MM2S_LENGTH, length);
+		writeRegisterOrdered<uint32_t>(MM2S_LENGTH, length);
 	}
 
 	void setS2MMByteLength(const uint32_t& length)
 	{
-		writeRegister<uint32_t>(S2MM_LENGTH, length);
+		writeRegisterOrdered<uint32_t>(S2MM_LENGTH, length);
 	}
 
 	////////////////////////////////////////
@@ -1695,6 +2527,21 @@ private:
 		return (channel == DMAChannel::MM2S ? 0 : 1);
 	}
 
+	// Restores the default status register and finish callback of the channel's watchdog
+	void resetWatchDog(const DMAChannel& channel)
+	{
+		if (channel == DMAChannel::MM2S)
+		{
+			m_watchDogMM2S.SetStatusRegister(&m_mm2sStatReg);
+			m_watchDogMM2S.SetFinishCallback(std::bind(&AxiDMA::OnMM2SFinished, this));
+		}
+		else
+		{
+			m_watchDogS2MM.SetStatusRegister(&m_s2mmStatReg);
+			m_watchDogS2MM.SetFinishCallback(std::bind(&AxiDMA::OnS2MMFinished, this));
+		}
+	}
+
 	////////////////////////////////////////
 
 	class ControlRegister : public internal::Register<uint32_t>
@@ -1792,27 +2639,19 @@ private:
 		uint8_t m_irqDelay     = 0;
 	};
 
-	class StatusRegister : public internal::Register<uint32_t>, public internal::HasInterrupt, public internal::HasStatus
+	class StatusRegister : public internal::axi_dma_sr::Layout, public internal::HasInterrupt, public internal::HasStatus
 	{
+		using Halted  = internal::axi_dma_sr::Halted;
+		using Idle    = internal::axi_dma_sr::Idle;
+		using SGIncld = internal::axi_dma_sr::SGIncld;
+		using IOCIrq  = internal::axi_dma_sr::IOCIrq;
+		using DlyIrq  = internal::axi_dma_sr::DlyIrq;
+		using ErrIrq  = internal::axi_dma_sr::ErrIrq;
+
 	public:
 		explicit StatusRegister(const std::string& name) :
-			Register(name)
-		{
-			RegisterElement<bool>(&m_halted, "Halted", 0);
-			RegisterElement<bool>(&m_idle, "Idle", 1);
-			RegisterElement<bool>(&m_sgIncld, "SGIncld", 3);
-			RegisterElement<bool>(&m_dmaIntErr, "DMAIntErr", 4);
-			RegisterElement<bool>(&m_dmaSlvErr, "DMASlvErr", 5);
-			RegisterElement<bool>(&m_dmaDecErr, "DMADecErr", 6);
-			RegisterElement<bool>(&m_sgIntErr, "SGIntErr", 8);
-			RegisterElement<bool>(&m_sgSlvErr, "SGSlvErr", 9);
-			RegisterElement<bool>(&m_sgDecErr, "SGDecErr", 10);
-			RegisterElement<bool>(&m_ioCIrq, "IOCIrq", 12);
-			RegisterElement<bool>(&m_dlyIrq, "DlyIrq", 13);
-			RegisterElement<bool>(&m_errIrq, "ErrIrq", 14);
-			RegisterElement<uint8_t>(&m_irqThresholdSts, "IRQThresholdSts", 16, 23);
-			RegisterElement<uint8_t>(&m_irqDelaySts, "IRQDelaySts", 24, 31);
-		}
+			LayoutRegister(name)
+		{}
 
 		void ClearInterrupts() override
 		{
@@ -1824,9 +2663,9 @@ private:
 		{
 			Update();
 			uint32_t intr = 0;
-			intr |= m_ioCIrq << (INTR_ON_COMPLETE >> 1);
-			intr |= m_dlyIrq << (INTR_ON_DELAY >> 1);
-			intr |= m_errIrq << (INTR_ON_ERROR >> 1);
+			intr |= Get<IOCIrq>() << (INTR_ON_COMPLETE >> 1);
+			intr |= Get<DlyIrq>() << (INTR_ON_DELAY >> 1);
+			intr |= Get<ErrIrq>() << (INTR_ON_ERROR >> 1);
 
 			return intr;
 		}
@@ -1834,11 +2673,11 @@ private:
 		void ResetInterrupts(const DMAInterrupts& intr)
 		{
 			if (intr & INTR_ON_COMPLETE)
-				m_ioCIrq = 1;
+				Set<IOCIrq>(1);
 			if (intr & INTR_ON_DELAY)
-				m_dlyIrq = 1;
+				Set<DlyIrq>(1);
 			if (intr & INTR_ON_ERROR)
-				m_errIrq = 1;
+				Set<ErrIrq>(1);
 
 			Update(internal::Direction::WRITE);
 		}
@@ -1846,38 +2685,22 @@ private:
 		bool IsStarted()
 		{
 			Update();
-			return !m_halted;
+			return !IsSet<Halted>();
 		}
 
 		bool IsSGEnabled()
 		{
 			Update();
-			return m_sgIncld;
+			return IsSet<SGIncld>();
 		}
 
 	protected:
 		void getStatus() override
 		{
 			Update();
-			if (!m_done && m_idle)
+			if (!m_done && IsSet<Idle>())
 				m_done = true;
 		}
-
-	private:
-		bool m_halted             = false;
-		bool m_idle               = false;
-		bool m_sgIncld            = false;
-		bool m_dmaIntErr          = false;
-		bool m_dmaSlvErr          = false;
-		bool m_dmaDecErr          = false;
-		bool m_sgIntErr           = false;
-		bool m_sgSlvErr           = false;
-		bool m_sgDecErr           = false;
-		bool m_ioCIrq             = false;
-		bool m_dlyIrq             = false;
-		bool m_errIrq             = false;
-		uint8_t m_irqThresholdSts = 0;
-		uint8_t m_irqDelaySts     = 0;
 	};
 
 	class MM2SControlRegister : public ControlRegister
@@ -1921,6 +2744,14 @@ private:
 
 	BdRing m_bdRingTx = BdRing(DMAChannel::MM2S);
 	BdRing m_bdRingRx = BdRing(DMAChannel::S2MM);
+	bool m_hostBdRing = false;
+
+	std::array<SGStream, 2> m_sgStreams = { { SGStream(this, DMAChannel::MM2S), SGStream(this, DMAChannel::S2MM) } };
+
+	std::array<IrqCoalescing, 2> m_coalescing = {};
+	std::array<ChunkResults, 2> m_sgCompleted = {};
+	std::array<SGTransfer, 2> m_sgTransfers   = {};
+	std::mutex m_sgDoneMtx                    = {};
 
 	MM2SControlRegister m_mm2sCtrlReg = MM2SControlRegister();
 	MM2SStatusRegister m_mm2sStatReg  = MM2SStatusRegister();
@@ -1946,6 +2777,13 @@ private:
 
 	ChunkResults m_s2mmChunkResults = {};
 
+	std::array<ChunkProgress, 2> m_chunkProgress = {};
+
+	// Simple mode transfers executed using the BD ring of the channel
+	std::array<bool, 2> m_chained       = { false, false };
+	std::array<Memory, 2> m_chainBdMems = {};
+	std::array<bool, 2> m_chainBdOwned  = { false, false };
+
 	bool m_mm2sPresent = false;
 	bool m_s2mmPresent = false;
 
@@ -27,6 +27,7 @@
 #pragma once
 
 #include "../internal/RegisterControl.hpp"
+#include "../internal/SPSCRing.hpp"
 #include "internal/WatchDog.hpp"
 
 #include "AxiInterruptController.hpp"
@@ -34,9 +35,14 @@
 #include <array>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <map>
 #include <vector>
 
+#ifndef EMBEDDED_XILINX
+#include <chrono>
+#endif
+
 // TODO: Implement non-interrupt status check
 
 #define AXI_GPIO_INVALID_CHANNEL_EXCEPTION                             \
@@ -93,6 +99,17 @@ public:
 
 	using IntrCallback = std::function<void(const Channel&, const uint32_t&, const bool&)>;
 
+	// Change of a channel recorded in capture mode, the timestamp is taken from the steady clock when the interrupt is handled (0 on bare-metal)
+	struct CaptureRecord
+	{
+		uint64_t timestampNS = 0;
+		Channel channel      = CHANNEL_1;
+		uint32_t oldValue    = 0;
+		uint32_t newValue    = 0;
+	};
+
+	static inline const std::size_t DEFAULT_CAPTURE_CAPACITY = 4096;
+
 private:
 	DISABLE_COPY_ASSIGN_MOVE(AxiGPIO)
 
@@ -115,8 +132,9 @@ public:
 
 	AxiGPIO(const CLAPPtr& pClap, const uint64_t& ctrlOffset, const DualChannel& dualChannel = DualChannel::No, const ResetOnInit& resetOnInit = ResetOnInit::Yes, const std::string& name = "") :
 		RegisterControlBase(pClap, ctrlOffset, name),
-		m_watchDog("AxiGPIO", pClap->MakeUserInterrupt()),
-		m_isDualChannel((dualChannel == DualChannel::Yes))
+		m_watchDog("AxiGPIO", pClap->MakeUserInterrupt(), pClap->GetCompletionReactor()),
+		m_isDualChannel((dualChannel == DualChannel::Yes)),
+		m_captureRing()
 	{
 		registerReg<uint32_t>(m_gpio1Data, ADDR_GPIO_DATA);
 		registerReg<uint32_t>(m_gpio1Tri, ADDR_GPIO_TRI);
@@ -224,6 +242,62 @@ public:
 		m_callbacks.push_back(callback);
 	}
 
+	/// @brief Enables the capture mode, in which interrupts record the changed channels into a preallocated ring instead of running the registered callbacks
+	/// @param capacity Number of records the ring can hold, rounded up to a power of two, records arriving while the ring is full are dropped
+	void EnableCapture(const std::size_t& capacity = DEFAULT_CAPTURE_CAPACITY)
+	{
+		if (m_running)
+			BUILD_IP_EXCEPTION(CLAPException, "Capture mode of GPIO at: 0x" << std::hex << m_ctrlOffset << " can only be changed while the GPIO is stopped");
+
+		if (capacity == 0)
+			BUILD_IP_EXCEPTION(CLAPException, "Capture capacity has to be greater than zero");
+
+		m_captureRing.Reset(capacity);
+		m_captureValues  = readChannels();
+		m_captureEnabled = true;
+	}
+
+	/// @brief Disables the capture mode and discards all records that have not been drained yet
+	void DisableCapture()
+	{
+		if (m_running)
+			BUILD_IP_EXCEPTION(CLAPException, "Capture mode of GPIO at: 0x" << std::hex << m_ctrlOffset << " can only be changed while the GPIO is stopped");
+
+		m_captureEnabled = false;
+		m_captureRing.Reset(0);
+
+		// The callback path diffs against the cached register values, which were not updated while capturing
+		m_gpio1Data.Update(internal::Direction::READ);
+		if (m_isDualChannel)
+			m_gpio2Data.Update(internal::Direction::READ);
+	}
+
+	bool IsCaptureEnabled() const
+	{
+		return m_captureEnabled;
+	}
+
+	/// @brief Moves the oldest captured records to the end of the given vector, must only be called by a single consumer thread at a time
+	/// @param records Vector the records are appended to
+	/// @param maxRecords Maximum number of records to drain
+	/// @return Number of drained records
+	std::size_t DrainCapture(std::vector<CaptureRecord>& records, const std::size_t& maxRecords = std::numeric_limits<std::size_t>::max())
+	{
+		return m_captureRing.Pop(records, maxRecords);
+	}
+
+	/// @brief Returns the number of records currently waiting to be drained
+	std::size_t GetCaptureBacklog() const
+	{
+		return m_captureRing.Size();
+	}
+
+	/// @brief Returns the number of records dropped because the ring was full since capture mode was enabled
+	uint64_t GetCaptureDrops() const
+	{
+		return m_captureRing.Drops();
+	}
+
 	bool OnFinished()
 	{
 		if (m_running)
@@ -322,6 +396,12 @@ public:
 
 	void InterruptTriggered([[maybe_unused]] const uint32_t& mask)
 	{
+		if (m_captureEnabled)
+		{
+			captureChanges();
+			return;
+		}
+
 		if (mask & INTR_ON_CH1)
 			runCallbacks(CHANNEL_1);
 		if (mask & INTR_ON_CH2 && m_isDualChannel)
@@ -329,6 +409,41 @@ public:
 	}
 
 private:
+	void captureChanges()
+	{
+		// Both channels are sampled in one pass, independent of which one raised the interrupt,
+		// and compared against the last captured values instead of the per-bit register caches
+		const std::array<uint32_t, 2> values = readChannels();
+		const uint64_t timestampNS           = captureTimestamp();
+
+		for (std::size_t i = 0; i < values.size(); i++)
+		{
+			if (values[i] != m_captureValues[i])
+				m_captureRing.Push({ timestampNS, static_cast<Channel>(i), m_captureValues[i], values[i] });
+		}
+
+		m_captureValues = values;
+	}
+
+	std::array<uint32_t, 2> readChannels()
+	{
+		std::array<uint32_t, 2> values = { readRegister<uint32_t>(ADDR_GPIO_DATA), 0 };
+
+		if (m_isDualChannel)
+			values[1] = readRegister<uint32_t>(ADDR_GPIO2_DATA);
+
+		return values;
+	}
+
+	static uint64_t captureTimestamp()
+	{
+#ifndef EMBEDDED_XILINX
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#else
+		return 0;
+#endif
+	}
+
 	void runCallbacks(const Channel& channel)
 	{
 		Bit32Arr changes = getGPIOChanges(channel);
@@ -577,5 +692,9 @@ private:
 	std::array<uint32_t, 2> m_gpioWidth         = { 32, 32 };
 	std::array<uint32_t, 2> m_triDefaultValues  = { 0xFFFFFFFF, 0xFFFFFFFF };
 	std::array<uint32_t, 2> m_dataDefaultValues = { 0x0, 0x0 };
+
+	bool m_captureEnabled                   = false;
+	std::array<uint32_t, 2> m_captureValues = { 0x0, 0x0 };
+	internal::SPSCRing<CaptureRecord> m_captureRing;
 };
 } // namespace clap
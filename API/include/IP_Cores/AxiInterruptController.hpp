@@ -31,11 +31,13 @@
 #include "internal/WatchDog.hpp"
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <functional>
-#include <map>
 #include <mutex>
+#include <ostream>
 #include <vector>
 
 // TODO: Maybe also implement polling for interrupts
@@ -44,11 +46,118 @@ namespace clap
 {
 class AxiInterruptController;
 
+static constexpr uint32_t AXI_INTC_MAX_SOURCES = 32;
+
+// Latencies of a single interrupt source of the AxiInterruptController.
+// The dispatch latency is the time between reading the ISR and the source being handled, i.e., its status
+// register cleared, inline callbacks executed and waiters notified. The wakeup latency is the time between
+// the notification and a waiter (or the completion reactor) consuming the interrupt.
+struct InterruptSourceStats
+{
+	uint64_t interrupts    = 0;
+	uint64_t wakeups       = 0;
+	double totalDispatchUS = 0.0;
+	double maxDispatchUS   = 0.0;
+	double totalWakeupUS   = 0.0;
+	double maxWakeupUS     = 0.0;
+
+	double GetAvgDispatchUS() const
+	{
+		return (interrupts == 0 ? 0.0 : totalDispatchUS / static_cast<double>(interrupts));
+	}
+
+	double GetAvgWakeupUS() const
+	{
+		return (wakeups == 0 ? 0.0 : totalWakeupUS / static_cast<double>(wakeups));
+	}
+
+	friend std::ostream& operator<<(std::ostream& stream, const InterruptSourceStats& stats)
+	{
+		stream << "Interrupts: " << stats.interrupts << ", Wakeups: " << stats.wakeups
+			   << ", Dispatch (avg/max): " << stats.GetAvgDispatchUS() << "/" << stats.maxDispatchUS << " us"
+			   << ", Wakeup (avg/max): " << stats.GetAvgWakeupUS() << "/" << stats.maxWakeupUS << " us";
+		return stream;
+	}
+};
+
 namespace internal
 {
-using AxiIntrCtrlCallback    = std::function<void(void)>;
-using AxiIntrCtrlCallbacks   = std::vector<AxiIntrCtrlCallback>;
-using AxiIntrCtrlCallbackMap = std::map<uint32_t, AxiIntrCtrlCallback>;
+using AxiIntrCtrlCallback  = std::function<void(void)>;
+using AxiIntrCtrlCallbacks = std::vector<AxiIntrCtrlCallback>;
+
+#ifndef EMBEDDED_XILINX
+// Lock-free counters of a single interrupt source, updated on the dispatch path without blocking it
+class InterruptSourceRecorder
+{
+	DISABLE_COPY_ASSIGN_MOVE(InterruptSourceRecorder)
+
+public:
+	InterruptSourceRecorder() {}
+
+	static int64_t Now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void RecordDispatch(const int64_t& startNS, const int64_t& endNS)
+	{
+		record(m_interrupts, m_totalDispatchNS, m_maxDispatchNS, endNS - startNS);
+	}
+
+	void RecordWakeup(const int64_t& triggerNS, const int64_t& consumeNS)
+	{
+		record(m_wakeups, m_totalWakeupNS, m_maxWakeupNS, consumeNS - triggerNS);
+	}
+
+	InterruptSourceStats Get() const
+	{
+		InterruptSourceStats stats;
+		stats.interrupts      = m_interrupts.load(std::memory_order_relaxed);
+		stats.wakeups         = m_wakeups.load(std::memory_order_relaxed);
+		stats.totalDispatchUS = toUS(m_totalDispatchNS);
+		stats.maxDispatchUS   = toUS(m_maxDispatchNS);
+		stats.totalWakeupUS   = toUS(m_totalWakeupNS);
+		stats.maxWakeupUS     = toUS(m_maxWakeupNS);
+		return stats;
+	}
+
+	void Reset()
+	{
+		m_interrupts.store(0, std::memory_order_relaxed);
+		m_wakeups.store(0, std::memory_order_relaxed);
+		m_totalDispatchNS.store(0, std::memory_order_relaxed);
+		m_maxDispatchNS.store(0, std::memory_order_relaxed);
+		m_totalWakeupNS.store(0, std::memory_order_relaxed);
+		m_maxWakeupNS.store(0, std::memory_order_relaxed);
+	}
+
+private:
+	static void record(std::atomic<uint64_t>& count, std::atomic<uint64_t>& total, std::atomic<uint64_t>& max, const int64_t& deltaNS)
+	{
+		const uint64_t ns = static_cast<uint64_t>(deltaNS < 0 ? 0 : deltaNS);
+		uint64_t curMax   = max.load(std::memory_order_relaxed);
+
+		count.fetch_add(1, std::memory_order_relaxed);
+		total.fetch_add(ns, std::memory_order_relaxed);
+
+		while (ns > curMax && !max.compare_exchange_weak(curMax, ns, std::memory_order_relaxed))
+			;
+	}
+
+	static double toUS(const std::atomic<uint64_t>& ns)
+	{
+		return static_cast<double>(ns.load(std::memory_order_relaxed)) / 1000.0;
+	}
+
+private:
+	std::atomic<uint64_t> m_interrupts      = { 0 };
+	std::atomic<uint64_t> m_wakeups         = { 0 };
+	std::atomic<uint64_t> m_totalDispatchNS = { 0 };
+	std::atomic<uint64_t> m_maxDispatchNS   = { 0 };
+	std::atomic<uint64_t> m_totalWakeupNS   = { 0 };
+	std::atomic<uint64_t> m_maxWakeupNS     = { 0 };
+};
+#endif
 
 class AxiIntrCtrlUserInterrupt : virtual public UserInterruptBase
 {
@@ -68,78 +177,92 @@ public:
 
 	bool WaitForInterrupt([[maybe_unused]] const int32_t& timeout = WAIT_INFINITE, [[maybe_unused]] const bool& runCallbacks = true) override
 	{
-		if (!m_interruptOccured && !waitForInterrupt(timeout))
+		if (!consumeInterrupt() && !waitForInterrupt(timeout))
 			return false;
 
-		m_interruptOccured = false;
+#ifndef EMBEDDED_XILINX
+		if (m_pRecorder)
+			m_pRecorder->RecordWakeup(m_triggerNS.load(std::memory_order_relaxed), InterruptSourceRecorder::Now());
+#endif
 
 		uint32_t lastIntr = UNSET_INTR_MASK;
 		if (m_pReg)
 			lastIntr = m_pReg->GetLastInterrupt();
 
-		if (runCallbacks)
-		{
-			for (const auto& callback : m_callbacks)
-				callback(lastIntr);
-		}
+		// Callbacks executed inline by the controller are not repeated
+		if (runCallbacks && !m_ranInline.load(std::memory_order_relaxed))
+			runIntrCallbacks(lastIntr);
 
 		CLAP_CLASS_LOG_DEBUG << "Interrupt present on " << m_devName << ", Interrupt Mask: " << (m_pReg ? std::to_string(lastIntr) : "No Status Register Specified") << std::endl;
 
 		return true;
 	}
 
-	void TriggerInterrupt()
+	// Called by the controller for every ISR bit of this interrupt, defined below AxiInterruptController
+	void TriggerInterrupt();
+
+private:
+	void runIntrCallbacks(const uint32_t& lastIntr)
 	{
-		if (m_pReg)
-			m_pReg->ClearInterrupts();
+		for (const auto& callback : m_callbacks)
+			callback(lastIntr);
+	}
 
-		m_interruptOccured = true;
-#ifndef EMBEDDED_XILINX
-		m_cv.notify_all();
-#else
-		if (m_instantForward)
-			WaitForInterrupt();
-#endif
-		CLAP_CLASS_LOG_DEBUG << "Interrupt triggered on " << m_devName << std::endl;
+	bool consumeInterrupt()
+	{
+		// Cheap check first to not dirty the cache line while no interrupt is pending
+		return m_interruptOccured.load(std::memory_order_acquire) && m_interruptOccured.exchange(false, std::memory_order_acq_rel);
 	}
 
-private:
 	bool waitForInterrupt([[maybe_unused]] const int32_t& timeout = WAIT_INFINITE)
 	{
+		if (timeout == 0) return false;
+
 		// The interruptOccured flag is used to make sure that the interrupt has not already occured
 #ifdef EMBEDDED_XILINX
 		const uint64_t timeoutTicks = static_cast<uint64_t>(timeout) * 1000;
 
 		if (timeout == WAIT_INFINITE)
 		{
-			while (!m_interruptOccured)
+			while (!consumeInterrupt())
 				utils::SleepUS(1);
 		}
 		else
 		{
 			uint64_t ticks = 0;
-			while (!m_interruptOccured && ticks < timeoutTicks)
+			while (!consumeInterrupt())
 			{
+				if (ticks >= timeoutTicks)
+					return false;
+
 				utils::SleepUS(1);
 				ticks++;
 			}
-
-			if (ticks >= timeoutTicks)
-				return false;
 		}
 #else
-		std::unique_lock<std::mutex> lck(m_mtx);
+		// Registering as waiter before checking the flag guarantees that the trigger either sees the
+		// waiter and notifies it or the waiter sees the flag, the trigger only locks if someone waits
+		m_waiters.fetch_add(1, std::memory_order_seq_cst);
+
+		bool interrupted = false;
 
-		if (!m_interruptOccured)
 		{
+			std::unique_lock<std::mutex> lck(m_mtx);
+			const auto hasInterrupt = [this] { return consumeInterrupt(); };
+
 			if (timeout == WAIT_INFINITE)
-				m_cv.wait(lck);
-			else
 			{
-				if (m_cv.wait_for(lck, std::chrono::milliseconds(timeout)) == std::cv_status::timeout)
-					return false;
+				m_cv.wait(lck, hasInterrupt);
+				interrupted = true;
 			}
+			else
+				interrupted = m_cv.wait_for(lck, std::chrono::milliseconds(timeout), hasInterrupt);
 		}
+
+		m_waiters.fetch_sub(1, std::memory_order_seq_cst);
+
+		if (!interrupted)
+			return false;
 #endif
 
 		return true;
@@ -148,10 +271,14 @@ private:
 private:
 	AxiInterruptController* m_pAxiIntC;
 #ifndef EMBEDDED_XILINX
-	std::condition_variable m_cv = {};
-	std::mutex m_mtx             = {};
+	std::condition_variable m_cv         = {};
+	std::mutex m_mtx                     = {};
+	std::atomic<uint32_t> m_waiters      = { 0 };
+	std::atomic<int64_t> m_triggerNS     = { 0 };
+	InterruptSourceRecorder* m_pRecorder = nullptr;
 #endif
-	bool m_interruptOccured = false;
+	std::atomic<bool> m_interruptOccured = { false };
+	std::atomic<bool> m_ranInline        = { false };
 };
 } // namespace internal
 
@@ -177,7 +304,7 @@ class AxiInterruptController : public internal::RegisterControlBase
 public:
 	AxiInterruptController(const CLAPPtr& pClap, const uint64_t& ctrlOffset, const std::string& name = "") :
 		RegisterControlBase(pClap, ctrlOffset, name),
-		m_watchDog("AxiInterruptController", pClap->MakeUserInterrupt()),
+		m_watchDog("AxiInterruptController", pClap->MakeUserInterrupt(), pClap->GetCompletionReactor()),
 		m_mutex()
 	{
 		registerReg<uint32_t>(m_intrStatusReg, ADDR_ISR);
@@ -265,35 +392,85 @@ public:
 		m_intrEnReg.SetBitAt(interruptNum, enable);
 	}
 
+	/// @brief Executes the interrupt callbacks of child interrupts directly on the thread handling the controller's interrupt
+	///        instead of the thread waiting for the child interrupt, saving a wakeup per interrupt. Waiting for the
+	///        child interrupt (e.g., by the core's watchdog) is not affected. Inline callbacks delay all other sources
+	///        handled by the controller and should therefore be short.
+	/// @param enable Whether callbacks are executed inline
+	void SetInlineCallbacks(const bool& enable)
+	{
+		m_inlineCallbacks.store(enable, std::memory_order_relaxed);
+	}
+
+	bool GetInlineCallbacks() const
+	{
+		return m_inlineCallbacks.load(std::memory_order_relaxed);
+	}
+
+	/// @brief Returns the dispatch and wakeup latencies of the given interrupt source, empty on bare-metal
+	InterruptSourceStats GetSourceStats(const uint32_t& interruptNum) const
+	{
+		if (interruptNum >= AXI_INTC_MAX_SOURCES)
+			throw std::runtime_error("Interrupt number out of range");
+
+#ifndef EMBEDDED_XILINX
+		return m_sourceStats[interruptNum].Get();
+#else
+		return InterruptSourceStats();
+#endif
+	}
+
+	void ResetSourceStats()
+	{
+#ifndef EMBEDDED_XILINX
+		for (internal::InterruptSourceRecorder& recorder : m_sourceStats)
+			recorder.Reset();
+#endif
+	}
+
 	void CoreInterruptTriggered([[maybe_unused]] const uint32_t& mask)
 	{
 		std::lock_guard<std::mutex> lock(m_mutex);
 
-		uint32_t intrs = m_intrStatusReg.GetInterrupts();
+		// All sources are handled with a single ISR read and acknowledged with a single IAR write
+		const uint32_t intrs = readRegister<uint32_t>(ADDR_ISR);
+
+#ifndef EMBEDDED_XILINX
+		const int64_t startNS = internal::InterruptSourceRecorder::Now();
+#endif
 
 		CLAP_IP_CORE_LOG_DEBUG << "CoreInterruptTriggered: " << std::hex << intrs << std::endl;
 
 		try
 		{
-			uint32_t idx = 0;
-			while (intrs > 0)
+			uint32_t pending = intrs;
+			uint32_t idx     = 0;
+
+			while (pending > 0)
 			{
-				if (intrs & 1)
+				if (pending & 1)
 				{
-					if (m_intrCallbacks.count(idx))
+					if (m_intrCallbacks[idx])
+					{
 						m_intrCallbacks[idx]();
-
-					m_intrAckReg.AcknowledgeInterrupt(idx);
+#ifndef EMBEDDED_XILINX
+						m_sourceStats[idx].RecordDispatch(startNS, internal::InterruptSourceRecorder::Now());
+#endif
+					}
 				}
 
 				idx++;
-				intrs >>= 1;
+				pending >>= 1;
 			}
 		}
 		catch (const std::exception& e)
 		{
 			std::cerr << e.what() << std::endl;
 		}
+
+		// The sources have been cleared by their callbacks, acknowledging them earlier would retrigger level interrupts
+		if (intrs != 0)
+			writeRegister<uint32_t>(ADDR_IAR, intrs);
 	}
 
 	internal::UserInterruptPtr MakeUserInterrupt()
@@ -323,8 +500,10 @@ private:
 
 	void registerIntrCallback(const uint32_t& interruptNum, internal::AxiIntrCtrlCallback callback)
 	{
-		m_intrCallbacks[interruptNum] = callback;
 		EnableInterrupt(interruptNum);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_intrCallbacks[interruptNum] = callback;
 	}
 
 	class InterruptAcknowledgeRegister : public internal::Bit32Register
@@ -423,9 +602,14 @@ private:
 
 private:
 	internal::WatchDog m_watchDog;
-	internal::AxiIntrCtrlCallbackMap m_intrCallbacks = {};
+	// Indexed by the interrupt number to avoid a lookup per source on the dispatch path
+	std::array<internal::AxiIntrCtrlCallback, AXI_INTC_MAX_SOURCES> m_intrCallbacks = {};
 	std::mutex m_mutex;
-	bool m_running = false;
+	bool m_running                      = false;
+	std::atomic<bool> m_inlineCallbacks = { false };
+#ifndef EMBEDDED_XILINX
+	std::array<internal::InterruptSourceRecorder, AXI_INTC_MAX_SOURCES> m_sourceStats = {};
+#endif
 
 	InterruptStatusRegister m_intrStatusReg   = InterruptStatusRegister();
 	internal::Bit32Register m_intrPendingReg  = internal::Bit32Register("Interrupt Pending Register");
@@ -443,11 +627,49 @@ namespace internal
 {
 inline void AxiIntrCtrlUserInterrupt::Init([[maybe_unused]] const uint32_t& devNum, [[maybe_unused]] const uint32_t& interruptNum, [[maybe_unused]] HasInterrupt* pReg)
 {
-	m_pReg    = pReg;
-	m_devName = "AxiIntrCtrl Intr#" + std::to_string(interruptNum);
+	m_pReg         = pReg;
+	m_interruptNum = interruptNum;
+	m_devName      = "AxiIntrCtrl Intr#" + std::to_string(interruptNum);
+#ifndef EMBEDDED_XILINX
+	// EnableInterrupt, called by registerIntrCallback, validates the interrupt number
+	m_pRecorder = (interruptNum < AXI_INTC_MAX_SOURCES ? &m_pAxiIntC->m_sourceStats[interruptNum] : nullptr);
+#endif
 	m_pAxiIntC->registerIntrCallback(interruptNum, std::bind(&AxiIntrCtrlUserInterrupt::TriggerInterrupt, this));
 }
 
+inline void AxiIntrCtrlUserInterrupt::TriggerInterrupt()
+{
+	if (m_pReg)
+		m_pReg->ClearInterrupts();
+
+	const bool runInline = m_pAxiIntC->GetInlineCallbacks();
+
+	if (runInline)
+		runIntrCallbacks(m_pReg ? m_pReg->GetLastInterrupt() : UNSET_INTR_MASK);
+
+	m_ranInline.store(runInline, std::memory_order_relaxed);
+
+#ifndef EMBEDDED_XILINX
+	m_triggerNS.store(InterruptSourceRecorder::Now(), std::memory_order_relaxed);
+	m_interruptOccured.store(true, std::memory_order_seq_cst);
+
+	// Blocked waiters are rare (the reactor is woken by the trigger notifier), only then the mutex is taken
+	if (m_waiters.load(std::memory_order_seq_cst) > 0)
+	{
+		std::lock_guard<std::mutex> lck(m_mtx);
+		m_cv.notify_all();
+	}
+
+	notifyTrigger();
+#else
+	m_interruptOccured.store(true, std::memory_order_release);
+
+	if (m_instantForward)
+		WaitForInterrupt();
+#endif
+	CLAP_CLASS_LOG_DEBUG << "Interrupt triggered on " << m_devName << std::endl;
+}
+
 } // namespace internal
 
 } // namespace clap
\ No newline at end of file
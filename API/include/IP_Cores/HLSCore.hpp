@@ -34,6 +34,14 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
+
+#ifndef EMBEDDED_XILINX
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#endif
 
 namespace clap
 {
@@ -85,13 +93,67 @@ public:
 		BIT_64 = sizeof(uint64_t)
 	};
 
+	// Argument set of a single run, used with the job queue (Enqueue)
+	class Job
+	{
+		friend class HLSCore;
+
+	public:
+		template<typename T>
+		Job& SetArg(const uint64_t& offset, const T& value)
+		{
+			static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8, "Only 8, 16, 32 and 64-bit arguments are supported");
+
+			m_args.push_back({ offset, static_cast<uint64_t>(value), static_cast<uint32_t>(sizeof(T)) });
+			return *this;
+		}
+
+		template<typename T>
+		Job& SetDataAddr(const uint64_t& offset, const T& addr)
+		{
+			return SetArg<T>(offset, addr);
+		}
+
+		Job& SetDataAddr(const uint64_t& offset, const Memory& mem, const AddressType& addrType = AddressType::BIT_64)
+		{
+			if (addrType == AddressType::BIT_32)
+				return SetArg<uint32_t>(offset, static_cast<uint32_t>(mem.GetBaseAddr()));
+
+			return SetArg<uint64_t>(offset, mem.GetBaseAddr());
+		}
+
+		// Binds bank i of the striped memory to the address argument at offsets[i], e.g., one per AXI port
+		Job& SetDataAddr(const std::vector<uint64_t>& offsets, const StripedMemory& mem, const AddressType& addrType = AddressType::BIT_64)
+		{
+			checkBankOffsets(offsets, mem);
+
+			for (std::size_t i = 0; i < offsets.size(); i++)
+				SetDataAddr(offsets[i], mem.GetBank(i), addrType);
+
+			return *this;
+		}
+
+	private:
+		struct Arg
+		{
+			uint64_t offset = 0;
+			uint64_t value  = 0;
+			uint32_t size   = 0;
+		};
+
+		std::vector<Arg> m_args = {};
+	};
+
 public:
 	HLSCore(const CLAPPtr& pClap, const uint64_t& ctrlOffset, const std::string& name = "") :
 		RegisterControlBase(pClap, ctrlOffset, name),
 		m_apCtrl(),
 		m_intrCtrl(),
 		m_intrStat(),
-		m_watchDog(name, pClap->MakeUserInterrupt())
+#ifndef EMBEDDED_XILINX
+		m_queueMonitor([this]() { return processJobQueue(); }),
+#endif
+		m_watchDog(name, pClap->MakeUserInterrupt(), pClap->GetCompletionReactor())
 	{
 		registerReg<uint8_t>(m_apCtrl, ADDR_AP_CTRL);
 		registerReg<uint8_t>(m_intrCtrl, ADDR_IER);
@@ -104,6 +166,9 @@ public:
 
 	bool Start()
 	{
+		m_watchDog.SetStatusRegister(&m_apCtrl);
+		m_watchDog.SetFinishCallback(nullptr);
+
 		if (!m_watchDog.Start())
 		{
 			CLAP_IP_CORE_LOG_ERROR << "Tried to start HLS core at: 0x" << std::hex << m_ctrlOffset << " which is still running, stopping startup ..." << std::endl;
@@ -124,6 +189,10 @@ public:
 	{
 		m_watchDog.Stop();
 		m_apCtrl.Reset();
+
+#ifndef EMBEDDED_XILINX
+		failJobQueue(std::make_exception_ptr(CLAPException("HLS core \"" + m_name + "\" was stopped before the job finished")));
+#endif
 	}
 
 	void Reset()
@@ -143,6 +212,73 @@ public:
 		return m_watchDog.GetRuntime();
 	}
 
+#ifndef EMBEDDED_XILINX
+	/// @brief Queues a run of the core with the given arguments
+	///        The arguments of the next job are written and the core is started again as soon as it asserts ap_ready,
+	///        i.e., while the previous job might still be running. For short jobs use a spinning poll strategy or enable
+	///        the ap_ready interrupt, otherwise the poll interval limits the throughput. WaitForFinish waits for all queued jobs.
+	/// @param job The arguments of the run
+	/// @return Future that becomes ready once the core reported ap_done for the job
+	std::future<void> Enqueue(const Job& job)
+	{
+		std::future<void> future;
+		bool startQueue = false;
+
+		{
+			std::lock_guard<std::mutex> lock(m_queueMtx);
+			m_pendingJobs.push_back({ job, std::promise<void>() });
+			future = m_pendingJobs.back().promise.get_future();
+
+			if (!m_queueActive)
+			{
+				m_queueActive = true;
+				startQueue    = true;
+			}
+		}
+
+		if (startQueue)
+		{
+			// A previous run of the queue or a regular start might still be finishing
+			m_watchDog.WaitForFinish();
+			m_watchDog.SetStatusRegister(&m_queueMonitor);
+			m_watchDog.SetFinishCallback([this]() { return processJobQueue(); });
+
+			if (!m_watchDog.Start(true))
+			{
+				failJobQueue(std::make_exception_ptr(CLAPException("Failed to start the job queue of HLS core \"" + m_name + "\"")));
+				return future;
+			}
+		}
+
+		// Launch right away if the core is ready instead of waiting for the next poll
+		processJobQueue();
+
+		return future;
+	}
+
+	/// @brief Returns the number of jobs that are queued or running
+	std::size_t GetQueuedJobs()
+	{
+		std::lock_guard<std::mutex> lock(m_queueMtx);
+		return m_pendingJobs.size() + m_runningJobs.size();
+	}
+#endif
+
+	void SetPollStrategy(const PollStrategy& strategy)
+	{
+		m_watchDog.SetPollStrategy(strategy);
+	}
+
+	CompletionStats GetCompletionStats() const
+	{
+		return m_watchDog.GetCompletionStats();
+	}
+
+	void ResetCompletionStats()
+	{
+		m_watchDog.ResetCompletionStats();
+	}
+
 	////////////////////////////////////////
 
 	////////////////////////////////////////
@@ -197,6 +333,15 @@ public:
 			setDataAddr<uint64_t>(offset, mem.GetBaseAddr());
 	}
 
+	// Binds bank i of the striped memory to the address argument at offsets[i], e.g., one per AXI port
+	void SetDataAddr(const std::vector<uint64_t>& offsets, const StripedMemory& mem, const AddressType& addrType = AddressType::BIT_64)
+	{
+		checkBankOffsets(offsets, mem);
+
+		for (std::size_t i = 0; i < offsets.size(); i++)
+			SetDataAddr(offsets[i], mem.GetBank(i), addrType);
+	}
+
 	template<typename T>
 	T GetDataAddr(const uint64_t& offset)
 	{
@@ -253,6 +398,115 @@ public:
 	////////////////////////////////////////
 
 private:
+	static void checkBankOffsets(const std::vector<uint64_t>& offsets, const StripedMemory& mem)
+	{
+		if (offsets.size() != mem.GetBankCount())
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG("HLSCore") << "Number of address offsets (" << offsets.size() << ") does not match the number of banks of the striped memory (" << mem.GetBankCount() << ")";
+			throw CLAPException(ss.str());
+		}
+	}
+
+#ifndef EMBEDDED_XILINX
+	// Completes finished jobs and launches the next one if the core accepts new arguments,
+	// returns true once the queue is drained
+	bool processJobQueue()
+	{
+		std::lock_guard<std::mutex> lock(m_queueMtx);
+
+		if (!m_queueActive) return true;
+
+		try
+		{
+			const internal::ApCtrl::Handshake hs = m_apCtrl.Sample();
+
+			if (hs.done && !m_runningJobs.empty())
+			{
+				m_runningJobs.front().set_value();
+				m_runningJobs.pop_front();
+			}
+
+			// ap_done is clear on read, therefore, multiple completions between two samples are only visible as an idle core
+			if (hs.idle && !hs.startPending)
+			{
+				for (std::promise<void>& promise : m_runningJobs)
+					promise.set_value();
+
+				m_runningJobs.clear();
+			}
+
+			// ap_start is cleared by the handshake (ap_ready), afterwards the arguments can be replaced
+			if (!hs.startPending && !m_pendingJobs.empty())
+			{
+				launchJob(m_pendingJobs.front().job);
+				m_runningJobs.push_back(std::move(m_pendingJobs.front().promise));
+				m_pendingJobs.pop_front();
+			}
+		}
+		catch (...)
+		{
+			failJobs(std::current_exception());
+			return true;
+		}
+
+		if (m_pendingJobs.empty() && m_runningJobs.empty())
+			m_queueActive = false;
+
+		return !m_queueActive;
+	}
+
+	void launchJob(const Job& job)
+	{
+		// Unchanged arguments are skipped, ap_start is written last
+		internal::RegisterTransaction tx(*this);
+
+		for (const Job::Arg& arg : job.m_args)
+		{
+			// Arguments are only written by the host
+			registerCacheable(arg.offset);
+
+			switch (arg.size)
+			{
+				case 1:
+					writeRegister<uint8_t>(arg.offset, static_cast<uint8_t>(arg.value));
+					break;
+				case 2:
+					writeRegister<uint16_t>(arg.offset, static_cast<uint16_t>(arg.value));
+					break;
+				case 4:
+					writeRegister<uint32_t>(arg.offset, static_cast<uint32_t>(arg.value));
+					break;
+				default:
+					writeRegister<uint64_t>(arg.offset, arg.value);
+					break;
+			}
+		}
+
+		writeRegisterOrdered<uint8_t>(ADDR_AP_CTRL, m_apCtrl.PrepareStart());
+		tx.Commit();
+	}
+
+	void failJobQueue(const std::exception_ptr& pExcept)
+	{
+		std::lock_guard<std::mutex> lock(m_queueMtx);
+		failJobs(pExcept);
+	}
+
+	void failJobs(const std::exception_ptr& pExcept)
+	{
+		for (std::promise<void>& promise : m_runningJobs)
+			promise.set_exception(pExcept);
+
+		for (QueuedJob& queued : m_pendingJobs)
+			queued.promise.set_exception(pExcept);
+
+		m_runningJobs.clear();
+		m_pendingJobs.clear();
+		m_queueActive = false;
+	}
+#endif
+
 	template<typename T>
 	void setDataAddr(const uint64_t& offset, const T addr)
 	{
@@ -396,6 +650,22 @@ private:
 	internal::ApCtrl m_apCtrl;
 	InterruptEnableRegister m_intrCtrl;
 	InterruptStatusRegister m_intrStat;
+
+#ifndef EMBEDDED_XILINX
+	struct QueuedJob
+	{
+		Job job                    = {};
+		std::promise<void> promise = {};
+	};
+
+	internal::CallbackStatus m_queueMonitor;
+	std::deque<QueuedJob> m_pendingJobs          = {};
+	std::deque<std::promise<void>> m_runningJobs = {};
+	std::mutex m_queueMtx                        = {};
+	bool m_queueActive                           = false;
+#endif
+
+	// Declared last, so that it is destroyed first and the reactor no longer accesses the job queue
 	internal::WatchDog m_watchDog;
 };
 } // namespace clap
\ No newline at end of file
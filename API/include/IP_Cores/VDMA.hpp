@@ -31,10 +31,18 @@
 
 #include "AxiInterruptController.hpp"
 
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <vector>
 
 namespace clap
 {
+static constexpr uint32_t VDMA_MAX_FRAME_STORES = 32;
+// Size of the start address register bank of a channel, frame stores beyond it are selected through the REG_INDEX register
+static constexpr uint32_t VDMA_START_ADDRESS_BANK_SIZE = 0x40;
+
 // The template defines the address width of the VDMA
 // required to read and write input/output addresses
 template<typename T>
@@ -47,12 +55,14 @@ class VDMA : public internal::RegisterControlBase
 		MM2S_VDMACR          = 0x00,
 		MM2S_VDMASR          = 0x04,
 		MM2S_REG_INDEX       = 0x14,
+		MM2S_FRMSTORE        = 0x18,
 		PARK_PTR_REG         = 0x28,
 		VDMA_VERSION         = 0x2C,
 		S2MM_VDMACR          = 0x30,
 		S2MM_VDMASR          = 0x34,
 		S2MM_VDMA_IRQ_MASK   = 0x3C,
 		S2MM_REG_INDEX       = 0x44,
+		S2MM_FRMSTORE        = 0x48,
 		MM2S_VSIZE           = 0x50,
 		MM2S_HSIZE           = 0x54,
 		MM2S_FRMDLY_STRIDE   = 0x58,
@@ -73,11 +83,14 @@ public:
 		VDMA_INTR_ALL            = (1 << 3) - 1 // All bits set
 	};
 
+	// Called with the index of the completed frame buffer, returning false ends the circular mode
+	using FrameCallback = std::function<bool(const uint32_t&)>;
+
 public:
 	VDMA(const CLAPPtr& pClap, const uint64_t& ctrlOffset, const std::string& name = "") :
 		RegisterControlBase(pClap, ctrlOffset, name),
-		m_watchDogMM2S("VDMA_MM2S", pClap->MakeUserInterrupt()),
-		m_watchDogS2MM("VDMA_S2MM", pClap->MakeUserInterrupt())
+		m_watchDogMM2S("VDMA_MM2S", pClap->MakeUserInterrupt(), pClap->GetCompletionReactor()),
+		m_watchDogS2MM("VDMA_S2MM", pClap->MakeUserInterrupt(), pClap->GetCompletionReactor())
 	{
 		registerReg<uint32_t>(m_mm2sCtrlReg, MM2S_VDMACR);
 		registerReg<uint32_t>(m_mm2sStatReg, MM2S_VDMASR);
@@ -86,19 +99,31 @@ public:
 		registerReg<uint32_t>(m_s2mmCtrlReg, S2MM_VDMACR);
 		registerReg<uint32_t>(m_s2mmStatReg, S2MM_VDMASR);
 		registerReg<uint32_t>(m_s2mmIrqMask, S2MM_VDMA_IRQ_MASK);
-		registerReg<uint32_t>(m_mm2sFDelyStrideReg, MM2S_FRMDLY_STRIDE);
-		registerReg<uint32_t>(m_s2mmFDelyStrideReg, S2MM_FRMDLY_STRIDE);
+		registerReg<uint32_t>(m_mm2sFDelyStrideReg, MM2S_FRMDLY_STRIDE, true);
+		registerReg<uint32_t>(m_s2mmFDelyStrideReg, S2MM_FRMDLY_STRIDE, true);
+
+		// Only the registers exclusively changed by the host are cached, VSize is not as writing it starts the transfer
+		registerCacheable(MM2S_HSIZE);
+		registerCacheable(S2MM_HSIZE);
+
+		for (uint64_t offset = 0; offset < VDMA_START_ADDRESS_BANK_SIZE; offset += sizeof(T))
+		{
+			registerCacheable(MM2S_START_ADDRESS + offset);
+			registerCacheable(S2MM_START_ADDRESS + offset);
+		}
 
 		// Make sure all offsets are registered as polling offsets
 		registerPollOffset(MM2S_VDMACR);
 		registerPollOffset(MM2S_VDMASR);
 		registerPollOffset(MM2S_REG_INDEX);
+		registerPollOffset(MM2S_FRMSTORE);
 		registerPollOffset(PARK_PTR_REG);
 		registerPollOffset(VDMA_VERSION);
 		registerPollOffset(S2MM_VDMACR);
 		registerPollOffset(S2MM_VDMASR);
 		registerPollOffset(S2MM_VDMA_IRQ_MASK);
 		registerPollOffset(S2MM_REG_INDEX);
+		registerPollOffset(S2MM_FRMSTORE);
 		registerPollOffset(MM2S_VSIZE);
 		registerPollOffset(MM2S_HSIZE);
 		registerPollOffset(MM2S_FRMDLY_STRIDE);
@@ -146,6 +171,9 @@ public:
 				return;
 			}
 
+			// Queue the configuration and write it with as few accesses as possible, VSize is written last as it starts the transfer
+			internal::RegisterTransaction tx(*this);
+
 			// Set the RunStop bit
 			m_mm2sCtrlReg.Start();
 			// Set the source address
@@ -170,6 +198,8 @@ public:
 				return;
 			}
 
+			internal::RegisterTransaction tx(*this);
+
 			// Set the RunStop bit
 			m_s2mmCtrlReg.Start();
 			// Set the destination address
@@ -207,15 +237,20 @@ public:
 			m_s2mmCtrlReg.Stop();
 			m_watchDogS2MM.Stop();
 		}
+
+		finishCircular(channel);
 	}
 
 	bool WaitForFinish(const DMAChannel& channel, const int32_t& timeoutMS = WAIT_INFINITE)
 	{
+		// In circular mode the watchdog only finishes once the frame callback ended the mode
+		const bool circular = IsCircularActive(channel);
+
 		if (channel == DMAChannel::MM2S)
 		{
 			bool state = m_watchDogMM2S.WaitForFinish(timeoutMS);
 			// The VDMA automatically restarts as long as it's not stopped so also restart the watchdog
-			if (state)
+			if (state && !circular)
 				m_watchDogMM2S.Start();
 			return state;
 		}
@@ -223,7 +258,7 @@ public:
 		{
 			bool state = m_watchDogS2MM.WaitForFinish(timeoutMS);
 			// The VDMA automatically restarts as long as it's not stopped so also restart the watchdog
-			if (state)
+			if (state && !circular)
 				m_watchDogS2MM.Start();
 			return state;
 		}
@@ -231,6 +266,158 @@ public:
 
 	////////////////////////////////////////
 
+	/// @brief Starts the given channel in circular mode over multiple frame buffers
+	///        The hardware cycles through the frame buffers without being restarted, every completed frame is
+	///        reported to the callback with its index while the hardware already works on the next frame buffer,
+	///        i.e., frame k can be processed while k+1 is transferred. Completion is detected through the frame
+	///        count interrupt if interrupts are enabled for the channel, otherwise the park pointer register is polled.
+	///        The mode runs until the callback returns false or Stop() is called. Without reactor (bare-metal)
+	///        ProcessFrames() has to be called periodically.
+	/// @param channel The channel to start
+	/// @param frames The frame buffers, at least 2 and at most 32 (limited by the number of frame stores of the core), at most 16 for 64-bit addresses
+	/// @param hSize Number of bytes per line, also used as stride
+	/// @param vSize Number of lines per frame
+	/// @param callback Callback called with the index of every completed frame buffer
+	void StartCircular(const DMAChannel& channel, const std::vector<Memory>& frames, const uint32_t& hSize, const uint32_t& vSize, FrameCallback callback)
+	{
+		FrameStream& stream = m_frameStreams[ch2Id(channel)];
+
+		if (stream.active)
+			BUILD_IP_EXCEPTION(CLAPException, "Channel " << channel << " is already running in circular mode");
+
+		if (!callback)
+			BUILD_IP_EXCEPTION(CLAPException, "No frame callback specified");
+
+		// Two banks of start address registers, each holding VDMA_START_ADDRESS_BANK_SIZE / sizeof(T) frame stores
+		const uint32_t framesPerBank = static_cast<uint32_t>(VDMA_START_ADDRESS_BANK_SIZE / sizeof(T));
+		const uint32_t maxFrames     = std::min(VDMA_MAX_FRAME_STORES, 2 * framesPerBank);
+
+		if (frames.size() < 2 || frames.size() > maxFrames)
+			BUILD_IP_EXCEPTION(CLAPException, "Circular mode requires between 2 and " << maxFrames << " frame buffers, " << frames.size() << " were specified");
+
+		const uint64_t frameSize = static_cast<uint64_t>(hSize) * vSize;
+
+		for (std::size_t i = 0; i < frames.size(); i++)
+		{
+			if (frames[i].GetSize() < frameSize)
+				BUILD_IP_EXCEPTION(CLAPException, "Frame buffer " << i << " holds " << frames[i].GetSize() << " bytes, but a frame requires " << frameSize << " bytes");
+		}
+
+		const uint32_t numFrames = static_cast<uint32_t>(frames.size());
+		const uint64_t storeReg  = (channel == DMAChannel::MM2S ? MM2S_FRMSTORE : S2MM_FRMSTORE);
+
+		// The number of frame stores is only writable if enabled in the core and is limited to C_NUM_FSTORES
+		writeRegister<uint32_t>(storeReg, numFrames);
+		const uint32_t numStores = readRegister<uint32_t>(storeReg) & (2 * VDMA_MAX_FRAME_STORES - 1);
+
+		if (numStores != numFrames)
+			BUILD_IP_EXCEPTION(CLAPException, "VDMA (" << channel << ") only provides " << numStores << " frame stores, but " << numFrames << " frame buffers were specified");
+
+		stream.callback  = std::move(callback);
+		stream.numFrames = numFrames;
+		stream.nextFrame = 0;
+		stream.frames    = 0;
+		stream.irqMode   = (channel == DMAChannel::MM2S ? m_watchDogMM2S : m_watchDogS2MM).IsInterruptSet();
+
+		{
+			// VSize is written last as it starts the transfer
+			internal::RegisterTransaction tx(*this);
+			const uint64_t addrReg  = (channel == DMAChannel::MM2S ? MM2S_START_ADDRESS : S2MM_START_ADDRESS);
+			const uint64_t indexReg = (channel == DMAChannel::MM2S ? MM2S_REG_INDEX : S2MM_REG_INDEX);
+
+			if (channel == DMAChannel::MM2S)
+				m_mm2sCtrlReg.StartCircular();
+			else
+				m_s2mmCtrlReg.StartCircular();
+
+			// The start addresses of both banks use the same offsets, therefore, the bank selection and the banked
+			// addresses are written ordered, i.e., they are neither coalesced nor skipped based on the register cache
+			for (uint32_t i = 0; i < numFrames; i++)
+			{
+				const uint64_t offset = addrReg + (i % framesPerBank) * sizeof(T);
+				const T addr          = static_cast<T>(frames[i].GetBaseAddr());
+
+				if (numFrames > framesPerBank && i % framesPerBank == 0)
+					writeRegisterOrdered<uint32_t>(indexReg, i / framesPerBank);
+
+				if (numFrames > framesPerBank)
+					writeRegisterOrdered<T>(offset, addr);
+				else
+					writeRegister<T>(offset, addr);
+			}
+
+			// Restore the first bank used by the single frame buffer accessors
+			if (numFrames > framesPerBank)
+				writeRegisterOrdered<uint32_t>(indexReg, 0);
+
+			if (channel == DMAChannel::MM2S)
+			{
+				m_mm2sFDelyStrideReg.SetStride(hSize);
+				m_mm2sFDelyStrideReg.Update(internal::Direction::WRITE);
+				setMM2SHSize(hSize);
+				setMM2SVSize(vSize);
+			}
+			else
+			{
+				m_s2mmFDelyStrideReg.SetStride(hSize);
+				m_s2mmFDelyStrideReg.Update(internal::Direction::WRITE);
+				setS2MMHSize(hSize);
+				setS2MMVSize(vSize);
+			}
+		}
+
+		// The cache holds the addresses of the second bank for the offsets of the first one
+		if (numFrames > framesPerBank)
+			InvalidateRegisterCache();
+
+		stream.active = true;
+
+		internal::WatchDog& watchDog = (channel == DMAChannel::MM2S ? m_watchDogMM2S : m_watchDogS2MM);
+		watchDog.SetStatusRegister(&stream.monitor);
+		watchDog.SetFinishCallback([this, channel]() {
+			uint32_t processed = 0;
+			return processFrames(channel, processed, m_frameStreams[ch2Id(channel)].irqMode);
+		});
+
+		if (!watchDog.Start(true))
+		{
+			Stop(channel);
+			BUILD_IP_EXCEPTION(CLAPException, "Watchdog for VDMA (" << channel << ") already running!");
+		}
+	}
+
+	/// @brief Hands all frames completed since the last call to the frame callback
+	///        Only required if the circular mode is not driven by the completion reactor, e.g., on bare-metal
+	/// @param channel The channel running in circular mode
+	/// @return Number of processed frames
+	uint32_t ProcessFrames(const DMAChannel& channel)
+	{
+		uint32_t processed = 0;
+		processFrames(channel, processed, false);
+		return processed;
+	}
+
+	bool IsCircularActive(const DMAChannel& channel) const
+	{
+		return m_frameStreams[ch2Id(channel)].active;
+	}
+
+	/// @brief Returns the number of frames completed by the current or last circular run on the given channel
+	uint64_t GetCircularFrameCount(const DMAChannel& channel) const
+	{
+		return m_frameStreams[ch2Id(channel)].frames;
+	}
+
+	/// @brief Returns the index of the frame store the given channel is currently working on
+	uint32_t GetCurrentFrameStore(const DMAChannel& channel)
+	{
+		// Read the raw value instead of using m_parkPntrReg, both channels access it, possibly from different threads
+		const uint32_t park = readRegister<uint32_t>(PARK_PTR_REG);
+		return (channel == DMAChannel::MM2S ? (park >> 16) : (park >> 24)) & (VDMA_MAX_FRAME_STORES - 1);
+	}
+
+	////////////////////////////////////////
+
 	////////////////////////////////////////
 
 	void Reset()
@@ -251,6 +438,9 @@ public:
 			Stop(DMAChannel::S2MM);
 			m_s2mmCtrlReg.DoReset();
 		}
+
+		// The reset restores the default values of all registers
+		InvalidateRegisterCache();
 	}
 
 	////////////////////////////////////////
@@ -362,6 +552,96 @@ public:
 	////////////////////////////////////////
 
 private:
+	struct FrameStream
+	{
+		FrameStream(VDMA* pVDMA, const DMAChannel& ch) :
+			monitor([pVDMA, ch]() { return pVDMA->pollFrames(ch); })
+		{}
+
+		DISABLE_COPY_ASSIGN_MOVE(FrameStream)
+
+		// Reports the next frame as done as soon as the hardware moved on to the following frame store
+		internal::CallbackStatus monitor;
+		FrameCallback callback = nullptr;
+		uint32_t numFrames     = 0;
+		uint32_t nextFrame     = 0;
+		uint64_t frames        = 0;
+		bool irqMode           = false;
+		// Cleared by the reactor thread once the callback ends the circular mode
+		std::atomic<bool> active = { false };
+	};
+
+	////////////////////////////////////////
+
+	uint32_t ch2Id(const DMAChannel& channel) const
+	{
+		return (channel == DMAChannel::MM2S ? 0 : 1);
+	}
+
+	// Returns true if the hardware finished the next frame expected by the circular mode
+	bool pollFrames(const DMAChannel& channel)
+	{
+		FrameStream& stream = m_frameStreams[ch2Id(channel)];
+
+		if (!stream.active) return true;
+
+		return GetCurrentFrameStore(channel) != stream.nextFrame;
+	}
+
+	// Hands the completed frames to the frame callback, returns true if the circular mode has ended
+	bool processFrames(const DMAChannel& channel, uint32_t& processed, const bool& interrupted)
+	{
+		FrameStream& stream = m_frameStreams[ch2Id(channel)];
+
+		processed = 0;
+
+		if (!stream.active) return true;
+
+		// Every frame store the hardware moved past has been completed, this also catches up on missed interrupts
+		const uint32_t current = GetCurrentFrameStore(channel);
+		uint32_t completed     = (current + stream.numFrames - stream.nextFrame) % stream.numFrames;
+
+		// The frame count interrupt is raised at the end of a frame, possibly before the hardware moved on to the next frame store
+		if (completed == 0 && interrupted)
+			completed = 1;
+
+		bool proceed = true;
+
+		while (proceed && processed < completed)
+		{
+			proceed          = stream.callback(stream.nextFrame);
+			stream.nextFrame = (stream.nextFrame + 1) % stream.numFrames;
+			stream.frames++;
+			processed++;
+		}
+
+		if (proceed) return false;
+
+		if (channel == DMAChannel::MM2S)
+			m_mm2sCtrlReg.Stop();
+		else
+			m_s2mmCtrlReg.Stop();
+
+		finishCircular(channel);
+		return true;
+	}
+
+	// Restores the watchdog of the channel after the circular mode ended
+	void finishCircular(const DMAChannel& channel)
+	{
+		FrameStream& stream = m_frameStreams[ch2Id(channel)];
+
+		if (!stream.active) return;
+
+		stream.active = false;
+
+		internal::WatchDog& watchDog = (channel == DMAChannel::MM2S ? m_watchDogMM2S : m_watchDogS2MM);
+		watchDog.UnsetStatusRegister();
+		watchDog.SetFinishCallback(nullptr);
+
+		CLAP_IP_CORE_LOG_DEBUG << "Circular mode on channel " << channel << " finished after " << stream.frames << " frames" << std::endl;
+	}
+
 	////////////////////////////////////////
 
 	void setMM2SSrcAddr(const T& addr)
@@ -380,12 +660,12 @@ private:
 
 	void setMM2SVSize(const uint16_t& size)
 	{
-		writeRegister<uint32_t>(MM2S_VSIZE, size);
+		writeRegisterOrdered<uint32_t>(MM2S_VSIZE, size);
 	}
 
 	void setS2MMVSize(const uint16_t& size)
 	{
-		writeRegister<uint32_t>(S2MM_VSIZE, size);
+		writeRegisterOrdered<uint32_t>(S2MM_VSIZE, size);
 	}
 
 	////////////////////////////////////////
@@ -444,6 +724,17 @@ private:
 			setRunStop(false);
 		}
 
+		// Starts the channel free-running through all frame stores with an interrupt after every frame
+		void StartCircular()
+		{
+			Update();
+			m_circularPark  = true;
+			m_frameCntEn    = false;
+			m_irqFrameCount = 1;
+			m_rs            = true;
+			Update(internal::Direction::WRITE);
+		}
+
 		void DoReset()
 		{
 			Update();
@@ -712,6 +1003,9 @@ private:
 	MM2SFrameDelayStrideRegister m_mm2sFDelyStrideReg = MM2SFrameDelayStrideRegister();
 	SS2MFrameDelayStrideRegister m_s2mmFDelyStrideReg = SS2MFrameDelayStrideRegister();
 
+	// Declared before the watchdogs, which are destroyed first and might still reference the monitors
+	std::array<FrameStream, 2> m_frameStreams = { { FrameStream(this, DMAChannel::MM2S), FrameStream(this, DMAChannel::S2MM) } };
+
 	internal::WatchDog m_watchDogMM2S;
 	internal::WatchDog m_watchDogS2MM;
 };
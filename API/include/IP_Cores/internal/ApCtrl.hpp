@@ -33,30 +33,41 @@ namespace clap
 {
 namespace internal
 {
-class ApCtrl : public Register<uint8_t>, public HasStatus
+namespace ap_ctrl
+{
+CLAP_REG_FIELD(ApStart, "ap_start", 0, 0);
+CLAP_REG_FIELD(ApDone, "ap_done", 1, 1);
+CLAP_REG_FIELD(ApIdle, "ap_idle", 2, 2);
+CLAP_REG_FIELD(ApReady, "ap_ready", 3, 3);
+CLAP_REG_FIELD(AutoRestart, "auto_restart", 7, 7);
+
+using Layout = LayoutRegister<uint8_t, ApStart, ApDone, ApIdle, ApReady, AutoRestart>;
+} // namespace ap_ctrl
+
+class ApCtrl : public ap_ctrl::Layout, public HasStatus
 {
 	DISABLE_COPY_ASSIGN_MOVE(ApCtrl)
 
+	using ApStart     = ap_ctrl::ApStart;
+	using ApDone      = ap_ctrl::ApDone;
+	using ApIdle      = ap_ctrl::ApIdle;
+	using ApReady     = ap_ctrl::ApReady;
+	using AutoRestart = ap_ctrl::AutoRestart;
+
 public:
 	ApCtrl() :
-		Register("ap_ctrl")
-	{
-		RegisterElement<bool>(&ap_start, "ap_start", 0);
-		RegisterElement<bool>(&ap_done, "ap_done", 1);
-		RegisterElement<bool>(&ap_idle, "ap_idle", 2);
-		RegisterElement<bool>(&ap_ready, "ap_ready", 3);
-		RegisterElement<bool>(&auto_restart, "auto_restart", 7);
-	}
+		LayoutRegister("ap_ctrl")
+	{}
 
 	void PrintStatus()
 	{
 		getStatus();
 		CLAP_LOG_INFO << "---- ap_ctrl: ----" << std::endl
-					  << "ap_start    : " << ap_start << std::endl
-					  << "ap_done     : " << ap_done << " (" << m_done << ")" << std::endl
-					  << "ap_idle     : " << ap_idle << std::endl
-					  << "ap_ready    : " << ap_ready << std::endl
-					  << "auto_restart: " << auto_restart << std::endl
+					  << "ap_start    : " << IsSet<ApStart>() << std::endl
+					  << "ap_done     : " << IsSet<ApDone>() << " (" << m_done << ")" << std::endl
+					  << "ap_idle     : " << IsSet<ApIdle>() << std::endl
+					  << "ap_ready    : " << IsSet<ApReady>() << std::endl
+					  << "auto_restart: " << IsSet<AutoRestart>() << std::endl
 					  << "------------------" << std::endl;
 	}
 
@@ -64,10 +75,10 @@ public:
 	{
 		getStatus();
 
-		if (!ap_idle) return false;
+		if (!IsSet<ApIdle>()) return false;
 
-		m_done   = false;
-		ap_start = true;
+		m_done = false;
+		Set<ApStart>(1);
 		Update(Direction::WRITE);
 
 		m_running = true;
@@ -75,16 +86,42 @@ public:
 		return true;
 	}
 
+	struct Handshake
+	{
+		bool done         = false;
+		bool idle         = false;
+		bool ready        = false;
+		bool startPending = false;
+	};
+
+	// Reads the handshake signals once, as ap_done is clear on read the caller has to act on the returned state
+	Handshake Sample()
+	{
+		Update();
+		return { IsSet<ApDone>(), IsSet<ApIdle>(), IsSet<ApReady>(), IsSet<ApStart>() };
+	}
+
+	// Returns the register value that starts the core without writing it, allowing the caller
+	// to write it ordered behind the arguments of the next run
+	uint8_t PrepareStart()
+	{
+		m_done    = false;
+		m_running = true;
+		Set<ApStart>(1);
+
+		return GetValue();
+	}
+
 	void SetAutoRestart(const bool& enable = true)
 	{
-		auto_restart = enable;
+		Set<AutoRestart>(enable);
 		Update(Direction::WRITE);
 	}
 
 	bool IsIdle()
 	{
 		getStatus();
-		return ap_idle;
+		return IsSet<ApIdle>();
 	}
 
 	void Reset()
@@ -97,7 +134,7 @@ private:
 	{
 		Update();
 
-		if (!m_done && ap_done)
+		if (!m_done && IsSet<ApDone>())
 		{
 			m_done    = true;
 			m_running = false;
@@ -106,7 +143,7 @@ private:
 		// Fallback check for ap_done there might be edge cases where the clear on read state of ap_done
 		// is not properly read by the register interface (e.g., when the ap_done flag is set and cleared in the same cycle).
 		// In this case we check if the ap_idle flag is set and set the ap_done flag accordingly
-		if (!m_done && ap_idle && m_running)
+		if (!m_done && IsSet<ApIdle>() && m_running)
 		{
 			m_done    = true;
 			m_running = false;
@@ -115,10 +152,10 @@ private:
 
 	void reset()
 	{
-		m_done       = false;
-		m_running    = false;
-		ap_start     = false;
-		auto_restart = false;
+		m_done    = false;
+		m_running = false;
+		Set<ApStart>(0);
+		Set<AutoRestart>(0);
 
 		Update(Direction::WRITE);
 
@@ -127,12 +164,6 @@ private:
 	}
 
 private:
-	bool ap_start     = false;
-	bool ap_done      = false;
-	bool ap_idle      = false;
-	bool ap_ready     = false;
-	bool auto_restart = false;
-
 	bool m_running = false;
 };
 } // namespace internal
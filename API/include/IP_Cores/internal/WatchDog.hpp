@@ -30,100 +30,54 @@
 #include <cstdint>
 #include <mutex>
 #include <string>
-#include <thread>
 
+#include "../../internal/CompletionReactor.hpp"
 #include "../../internal/Constants.hpp"
 #include "../../internal/Exceptions.hpp"
 #include "../../internal/Logger.hpp"
 #include "../../internal/Timer.hpp"
+#include "../../internal/Trace.hpp"
 #include "../../internal/Types.hpp"
 #include "../../internal/UserInterruptBase.hpp"
 
 #ifndef EMBEDDED_XILINX
 #include <atomic>
 #include <chrono>
-#include <mutex>
+#include <exception>
+#include <memory>
 #endif
 
 namespace clap
 {
 namespace internal
 {
-static std::exception_ptr g_pExcept = nullptr;
-static int64_t g_pollSleepTimeMS    = 10;
+static int64_t g_pollSleepTimeMS = 10;
 
 // TODO: Rename to indicate that this also controls whether the thread should be terminated
 // TODO: Replace the bool with an enum
 using WatchDogFinishCallback = std::function<bool(void)>;
 
-// TODO: Calling WaitForInterrupt with a non-infinit timeout and checking the threadDone flag is not the best solution.
-//       Find a better way, i.e., a way to interrupt the call to poll (ppoll or epoll might be a solution)
-
-#ifndef EMBEDDED_XILINX
-static void waitForFinishThread(UserInterruptBase* pUserIntr, HasStatus* pStatus, Timer* pTimer, [[maybe_unused]] std::condition_variable* pCv, [[maybe_unused]] const std::string& name,
-								std::atomic<bool>* pThreadDone, [[maybe_unused]] const bool& dontTerminate, [[maybe_unused]] const WatchDogFinishCallback& callback)
-{
-	pThreadDone->store(false, std::memory_order_release);
-	pTimer->Start();
-
-	bool end = !dontTerminate;
-
-	if (pUserIntr->IsSet())
-		CLAP_LOG_DEBUG << "[" << name << "] Interrupt Mode ... " << std::endl;
-	else
-		CLAP_LOG_DEBUG << "[" << name << "] Polling Mode ... " << std::endl;
-
-	try
-	{
-		do
-		{
-			if (pUserIntr->IsSet())
-			{
-				while (!pThreadDone->load(std::memory_order_acquire) && !pUserIntr->WaitForInterrupt(100))
-					;
-			}
-			else if (pStatus)
-			{
-				while (!pThreadDone->load(std::memory_order_acquire) && !pStatus->PollDone())
-					utils::SleepMS(g_pollSleepTimeMS);
-			}
-
-			const bool forceTerminate = pThreadDone->load(std::memory_order_acquire);
-			if (!forceTerminate && callback)
-				end = callback();
-
-		} while (!pThreadDone->load(std::memory_order_acquire) && dontTerminate && !end);
-	}
-	catch (...)
-	{
-		// Set the global exception pointer in case of an exception
-		g_pExcept = std::current_exception();
-	}
-
-	pTimer->Stop();
-
-	pThreadDone->store(true, std::memory_order_release);
-	pCv->notify_all();
-
-	CLAP_LOG_DEBUG << "[" << name << "] Finished" << std::endl;
-}
-#endif
-
 class WatchDog
 {
 	DISABLE_COPY_ASSIGN_MOVE(WatchDog)
 
 public:
-	WatchDog(const std::string& name, UserInterruptPtr pInterrupt) :
+	// Without a reactor the WatchDog uses a private one, i.e., a single thread for the lifetime of the WatchDog
+	WatchDog(const std::string& name, UserInterruptPtr pInterrupt, CompletionReactorPtr pReactor = nullptr) :
 		m_name(name),
 		m_pInterrupt(std::move(pInterrupt)),
 		m_timer()
 #ifndef EMBEDDED_XILINX
 		,
+		m_pReactor(pReactor ? std::move(pReactor) : std::make_shared<CompletionReactor>()),
 		m_mtx(),
-		m_waitThread(),
 		m_cv(),
-		m_threadDone(false)
+		m_jobDone(false),
+		m_recorder()
+#endif
+#ifdef CLAP_TRACE_ACTIVE
+		,
+		m_traceNameID(CLAP_TRACE_INTERN(name))
 #endif
 	{
 	}
@@ -145,27 +99,23 @@ public:
 		m_pInterrupt = std::move(pInterrupt);
 	}
 
-	void InitInterrupt([[maybe_unused]] const uint32_t& devNum, [[maybe_unused]] const uint32_t& interruptNum, [[maybe_unused]] HasInterrupt* pReg = nullptr)
+	void InitInterrupt(const uint32_t& devNum, const uint32_t& interruptNum, HasInterrupt* pReg = nullptr)
 	{
-#ifdef _WIN32
-		CLAP_CLASS_LOG_ERROR << "Error: Interrupts are not supported on Windows." << std::endl;
-#else
 		m_pInterrupt->Init(devNum, interruptNum, pReg);
 		// Check for existing interrupts and clear them
 		CLAP_CLASS_LOG_DEBUG << "Clearing existing interrupts ..." << std::endl;
 		while (m_pInterrupt->WaitForInterrupt(1))
 			;
-
-#endif
 	}
 
 	void UnsetInterrupt()
 	{
-#ifdef _WIN32
-		CLAP_CLASS_LOG_ERROR << "Error: Interrupts are not supported on Windows." << std::endl;
-#else
 		m_pInterrupt->Unset();
-#endif
+	}
+
+	bool IsInterruptSet() const
+	{
+		return m_pInterrupt->IsSet();
 	}
 
 	void SetStatusRegister(HasStatus* pStatus)
@@ -181,23 +131,44 @@ public:
 	bool Start(const bool& dontTerminate = false)
 	{
 #ifndef EMBEDDED_XILINX
-		// Check if the thread has finished but was not joined
-		if (m_threadDone.load(std::memory_order_acquire))
-			joinThread();
-
-		if (m_threadRunning) return false;
+		if (m_jobRunning && !m_jobDone.load(std::memory_order_acquire)) return false;
 
 		if (!m_pInterrupt->IsSet() && m_pStatus == nullptr)
 		{
 			std::stringstream ss("");
-			ss << CLASS_TAG_AUTO << "Error: Tried to start WatchDog thread with neither the interrupt nor the status register set.";
+			ss << CLASS_TAG_AUTO << "Error: Tried to start WatchDog with neither the interrupt nor the status register set.";
 			throw WatchDogException(ss.str());
 		}
 
-		g_pExcept = nullptr;
-		m_threadDone.store(false, std::memory_order_release);
-		m_waitThread    = std::thread(waitForFinishThread, m_pInterrupt.get(), m_pStatus, &m_timer, &m_cv, m_name, &m_threadDone, dontTerminate, m_callback);
-		m_threadRunning = true;
+		if (m_pInterrupt->IsSet())
+			CLAP_CLASS_LOG_DEBUG << "[" << m_name << "] Interrupt Mode ... " << std::endl;
+		else
+			CLAP_CLASS_LOG_DEBUG << "[" << m_name << "] Polling Mode ... " << std::endl;
+
+		CompletionReactor::JobDesc desc;
+		desc.name           = m_name;
+		desc.pInterrupt     = m_pInterrupt.get();
+		desc.pStatus        = m_pStatus;
+		desc.strategy       = (m_customPollStrategy ? m_pollStrategy : PollStrategy::FixedSleep(static_cast<uint32_t>(g_pollSleepTimeMS * 1000)));
+		desc.dontTerminate  = dontTerminate;
+		desc.finishCallback = m_callback;
+		desc.doneCallback   = [this](std::exception_ptr pExcept) { onJobDone(pExcept); };
+		desc.pRecorder      = &m_recorder;
+
+		if (m_pMetrics == nullptr)
+			m_pMetrics = m_pReactor->GetCoreMetricsRecorder(m_name);
+
+		desc.pMetrics = m_pMetrics;
+
+		m_pExcept = nullptr;
+		m_jobDone.store(false, std::memory_order_release);
+		m_timer.Start();
+#ifdef CLAP_TRACE_ACTIVE
+		m_traceStartNS = CLAP_TRACE_NOW();
+#endif
+
+		m_jobID      = m_pReactor->Submit(desc);
+		m_jobRunning = true;
 #endif
 
 		return true;
@@ -206,11 +177,22 @@ public:
 	void Stop()
 	{
 #ifndef EMBEDDED_XILINX
-		if (!m_threadRunning) return;
+		if (!m_jobRunning) return;
+
+		// Once Cancel returns the reactor no longer accesses this WatchDog
+		if (m_pReactor->Cancel(m_jobID))
+		{
+			m_timer.Stop();
+			CLAP_CLASS_LOG_DEBUG << "[" << m_name << "] Stopped" << std::endl;
+		}
+
+		{
+			std::lock_guard<std::mutex> lck(m_mtx);
+			m_jobDone.store(true, std::memory_order_release);
+		}
 
-		m_threadDone.store(true, std::memory_order_release);
 		m_cv.notify_all();
-		joinThread();
+		m_jobRunning = false;
 		checkException();
 #endif
 	}
@@ -218,30 +200,24 @@ public:
 	bool WaitForFinish(const int32_t& timeoutMS = WAIT_INFINITE)
 	{
 #ifndef EMBEDDED_XILINX
-		using namespace std::chrono_literals;
-
 		CLAP_CLASS_LOG_DEBUG << "Core=" << m_name << " timeoutMS=" << (timeoutMS == WAIT_INFINITE ? "Infinite" : std::to_string(timeoutMS)) << std::endl;
 
-		if (!m_threadRunning)
+		if (!m_jobRunning)
 			return true;
 
-		if (m_threadDone.load(std::memory_order_acquire))
 		{
-			joinThread();
-			checkException();
-			return true;
-		}
+			CLAP_TRACE_SCOPE(trace::EventType::WatchDogWait, 0, 0, m_traceNameID);
 
-		{
 			std::unique_lock<std::mutex> lck(m_mtx);
+			const auto isDone = [this] { return m_jobDone.load(std::memory_order_acquire); };
 
 			if (timeoutMS == WAIT_INFINITE)
-				m_cv.wait(lck, [this] { return m_threadDone.load(std::memory_order_acquire); });
-			else if (m_cv.wait_for(lck, std::chrono::milliseconds(timeoutMS)) == std::cv_status::timeout)
+				m_cv.wait(lck, isDone);
+			else if (!m_cv.wait_for(lck, std::chrono::milliseconds(timeoutMS), isDone))
 				return false;
 		}
 
-		joinThread();
+		m_jobRunning = false;
 		checkException();
 #else
 		if (m_pInterrupt->IsSet())
@@ -281,31 +257,77 @@ public:
 		m_callback = callback;
 	}
 
+	// Sets the strategy used to poll the status register, takes effect on the next start.
+	// Without a custom strategy the global poll sleep time is used (SetWatchDogPollSleepTimeMS).
+	void SetPollStrategy(const PollStrategy& strategy)
+	{
+		m_pollStrategy       = strategy;
+		m_customPollStrategy = true;
+	}
+
+	CompletionStats GetCompletionStats() const
+	{
+#ifndef EMBEDDED_XILINX
+		return m_recorder.Get();
+#else
+		return CompletionStats();
+#endif
+	}
+
+	void ResetCompletionStats()
+	{
+#ifndef EMBEDDED_XILINX
+		m_recorder.Reset();
+#endif
+	}
+
 private:
+#ifndef EMBEDDED_XILINX
+	// Called by the reactor thread once the job is done
+	void onJobDone(std::exception_ptr pExcept)
+	{
+		m_timer.Stop();
+
+#ifdef CLAP_TRACE_ACTIVE
+		trace::Event event;
+		event.type    = trace::EventType::WatchDogRun;
+		event.nameID  = m_traceNameID;
+		event.startNS = m_traceStartNS;
+		event.endNS   = CLAP_TRACE_NOW();
+		CLAP_TRACE_RECORD(event);
+#endif
+
+		// Notify while holding the lock, a waiter might destroy the WatchDog as soon as it observes the job as done
+		std::lock_guard<std::mutex> lck(m_mtx);
+		m_pExcept = pExcept;
+		m_jobDone.store(true, std::memory_order_release);
+		m_cv.notify_all();
+
+		CLAP_CLASS_LOG_DEBUG << "[" << m_name << "] Finished" << std::endl;
+	}
+#endif
+
 	void checkException()
 	{
-		if (g_pExcept)
+#ifndef EMBEDDED_XILINX
+		std::exception_ptr pExcept = nullptr;
+
+		{
+			std::lock_guard<std::mutex> lck(m_mtx);
+			std::swap(pExcept, m_pExcept);
+		}
+
+		if (pExcept)
 		{
 			try
 			{
-				std::rethrow_exception(g_pExcept);
+				std::rethrow_exception(pExcept);
 			}
-			catch ([[maybe_unused]] const std::exception& ex)
+			catch (const std::exception& ex)
 			{
+				CLAP_CLASS_LOG_ERROR << "[" << m_name << "] " << ex.what() << std::endl;
 			}
 		}
-	}
-
-	void joinThread()
-	{
-#ifndef EMBEDDED_XILINX
-		std::lock_guard<std::mutex> lck(m_mtx);
-		if (!m_threadRunning) return;
-
-		if (m_waitThread.joinable())
-			m_waitThread.join();
-
-		m_threadRunning = false;
 #endif
 	}
 
@@ -314,14 +336,24 @@ private:
 	UserInterruptPtr m_pInterrupt;
 	Timer m_timer;
 #ifndef EMBEDDED_XILINX
+	CompletionReactorPtr m_pReactor;
 	std::mutex m_mtx;
-	std::thread m_waitThread;
 	std::condition_variable m_cv;
-	bool m_threadRunning = false;
-	std::atomic<bool> m_threadDone;
+	std::atomic<bool> m_jobDone;
+	CompletionRecorder m_recorder;
+	CompletionReactor::JobID m_jobID = 0;
+	bool m_jobRunning                = false;
+	std::exception_ptr m_pExcept     = nullptr;
+	CoreMetricsRecorder* m_pMetrics  = nullptr;
 #endif
 	WatchDogFinishCallback m_callback = nullptr;
 	HasStatus* m_pStatus              = nullptr;
+	PollStrategy m_pollStrategy       = {};
+	bool m_customPollStrategy         = false;
+#ifdef CLAP_TRACE_ACTIVE
+	uint32_t m_traceNameID  = 0;
+	uint64_t m_traceStartNS = 0;
+#endif
 };
 } // namespace internal
 
@@ -330,4 +362,4 @@ inline void SetWatchDogPollSleepTimeMS(const uint32_t& timeMS = 10)
 	internal::g_pollSleepTimeMS = timeMS;
 }
 
-} // namespace clap
\ No newline at end of file
+} // namespace clap
@@ -0,0 +1,407 @@
+/*
+ *  File: AsyncTransfer.hpp
+ *  Copyright (c) 2023 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "CLAPBackend.hpp"
+#include "Constants.hpp"
+#include "Exceptions.hpp"
+#include "Logger.hpp"
+#include "Memory.hpp"
+#include "Numa.hpp"
+#include "Types.hpp"
+#include "Utils.hpp"
+
+namespace clap
+{
+namespace internal
+{
+// Completion state shared between the transfer pool and all handles of a submission
+class TransferState
+{
+	DISABLE_COPY_ASSIGN_MOVE(TransferState)
+
+public:
+	explicit TransferState(const std::size_t& pending) :
+		m_pending(pending),
+		m_pExcept(nullptr),
+		m_mtx(),
+		m_cv()
+	{}
+
+	void Complete(const std::exception_ptr& pExcept)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+
+			// Only the first error of a submission is reported
+			if (pExcept && !m_pExcept)
+				m_pExcept = pExcept;
+
+			m_pending--;
+		}
+
+		m_cv.notify_all();
+	}
+
+	bool Wait(const int32_t& timeoutMS)
+	{
+		std::unique_lock<std::mutex> lock(m_mtx);
+
+		const auto done = [this] { return m_pending == 0; };
+
+		if (timeoutMS == WAIT_INFINITE)
+			m_cv.wait(lock, done);
+		else if (!m_cv.wait_for(lock, std::chrono::milliseconds(timeoutMS), done))
+			return false;
+
+		if (m_pExcept) std::rethrow_exception(m_pExcept);
+
+		return true;
+	}
+
+	bool IsDone() const
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		return (m_pending == 0);
+	}
+
+private:
+	std::size_t m_pending;
+	std::exception_ptr m_pExcept;
+	mutable std::mutex m_mtx;
+	std::condition_variable m_cv;
+};
+
+using TransferStatePtr = std::shared_ptr<TransferState>;
+
+struct TransferOp
+{
+	CLAPBackend::TYPE type = CLAPBackend::TYPE::READ;
+	uint64_t addr          = 0;
+	void* pData            = nullptr;
+	uint64_t size          = 0;
+};
+
+// Pool of worker threads executing transfers on the backend. Reads and writes are kept in separate
+// queues and every worker picks from the direction with fewer transfers in flight, this way, uploads
+// and downloads of a batch overlap on the independent H2C and C2H engines.
+class TransferPool
+{
+	DISABLE_COPY_ASSIGN_MOVE(TransferPool)
+
+	struct Job
+	{
+		TransferOp op           = {};
+		TransferStatePtr pState = nullptr;
+	};
+
+public:
+	explicit TransferPool(CLAPBackendPtr pBackend) :
+		m_pBackend(std::move(pBackend)),
+		m_readJobs(),
+		m_writeJobs(),
+		m_workers(),
+		m_mtx(),
+		m_cv()
+	{}
+
+	~TransferPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			m_stop = true;
+		}
+
+		m_cv.notify_all();
+
+		// Workers drain the queues before exiting, as the queued transfers reference user buffers
+		for (std::thread& t : m_workers)
+			t.join();
+	}
+
+	TransferStatePtr Submit(const std::vector<TransferOp>& ops)
+	{
+		TransferStatePtr pState = std::make_shared<TransferState>(ops.size());
+
+		if (ops.empty()) return pState;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+
+			if (m_workers.empty())
+				startWorkers();
+
+			for (const TransferOp& op : ops)
+			{
+				if (op.type == CLAPBackend::TYPE::READ)
+					m_readJobs.push_back({ op, pState });
+				else
+					m_writeJobs.push_back({ op, pState });
+			}
+		}
+
+		m_cv.notify_all();
+
+		return pState;
+	}
+
+	// Restricts the worker threads to the given CPUs, takes effect immediately for running workers
+	void SetThreadAffinity(const CpuSet& cpus)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_affinity = cpus;
+
+		for (std::thread& t : m_workers)
+			numa::PinThread(t, m_affinity);
+	}
+
+private:
+	void startWorkers()
+	{
+		// At least one worker per direction is used to overlap reads and writes
+		const std::size_t workerCnt = std::max<std::size_t>(2, m_pBackend->GetTransferConcurrency());
+
+		CLAP_CLASS_LOG_DEBUG << "Starting " << workerCnt << " transfer workers" << std::endl;
+
+		for (std::size_t i = 0; i < workerCnt; i++)
+		{
+			m_workers.emplace_back(&TransferPool::run, this);
+
+			if (!m_affinity.empty())
+				numa::PinThread(m_workers.back(), m_affinity);
+		}
+	}
+
+	void run()
+	{
+		while (true)
+		{
+			Job job;
+
+			{
+				std::unique_lock<std::mutex> lock(m_mtx);
+				m_cv.wait(lock, [this] { return m_stop || !m_readJobs.empty() || !m_writeJobs.empty(); });
+
+				if (m_readJobs.empty() && m_writeJobs.empty()) return;
+
+				const bool pickRead    = !m_readJobs.empty() && (m_writeJobs.empty() || m_readsInFlight <= m_writesInFlight);
+				std::deque<Job>& queue = (pickRead ? m_readJobs : m_writeJobs);
+
+				job = std::move(queue.front());
+				queue.pop_front();
+
+				(pickRead ? m_readsInFlight : m_writesInFlight)++;
+			}
+
+			std::exception_ptr pExcept = nullptr;
+
+			try
+			{
+				if (job.op.type == CLAPBackend::TYPE::READ)
+					m_pBackend->Read(job.op.addr, job.op.pData, job.op.size);
+				else
+					m_pBackend->Write(job.op.addr, job.op.pData, job.op.size);
+			}
+			catch (...)
+			{
+				pExcept = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mtx);
+				(job.op.type == CLAPBackend::TYPE::READ ? m_readsInFlight : m_writesInFlight)--;
+			}
+
+			job.pState->Complete(pExcept);
+		}
+	}
+
+private:
+	CLAPBackendPtr m_pBackend;
+	std::deque<Job> m_readJobs;
+	std::deque<Job> m_writeJobs;
+	std::vector<std::thread> m_workers;
+	std::mutex m_mtx;
+	std::condition_variable m_cv;
+	CpuSet m_affinity            = {};
+	std::size_t m_readsInFlight  = 0;
+	std::size_t m_writesInFlight = 0;
+	bool m_stop                  = false;
+};
+
+using TransferPoolPtr = std::shared_ptr<TransferPool>;
+} // namespace internal
+
+// Lightweight handle to an asynchronous transfer or a submitted transfer batch,
+// the buffers involved must remain valid until the transfer has completed
+class TransferHandle
+{
+public:
+	TransferHandle() = default;
+
+	explicit TransferHandle(internal::TransferStatePtr pState) :
+		m_pState(std::move(pState))
+	{}
+
+	/// @brief Waits for the transfer to finish, rethrows the first error that occurred during the transfer
+	/// @param timeoutMS Timeout in milliseconds
+	/// @return true if the transfer finished, false if the timeout expired
+	bool Wait(const int32_t& timeoutMS = WAIT_INFINITE) const
+	{
+		if (!m_pState) return true;
+
+		return m_pState->Wait(timeoutMS);
+	}
+
+	bool IsDone() const
+	{
+		return (!m_pState || m_pState->IsDone());
+	}
+
+	bool IsValid() const
+	{
+		return (m_pState != nullptr);
+	}
+
+private:
+	internal::TransferStatePtr m_pState = nullptr;
+};
+
+// Collection of host/device transfers that are submitted at once. The transfers of a batch
+// are executed concurrently in an order chosen by the transfer pool, therefore, the operations
+// of a batch must not depend on each other.
+class TransferBatch
+{
+public:
+	explicit TransferBatch(internal::TransferPoolPtr pPool) :
+		m_pPool(std::move(pPool)),
+		m_ops()
+	{}
+
+	/// @brief Adds a read from the given memory object into a data buffer
+	/// @param mem Memory object to read from
+	/// @param memOffset Offset in the memory object to read from
+	/// @param pData Pointer to the data buffer
+	/// @param sizeInByte Number of bytes to read, USE_MEMORY_SIZE reads until the end of the memory
+	TransferBatch& Read(const Memory& mem, const uint64_t& memOffset, void* pData, const uint64_t& sizeInByte = USE_MEMORY_SIZE)
+	{
+		m_ops.push_back({ internal::CLAPBackend::TYPE::READ, mem.GetBaseAddr() + memOffset, pData, getSize(mem, memOffset, sizeInByte) });
+		return *this;
+	}
+
+	/// @brief Adds a write of a data buffer to the given memory object
+	/// @param mem Memory object to write to
+	/// @param memOffset Offset in the memory object to write to
+	/// @param pData Pointer to the data buffer
+	/// @param sizeInByte Number of bytes to write, USE_MEMORY_SIZE writes until the end of the memory
+	TransferBatch& Write(const Memory& mem, const uint64_t& memOffset, const void* pData, const uint64_t& sizeInByte = USE_MEMORY_SIZE)
+	{
+		// The data is never modified, the op just shares the pointer type with reads
+		m_ops.push_back({ internal::CLAPBackend::TYPE::WRITE, mem.GetBaseAddr() + memOffset, const_cast<void*>(pData), getSize(mem, memOffset, sizeInByte) });
+		return *this;
+	}
+
+	template<typename T>
+	TransferBatch& Read(const Memory& mem, const uint64_t& memOffset, CLAPBuffer<T>& buffer, const uint64_t& sizeInByte = USE_MEMORY_SIZE)
+	{
+		const uint64_t size = getSize(mem, memOffset, sizeInByte);
+		checkBufferSize(buffer.size() * sizeof(T), size);
+		return Read(mem, memOffset, buffer.data(), size);
+	}
+
+	template<typename T>
+	TransferBatch& Write(const Memory& mem, const uint64_t& memOffset, const CLAPBuffer<T>& buffer, const uint64_t& sizeInByte = USE_MEMORY_SIZE)
+	{
+		const uint64_t size = getSize(mem, memOffset, sizeInByte);
+		checkBufferSize(buffer.size() * sizeof(T), size);
+		return Write(mem, memOffset, buffer.data(), size);
+	}
+
+	/// @brief Submits all transfers of the batch, the batch keeps its transfers and can be submitted again
+	/// @return Handle that completes once all transfers of the batch have finished
+	TransferHandle Submit() const
+	{
+		return TransferHandle(m_pPool->Submit(m_ops));
+	}
+
+	void Clear()
+	{
+		m_ops.clear();
+	}
+
+	std::size_t GetSize() const
+	{
+		return m_ops.size();
+	}
+
+private:
+	uint64_t getSize(const Memory& mem, const uint64_t& memOffset, const uint64_t& sizeInByte) const
+	{
+		if (memOffset > mem.GetSize())
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Offset (0x" << std::hex << memOffset << ") exceeds the size of the given memory (0x" << mem.GetSize() << ")";
+			throw CLAPException(ss.str());
+		}
+
+		const uint64_t size = (sizeInByte == USE_MEMORY_SIZE ? mem.GetSize() - memOffset : sizeInByte);
+
+		if (memOffset + size > mem.GetSize())
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Specified size (0x" << std::hex << size << ") and offset (0x" << memOffset << ") exceed the size of the given memory (0x" << mem.GetSize() << ")";
+			throw CLAPException(ss.str());
+		}
+
+		return size;
+	}
+
+	void checkBufferSize(const uint64_t& bufferSize, const uint64_t& size) const
+	{
+		if (size <= bufferSize) return;
+
+		std::stringstream ss;
+		ss << CLASS_TAG_AUTO << "Byte size of buffer provided (" << bufferSize << ") is smaller than the desired transfer size (" << size << ")";
+		throw CLAPException(ss.str());
+	}
+
+private:
+	internal::TransferPoolPtr m_pPool;
+	std::vector<internal::TransferOp> m_ops;
+};
+} // namespace clap
@@ -26,7 +26,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -36,10 +42,15 @@
 #include <unistd.h>
 #endif
 
+#include "Constants.hpp"
+#include "CopyKernels.hpp"
 #include "Defines.hpp"
 #include "Exceptions.hpp"
 #include "Expected.hpp"
+#include "Metrics.hpp"
+#include "StdStub.hpp"
 #include "Timer.hpp"
+#include "Trace.hpp"
 #include "Types.hpp"
 #include "UserInterruptBase.hpp"
 
@@ -47,6 +58,12 @@ namespace clap
 {
 namespace internal
 {
+struct DeviceRange
+{
+	uint64_t addr = 0;
+	uint64_t size = 0;
+};
+
 class CLAPBackend
 {
 public:
@@ -65,6 +82,107 @@ public:
 	virtual void Read(const uint64_t& addr, void* pData, const uint64_t& sizeInByte)        = 0;
 	virtual void Write(const uint64_t& addr, const void* pData, const uint64_t& sizeInByte) = 0;
 
+	// Reads/Writes a single scalar (1, 2, 4 or 8 byte), the default implementation stages the data in
+	// an aligned stack buffer to satisfy the alignment requirements of Read/Write. Backends with direct
+	// access to the memory (e.g., UIO or BareMetal) override these to avoid the staging.
+	virtual void ReadScalar(const uint64_t& addr, void* pData, const std::size_t& byteCnt)
+	{
+		checkScalarSize(byteCnt);
+
+		alignas(ALIGNMENT) uint8_t buffer[sizeof(uint64_t)];
+		Read(addr, buffer, byteCnt);
+		std::memcpy(pData, buffer, byteCnt);
+	}
+
+	virtual void WriteScalar(const uint64_t& addr, const void* pData, const std::size_t& byteCnt)
+	{
+		checkScalarSize(byteCnt);
+
+		alignas(ALIGNMENT) uint8_t buffer[sizeof(uint64_t)];
+		std::memcpy(buffer, pData, byteCnt);
+		Write(addr, buffer, byteCnt);
+	}
+
+	template<typename T>
+	T ReadScalar(const uint64_t& addr)
+	{
+		static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8, "Only 8, 16, 32 and 64-bit scalars are supported");
+
+		T data;
+		ReadScalar(addr, &data, sizeof(T));
+		return data;
+	}
+
+	template<typename T>
+	void WriteScalar(const uint64_t& addr, const T& data)
+	{
+		static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8, "Only 8, 16, 32 and 64-bit scalars are supported");
+
+		WriteScalar(addr, &data, sizeof(T));
+	}
+
+	// Reads/Writes a chunk from/to the stream interface of the backend, as data is always read from or
+	// written to the stream offset the PCIe backend overrides these to skip the seek of the generic path.
+	virtual void ReadStream(void* pData, const uint64_t& sizeInByte)
+	{
+		Read(XDMA_STREAM_OFFSET, pData, sizeInByte);
+	}
+
+	virtual void WriteStream(const void* pData, const uint64_t& sizeInByte)
+	{
+		Write(XDMA_STREAM_OFFSET, pData, sizeInByte);
+	}
+
+	// Returns a host pointer to the given device memory range for backends where the memory is directly
+	// addressable (UIO, /dev/mem or bare metal), nullptr if the backend does not support mapping memory.
+	// Every successful mapping has to be released using UnmapMemory.
+	virtual void* MapMemory([[maybe_unused]] const uint64_t& addr, [[maybe_unused]] const uint64_t& sizeInByte)
+	{
+		return nullptr;
+	}
+
+	virtual void UnmapMemory([[maybe_unused]] const uint64_t& addr, [[maybe_unused]] void* pMem, [[maybe_unused]] const uint64_t& sizeInByte) {}
+
+	// Returns a host pointer to addr within a register mapping that stays valid for the lifetime of the backend, sizeInByte
+	// is set to the number of bytes accessible starting at addr. nullptr if registers are not directly accessible at addr.
+	virtual void* GetRegisterWindow([[maybe_unused]] const uint64_t& addr, [[maybe_unused]] uint64_t& sizeInByte)
+	{
+		return nullptr;
+	}
+
+	// Makes CPU writes to a mapped range visible to the device
+	virtual void FlushMapped([[maybe_unused]] void* pMem, [[maybe_unused]] const uint64_t& sizeInByte)
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+
+	// Discards cached data of a mapped range, required before reading data written by the device
+	virtual void InvalidateMapped([[maybe_unused]] void* pMem, [[maybe_unused]] const uint64_t& sizeInByte)
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+
+	// Sets the coherency of a device memory range, has to be set before transfers to the range are issued
+	void SetCoherency(const uint64_t& addr, const uint64_t& sizeInByte, const Coherency& coherency)
+	{
+		std::lock_guard<std::mutex> lock(m_coherencyMtx);
+		m_coherencyRanges.push_back({ addr, sizeInByte, coherency });
+	}
+
+	// Coherency of the range containing addr, ranges without a coherency set are treated as non-coherent
+	Coherency GetCoherency(const uint64_t& addr) const
+	{
+		Coherency coherency = Coherency::NonCoherent;
+		findCoherency(addr, coherency);
+		return coherency;
+	}
+
+	// Performs the cache maintenance of all given ranges in one batch, see CLAP::Sync
+	virtual void SyncRanges([[maybe_unused]] const std::vector<DeviceRange>& ranges, [[maybe_unused]] const SyncDirection& dir)
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+
 	virtual void ReadCtrl([[maybe_unused]] const uint64_t& addr, [[maybe_unused]] uint64_t& data, [[maybe_unused]] const std::size_t& byteCnt)
 	{
 		throw CLAPException("ReadCtrl not implemented");
@@ -102,6 +220,62 @@ public:
 		return 0;
 	}
 
+	// Whether writing consecutive registers in a single burst is cheaper than writing them one by one,
+	// i.e., if every access is a separate transfer (PCIe). Used by register transactions to coalesce writes.
+	virtual bool SupportsRegisterBursts() const
+	{
+		return false;
+	}
+
+	// Writes count consecutive 32-bit registers, the default implementation writes them one by one to retain the access width
+	virtual void WriteRegisters(const uint64_t& addr, const uint32_t* pData, const std::size_t& count)
+	{
+		for (std::size_t i = 0; i < count; i++)
+			WriteScalar<uint32_t>(addr + i * sizeof(uint32_t), pData[i]);
+	}
+
+	// Number of transfers the backend can execute in parallel, e.g., the number of DMA engines
+	virtual std::size_t GetTransferConcurrency() const
+	{
+		return 1;
+	}
+
+#ifndef EMBEDDED_XILINX
+	// NUMA node the device is attached to, NUMA_NODE_UNKNOWN if the backend cannot tell
+	virtual int32_t GetNumaNode() const
+	{
+		return NUMA_NODE_UNKNOWN;
+	}
+
+	// Restricts the threads spawned by the backend itself, e.g., for striped transfers, to the given CPUs
+	virtual void ConfigureThreadAffinity([[maybe_unused]] const CpuSet& cpus) {}
+#endif
+
+	virtual void ConfigureMapCache([[maybe_unused]] const uint64_t& windowSize, [[maybe_unused]] const std::size_t& maxWindows)
+	{
+		CLAP_CLASS_LOG_WARNING << "The " << m_backendName << " backend does not use a map cache, ignoring configuration" << std::endl;
+	}
+
+	virtual void ConfigureStriping([[maybe_unused]] const uint64_t& minStripeSize)
+	{
+		CLAP_CLASS_LOG_WARNING << "The " << m_backendName << " backend does not support striping, ignoring configuration" << std::endl;
+	}
+
+	virtual void ConfigureCopyKernels([[maybe_unused]] const CopyKernel& readKernel, [[maybe_unused]] const CopyKernel& writeKernel)
+	{
+		CLAP_CLASS_LOG_WARNING << "The " << m_backendName << " backend does not copy data through a memory mapping, ignoring configuration" << std::endl;
+	}
+
+	virtual void ConfigurePositionalIO([[maybe_unused]] const uint32_t& fdsPerChannel)
+	{
+		CLAP_CLASS_LOG_WARNING << "The " << m_backendName << " backend does not support positional I/O, ignoring configuration" << std::endl;
+	}
+
+	virtual void ConfigureRegisterBAR([[maybe_unused]] const uint64_t& axiBaseAddr, [[maybe_unused]] const uint64_t& sizeInByte, [[maybe_unused]] const bool& bypass)
+	{
+		CLAP_CLASS_LOG_WARNING << "The " << m_backendName << " backend does not support a memory-mapped register BAR, ignoring configuration" << std::endl;
+	}
+
 	const std::string& GetName(const TYPE& type) const
 	{
 		if (type == TYPE::READ)
@@ -138,10 +312,56 @@ public:
 		return m_logByteThreshold;
 	}
 
+	// Number of operations, bytes and the latency of all transfers of the given type since the creation / last reset
+	TransferMetrics GetTransferMetrics(const TYPE& type) const
+	{
+		return m_transferMetrics[static_cast<std::size_t>(type)].Snapshot();
+	}
+
+	void ResetTransferMetrics()
+	{
+		for (TransferRecorder& recorder : m_transferMetrics)
+			recorder.Reset();
+	}
+
 protected:
+	void checkCopyKernel(const CopyKernel& kernel) const
+	{
+		const std::vector<CopyKernel> kernels = AvailableCopyKernels();
+
+		if (std::find(kernels.begin(), kernels.end(), kernel) == kernels.end())
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Copy kernel " << kernel << " is not supported by this CPU";
+			throw CLAPException(ss.str());
+		}
+	}
+
+	void checkScalarSize(const std::size_t& byteCnt) const
+	{
+		if (byteCnt == 1 || byteCnt == 2 || byteCnt == 4 || byteCnt == 8) return;
+
+		std::stringstream ss;
+		ss << CLASS_TAG_AUTO << "Unsupported scalar size of " << byteCnt << " byte, only 1, 2, 4 and 8 byte are supported";
+		throw CLAPException(ss.str());
+	}
+
+	// Whether a transfer to addr has to maintain the caches, byDefault is returned if addr is not part of a range with a coherency set
+	bool maintainOnTransfer(const uint64_t& addr, const bool& byDefault) const
+	{
+		Coherency coherency;
+		return findCoherency(addr, coherency) ? (coherency == Coherency::NonCoherent) : byDefault;
+	}
+
+	void recordTransfer(const TYPE& type, const uint64_t& sizeInByte, const Timer& timer)
+	{
+		m_transferMetrics[static_cast<std::size_t>(type)].Record(sizeInByte, timer.GetElapsedTimeInNanoSec());
+	}
+
 	void logTransferTime(const uint64_t& addr, const uint64_t& sizeInByte, const Timer& timer, const bool& reading)
 	{
-		if(sizeInByte <= m_logByteThreshold)
+		// Checked first, as formatting the message and searching the poll list are expensive on the hot path
+		if (sizeInByte <= m_logByteThreshold || !logging::IsLogEnabled(logging::Verbosity::VB_VERBOSE))
 			return;
 
 		// Get the time in seconds, if the time is 0.0, set it to 1ns to avoid division by 0
@@ -174,6 +394,38 @@ protected:
 	std::vector<uint64_t> m_pollAddrs = {};
 
 	uint64_t m_logByteThreshold = 8;
+
+private:
+	struct CoherencyRange
+	{
+		uint64_t addr       = 0;
+		uint64_t size       = 0;
+		Coherency coherency = Coherency::NonCoherent;
+	};
+
+	// Regions can be added while other threads transfer data, hence, the ranges are only accessed with the mutex held
+	bool findCoherency(const uint64_t& addr, Coherency& coherency) const
+	{
+		std::lock_guard<std::mutex> lock(m_coherencyMtx);
+
+		for (const CoherencyRange& range : m_coherencyRanges)
+		{
+			if (addr >= range.addr && addr - range.addr < range.size)
+			{
+				coherency = range.coherency;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+private:
+	// Indexed by TYPE
+	std::array<TransferRecorder, 3> m_transferMetrics = {};
+
+	std::vector<CoherencyRange> m_coherencyRanges = {};
+	mutable std::mutex m_coherencyMtx = {};
 };
 } // namespace internal
 } // namespace clap
\ No newline at end of file
@@ -0,0 +1,798 @@
+/*
+ *  File: CompletionReactor.hpp
+ *  Copyright (c) 2023 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <memory>
+#include <string>
+
+#ifndef EMBEDDED_XILINX
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+#endif
+
+#include "Defines.hpp"
+#include "Exceptions.hpp"
+#include "FileOps.hpp"
+#include "Logger.hpp"
+#include "Metrics.hpp"
+#include "Numa.hpp"
+#include "RegisterInterface.hpp"
+#include "UserInterruptBase.hpp"
+#include "Utils.hpp"
+
+namespace clap
+{
+// Strategy used to poll the status register of a core when no interrupt is set.
+// The status is polled back-to-back during the spin phase, yielding between polls during the
+// yield phase and afterwards sleeping between polls, starting with sleepStartUS and doubling the
+// sleep time after every unsuccessful poll up to sleepMaxUS.
+struct PollStrategy
+{
+	uint32_t spinTimeUS   = 0;
+	uint32_t yieldTimeUS  = 0;
+	uint32_t sleepStartUS = 10000;
+	uint32_t sleepMaxUS   = 10000;
+
+	static PollStrategy FixedSleep(const uint32_t& sleepUS)
+	{
+		PollStrategy strategy;
+		strategy.sleepStartUS = sleepUS;
+		strategy.sleepMaxUS   = sleepUS;
+		return strategy;
+	}
+
+	static PollStrategy Adaptive(const uint32_t& spinTimeUS = 50, const uint32_t& yieldTimeUS = 200, const uint32_t& sleepMaxUS = 1000)
+	{
+		PollStrategy strategy;
+		strategy.spinTimeUS   = spinTimeUS;
+		strategy.yieldTimeUS  = yieldTimeUS;
+		strategy.sleepStartUS = 1;
+		strategy.sleepMaxUS   = sleepMaxUS;
+		return strategy;
+	}
+};
+
+// Statistics about detected completions, all times in microseconds.
+// The detection delay is an upper bound of the time between the completion of the core
+// and its detection, i.e., the time between the last unsuccessful and the successful poll.
+// In interrupt mode only the wait times are recorded.
+struct CompletionStats
+{
+	uint64_t completions = 0;
+	uint64_t polls       = 0;
+	double totalWaitUS   = 0.0;
+	double minWaitUS     = 0.0;
+	double maxWaitUS     = 0.0;
+	double totalDetectUS = 0.0;
+	double maxDetectUS   = 0.0;
+
+	double GetAvgWaitUS() const
+	{
+		return (completions == 0 ? 0.0 : totalWaitUS / static_cast<double>(completions));
+	}
+
+	double GetAvgDetectUS() const
+	{
+		return (completions == 0 ? 0.0 : totalDetectUS / static_cast<double>(completions));
+	}
+
+	friend std::ostream& operator<<(std::ostream& stream, const CompletionStats& stats)
+	{
+		stream << "Completions: " << stats.completions << ", Polls: " << stats.polls
+			   << ", Wait (avg/min/max): " << stats.GetAvgWaitUS() << "/" << stats.minWaitUS << "/" << stats.maxWaitUS << " us"
+			   << ", Detection Delay (avg/max): " << stats.GetAvgDetectUS() << "/" << stats.maxDetectUS << " us";
+		return stream;
+	}
+};
+
+#ifndef EMBEDDED_XILINX
+namespace internal
+{
+class CompletionRecorder
+{
+	DISABLE_COPY_ASSIGN_MOVE(CompletionRecorder)
+
+public:
+	CompletionRecorder() :
+		m_stats(),
+		m_mtx()
+	{}
+
+	void Record(const uint64_t& polls, const double& waitUS, const double& detectUS)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+
+		m_stats.minWaitUS = (m_stats.completions == 0 ? waitUS : std::min(m_stats.minWaitUS, waitUS));
+		m_stats.maxWaitUS = std::max(m_stats.maxWaitUS, waitUS);
+		m_stats.totalWaitUS += waitUS;
+		m_stats.maxDetectUS = std::max(m_stats.maxDetectUS, detectUS);
+		m_stats.totalDetectUS += detectUS;
+		m_stats.polls += polls;
+		m_stats.completions++;
+	}
+
+	CompletionStats Get() const
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		return m_stats;
+	}
+
+	void Reset()
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_stats = CompletionStats();
+	}
+
+private:
+	CompletionStats m_stats;
+	mutable std::mutex m_mtx;
+};
+
+// Single thread servicing the completion detection of all active jobs (WatchDogs) of a CLAP instance.
+// Interrupts providing a pollable handle are multiplexed using epoll, all other interrupts are checked
+// whenever they notify the reactor and status registers are polled according to the strategy of the job.
+class CompletionReactor
+{
+	DISABLE_COPY_ASSIGN_MOVE(CompletionReactor)
+
+	using SteadyClock = std::chrono::steady_clock;
+
+public:
+	using JobID = uint64_t;
+	// Called for every detected completion, returns true if the job is done
+	using FinishCallback = std::function<bool(void)>;
+	// Called once the job is done or an exception occurred, not called for canceled jobs
+	using DoneCallback = std::function<void(std::exception_ptr)>;
+
+	struct JobDesc
+	{
+		std::string name              = "";
+		UserInterruptBase* pInterrupt = nullptr;
+		HasStatus* pStatus            = nullptr;
+		PollStrategy strategy         = {};
+		bool dontTerminate            = false;
+		FinishCallback finishCallback = nullptr;
+		DoneCallback doneCallback     = nullptr;
+		CompletionRecorder* pRecorder = nullptr;
+		CoreMetricsRecorder* pMetrics = nullptr;
+	};
+
+private:
+	struct Job
+	{
+		JobDesc desc                     = {};
+		DeviceHandle fd                  = INVALID_HANDLE;
+		bool interruptMode               = false;
+		bool ready                       = false;
+		bool yielding                    = false;
+		uint32_t sleepUS                 = 0;
+		uint64_t polls                   = 0;
+		SteadyClock::time_point start    = {};
+		SteadyClock::time_point lastPoll = {};
+		SteadyClock::time_point nextPoll = {};
+	};
+
+	static constexpr JobID WAKE_ID      = std::numeric_limits<JobID>::max();
+	static constexpr JobID TIMER_ID     = std::numeric_limits<JobID>::max() - 1;
+	static constexpr int32_t MAX_EVENTS = 32;
+
+public:
+	CompletionReactor() :
+		m_pending(),
+		m_cancelRequests(),
+		m_alive(),
+		m_jobs(),
+		m_thread(),
+		m_mtx(),
+		m_cv()
+#ifdef _WIN32
+		,
+		m_wakeMtx(),
+		m_wakeCv()
+#endif
+	{
+#ifndef _WIN32
+		m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+		m_wakeFd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		m_timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+		if (!DEVICE_HANDLE_VALID(m_epollFd) || !DEVICE_HANDLE_VALID(m_wakeFd) || !DEVICE_HANDLE_VALID(m_timerFd))
+		{
+			int32_t errsv = errno;
+			closeHandles();
+
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Failed to create the epoll, event or timer handle; errno: " << errsv;
+			throw CLAPException(ss.str());
+		}
+
+		addHandle(m_wakeFd, WAKE_ID);
+		addHandle(m_timerFd, TIMER_ID);
+#endif
+	}
+
+	~CompletionReactor()
+	{
+		stop();
+#ifndef _WIN32
+		closeHandles();
+#endif
+	}
+
+	// Registry used to collect the metrics of all jobs submitted to this reactor, see CLAP::GetMetrics
+	void SetMetricsRegistry(MetricsRegistryPtr pMetrics)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_pMetrics = std::move(pMetrics);
+	}
+
+	// Restricts the reactor thread to the given CPUs, takes effect immediately if the thread is already running
+	void SetThreadAffinity(const CpuSet& cpus)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_affinity = cpus;
+
+		if (m_running)
+			numa::PinThread(m_thread, m_affinity);
+	}
+
+	// Returns the recorder for the given job name, nullptr if no registry is set. The recorder lives as long as the reactor.
+	CoreMetricsRecorder* GetCoreMetricsRecorder(const std::string& name)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		return (m_pMetrics ? m_pMetrics->GetCoreRecorder(name) : nullptr);
+	}
+
+	JobID Submit(const JobDesc& desc)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+
+		// The reactor thread is only started once it is actually required
+		if (!m_running)
+		{
+			m_running = true;
+			m_thread  = std::thread(&CompletionReactor::run, this);
+
+			if (!m_affinity.empty())
+				numa::PinThread(m_thread, m_affinity);
+		}
+
+		const JobID id = m_nextID++;
+		m_pending.push_back(std::make_pair(id, desc));
+		m_alive.insert(id);
+		wake();
+
+		return id;
+	}
+
+	// Removes the job from the reactor, once this returns none of the callbacks of the job are running or will be called.
+	// Returns false if the job was already done.
+	bool Cancel(const JobID& id)
+	{
+		std::unique_lock<std::mutex> lock(m_mtx);
+
+		if (m_alive.count(id) == 0) return false;
+
+		auto it = std::find_if(m_pending.begin(), m_pending.end(), [&id](const std::pair<JobID, JobDesc>& p) { return p.first == id; });
+		if (it != m_pending.end())
+		{
+			m_pending.erase(it);
+			m_alive.erase(id);
+			return true;
+		}
+
+		m_cancelRequests.insert(id);
+		wake();
+
+		// When called from within a callback the job is skipped until it is removed by the reactor thread
+		if (std::this_thread::get_id() == m_thread.get_id())
+			return true;
+
+		m_cv.wait(lock, [this, &id] { return m_alive.count(id) == 0; });
+		return true;
+	}
+
+	bool IsActive(const JobID& id) const
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		return (m_alive.count(id) != 0);
+	}
+
+private:
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			if (!m_running) return;
+
+			m_running = false;
+			wake();
+		}
+
+		if (m_thread.joinable())
+			m_thread.join();
+
+		// Jobs that are not done yet fail, so that callers waiting for them do not block forever
+		std::vector<DoneCallback> callbacks;
+
+		for (auto& [id, job] : m_jobs)
+		{
+			releaseJob(job);
+
+			if (!isCanceled(id))
+				callbacks.push_back(job.desc.doneCallback);
+		}
+
+		m_jobs.clear();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			for (const auto& [id, desc] : m_pending)
+				callbacks.push_back(desc.doneCallback);
+
+			m_pending.clear();
+		}
+
+		if (!callbacks.empty())
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "The completion reactor was stopped before the job was done";
+			const std::exception_ptr pExcept = std::make_exception_ptr(CLAPException(ss.str()));
+
+			for (const DoneCallback& callback : callbacks)
+			{
+				if (callback)
+					callback(pExcept);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_cancelRequests.clear();
+		m_alive.clear();
+		m_cv.notify_all();
+	}
+
+	void run()
+	{
+		std::vector<std::pair<JobID, std::exception_ptr>> done;
+
+		while (sync())
+		{
+			for (auto& [id, job] : m_jobs)
+			{
+				if (isCanceled(id)) continue;
+
+				try
+				{
+					if (process(job))
+						done.push_back(std::make_pair(id, nullptr));
+				}
+				catch (...)
+				{
+					done.push_back(std::make_pair(id, std::current_exception()));
+				}
+			}
+
+			for (const auto& [id, pExcept] : done)
+				retire(id, pExcept);
+
+			done.clear();
+
+			waitForEvents();
+		}
+	}
+
+	// Picks up new and canceled jobs, returns false once the reactor is stopped
+	bool sync()
+	{
+		std::vector<std::pair<JobID, JobDesc>> pending;
+		std::set<JobID> canceled;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			if (!m_running) return false;
+
+			pending.swap(m_pending);
+			canceled.swap(m_cancelRequests);
+		}
+
+		for (const JobID& id : canceled)
+		{
+			auto it = m_jobs.find(id);
+			if (it == m_jobs.end()) continue;
+
+			releaseJob(it->second);
+			m_jobs.erase(it);
+		}
+
+		for (const auto& [id, desc] : pending)
+		{
+			try
+			{
+				addJob(id, desc);
+			}
+			catch (...)
+			{
+				retire(id, std::current_exception());
+			}
+		}
+
+		if (!canceled.empty())
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			for (const JobID& id : canceled)
+				m_alive.erase(id);
+
+			m_cv.notify_all();
+		}
+
+		return true;
+	}
+
+	bool isCanceled(const JobID& id) const
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		return (m_cancelRequests.count(id) != 0);
+	}
+
+	void addJob(const JobID& id, const JobDesc& desc)
+	{
+		Job& job          = m_jobs[id];
+		job.desc          = desc;
+		job.interruptMode = (desc.pInterrupt != nullptr && desc.pInterrupt->IsSet());
+
+		resetWait(job);
+
+		if (!job.interruptMode) return;
+
+#ifndef _WIN32
+		job.fd = desc.pInterrupt->GetPollHandle();
+
+		if (DEVICE_HANDLE_VALID(job.fd))
+			addHandle(job.fd, id);
+		else
+#endif
+			desc.pInterrupt->SetTriggerNotifier([this]() { wake(); });
+
+		desc.pInterrupt->Arm();
+	}
+
+	void releaseJob(Job& job)
+	{
+		if (!job.interruptMode) return;
+
+#ifndef _WIN32
+		if (DEVICE_HANDLE_VALID(job.fd))
+			removeHandle(job.fd);
+		else
+#endif
+			job.desc.pInterrupt->SetTriggerNotifier(nullptr);
+	}
+
+	void retire(const JobID& id, const std::exception_ptr& pExcept)
+	{
+		auto it = m_jobs.find(id);
+		if (it == m_jobs.end()) return;
+
+		releaseJob(it->second);
+		const DoneCallback callback = it->second.desc.doneCallback;
+		m_jobs.erase(it);
+
+		if (callback)
+			callback(pExcept);
+
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_alive.erase(id);
+		m_cv.notify_all();
+	}
+
+	void resetWait(Job& job)
+	{
+		job.start    = SteadyClock::now();
+		job.lastPoll = job.start;
+		job.nextPoll = job.start;
+		job.sleepUS  = job.desc.strategy.sleepStartUS;
+		job.polls    = 0;
+		job.yielding = false;
+	}
+
+	// Checks the job for a completion, returns true if the job is done
+	bool process(Job& job)
+	{
+		bool completed = false;
+
+		if (job.interruptMode)
+		{
+			// Pollable interrupts are only checked once epoll reported them as ready
+			if (DEVICE_HANDLE_VALID(job.fd) && !job.ready) return false;
+
+			job.ready = false;
+			job.polls++;
+			completed = job.desc.pInterrupt->WaitForInterrupt(0);
+		}
+		else if (job.desc.pStatus)
+		{
+			const SteadyClock::time_point now = SteadyClock::now();
+			if (now < job.nextPoll) return false;
+
+			job.polls++;
+			completed = job.desc.pStatus->PollDone();
+
+			if (!completed)
+			{
+				scheduleNextPoll(job, now);
+				job.lastPoll = now;
+			}
+		}
+
+		if (!completed) return false;
+
+		const SteadyClock::time_point now = SteadyClock::now();
+
+		if (job.desc.pRecorder)
+			job.desc.pRecorder->Record(job.polls, elapsedUS(job.start, now), (job.interruptMode ? 0.0 : elapsedUS(job.lastPoll, now)));
+
+		if (job.desc.pMetrics)
+			job.desc.pMetrics->Record(job.polls, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - job.start).count()), job.interruptMode);
+
+		bool end = !job.desc.dontTerminate;
+		if (job.desc.finishCallback)
+			end = job.desc.finishCallback();
+
+		if (!job.desc.dontTerminate || end) return true;
+
+		resetWait(job);
+
+		if (job.interruptMode)
+			job.desc.pInterrupt->Arm();
+
+		return false;
+	}
+
+	void scheduleNextPoll(Job& job, const SteadyClock::time_point& now)
+	{
+		const PollStrategy& strategy = job.desc.strategy;
+		const double elapsed         = elapsedUS(job.start, now);
+
+		job.yielding = false;
+
+		if (elapsed < strategy.spinTimeUS)
+		{
+			job.nextPoll = now;
+			return;
+		}
+
+		if (elapsed < static_cast<double>(strategy.spinTimeUS) + strategy.yieldTimeUS || job.sleepUS == 0)
+		{
+			job.nextPoll = now;
+			job.yielding = true;
+			return;
+		}
+
+		job.nextPoll = now + std::chrono::microseconds(job.sleepUS);
+		job.sleepUS  = std::min(job.sleepUS > std::numeric_limits<uint32_t>::max() / 2 ? std::numeric_limits<uint32_t>::max() : job.sleepUS * 2, strategy.sleepMaxUS);
+	}
+
+	// Determines the earliest status poll, returns false if no status has to be polled
+	bool nextDeadline(SteadyClock::time_point& deadline, bool& yield) const
+	{
+		bool found = false;
+		bool spin  = false;
+		yield      = false;
+
+		for (const auto& [id, job] : m_jobs)
+		{
+			if (job.interruptMode) continue;
+
+			if (!found || job.nextPoll < deadline)
+				deadline = job.nextPoll;
+
+			if (job.nextPoll <= SteadyClock::now())
+			{
+				spin |= !job.yielding;
+				yield |= job.yielding;
+			}
+
+			found = true;
+		}
+
+		// Only yield if none of the jobs is still in its spin phase
+		yield = (yield && !spin);
+
+		return found;
+	}
+
+	void waitForEvents()
+	{
+		SteadyClock::time_point deadline;
+		bool yield         = false;
+		const bool polling = nextDeadline(deadline, yield);
+
+		if (yield)
+			std::this_thread::yield();
+
+#ifndef _WIN32
+		int32_t timeoutMS = -1;
+
+		if (polling)
+		{
+			const SteadyClock::time_point now = SteadyClock::now();
+
+			if (deadline <= now)
+				timeoutMS = 0;
+			else
+				armTimer(std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now).count());
+		}
+
+		struct epoll_event events[MAX_EVENTS];
+		const int32_t cnt = epoll_wait(m_epollFd, events, MAX_EVENTS, timeoutMS);
+
+		for (int32_t i = 0; i < cnt; i++)
+		{
+			const JobID id = events[i].data.u64;
+			uint64_t val;
+
+			if (id == WAKE_ID)
+			{
+				if (::read(m_wakeFd, &val, sizeof(val)) < 0) continue;
+			}
+			else if (id == TIMER_ID)
+			{
+				if (::read(m_timerFd, &val, sizeof(val)) < 0) continue;
+			}
+			else
+			{
+				auto it = m_jobs.find(id);
+				if (it != m_jobs.end())
+					it->second.ready = true;
+			}
+		}
+#else
+		std::unique_lock<std::mutex> lock(m_wakeMtx);
+
+		if (!m_wakePending)
+		{
+			if (polling)
+				m_wakeCv.wait_until(lock, deadline, [this] { return m_wakePending; });
+			else
+				m_wakeCv.wait(lock, [this] { return m_wakePending; });
+		}
+
+		m_wakePending = false;
+#endif
+	}
+
+	void wake()
+	{
+#ifndef _WIN32
+		const uint64_t val = 1;
+		if (::write(m_wakeFd, &val, sizeof(val)) < 0)
+			CLAP_CLASS_LOG_ERROR << "Failed to wake up the reactor thread" << std::endl;
+#else
+		{
+			std::lock_guard<std::mutex> lock(m_wakeMtx);
+			m_wakePending = true;
+		}
+		m_wakeCv.notify_one();
+#endif
+	}
+
+#ifndef _WIN32
+	void addHandle(const DeviceHandle& fd, const JobID& id)
+	{
+		struct epoll_event ev = {};
+		ev.events             = EPOLLIN;
+		ev.data.u64           = id;
+
+		if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Failed to add handle " << fd << " to epoll; errno: " << errno;
+			throw CLAPException(ss.str());
+		}
+	}
+
+	void removeHandle(const DeviceHandle& fd)
+	{
+		// The handle might already be closed, which implicitly removes it from the epoll set
+		epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+	}
+
+	void armTimer(const int64_t& ns)
+	{
+		struct itimerspec spec = {};
+		spec.it_value.tv_sec   = ns / 1000000000;
+		spec.it_value.tv_nsec  = ns % 1000000000;
+
+		timerfd_settime(m_timerFd, 0, &spec, nullptr);
+	}
+
+	void closeHandles()
+	{
+		CloseDevice(m_timerFd);
+		CloseDevice(m_wakeFd);
+		CloseDevice(m_epollFd);
+	}
+#endif
+
+	static double elapsedUS(const SteadyClock::time_point& start, const SteadyClock::time_point& end)
+	{
+		return std::chrono::duration<double, std::micro>(end - start).count();
+	}
+
+private:
+	std::vector<std::pair<JobID, JobDesc>> m_pending;
+	std::set<JobID> m_cancelRequests;
+	std::set<JobID> m_alive;
+	std::map<JobID, Job> m_jobs;
+	std::thread m_thread;
+	mutable std::mutex m_mtx;
+	std::condition_variable m_cv;
+	MetricsRegistryPtr m_pMetrics = nullptr;
+	CpuSet m_affinity             = {};
+	JobID m_nextID                = 1;
+	bool m_running                = false;
+#ifndef _WIN32
+	DeviceHandle m_epollFd = INVALID_HANDLE;
+	DeviceHandle m_wakeFd  = INVALID_HANDLE;
+	DeviceHandle m_timerFd = INVALID_HANDLE;
+#else
+	std::mutex m_wakeMtx;
+	std::condition_variable m_wakeCv;
+	bool m_wakePending = false;
+#endif
+};
+
+using CompletionReactorPtr = std::shared_ptr<CompletionReactor>;
+} // namespace internal
+#else
+namespace internal
+{
+// Bare metal does not use a reactor, this only keeps the interface identical
+using CompletionReactorPtr = std::shared_ptr<void>;
+} // namespace internal
+#endif // EMBEDDED_XILINX
+} // namespace clap
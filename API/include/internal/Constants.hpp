@@ -57,10 +57,14 @@ inline constexpr uint32_t MINUS_ONE_U = 0xFFFFFFFF;
  *	systems.)
  */
 inline constexpr uint32_t RW_MAX_SIZE = 0x7ffff000;
+
+inline constexpr uint32_t XDMA_MAX_CHANNELS            = 4;        // The XDMA IP supports up to 4 H2C and 4 C2H channels
+inline constexpr uint64_t XDMA_DEFAULT_MIN_STRIPE_SIZE = 0x400000; // 4 MiB
 } // namespace internal
 
-inline constexpr uint32_t USE_AUTO_DETECT = internal::MINUS_ONE_U;
-inline constexpr int32_t INTR_UNDEFINED  = internal::MINUS_ONE_S;
-inline constexpr uint32_t UNSET_INTR_MASK = 0;
+inline constexpr uint32_t USE_AUTO_DETECT   = internal::MINUS_ONE_U;
+inline constexpr int32_t INTR_UNDEFINED    = internal::MINUS_ONE_S;
+inline constexpr uint32_t UNSET_INTR_MASK   = 0;
+inline constexpr uint32_t XDMA_ALL_CHANNELS = internal::MINUS_ONE_U - 1; // Opens all available XDMA channels and stripes large transfers across them
 
 } // namespace clap
\ No newline at end of file
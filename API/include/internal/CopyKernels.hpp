@@ -0,0 +1,516 @@
+/*
+ *  File: CopyKernels.hpp
+ *  Copyright (c) 2024 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+// Kernels moving data between host memory and memory-mapped device memory (UIO, /dev/mem, bare metal).
+// The vector kernels are selected at runtime based on the features of the CPU.
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <sstream>
+#include <vector>
+
+#include "Exceptions.hpp"
+#include "Timer.hpp"
+#include "Utils.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CLAP_COPY_X86
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CLAP_COPY_NEON
+#endif
+
+namespace clap
+{
+enum class CopyKernel
+{
+	MemCpy,   // std::memcpy, the width of the accesses is up to the C library
+	Fixed32,  // Only 32-bit accesses, for AXI slaves that do not support other access widths, address and size have to be 4 byte aligned
+	Fixed64,  // Only 64-bit accesses, address and size have to be 8 byte aligned
+	Vector,   // Widest vector loads and stores supported by the CPU (AVX, SSE2, NEON)
+	Streaming // Non-temporal vector loads and stores bypassing the cache, e.g., for write-combined mappings
+};
+
+inline const char* ToString(const CopyKernel& kernel)
+{
+	switch (kernel)
+	{
+		case CopyKernel::MemCpy:
+			return "MemCpy";
+		case CopyKernel::Fixed32:
+			return "Fixed32";
+		case CopyKernel::Fixed64:
+			return "Fixed64";
+		case CopyKernel::Vector:
+			return "Vector";
+		case CopyKernel::Streaming:
+			return "Streaming";
+	}
+
+	return "Unknown";
+}
+
+inline std::ostream& operator<<(std::ostream& os, const CopyKernel& kernel)
+{
+	os << ToString(kernel);
+	return os;
+}
+
+struct CopyKernelResult
+{
+	CopyKernel kernel = CopyKernel::MemCpy;
+	double readMBs    = 0.0; // Device to host
+	double writeMBs   = 0.0; // Host to device
+};
+
+using CopyKernelResults = std::vector<CopyKernelResult>;
+
+namespace internal
+{
+struct CpuFeatures
+{
+	bool sse2  = false;
+	bool sse41 = false;
+	bool avx   = false;
+	bool neon  = false;
+
+	static const CpuFeatures& Get()
+	{
+		static const CpuFeatures features = detect();
+		return features;
+	}
+
+private:
+	static CpuFeatures detect()
+	{
+		CpuFeatures features;
+#if defined(CLAP_COPY_X86)
+		__builtin_cpu_init();
+		features.sse2  = __builtin_cpu_supports("sse2");
+		features.sse41 = __builtin_cpu_supports("sse4.1");
+		features.avx   = __builtin_cpu_supports("avx");
+#elif defined(CLAP_COPY_NEON)
+		features.neon = true;
+#endif
+		return features;
+	}
+};
+
+// Width of the vector accesses of the Vector and Streaming kernels, 0 if the CPU has no supported vector unit
+inline std::size_t VectorWidth(const CopyKernel& kernel)
+{
+	const CpuFeatures& cpu = CpuFeatures::Get();
+
+	if (kernel == CopyKernel::Streaming)
+	{
+#if defined(CLAP_COPY_X86)
+		return (cpu.avx ? 32 : (cpu.sse41 ? 16 : 0));
+#elif defined(CLAP_COPY_NEON) && defined(__aarch64__)
+		return 16;
+#else
+		return 0;
+#endif
+	}
+
+	if (cpu.avx) return 32;
+	if (cpu.sse2 || cpu.neon) return 16;
+
+	return 0;
+}
+
+// Width of the accesses of the fixed-width kernels, 0 for all other kernels
+inline std::size_t FixedWidth(const CopyKernel& kernel)
+{
+	if (kernel == CopyKernel::Fixed32) return sizeof(uint32_t);
+	if (kernel == CopyKernel::Fixed64) return sizeof(uint64_t);
+
+	return 0;
+}
+
+// Whether the kernel can copy the given device range, the fixed-width kernels never fall back to narrower accesses
+inline bool SupportsRange(const CopyKernel& kernel, const void* pDev, const uint64_t& sizeInByte)
+{
+	const std::size_t width = FixedWidth(kernel);
+	return (width == 0 || (reinterpret_cast<uintptr_t>(pDev) % width == 0 && sizeInByte % width == 0));
+}
+
+inline std::vector<CopyKernel> AvailableCopyKernels()
+{
+	std::vector<CopyKernel> kernels = { CopyKernel::MemCpy, CopyKernel::Fixed32, CopyKernel::Fixed64 };
+
+	if (VectorWidth(CopyKernel::Vector) != 0) kernels.push_back(CopyKernel::Vector);
+	if (VectorWidth(CopyKernel::Streaming) != 0) kernels.push_back(CopyKernel::Streaming);
+
+	return kernels;
+}
+
+namespace copy
+{
+inline void checkRange(const CopyKernel& kernel, const void* pDev, const uint64_t& sizeInByte)
+{
+	if (SupportsRange(kernel, pDev, sizeInByte)) return;
+
+	std::stringstream ss;
+	ss << CLASS_TAG("CopyKernels") << "The " << kernel << " kernel only performs " << FixedWidth(kernel) * 8 << "-bit accesses, but the device address (0x" << std::hex
+	   << reinterpret_cast<uintptr_t>(pDev) << ") or the size (0x" << sizeInByte << std::dec << ") is not a multiple of " << FixedWidth(kernel) << " byte";
+	throw CLAPException(ss.str());
+}
+
+template<typename T>
+inline void readOne(uint8_t* pDst, const uint8_t* pDev)
+{
+	const T value = *reinterpret_cast<const volatile T*>(pDev);
+	std::memcpy(pDst, &value, sizeof(T));
+}
+
+template<typename T>
+inline void writeOne(uint8_t* pDev, const uint8_t* pSrc)
+{
+	T value;
+	std::memcpy(&value, pSrc, sizeof(T));
+	*reinterpret_cast<volatile T*>(pDev) = value;
+}
+
+// Widest access of at most maxWidth byte that is naturally aligned regarding the device address
+inline std::size_t stepWidth(const uint8_t* pDev, const uint64_t& remaining, const std::size_t& maxWidth)
+{
+	const uintptr_t addr = reinterpret_cast<uintptr_t>(pDev);
+
+	for (std::size_t width = maxWidth; width > 1; width /= 2)
+	{
+		if (remaining >= width && addr % width == 0) return width;
+	}
+
+	return 1;
+}
+
+inline std::size_t readStep(uint8_t* pDst, const uint8_t* pDev, const uint64_t& remaining, const std::size_t& maxWidth)
+{
+	const std::size_t width = stepWidth(pDev, remaining, maxWidth);
+
+	switch (width)
+	{
+		case 8:
+			readOne<uint64_t>(pDst, pDev);
+			break;
+		case 4:
+			readOne<uint32_t>(pDst, pDev);
+			break;
+		case 2:
+			readOne<uint16_t>(pDst, pDev);
+			break;
+		default:
+			readOne<uint8_t>(pDst, pDev);
+			break;
+	}
+
+	return width;
+}
+
+inline std::size_t writeStep(uint8_t* pDev, const uint8_t* pSrc, const uint64_t& remaining, const std::size_t& maxWidth)
+{
+	const std::size_t width = stepWidth(pDev, remaining, maxWidth);
+
+	switch (width)
+	{
+		case 8:
+			writeOne<uint64_t>(pDev, pSrc);
+			break;
+		case 4:
+			writeOne<uint32_t>(pDev, pSrc);
+			break;
+		case 2:
+			writeOne<uint16_t>(pDev, pSrc);
+			break;
+		default:
+			writeOne<uint8_t>(pDev, pSrc);
+			break;
+	}
+
+	return width;
+}
+
+// Copies count elements of type T, the device pointer is aligned to sizeof(T)
+template<typename T>
+inline void readFixed(uint8_t* pDst, const uint8_t* pDev, const uint64_t& count)
+{
+	const volatile T* pD = reinterpret_cast<const volatile T*>(pDev);
+
+	for (uint64_t i = 0; i < count; i++)
+	{
+		const T value = pD[i];
+		std::memcpy(pDst + i * sizeof(T), &value, sizeof(T));
+	}
+}
+
+template<typename T>
+inline void writeFixed(uint8_t* pDev, const uint8_t* pSrc, const uint64_t& count)
+{
+	volatile T* pD = reinterpret_cast<volatile T*>(pDev);
+
+	for (uint64_t i = 0; i < count; i++)
+	{
+		T value;
+		std::memcpy(&value, pSrc + i * sizeof(T), sizeof(T));
+		pD[i] = value;
+	}
+}
+
+// Copies count blocks of width byte, the device pointer is aligned to width, the host pointer can be unaligned
+#if defined(CLAP_COPY_X86)
+inline void readVector16(uint8_t* pDst, const uint8_t* pDev, const uint64_t& count)
+{
+	for (uint64_t i = 0; i < count; i++)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i * 16), _mm_load_si128(reinterpret_cast<const __m128i*>(pDev + i * 16)));
+}
+
+inline void writeVector16(uint8_t* pDev, const uint8_t* pSrc, const uint64_t& count)
+{
+	for (uint64_t i = 0; i < count; i++)
+		_mm_store_si128(reinterpret_cast<__m128i*>(pDev + i * 16), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i * 16)));
+}
+
+__attribute__((target("avx"))) inline void readVector32(uint8_t* pDst, const uint8_t* pDev, const uint64_t& count)
+{
+	for (uint64_t i = 0; i < count; i++)
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + i * 32), _mm256_load_si256(reinterpret_cast<const __m256i*>(pDev + i * 32)));
+}
+
+__attribute__((target("avx"))) inline void writeVector32(uint8_t* pDev, const uint8_t* pSrc, const uint64_t& count)
+{
+	for (uint64_t i = 0; i < count; i++)
+		_mm256_store_si256(reinterpret_cast<__m256i*>(pDev + i * 32), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + i * 32)));
+}
+
+// Non-temporal loads only have an effect on write-combined memory, where they avoid the uncached read path
+__attribute__((target("sse4.1"))) inline void readStreaming16(uint8_t* pDst, const uint8_t* pDev, const uint64_t& count)
+{
+	for (uint64_t i = 0; i < count; i++)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i * 16), _mm_stream_load_si128(reinterpret_cast<__m128i*>(const_cast<uint8_t*>(pDev + i * 16))));
+}
+
+inline void writeStreaming16(uint8_t* pDev, const uint8_t* pSrc, const uint64_t& count)
+{
+	for (uint64_t i = 0; i < count; i++)
+		_mm_stream_si128(reinterpret_cast<__m128i*>(pDev + i * 16), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i * 16)));
+
+	_mm_sfence();
+}
+
+__attribute__((target("avx"))) inline void writeStreaming32(uint8_t* pDev, const uint8_t* pSrc, const uint64_t& count)
+{
+	for (uint64_t i = 0; i < count; i++)
+		_mm256_stream_si256(reinterpret_cast<__m256i*>(pDev + i * 32), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + i * 32)));
+
+	_mm_sfence();
+}
+
+inline void readBlocks(uint8_t* pDst, const uint8_t* pDev, const uint64_t& count, const std::size_t& width, const bool& streaming)
+{
+	if (streaming && width == 16)
+		readStreaming16(pDst, pDev, count);
+	else if (streaming)
+		// AVX lacks a 256-bit non-temporal load, two 128-bit ones are used instead
+		readStreaming16(pDst, pDev, count * 2);
+	else if (width == 32)
+		readVector32(pDst, pDev, count);
+	else
+		readVector16(pDst, pDev, count);
+}
+
+inline void writeBlocks(uint8_t* pDev, const uint8_t* pSrc, const uint64_t& count, const std::size_t& width, const bool& streaming)
+{
+	if (streaming && width == 32)
+		writeStreaming32(pDev, pSrc, count);
+	else if (streaming)
+		writeStreaming16(pDev, pSrc, count);
+	else if (width == 32)
+		writeVector32(pDev, pSrc, count);
+	else
+		writeVector16(pDev, pSrc, count);
+}
+#elif defined(CLAP_COPY_NEON)
+inline void readBlocks(uint8_t* pDst, const uint8_t* pDev, const uint64_t& count, [[maybe_unused]] const std::size_t& width, [[maybe_unused]] const bool& streaming)
+{
+	for (uint64_t i = 0; i < count; i++)
+	{
+#if defined(__aarch64__)
+		if (streaming)
+		{
+			uint64_t lo, hi;
+			asm volatile("ldnp %0, %1, [%2]" : "=r"(lo), "=r"(hi) : "r"(pDev + i * 16) : "memory");
+			std::memcpy(pDst + i * 16, &lo, sizeof(lo));
+			std::memcpy(pDst + i * 16 + 8, &hi, sizeof(hi));
+			continue;
+		}
+#endif
+		vst1q_u8(pDst + i * 16, vld1q_u8(pDev + i * 16));
+	}
+}
+
+inline void writeBlocks(uint8_t* pDev, const uint8_t* pSrc, const uint64_t& count, [[maybe_unused]] const std::size_t& width, [[maybe_unused]] const bool& streaming)
+{
+	for (uint64_t i = 0; i < count; i++)
+	{
+#if defined(__aarch64__)
+		if (streaming)
+		{
+			uint64_t lo, hi;
+			std::memcpy(&lo, pSrc + i * 16, sizeof(lo));
+			std::memcpy(&hi, pSrc + i * 16 + 8, sizeof(hi));
+			asm volatile("stnp %0, %1, [%2]" : : "r"(lo), "r"(hi), "r"(pDev + i * 16) : "memory");
+			continue;
+		}
+#endif
+		vst1q_u8(pDev + i * 16, vld1q_u8(pSrc + i * 16));
+	}
+}
+#else
+// Never called, VectorWidth is 0 without a supported vector unit
+inline void readBlocks(uint8_t*, const uint8_t*, const uint64_t&, const std::size_t&, const bool&) {}
+inline void writeBlocks(uint8_t*, const uint8_t*, const uint64_t&, const std::size_t&, const bool&) {}
+#endif
+} // namespace copy
+
+// Copies sizeInByte byte from the device memory pDev to the host memory pDst
+inline void CopyFromDevice(void* pDst, const void* pDev, const uint64_t& sizeInByte, const CopyKernel& kernel)
+{
+	uint8_t* pD       = reinterpret_cast<uint8_t*>(pDst);
+	const uint8_t* pS = reinterpret_cast<const uint8_t*>(pDev);
+
+	if (kernel == CopyKernel::MemCpy)
+	{
+		std::memcpy(pD, pS, sizeInByte);
+		return;
+	}
+
+	copy::checkRange(kernel, pS, sizeInByte);
+
+	const std::size_t vecWidth = (kernel == CopyKernel::Vector || kernel == CopyKernel::Streaming ? VectorWidth(kernel) : 0);
+	const std::size_t maxWidth = (kernel == CopyKernel::Fixed32 ? sizeof(uint32_t) : sizeof(uint64_t));
+	uint64_t count             = 0;
+
+	// Scalar head, only required for the vector kernels until the device address is aligned to the width of the body accesses
+	const std::size_t bodyWidth = (vecWidth != 0 ? vecWidth : maxWidth);
+
+	while (count < sizeInByte && reinterpret_cast<uintptr_t>(pS + count) % bodyWidth != 0)
+		count += copy::readStep(pD + count, pS + count, sizeInByte - count, maxWidth);
+
+	const uint64_t blocks = (sizeInByte - count) / bodyWidth;
+
+	if (vecWidth != 0)
+		copy::readBlocks(pD + count, pS + count, blocks, vecWidth, kernel == CopyKernel::Streaming);
+	else if (bodyWidth == sizeof(uint64_t))
+		copy::readFixed<uint64_t>(pD + count, pS + count, blocks);
+	else
+		copy::readFixed<uint32_t>(pD + count, pS + count, blocks);
+
+	count += blocks * bodyWidth;
+
+	while (count < sizeInByte)
+		count += copy::readStep(pD + count, pS + count, sizeInByte - count, maxWidth);
+}
+
+// Copies sizeInByte byte from the host memory pSrc to the device memory pDev
+inline void CopyToDevice(void* pDev, const void* pSrc, const uint64_t& sizeInByte, const CopyKernel& kernel)
+{
+	uint8_t* pD       = reinterpret_cast<uint8_t*>(pDev);
+	const uint8_t* pS = reinterpret_cast<const uint8_t*>(pSrc);
+
+	if (kernel == CopyKernel::MemCpy)
+	{
+		std::memcpy(pD, pS, sizeInByte);
+		return;
+	}
+
+	copy::checkRange(kernel, pD, sizeInByte);
+
+	const std::size_t vecWidth = (kernel == CopyKernel::Vector || kernel == CopyKernel::Streaming ? VectorWidth(kernel) : 0);
+	const std::size_t maxWidth = (kernel == CopyKernel::Fixed32 ? sizeof(uint32_t) : sizeof(uint64_t));
+	uint64_t count             = 0;
+
+	const std::size_t bodyWidth = (vecWidth != 0 ? vecWidth : maxWidth);
+
+	while (count < sizeInByte && reinterpret_cast<uintptr_t>(pD + count) % bodyWidth != 0)
+		count += copy::writeStep(pD + count, pS + count, sizeInByte - count, maxWidth);
+
+	const uint64_t blocks = (sizeInByte - count) / bodyWidth;
+
+	if (vecWidth != 0)
+		copy::writeBlocks(pD + count, pS + count, blocks, vecWidth, kernel == CopyKernel::Streaming);
+	else if (bodyWidth == sizeof(uint64_t))
+		copy::writeFixed<uint64_t>(pD + count, pS + count, blocks);
+	else
+		copy::writeFixed<uint32_t>(pD + count, pS + count, blocks);
+
+	count += blocks * bodyWidth;
+
+	while (count < sizeInByte)
+		count += copy::writeStep(pD + count, pS + count, sizeInByte - count, maxWidth);
+}
+
+#ifndef EMBEDDED_XILINX
+// Measures the throughput of all kernels supported by the CPU on the given mapped device memory, the memory is overwritten
+inline CopyKernelResults BenchmarkCopyKernels(void* pDev, const uint64_t& sizeInByte, const uint32_t& iterations)
+{
+	CopyKernelResults results;
+	std::vector<uint8_t> host(sizeInByte, 0x5A);
+
+	const auto measure = [&](const auto& op) {
+		op(); // Warmup
+
+		Timer timer;
+		timer.Start();
+
+		for (uint32_t i = 0; i < iterations; i++)
+			op();
+
+		timer.Stop();
+
+		const double us = static_cast<double>(timer.GetElapsedTimeInNanoSec()) / 1000.0;
+		return (us <= 0.0 ? 0.0 : static_cast<double>(sizeInByte) * iterations / us);
+	};
+
+	for (const CopyKernel& kernel : AvailableCopyKernels())
+	{
+		if (!SupportsRange(kernel, pDev, sizeInByte)) continue;
+
+		CopyKernelResult res;
+		res.kernel   = kernel;
+		res.writeMBs = measure([&]() { CopyToDevice(pDev, host.data(), sizeInByte, kernel); });
+		res.readMBs  = measure([&]() { CopyFromDevice(host.data(), pDev, sizeInByte, kernel); });
+		results.push_back(res);
+	}
+
+	return results;
+}
+#endif
+} // namespace internal
+} // namespace clap
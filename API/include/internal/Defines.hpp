@@ -45,7 +45,7 @@ using ByteCntType  = DWORD;
 #define CLOSE_DEVICE(HANDLE)     CloseHandle(HANDLE)
 #define SEEK(HANDLE, OFFSET)     SetFilePointer(HANDLE, OFFSET, NULL, FILE_BEGIN)
 #define SEEK_INVALID(RC, OFFSET) (RC == INVALID_SET_FILE_POINTER)
-#define CTRL_OPEN_FLAGS          (DEFAULT_OPEN_FLAGS | FILE_FLAG_OVERLAPPED)
+#define CTRL_OPEN_FLAGS          DEFAULT_OPEN_FLAGS
 #else
 #include <cstdint>
 #include <sys/types.h>
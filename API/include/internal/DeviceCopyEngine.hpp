@@ -0,0 +1,52 @@
+/*
+ *  File: DeviceCopyEngine.hpp
+ *  Copyright (c) 2024 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "Utils.hpp"
+
+namespace clap
+{
+namespace internal
+{
+// Engine copying between two device addresses without moving the data through the host, e.g., an AxiCDMA core.
+// Set on a CLAP instance it is used by CLAP::CopyMemory.
+class DeviceCopyEngine
+{
+	DISABLE_COPY_ASSIGN_MOVE(DeviceCopyEngine)
+
+public:
+	DeviceCopyEngine() {}
+
+	virtual ~DeviceCopyEngine() = default;
+
+	// Blocks until the copy is completed, throws on failure
+	virtual void CopyDeviceMemory(const uint64_t& srcAddr, const uint64_t& dstAddr, const uint64_t& sizeInByte) = 0;
+};
+} // namespace internal
+} // namespace clap
@@ -0,0 +1,363 @@
+/*
+ *  File: DeviceLock.hpp
+ *  Copyright (c) 2023 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+// Cross-process locking of devices and address ranges. Every device (identified by its backend and device number)
+// has a lock file, which is locked using flock, either exclusively or shared. Address ranges are locked using open
+// file description locks on byte ranges of the same file, offset by the address. Both kinds of locks are released by
+// the kernel once the process terminates, therefore, stale lock files do not block later runs.
+
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Defines.hpp"
+#include "Exceptions.hpp"
+#include "Logger.hpp"
+#include "Types.hpp"
+#include "Utils.hpp"
+
+#ifndef CLAP_LOCK_DIR
+#define CLAP_LOCK_DIR "/tmp"
+#endif
+
+namespace clap
+{
+namespace internal
+{
+class DeviceLock;
+
+inline constexpr int32_t INVALID_LOCK_FD = -1;
+// The owner PID is written padded to a fixed width, so that a shorter PID overwrites a longer one completely
+inline constexpr std::size_t LOCK_OWNER_FIELD_SIZE = 20;
+} // namespace internal
+
+// Lock of an address range of a device, the range is unlocked once the object is destroyed
+class AddressRangeLock
+{
+	friend class internal::DeviceLock;
+
+public:
+	AddressRangeLock() = default;
+
+	~AddressRangeLock()
+	{
+		release();
+	}
+
+	AddressRangeLock(const AddressRangeLock&)            = delete;
+	AddressRangeLock& operator=(const AddressRangeLock&) = delete;
+
+	AddressRangeLock(AddressRangeLock&& other) noexcept :
+		m_fd(other.m_fd),
+		m_addr(other.m_addr),
+		m_size(other.m_size)
+	{
+		other.m_fd = internal::INVALID_LOCK_FD;
+	}
+
+	AddressRangeLock& operator=(AddressRangeLock&& other) noexcept
+	{
+		if (this != &other)
+		{
+			release();
+			m_fd       = other.m_fd;
+			m_addr     = other.m_addr;
+			m_size     = other.m_size;
+			other.m_fd = internal::INVALID_LOCK_FD;
+		}
+
+		return *this;
+	}
+
+	bool IsLocked() const
+	{
+		return m_fd != internal::INVALID_LOCK_FD;
+	}
+
+	const uint64_t& GetBaseAddr() const
+	{
+		return m_addr;
+	}
+
+	const uint64_t& GetSize() const
+	{
+		return m_size;
+	}
+
+private:
+	AddressRangeLock(const int32_t& fd, const uint64_t& addr, const uint64_t& size) :
+		m_fd(fd),
+		m_addr(addr),
+		m_size(size)
+	{}
+
+	void release()
+	{
+#ifndef _WIN32
+		// Closing the only descriptor of the open file description releases its range lock
+		if (m_fd != internal::INVALID_LOCK_FD)
+			close(m_fd);
+#endif
+		m_fd = internal::INVALID_LOCK_FD;
+	}
+
+private:
+	int32_t m_fd    = internal::INVALID_LOCK_FD;
+	uint64_t m_addr = 0;
+	uint64_t m_size = 0;
+};
+
+namespace internal
+{
+class DeviceLock
+{
+	DISABLE_COPY_ASSIGN_MOVE(DeviceLock)
+
+	using DeviceLockPtr = std::shared_ptr<DeviceLock>;
+
+public:
+	// CLAP instances of the same process opening the same device share its lock,
+	// a different process (including a forked child) opening the device in a conflicting mode is rejected
+	static DeviceLockPtr Acquire(const std::string& backendName, const uint32_t& devNum, const DeviceAccess& access)
+	{
+		static std::mutex mtx;
+		static std::map<std::string, std::weak_ptr<DeviceLock>> locks;
+
+		const std::string fileName = LockFileName(backendName, devNum);
+
+		std::lock_guard<std::mutex> lock(mtx);
+
+		DeviceLockPtr pLock = locks[fileName].lock();
+		if (pLock && pLock->m_pid == currentPID())
+		{
+			if (pLock->m_access != access)
+			{
+				std::stringstream ss;
+				ss << CLASS_TAG("DeviceLock") << "Device " << devNum << " of the " << backendName << " backend is already opened by this process with a different access mode";
+				throw CLAPException(ss.str());
+			}
+
+			return pLock;
+		}
+
+		pLock           = DeviceLockPtr(new DeviceLock(fileName, access));
+		locks[fileName] = pLock;
+
+		return pLock;
+	}
+
+	static std::string LockFileName(const std::string& backendName, const uint32_t& devNum)
+	{
+		std::string name = backendName;
+		for (char& c : name)
+		{
+			if (!std::isalnum(static_cast<unsigned char>(c)))
+				c = '_';
+		}
+
+		return std::string(CLAP_LOCK_DIR) + "/clap_" + name + "_" + std::to_string(devNum) + ".lock";
+	}
+
+	~DeviceLock()
+	{
+#ifndef _WIN32
+		if (m_fd != INVALID_LOCK_FD)
+			close(m_fd);
+#endif
+	}
+
+	AddressRangeLock LockRange(const uint64_t& addr, const uint64_t& sizeInByte)
+	{
+		if (sizeInByte == 0 || addr > static_cast<uint64_t>(INT64_MAX) - sizeInByte)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Invalid address range, address: 0x" << std::hex << addr << ", size: 0x" << sizeInByte;
+			throw CLAPException(ss.str());
+		}
+
+#ifdef _WIN32
+		CLAP_CLASS_LOG_WARNING << "Address range locks are not supported on Windows, the range is not locked" << std::endl;
+		return AddressRangeLock();
+#else
+		// Every range lock uses its own open file description, so that overlapping ranges are also detected within the process
+		const int32_t fd = openLockFile();
+
+		struct flock fl = {};
+		fl.l_type       = F_WRLCK;
+		fl.l_whence     = SEEK_SET;
+		fl.l_start      = static_cast<off_t>(addr);
+		fl.l_len        = static_cast<off_t>(sizeInByte);
+
+#ifdef F_OFD_SETLK
+		const int32_t res = fcntl(fd, F_OFD_SETLK, &fl);
+#else
+		const int32_t res = fcntl(fd, F_SETLK, &fl);
+#endif
+
+		if (res != 0)
+		{
+			const int32_t err = errno;
+			close(fd);
+
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Unable to lock the address range 0x" << std::hex << addr << " - 0x" << addr + sizeInByte - 1 << std::dec;
+			if (err == EACCES || err == EAGAIN)
+				ss << ", the range overlaps with a range locked by another CLAP instance";
+			else
+				ss << " (" << std::strerror(err) << ")";
+			throw CLAPException(ss.str());
+		}
+
+		return AddressRangeLock(fd, addr, sizeInByte);
+#endif
+	}
+
+	const DeviceAccess& GetAccess() const
+	{
+		return m_access;
+	}
+
+	const std::string& GetFileName() const
+	{
+		return m_fileName;
+	}
+
+private:
+	DeviceLock(const std::string& fileName, const DeviceAccess& access) :
+		m_fileName(fileName),
+		m_access(access),
+		m_pid(currentPID())
+	{
+#ifdef _WIN32
+		CLAP_CLASS_LOG_WARNING << "Device locks are not supported on Windows, the device is not locked" << std::endl;
+#else
+		m_fd = openLockFile();
+
+		if (flock(m_fd, (access == DeviceAccess::Shared ? LOCK_SH : LOCK_EX) | LOCK_NB) != 0)
+		{
+			const int32_t err       = errno;
+			const std::string owner = readOwner();
+			close(m_fd);
+			m_fd = INVALID_LOCK_FD;
+
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Unable to lock " << m_fileName;
+			if (err == EWOULDBLOCK)
+				ss << ", the device is already in use by another process" << (owner.empty() ? "" : " (PID: " + owner + ")");
+			else
+				ss << " (" << std::strerror(err) << ")";
+			throw CLAPException(ss.str());
+		}
+
+		// Only an exclusive owner is recorded, shared users are identified by their range locks and clear a stale owner
+		std::string owner = (access == DeviceAccess::Exclusive ? std::to_string(getpid()) : std::string());
+		owner.resize(LOCK_OWNER_FIELD_SIZE, ' ');
+		if (pwrite(m_fd, owner.data(), owner.size(), 0) != static_cast<ssize_t>(owner.size()))
+			CLAP_CLASS_LOG_DEBUG << "Unable to write the PID to " << m_fileName << std::endl;
+#endif
+	}
+
+	static int64_t currentPID()
+	{
+#ifdef _WIN32
+		return static_cast<int64_t>(GetCurrentProcessId());
+#else
+		return static_cast<int64_t>(getpid());
+#endif
+	}
+
+#ifndef _WIN32
+	// The lock directory is world-writable, therefore symbolic links are never followed and an existing file is only
+	// used if it is a regular file with a single link, a privileged process additionally only trusts files owned by root
+	int32_t openLockFile() const
+	{
+		bool created = true;
+		int32_t fd   = open(m_fileName.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC | O_NOFOLLOW, 0666);
+		if (fd == INVALID_LOCK_FD && errno == EEXIST)
+		{
+			created = false;
+			fd      = open(m_fileName.c_str(), O_RDWR | O_CLOEXEC | O_NOFOLLOW);
+		}
+
+		if (fd == INVALID_LOCK_FD)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Unable to open lock file " << m_fileName << " (" << std::strerror(errno) << ")";
+			throw CLAPException(ss.str());
+		}
+
+		struct stat st = {};
+		if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_nlink != 1 || (geteuid() == 0 && st.st_uid != 0))
+		{
+			close(fd);
+
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Refusing to use lock file " << m_fileName << ", it is not a regular file with a single link or not owned by a trusted user";
+			throw CLAPException(ss.str());
+		}
+
+		// Allow other users to lock the device as well, independent of the umask of the creating process
+		if (created)
+			fchmod(fd, 0666);
+
+		return fd;
+	}
+
+	std::string readOwner() const
+	{
+		char buf[LOCK_OWNER_FIELD_SIZE + 1] = {};
+		const ssize_t len                   = pread(m_fd, buf, LOCK_OWNER_FIELD_SIZE, 0);
+
+		std::string owner = (len > 0 ? std::string(buf, static_cast<std::size_t>(len)) : std::string());
+		owner.erase(owner.find_last_not_of(' ') + 1);
+
+		return owner;
+	}
+#endif
+
+private:
+	std::string m_fileName = "";
+	DeviceAccess m_access  = DeviceAccess::Exclusive;
+	int64_t m_pid          = 0;
+	int32_t m_fd           = INVALID_LOCK_FD;
+};
+} // namespace internal
+} // namespace clap
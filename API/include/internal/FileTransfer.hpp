@@ -0,0 +1,462 @@
+/*
+ *  File: FileTransfer.hpp
+ *  Copyright (c) 2024 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+// Transfers between files and device memory without holding the entire file in host memory.
+// The file is streamed through a ring of aligned staging buffers, the file I/O of one chunk overlaps with
+// the DMA transfers of the previous chunks. Backends that can map the device memory (UIO, /dev/mem)
+// read and write the file directly from the mapped memory instead.
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <exception>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include "AsyncTransfer.hpp"
+#include "CLAPBackend.hpp"
+#include "Constants.hpp"
+#include "Defines.hpp"
+#include "Exceptions.hpp"
+#include "Types.hpp"
+#include "Utils.hpp"
+
+namespace clap
+{
+struct FileTransferOptions
+{
+	// Size of a single staging buffer in bytes, has to be a multiple of ALIGNMENT
+	uint64_t chunkSize = 8ULL << 20;
+	// Number of staging buffers, i.e., chunks in flight, the host memory used is chunkSize * bufferCount
+	uint32_t bufferCount = 4;
+	// Bypasses the page cache (O_DIRECT), only used if the file offset is aligned to ALIGNMENT and the file system supports it
+	bool directIO = true;
+};
+
+namespace internal
+{
+// File accessed at explicit offsets. With direct I/O the buffer, the offset, and the size of each access have
+// to be aligned to the logical block size of the file system, ALIGNMENT covers all common block sizes.
+class StagingFile
+{
+	DISABLE_COPY_ASSIGN_MOVE(StagingFile)
+
+public:
+	StagingFile(const std::string& fileName, const bool& write, const bool& direct) :
+		m_fileName(fileName)
+	{
+#ifdef _WIN32
+		// Unbuffered I/O on Windows has different alignment rules, hence, the page cache is always used
+		m_fd = CreateFileA(fileName.c_str(), (write ? GENERIC_WRITE : GENERIC_READ), FILE_SHARE_READ, NULL, (write ? OPEN_ALWAYS : OPEN_EXISTING), FILE_ATTRIBUTE_NORMAL, NULL);
+		const int32_t err = static_cast<int32_t>(GetLastError());
+		static_cast<void>(direct);
+#else
+		const int32_t flags = (write ? (O_WRONLY | O_CREAT) : O_RDONLY);
+
+#ifdef O_DIRECT
+		if (direct)
+		{
+			m_fd     = open(fileName.c_str(), flags | O_DIRECT, 0644);
+			m_direct = DEVICE_HANDLE_VALID(m_fd);
+		}
+#endif
+
+		// Not all file systems support direct I/O, e.g., tmpfs
+		if (!DEVICE_HANDLE_VALID(m_fd))
+			m_fd = open(fileName.c_str(), flags, 0644);
+
+		const int32_t err = errno;
+#endif
+
+		if (!DEVICE_HANDLE_VALID(m_fd))
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Unable to open file " << fileName << "; errno: " << err;
+			throw CLAPException(ss.str());
+		}
+	}
+
+	~StagingFile()
+	{
+		if (DEVICE_HANDLE_VALID(m_fd))
+			CLOSE_DEVICE(m_fd);
+	}
+
+	uint64_t GetSize() const
+	{
+#ifdef _WIN32
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(m_fd, &size)) return 0;
+		return static_cast<uint64_t>(size.QuadPart);
+#else
+		struct stat st;
+		if (fstat(m_fd, &st) != 0) return 0;
+		return static_cast<uint64_t>(st.st_size);
+#endif
+	}
+
+	const bool& IsDirect() const
+	{
+		return m_direct;
+	}
+
+	// Switches to buffered I/O, e.g., to write a tail that is not a multiple of the block size
+	void DisableDirect()
+	{
+#if !defined(_WIN32) && defined(O_DIRECT)
+		if (!m_direct) return;
+
+		fcntl(m_fd, F_SETFL, fcntl(m_fd, F_GETFL) & ~O_DIRECT);
+		m_direct = false;
+#endif
+	}
+
+	// Reads up to sizeInByte bytes, less bytes are only returned at the end of the file
+	uint64_t ReadAt(void* pData, const uint64_t& offset, const uint64_t& sizeInByte)
+	{
+		uint8_t* pBytes = static_cast<uint8_t*>(pData);
+		uint64_t count  = 0;
+
+		while (count < sizeInByte)
+		{
+			const int64_t rc = readAt(pBytes + count, offset + count, sizeInByte - count);
+
+			if (rc == 0) break;
+
+			if (rc < 0)
+			{
+				// Direct I/O is not supported for all files of a file system, e.g., some FUSE file systems
+				if (m_direct && errno == EINVAL)
+				{
+					DisableDirect();
+					continue;
+				}
+
+				std::stringstream ss;
+				ss << CLASS_TAG_AUTO << "Failed to read 0x" << std::hex << (sizeInByte - count) << " byte from " << m_fileName << " at offset 0x" << (offset + count) << std::dec << "; errno: " << errno;
+				throw CLAPException(ss.str());
+			}
+
+			count += static_cast<uint64_t>(rc);
+		}
+
+		return count;
+	}
+
+	void WriteAt(const void* pData, const uint64_t& offset, const uint64_t& sizeInByte)
+	{
+		const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+		uint64_t count        = 0;
+
+		while (count < sizeInByte)
+		{
+			const int64_t rc = writeAt(pBytes + count, offset + count, sizeInByte - count);
+
+			if (rc <= 0)
+			{
+				if (rc < 0 && m_direct && errno == EINVAL)
+				{
+					DisableDirect();
+					continue;
+				}
+
+				std::stringstream ss;
+				ss << CLASS_TAG_AUTO << "Failed to write 0x" << std::hex << (sizeInByte - count) << " byte to " << m_fileName << " at offset 0x" << (offset + count) << std::dec << "; errno: " << errno;
+				throw CLAPException(ss.str());
+			}
+
+			count += static_cast<uint64_t>(rc);
+		}
+	}
+
+private:
+	int64_t readAt(void* pData, const uint64_t& offset, const uint64_t& sizeInByte)
+	{
+#ifdef _WIN32
+		OVERLAPPED ov   = {};
+		ov.Offset       = static_cast<DWORD>(offset & 0xFFFFFFFF);
+		ov.OffsetHigh   = static_cast<DWORD>(offset >> 32);
+		DWORD bytesRead = 0;
+
+		if (!ReadFile(m_fd, pData, static_cast<DWORD>(std::min<uint64_t>(sizeInByte, 1ULL << 30)), &bytesRead, &ov))
+			return (GetLastError() == ERROR_HANDLE_EOF ? 0 : -1);
+
+		return static_cast<int64_t>(bytesRead);
+#else
+		return static_cast<int64_t>(pread(m_fd, pData, sizeInByte, static_cast<off_t>(offset)));
+#endif
+	}
+
+	int64_t writeAt(const void* pData, const uint64_t& offset, const uint64_t& sizeInByte)
+	{
+#ifdef _WIN32
+		OVERLAPPED ov      = {};
+		ov.Offset          = static_cast<DWORD>(offset & 0xFFFFFFFF);
+		ov.OffsetHigh      = static_cast<DWORD>(offset >> 32);
+		DWORD bytesWritten = 0;
+
+		if (!WriteFile(m_fd, pData, static_cast<DWORD>(std::min<uint64_t>(sizeInByte, 1ULL << 30)), &bytesWritten, &ov))
+			return -1;
+
+		return static_cast<int64_t>(bytesWritten);
+#else
+		return static_cast<int64_t>(pwrite(m_fd, pData, sizeInByte, static_cast<off_t>(offset)));
+#endif
+	}
+
+private:
+	std::string m_fileName;
+	DeviceHandle m_fd = INVALID_HANDLE;
+	bool m_direct     = false;
+};
+
+// Mapping of device memory for the zero-copy path, nullptr if the backend does not support mapping
+class MappedRange
+{
+	DISABLE_COPY_ASSIGN_MOVE(MappedRange)
+
+public:
+	MappedRange(const CLAPBackendPtr& pBackend, const uint64_t& addr, const uint64_t& sizeInByte) :
+		m_pBackend(pBackend),
+		m_addr(addr),
+		m_size(sizeInByte),
+		m_pMem(pBackend->MapMemory(addr, sizeInByte))
+	{}
+
+	~MappedRange()
+	{
+		if (m_pMem)
+			m_pBackend->UnmapMemory(m_addr, m_pMem, m_size);
+	}
+
+	void* Get() const
+	{
+		return m_pMem;
+	}
+
+private:
+	CLAPBackendPtr m_pBackend;
+	uint64_t m_addr;
+	uint64_t m_size;
+	void* m_pMem;
+};
+
+// Moves data between a file and the device, bounding the host memory to the staging ring
+class FileStager
+{
+	DISABLE_COPY_ASSIGN_MOVE(FileStager)
+
+public:
+	FileStager(CLAPBackendPtr pBackend, TransferPoolPtr pPool, const FileTransferOptions& options) :
+		m_pBackend(std::move(pBackend)),
+		m_pPool(std::move(pPool)),
+		m_options(options),
+		m_buffers(),
+		m_inFlight()
+	{
+		if (m_options.chunkSize == 0 || m_options.chunkSize % ALIGNMENT != 0 || m_options.bufferCount == 0)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "The chunk size (" << m_options.chunkSize << ") has to be a non-zero multiple of " << ALIGNMENT << " bytes and at least one staging buffer is required";
+			throw CLAPException(ss.str());
+		}
+	}
+
+	~FileStager()
+	{
+		// The transfers in flight reference the staging buffers
+		drain();
+	}
+
+	// Transfers sizeInByte bytes starting at fileOffset to the device, the file has to contain all of them
+	void ToDevice(const std::string& fileName, const uint64_t& fileOffset, const uint64_t& addr, const uint64_t& sizeInByte)
+	{
+		const MappedRange mapped(m_pBackend, addr, sizeInByte);
+
+		// Direct I/O into mapped device memory is not supported by the kernel, the page cache is used instead
+		StagingFile file(fileName, false, m_options.directIO && !mapped.Get() && fileOffset % ALIGNMENT == 0);
+
+		const uint64_t fileSize = file.GetSize();
+
+		if (fileOffset + sizeInByte > fileSize)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Unable to read 0x" << std::hex << sizeInByte << " byte from " << fileName << " at offset 0x" << fileOffset << ", the file size is 0x" << fileSize << std::dec;
+			throw CLAPException(ss.str());
+		}
+
+		if (mapped.Get())
+		{
+			file.ReadAt(mapped.Get(), fileOffset, sizeInByte);
+			m_pBackend->FlushMapped(mapped.Get(), sizeInByte);
+			return;
+		}
+
+		for (uint64_t offset = 0, chunk = 0; offset < sizeInByte; chunk++)
+		{
+			const uint64_t len = std::min(m_options.chunkSize, sizeInByte - offset);
+			uint8_t* pBuffer   = acquireBuffer(chunk, sizeInByte);
+
+			// Direct reads have to cover whole blocks, the staging buffer always holds a full chunk
+			const uint64_t readLen = (file.IsDirect() ? ROUND_UP_DIV(len, ALIGNMENT) * ALIGNMENT : len);
+
+			if (file.ReadAt(pBuffer, fileOffset + offset, readLen) < len)
+			{
+				std::stringstream ss;
+				ss << CLASS_TAG_AUTO << "The file " << fileName << " ended before 0x" << std::hex << sizeInByte << " byte were read" << std::dec;
+				throw CLAPException(ss.str());
+			}
+
+			m_inFlight[chunk % m_buffers.size()] = m_pPool->Submit({ { CLAPBackend::TYPE::WRITE, addr + offset, pBuffer, len } });
+			offset += len;
+		}
+
+		waitAll();
+	}
+
+	// Transfers sizeInByte bytes from the device to the file, starting at fileOffset
+	void FromDevice(const std::string& fileName, const uint64_t& fileOffset, const uint64_t& addr, const uint64_t& sizeInByte)
+	{
+		const MappedRange mapped(m_pBackend, addr, sizeInByte);
+
+		StagingFile file(fileName, true, m_options.directIO && !mapped.Get() && fileOffset % ALIGNMENT == 0);
+
+		if (mapped.Get())
+		{
+			m_pBackend->InvalidateMapped(mapped.Get(), sizeInByte);
+			file.WriteAt(mapped.Get(), fileOffset, sizeInByte);
+			return;
+		}
+
+		const uint64_t chunkCnt = ROUND_UP_DIV(sizeInByte, m_options.chunkSize);
+
+		const auto submitRead = [&](const uint64_t& chunk) {
+			const uint64_t offset = chunk * m_options.chunkSize;
+			const uint64_t len    = std::min(m_options.chunkSize, sizeInByte - offset);
+			uint8_t* pBuffer      = acquireBuffer(chunk, sizeInByte);
+
+			m_inFlight[chunk % m_buffers.size()] = m_pPool->Submit({ { CLAPBackend::TYPE::READ, addr + offset, pBuffer, len } });
+		};
+
+		for (uint64_t chunk = 0; chunk < std::min<uint64_t>(chunkCnt, m_options.bufferCount); chunk++)
+			submitRead(chunk);
+
+		for (uint64_t chunk = 0; chunk < chunkCnt; chunk++)
+		{
+			const std::size_t slot = static_cast<std::size_t>(chunk % m_buffers.size());
+			const uint64_t offset  = chunk * m_options.chunkSize;
+			const uint64_t len     = std::min(m_options.chunkSize, sizeInByte - offset);
+
+			TransferStatePtr pState = nullptr;
+			std::swap(pState, m_inFlight[slot]);
+			pState->Wait(WAIT_INFINITE);
+
+			// Only the last chunk can be smaller than a block
+			if (len % ALIGNMENT != 0)
+				file.DisableDirect();
+
+			file.WriteAt(m_buffers[slot].data(), fileOffset + offset, len);
+
+			if (chunk + m_buffers.size() < chunkCnt)
+				submitRead(chunk + m_buffers.size());
+		}
+	}
+
+private:
+	// Returns the staging buffer of the given chunk once the previous transfer using it completed
+	uint8_t* acquireBuffer(const uint64_t& chunk, const uint64_t& sizeInByte)
+	{
+		const std::size_t slot = static_cast<std::size_t>(chunk % m_options.bufferCount);
+
+		// Small transfers do not allocate the entire ring
+		if (slot == m_buffers.size())
+		{
+			m_buffers.emplace_back(static_cast<std::size_t>(std::min(m_options.chunkSize, ROUND_UP_DIV(sizeInByte, ALIGNMENT) * ALIGNMENT)));
+			m_inFlight.push_back(nullptr);
+		}
+
+		if (m_inFlight[slot])
+		{
+			TransferStatePtr pState = nullptr;
+			std::swap(pState, m_inFlight[slot]);
+			pState->Wait(WAIT_INFINITE);
+		}
+
+		return m_buffers[slot].data();
+	}
+
+	void waitAll()
+	{
+		for (TransferStatePtr& pState : m_inFlight)
+		{
+			if (!pState) continue;
+
+			TransferStatePtr pDone = nullptr;
+			std::swap(pDone, pState);
+			pDone->Wait(WAIT_INFINITE);
+		}
+	}
+
+	// Waits for all transfers without reporting their errors, used when an error is already being propagated
+	void drain() noexcept
+	{
+		for (TransferStatePtr& pState : m_inFlight)
+		{
+			if (!pState) continue;
+
+			try
+			{
+				pState->Wait(WAIT_INFINITE);
+			}
+			catch (...)
+			{
+			}
+
+			pState = nullptr;
+		}
+	}
+
+private:
+	CLAPBackendPtr m_pBackend;
+	TransferPoolPtr m_pPool;
+	FileTransferOptions m_options;
+	std::vector<CLAPBuffer<uint8_t>> m_buffers;
+	std::vector<TransferStatePtr> m_inFlight;
+};
+} // namespace internal
+} // namespace clap
@@ -0,0 +1,338 @@
+/*
+ *  File: HugePageAllocator.hpp
+ *  Copyright (c) 2024 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+// Recycling allocator for large host buffers backed by hugepages, reducing page faults, TLB misses and
+// the cost of pinning the pages for every DMA transfer. Buffers are grouped into size classes and
+// returned buffers are kept in a free-list, so that repeated transfers of the same size reuse the
+// already faulted-in pages. Only available on Linux, other platforms keep using the AlignmentAllocator.
+
+#if !defined(EMBEDDED_XILINX) && !defined(_WIN32)
+#define CLAP_HUGEPAGES_AVAILABLE
+#endif
+
+#ifdef CLAP_HUGEPAGES_AVAILABLE
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <vector>
+
+#include <sys/mman.h>
+
+#include "AlignmentAllocator.hpp"
+#include "Constants.hpp"
+#include "Exceptions.hpp"
+#include "Utils.hpp"
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+namespace clap
+{
+enum class HugePageSize
+{
+	Transparent, // Regular pages, advising the kernel to back them with transparent hugepages
+	Size2MiB,
+	Size1GiB
+};
+
+struct HugePageStats
+{
+	uint64_t hits         = 0; // Allocations served from the free-list
+	uint64_t misses       = 0; // Allocations that required a new mapping
+	uint64_t hugetlbMaps  = 0; // Mappings backed by reserved hugetlb pages
+	uint64_t fallbackMaps = 0; // Mappings backed by regular (transparent huge) pages, e.g., because no hugetlb pages were reserved
+	uint64_t cachedBytes  = 0;
+	uint64_t liveBuffers  = 0;
+};
+
+namespace internal
+{
+class HugePagePool
+{
+	DISABLE_COPY_ASSIGN_MOVE(HugePagePool)
+
+	static constexpr uint64_t SIZE_2MIB = 1ULL << 21;
+	static constexpr uint64_t SIZE_1GIB = 1ULL << 30;
+
+public:
+	static HugePagePool& Get()
+	{
+		// Intentionally leaked, buffers with static storage duration might be returned after the pool would have been destroyed
+		static HugePagePool* pPool = new HugePagePool();
+		return *pPool;
+	}
+
+	// Changing the configuration requires all buffers to be returned, as the size class of a buffer depends on it
+	void Configure(const HugePageSize& pageSize, const uint64_t& maxCachedBytes, const uint64_t& minHugeSize)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+
+		if (m_stats.liveBuffers != 0)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Unable to reconfigure the hugepage pool while " << m_stats.liveBuffers << " buffers are in use";
+			throw CLAPException(ss.str());
+		}
+
+		releaseCached();
+
+		m_pageSize       = pageSize;
+		m_maxCachedBytes = maxCachedBytes;
+		m_minHugeSize    = minHugeSize;
+	}
+
+	void* Allocate(const std::size_t& sizeInByte)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+
+		void* p = nullptr;
+
+		if (sizeInByte < m_minHugeSize)
+			p = alignedMalloc(ALIGNMENT, roundUp(sizeInByte, ALIGNMENT));
+		else
+		{
+			const uint64_t pageSize  = pageBytes(sizeInByte);
+			const uint64_t classSize = sizeClass(sizeInByte);
+			auto it                  = m_freeLists.find(classSize);
+
+			if (it != m_freeLists.end() && !it->second.empty())
+			{
+				p = it->second.back();
+				it->second.pop_back();
+				m_stats.cachedBytes -= classSize;
+				m_stats.hits++;
+			}
+			else
+			{
+				p = mapPages(classSize, pageSize);
+				m_stats.misses++;
+			}
+		}
+
+		if (p == nullptr)
+			throw std::bad_alloc();
+
+		m_stats.liveBuffers++;
+		return p;
+	}
+
+	void Deallocate(void* p, const std::size_t& sizeInByte) noexcept
+	{
+		if (p == nullptr) return;
+
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_stats.liveBuffers--;
+
+		if (sizeInByte < m_minHugeSize)
+		{
+			alignedFree(p);
+			return;
+		}
+
+		const uint64_t classSize = sizeClass(sizeInByte);
+
+		if (m_stats.cachedBytes + classSize > m_maxCachedBytes)
+		{
+			munmap(p, classSize);
+			return;
+		}
+
+		m_freeLists[classSize].push_back(p);
+		m_stats.cachedBytes += classSize;
+	}
+
+	// Returns all cached buffers to the operating system
+	void Trim()
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		releaseCached();
+	}
+
+	HugePageStats GetStats()
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		return m_stats;
+	}
+
+private:
+	HugePagePool() = default;
+
+	static uint64_t roundUp(const uint64_t& value, const uint64_t& granularity)
+	{
+		return ((value + granularity - 1) / granularity) * granularity;
+	}
+
+	// Buffers are only backed by 1 GiB pages if rounding them up to whole pages wastes at most 1/8 of the buffer, i.e., buffers
+	// smaller than about 910 MiB use 2 MiB pages instead of pinning a whole 1 GiB page each
+	uint64_t pageBytes(const uint64_t& sizeInByte) const
+	{
+		if (m_pageSize != HugePageSize::Size1GiB) return SIZE_2MIB;
+
+		return (roundUp(sizeInByte, SIZE_1GIB) - sizeInByte <= sizeInByte / 8 ? SIZE_1GIB : SIZE_2MIB);
+	}
+
+	// Rounds the size up to a multiple of the page size with four classes per power of two, limiting the waste to 25 %
+	uint64_t sizeClass(const uint64_t& sizeInByte) const
+	{
+		const uint64_t pageSize = pageBytes(sizeInByte);
+		const uint64_t pages    = roundUp(sizeInByte, pageSize) / pageSize;
+
+		uint64_t granularity = 1;
+		while ((granularity << 3) <= pages)
+			granularity <<= 1;
+
+		return roundUp(pages, granularity) * pageSize;
+	}
+
+	void* mapPages(const uint64_t& sizeInByte, const uint64_t& pageSize)
+	{
+		if (m_pageSize != HugePageSize::Transparent)
+		{
+			const int32_t pageFlag = (pageSize == SIZE_1GIB ? 30 : 21) << MAP_HUGE_SHIFT;
+			void* p                = mmap(nullptr, sizeInByte, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | pageFlag, -1, 0);
+
+			if (p != MAP_FAILED)
+			{
+				m_stats.hugetlbMaps++;
+				return p;
+			}
+		}
+
+		// Transparent hugepages are only used for 2 MiB aligned regions, therefore, over-allocate and trim the mapping
+		const uint64_t mapSize = sizeInByte + SIZE_2MIB;
+		void* pMap             = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if (pMap == MAP_FAILED)
+			return nullptr;
+
+		const uintptr_t base    = reinterpret_cast<uintptr_t>(pMap);
+		const uintptr_t aligned = static_cast<uintptr_t>(roundUp(base, SIZE_2MIB));
+
+		if (aligned != base)
+			munmap(pMap, aligned - base);
+
+		if (aligned + sizeInByte < base + mapSize)
+			munmap(reinterpret_cast<void*>(aligned + sizeInByte), base + mapSize - aligned - sizeInByte);
+
+#ifdef MADV_HUGEPAGE
+		madvise(reinterpret_cast<void*>(aligned), sizeInByte, MADV_HUGEPAGE);
+#endif
+
+		m_stats.fallbackMaps++;
+		return reinterpret_cast<void*>(aligned);
+	}
+
+	void releaseCached()
+	{
+		for (auto& [classSize, buffers] : m_freeLists)
+		{
+			for (void* p : buffers)
+				munmap(p, classSize);
+		}
+
+		m_freeLists.clear();
+		m_stats.cachedBytes = 0;
+	}
+
+private:
+	std::mutex m_mtx                                   = {};
+	HugePageSize m_pageSize                            = HugePageSize::Size2MiB;
+	uint64_t m_maxCachedBytes                          = SIZE_1GIB;
+	uint64_t m_minHugeSize                             = SIZE_2MIB / 2;
+	std::map<uint64_t, std::vector<void*>> m_freeLists = {};
+	HugePageStats m_stats                              = {};
+};
+
+template<typename T>
+class HugePageAllocator
+{
+public:
+	using value_type = T;
+
+	HugePageAllocator() = default;
+
+	template<typename U>
+	HugePageAllocator(const HugePageAllocator<U>&) noexcept
+	{
+	}
+
+	T* allocate(const std::size_t& n)
+	{
+		if (n == 0)
+			return nullptr;
+
+		return static_cast<T*>(HugePagePool::Get().Allocate(n * sizeof(T)));
+	}
+
+	void deallocate(T* ptr, const std::size_t& n) noexcept
+	{
+		HugePagePool::Get().Deallocate(static_cast<void*>(ptr), n * sizeof(T));
+	}
+};
+
+template<class T, class U>
+inline bool operator==(const HugePageAllocator<T>&, const HugePageAllocator<U>&) noexcept
+{
+	return true;
+}
+
+template<class T, class U>
+inline bool operator!=(const HugePageAllocator<T>&, const HugePageAllocator<U>&) noexcept
+{
+	return false;
+}
+} // namespace internal
+
+/// @brief Configures the hugepage pool used by CLAPHugeBuffer, has to be called while no such buffer is allocated
+/// @param pageSize Size of the pages backing the buffers, falls back to transparent hugepages if no hugetlb pages are reserved.
+///        With 1 GiB pages, buffers that would waste more than 1/8 of their size when rounded up to whole 1 GiB pages
+///        (i.e., all buffers below about 910 MiB) are backed by 2 MiB pages instead
+/// @param maxCachedBytes Maximum number of bytes kept in the free-list, further returned buffers are unmapped
+/// @param minHugeSize Buffers smaller than this size are allocated using aligned_alloc
+inline void ConfigureHugePages(const HugePageSize& pageSize, const uint64_t& maxCachedBytes = 1ULL << 30, const uint64_t& minHugeSize = 1ULL << 20)
+{
+	internal::HugePagePool::Get().Configure(pageSize, maxCachedBytes, minHugeSize);
+}
+
+/// @brief Returns all buffers cached by the hugepage pool to the operating system
+inline void TrimHugePages()
+{
+	internal::HugePagePool::Get().Trim();
+}
+
+inline HugePageStats GetHugePageStats()
+{
+	return internal::HugePagePool::Get().GetStats();
+}
+} // namespace clap
+#endif
@@ -0,0 +1,243 @@
+/*
+ *  File: IoCompletionPort.hpp
+ *  Copyright (c) 2024 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Constants.hpp"
+#include "Defines.hpp"
+#include "Exceptions.hpp"
+#include "Logger.hpp"
+#include "Utils.hpp"
+
+namespace clap
+{
+namespace internal
+{
+// I/O completion port shared by all overlapped device handles of the process. A service thread dequeues
+// the completion packets and calls the completion function of the finished operation.
+class IoCompletionPort
+{
+	DISABLE_COPY_ASSIGN_MOVE(IoCompletionPort)
+
+	static constexpr ULONG_PTR STOP_KEY = 1;
+
+public:
+	// Function called by the service thread with the number of transferred bytes and the error code of the operation
+	using CompletionFunc = std::function<void(const DWORD&, const DWORD&)>;
+
+	struct Operation : public OVERLAPPED
+	{
+		Operation() :
+			OVERLAPPED(),
+			onComplete(nullptr)
+		{}
+
+		CompletionFunc onComplete;
+	};
+
+	static IoCompletionPort& Get()
+	{
+		static IoCompletionPort port;
+		return port;
+	}
+
+	// Opens the given device for overlapped I/O and associates it with the port, INVALID_HANDLE on failure
+	DeviceHandle Open(const std::string& name, const FlagType& flags)
+	{
+		DeviceHandle fd = CreateFile(name.c_str(), flags, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, NULL);
+		if (!DEVICE_HANDLE_VALID(fd)) return INVALID_HANDLE;
+
+		if (CreateIoCompletionPort(fd, m_port, 0, 0) == NULL)
+		{
+			CLAP_CLASS_LOG_ERROR << "Failed to associate " << name << " with the completion port, Error: " << GetLastError() << std::endl;
+			CLOSE_DEVICE(fd);
+			return INVALID_HANDLE;
+		}
+
+		return fd;
+	}
+
+	// Starts an overlapped read or write, the completion function of the operation is called by the service thread, also if
+	// the operation completes synchronously. Returns false if the operation could not be started, the completion function is not called then.
+	static bool Start(const DeviceHandle& fd, Operation& op, const bool& read, void* pData, const DWORD& sizeInByte, const uint64_t& offset, DWORD& error)
+	{
+		static_cast<OVERLAPPED&>(op) = OVERLAPPED();
+		op.Offset                    = static_cast<DWORD>(offset & 0xFFFFFFFF);
+		op.OffsetHigh                = static_cast<DWORD>(offset >> 32);
+
+		const BOOL ok = (read ? ReadFile(fd, pData, sizeInByte, NULL, &op) : WriteFile(fd, pData, sizeInByte, NULL, &op));
+		error         = (ok ? ERROR_SUCCESS : GetLastError());
+
+		return (ok || error == ERROR_IO_PENDING);
+	}
+
+	// Reads sizeInByte starting at offset, all chunks are in flight at once, blocks until the transfer completed
+	void Read(const DeviceHandle& fd, const std::string& name, void* pData, const uint64_t& sizeInByte, const uint64_t& offset)
+	{
+		transfer(fd, name, true, reinterpret_cast<uint8_t*>(pData), sizeInByte, offset);
+	}
+
+	void Write(const DeviceHandle& fd, const std::string& name, const void* pData, const uint64_t& sizeInByte, const uint64_t& offset)
+	{
+		// The data is never modified, the cast only allows sharing the transfer code with Read
+		transfer(fd, name, false, const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(pData)), sizeInByte, offset);
+	}
+
+private:
+	IoCompletionPort() :
+		m_port(CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1)),
+		m_thread()
+	{
+		if (m_port == NULL)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Failed to create the I/O completion port, Error: " << GetLastError();
+			throw CLAPException(ss.str());
+		}
+
+		m_thread = std::thread(&IoCompletionPort::run, this);
+	}
+
+	~IoCompletionPort()
+	{
+		PostQueuedCompletionStatus(m_port, 0, STOP_KEY, NULL);
+
+		if (m_thread.joinable())
+			m_thread.join();
+
+		CloseHandle(m_port);
+	}
+
+	void run()
+	{
+		while (true)
+		{
+			DWORD bytes       = 0;
+			ULONG_PTR key     = 0;
+			LPOVERLAPPED pOv  = NULL;
+			const BOOL ok     = GetQueuedCompletionStatus(m_port, &bytes, &key, &pOv, INFINITE);
+			const DWORD error = (ok ? ERROR_SUCCESS : GetLastError());
+
+			if (pOv == NULL)
+			{
+				if (key == STOP_KEY) return;
+				continue;
+			}
+
+			Operation* pOp = static_cast<Operation*>(pOv);
+
+			if (pOp->onComplete)
+				pOp->onComplete(bytes, error);
+		}
+	}
+
+	void transfer(const DeviceHandle& fd, const std::string& name, const bool& read, uint8_t* pData, const uint64_t& sizeInByte, const uint64_t& offset)
+	{
+		struct Batch
+		{
+			std::mutex mtx;
+			std::condition_variable cv;
+			std::size_t pending = 0;
+			DWORD error         = ERROR_SUCCESS;
+			uint64_t failedAddr = 0;
+		} batch;
+
+		const std::size_t chunkCnt = static_cast<std::size_t>(ROUND_UP_DIV(sizeInByte, RW_MAX_SIZE));
+		std::vector<Operation> ops(chunkCnt);
+
+		for (std::size_t i = 0; i < chunkCnt; i++)
+		{
+			const uint64_t chunkOffset = i * RW_MAX_SIZE;
+			const DWORD bytes          = static_cast<DWORD>(std::min<uint64_t>(RW_MAX_SIZE, sizeInByte - chunkOffset));
+
+			ops[i].onComplete = [&batch, bytes, chunkOffset, offset](const DWORD& transferred, const DWORD& error) {
+				std::lock_guard<std::mutex> lock(batch.mtx);
+
+				if (batch.error == ERROR_SUCCESS && (error != ERROR_SUCCESS || transferred != bytes))
+				{
+					batch.error      = (error != ERROR_SUCCESS ? error : ERROR_HANDLE_EOF);
+					batch.failedAddr = offset + chunkOffset;
+				}
+
+				// Notified while holding the lock, as the batch lives on the stack of the waiting thread
+				batch.pending--;
+				batch.cv.notify_all();
+			};
+
+			{
+				std::lock_guard<std::mutex> lock(batch.mtx);
+				batch.pending++;
+			}
+
+			DWORD error;
+			if (!Start(fd, ops[i], read, pData + chunkOffset, bytes, offset + chunkOffset, error))
+			{
+				std::lock_guard<std::mutex> lock(batch.mtx);
+				batch.pending--;
+
+				if (batch.error == ERROR_SUCCESS)
+				{
+					batch.error      = error;
+					batch.failedAddr = offset + chunkOffset;
+				}
+
+				break;
+			}
+		}
+
+		// All started chunks have to complete before returning, as they reference the operations and the user buffer
+		std::unique_lock<std::mutex> lock(batch.mtx);
+		batch.cv.wait(lock, [&batch] { return batch.pending == 0; });
+
+		if (batch.error != ERROR_SUCCESS)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << name << ", failed to " << (read ? "read" : "write") << " 0x" << std::hex << sizeInByte << " byte " << (read ? "from" : "to")
+			   << " offset 0x" << offset << " (chunk at 0x" << batch.failedAddr << ") Error: " << std::dec << batch.error;
+			throw CLAPException(ss.str());
+		}
+	}
+
+private:
+	HANDLE m_port;
+	std::thread m_thread;
+};
+} // namespace internal
+} // namespace clap
+#endif // _WIN32
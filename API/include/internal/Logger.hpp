@@ -26,9 +26,21 @@
 
 #pragma once
 
+// Messages with a lower level than CLAP_LOG_COMPILE_LEVEL (0 = debug ... 4 = error) are removed at compile time
+#ifndef CLAP_LOG_COMPILE_LEVEL
+#define CLAP_LOG_COMPILE_LEVEL 0
+#endif
+
+// With CLAP_LOG_ASYNC the messages are queued per thread and written by a background sink thread.
+// Bare-metal builds and xil_printf are not supported, as they lack threads.
+#if defined(CLAP_LOG_ASYNC) && !defined(EMBEDDED_XILINX) && !defined(CLAP_USE_XIL_PRINTF)
+#define CLAP_LOG_ASYNC_ACTIVE
+#endif
+
 #include <iostream>
 #include <mutex>
 #include <sstream>
+#include <type_traits>
 
 #include "StdStub.hpp"
 #include "Utils.hpp"
@@ -37,6 +49,28 @@
 #include <xil_printf.h>
 #endif
 
+#ifdef CLAP_LOG_ASYNC_ACTIVE
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Number of messages queued per thread, further messages are dropped until the sink caught up
+#ifndef CLAP_LOG_ASYNC_QUEUE_SIZE
+#define CLAP_LOG_ASYNC_QUEUE_SIZE 4096
+#endif
+
+// Maximum time in microseconds a queued message waits before being written
+#ifndef CLAP_LOG_ASYNC_FLUSH_INTERVAL_US
+#define CLAP_LOG_ASYNC_FLUSH_INTERVAL_US 1000
+#endif
+#endif
+
 namespace clap
 {
 namespace logging
@@ -51,6 +85,239 @@ enum class Verbosity
 	VB_NONE    = 255
 };
 
+template<typename T>
+constexpr typename std::underlying_type<T>::type ToUnderlying(const T& t) noexcept
+{
+	return static_cast<typename std::underlying_type<T>::type>(t);
+}
+
+// Whether messages of the given level are compiled in at all
+constexpr bool IsCompiledIn([[maybe_unused]] const Verbosity& v)
+{
+#ifdef CLAP_DISABLE_LOGGING
+	return false;
+#else
+	return ToUnderlying(v) >= CLAP_LOG_COMPILE_LEVEL;
+#endif
+}
+
+#ifdef CLAP_LOG_ASYNC_ACTIVE
+static_assert((CLAP_LOG_ASYNC_QUEUE_SIZE & (CLAP_LOG_ASYNC_QUEUE_SIZE - 1)) == 0, "CLAP_LOG_ASYNC_QUEUE_SIZE has to be a power of two");
+
+// Writes the messages queued by the logging threads from a single background thread,
+// emitting a message therefore neither takes a lock nor waits for the output stream.
+class AsyncLogSink
+{
+	struct Entry
+	{
+		uint64_t seq          = 0;
+		std::ostream* pStream = nullptr;
+		std::string msg       = {};
+	};
+
+	// Single-producer single-consumer queue, filled by its thread and drained by the sink
+	struct ThreadQueue
+	{
+		std::atomic<uint64_t> head    = { 0 };
+		std::atomic<uint64_t> tail    = { 0 };
+		std::atomic<uint64_t> dropped = { 0 };
+		// Cleared once the owning thread terminated, allowing the queue to be reused by a new thread
+		std::atomic<bool> owned    = { true };
+		std::vector<Entry> entries = std::vector<Entry>(CLAP_LOG_ASYNC_QUEUE_SIZE);
+	};
+
+	using ThreadQueuePtr = std::shared_ptr<ThreadQueue>;
+
+	struct QueueHandle
+	{
+		DISABLE_COPY_ASSIGN_MOVE(QueueHandle)
+
+		QueueHandle() = default;
+
+		~QueueHandle()
+		{
+			if (pQueue)
+				pQueue->owned.store(false, std::memory_order_release);
+		}
+
+		ThreadQueuePtr pQueue = nullptr;
+	};
+
+	AsyncLogSink() :
+		m_mtx(),
+		m_cv(),
+		m_queues(),
+		m_thread()
+	{
+		m_thread = std::thread(&AsyncLogSink::run, this);
+	}
+
+	DISABLE_COPY_ASSIGN_MOVE(AsyncLogSink)
+
+public:
+	~AsyncLogSink()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			m_stop = true;
+		}
+
+		m_cv.notify_all();
+		m_thread.join();
+
+		// Messages emitted from here on are written synchronously
+		s_destroyed.store(true, std::memory_order_release);
+		drain(m_queues);
+	}
+
+	static AsyncLogSink& Get()
+	{
+		static AsyncLogSink sink;
+		return sink;
+	}
+
+	// False once the sink was destroyed, i.e., for messages emitted during the static destruction
+	static bool IsAvailable()
+	{
+		return !s_destroyed.load(std::memory_order_acquire);
+	}
+
+	void Push(std::ostream* pStream, std::string&& msg)
+	{
+		ThreadQueue& queue  = localQueue();
+		const uint64_t head = queue.head.load(std::memory_order_relaxed);
+
+		if (head - queue.tail.load(std::memory_order_acquire) >= CLAP_LOG_ASYNC_QUEUE_SIZE)
+		{
+			queue.dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		Entry& entry  = queue.entries[head & (CLAP_LOG_ASYNC_QUEUE_SIZE - 1)];
+		entry.seq     = s_seq.fetch_add(1, std::memory_order_relaxed);
+		entry.pStream = pStream;
+		entry.msg     = std::move(msg);
+		queue.head.store(head + 1, std::memory_order_release);
+	}
+
+	// Blocks until all messages emitted before the call have been written
+	void Flush()
+	{
+		std::unique_lock<std::mutex> lock(m_mtx);
+		if (m_stop) return;
+
+		// Only a pass started after this point is guaranteed to observe the queued messages
+		const uint64_t target = m_passStarted + 1;
+		m_flushRequested      = true;
+		m_cv.notify_all();
+		m_cv.wait(lock, [this, target] { return m_passDone >= target || m_stop; });
+	}
+
+private:
+	ThreadQueue& localQueue()
+	{
+		thread_local QueueHandle handle;
+
+		if (handle.pQueue == nullptr)
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+
+			for (const ThreadQueuePtr& pQueue : m_queues)
+			{
+				bool expected = false;
+				if (pQueue->owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+				{
+					handle.pQueue = pQueue;
+					break;
+				}
+			}
+
+			if (handle.pQueue == nullptr)
+			{
+				m_queues.push_back(std::make_shared<ThreadQueue>());
+				handle.pQueue = m_queues.back();
+			}
+		}
+
+		return *handle.pQueue;
+	}
+
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(m_mtx);
+
+		while (!m_stop)
+		{
+			m_cv.wait_for(lock, std::chrono::microseconds(CLAP_LOG_ASYNC_FLUSH_INTERVAL_US), [this] { return m_stop || m_flushRequested; });
+
+			m_flushRequested                  = false;
+			const uint64_t pass               = ++m_passStarted;
+			const std::vector<ThreadQueuePtr> queues = m_queues;
+
+			lock.unlock();
+			drain(queues);
+			lock.lock();
+
+			m_passDone = pass;
+			m_cv.notify_all();
+		}
+	}
+
+	// Writes the queued messages of all threads in the order they were emitted
+	void drain(const std::vector<ThreadQueuePtr>& queues)
+	{
+		uint64_t dropped = 0;
+
+		for (const ThreadQueuePtr& pQueue : queues)
+		{
+			const uint64_t tail = pQueue->tail.load(std::memory_order_relaxed);
+			const uint64_t head = pQueue->head.load(std::memory_order_acquire);
+
+			for (uint64_t i = tail; i < head; i++)
+				m_batch.push_back(std::move(pQueue->entries[i & (CLAP_LOG_ASYNC_QUEUE_SIZE - 1)]));
+
+			pQueue->tail.store(head, std::memory_order_release);
+			dropped += pQueue->dropped.exchange(0, std::memory_order_relaxed);
+		}
+
+		if (m_batch.empty() && dropped == 0) return;
+
+		std::sort(m_batch.begin(), m_batch.end(), [](const Entry& a, const Entry& b) { return a.seq < b.seq; });
+
+		std::vector<std::ostream*> streams;
+		for (const Entry& entry : m_batch)
+		{
+			*entry.pStream << entry.msg;
+
+			if (std::find(streams.begin(), streams.end(), entry.pStream) == streams.end())
+				streams.push_back(entry.pStream);
+		}
+
+		if (dropped != 0)
+			std::cerr << "[AsyncLogSink] Dropped " << dropped << " log messages, consider increasing CLAP_LOG_ASYNC_QUEUE_SIZE" << std::endl;
+
+		for (std::ostream* pStream : streams)
+			pStream->flush();
+
+		m_batch.clear();
+	}
+
+private:
+	std::mutex m_mtx;
+	std::condition_variable m_cv;
+	std::vector<ThreadQueuePtr> m_queues;
+	std::thread m_thread;
+	std::vector<Entry> m_batch = {};
+	uint64_t m_passStarted     = 0;
+	uint64_t m_passDone        = 0;
+	bool m_flushRequested      = false;
+	bool m_stop                = false;
+
+	static inline std::atomic<uint64_t> s_seq   = { 0 };
+	static inline std::atomic<bool> s_destroyed = { false };
+};
+#endif
+
 // Partially based on: https://stackoverflow.com/a/57554337
 
 // Required for ostream manipulators (e.g. std::endl or std::flush)
@@ -70,6 +337,12 @@ public:
 		m_verbosity = v;
 	}
 
+	// Allows skipping the formatting of messages that would be discarded anyway
+	bool IsEnabled() const
+	{
+		return m_lvl >= m_verbosity;
+	}
+
 	// Required for pure std::endl / std::flush calls (e.g. Logger << std::endl)
 	Logger& operator<<(ManipType manip)
 	{
@@ -80,27 +353,43 @@ public:
 	template<typename T>
 	void log(T& message)
 	{
-		std::lock_guard<std::mutex> lock(s_logMutex);
+		if (!IsEnabled()) return;
 
-		if (m_lvl >= m_verbosity)
+#ifdef CLAP_LOG_ASYNC_ACTIVE
+		if (AsyncLogSink::IsAvailable())
 		{
+			AsyncLogSink::Get().Push(&m_outStream, message.str());
+			return;
+		}
+#endif
+
+		std::lock_guard<std::mutex> lock(s_logMutex);
 #ifdef CLAP_USE_XIL_PRINTF
-			xil_printf("%s\r", message.str().c_str());
+		xil_printf("%s\r", message.str().c_str());
 #else
-			m_outStream << message.str();
+		m_outStream << message.str();
 #endif
-		}
-
-		message.flush();
 	}
 
 	// Specialization for ostream manipulators (e.g. std::endl or std::flush)
 	void log(ManipType manip)
 	{
-		std::lock_guard<std::mutex> lock(s_logMutex);
+		if (!IsEnabled()) return;
 
-		if (m_lvl >= m_verbosity)
-			m_outStream << manip;
+#ifdef CLAP_LOG_ASYNC_ACTIVE
+		if (AsyncLogSink::IsAvailable())
+		{
+			// The sink flushes the streams after each pass, only the characters inserted by the manipulator are queued
+			std::ostringstream ss;
+			ss << manip;
+			if (ss.tellp() > 0)
+				AsyncLogSink::Get().Push(&m_outStream, ss.str());
+			return;
+		}
+#endif
+
+		std::lock_guard<std::mutex> lock(s_logMutex);
+		m_outStream << manip;
 	}
 
 private:
@@ -125,7 +414,9 @@ public:
 	LoggerBuffer(LoggerBuffer&& buf) :
 		m_stream(std::move(buf.m_stream)),
 		m_pLogger(buf.m_pLogger)
-	{}
+	{
+		buf.m_pLogger = nullptr;
+	}
 
 	template<typename T>
 	LoggerBuffer& operator<<(T&& message)
@@ -159,13 +450,20 @@ LoggerBuffer operator<<(Logger& logger, T&& message)
 	return buf;
 }
 
+// Turns a complete log statement into a void expression, used by the CLAP_LOG_* macros
+struct LogVoidify
+{
+	void operator&(const LoggerBuffer&) const {}
+	void operator&(const Logger&) const {}
+};
+
 class LoggerContainer
 {
 public:
 	LoggerContainer()  = default;
 	~LoggerContainer() = default;
 
-	Logger& GetLogger(const Verbosity& v)
+	Logger& GetLogger([[maybe_unused]] const Verbosity& v)
 	{
 #ifdef CLAP_DISABLE_LOGGING
 		return m_none;
@@ -188,7 +486,7 @@ public:
 #endif
 	}
 
-	void SetVerbosity(const Verbosity& v)
+	void SetVerbosity([[maybe_unused]] const Verbosity& v)
 	{
 #ifndef CLAP_DISABLE_LOGGING
 		m_debug.SetVerbosity(v);
@@ -222,10 +520,10 @@ inline Logger& GetLogger(const Verbosity& v)
 	return GetLoggers().GetLogger(v);
 }
 
-template<typename T>
-constexpr typename std::underlying_type<T>::type ToUnderlying(const T& t) noexcept
+// Whether a message of the given level would be emitted, considering both the compile-time and the runtime level
+inline bool IsLogEnabled(const Verbosity& v)
 {
-	return static_cast<typename std::underlying_type<T>::type>(t);
+	return IsCompiledIn(v) && GetLogger(v).IsEnabled();
 }
 
 inline Verbosity ToVerbosity(const int32_t& val)
@@ -243,20 +541,50 @@ inline void SetVerbosity([[maybe_unused]] const Verbosity& v)
 #endif
 }
 
+// Blocks until all messages emitted so far have been written, a no-op without CLAP_LOG_ASYNC
+inline void FlushLogs()
+{
+#ifdef CLAP_LOG_ASYNC_ACTIVE
+	if (AsyncLogSink::IsAvailable())
+		AsyncLogSink::Get().Flush();
+#endif
+}
+
 } // namespace logging
 
-#ifndef CLAP_DISABLE_LOGGING
-#define CLAP_LOG_DEBUG   logging::GetLogger(logging::Verbosity::VB_DEBUG)
-#define CLAP_LOG_VERBOSE logging::GetLogger(logging::Verbosity::VB_VERBOSE)
-#define CLAP_LOG_INFO    logging::GetLogger(logging::Verbosity::VB_INFO)
-#define CLAP_LOG_WARNING logging::GetLogger(logging::Verbosity::VB_WARNING)
-#define CLAP_LOG_ERROR   logging::GetLogger(logging::Verbosity::VB_ERROR)
+// Statements whose level is disabled at runtime skip the formatting of all operands,
+// statements below CLAP_LOG_COMPILE_LEVEL are never evaluated and removed by the compiler.
+#define CLAP_LOG_STREAM(_V_) !logging::GetLogger(_V_).IsEnabled() ? (void)0 : logging::LogVoidify() & logging::GetLogger(_V_)
+#define CLAP_LOG_DISCARD     true ? (void)0 : logging::LogVoidify() & logging::GetLogger(logging::Verbosity::VB_NONE)
+
+#if !defined(CLAP_DISABLE_LOGGING) && CLAP_LOG_COMPILE_LEVEL <= 0
+#define CLAP_LOG_DEBUG CLAP_LOG_STREAM(logging::Verbosity::VB_DEBUG)
+#else
+#define CLAP_LOG_DEBUG CLAP_LOG_DISCARD
+#endif
+
+#if !defined(CLAP_DISABLE_LOGGING) && CLAP_LOG_COMPILE_LEVEL <= 1
+#define CLAP_LOG_VERBOSE CLAP_LOG_STREAM(logging::Verbosity::VB_VERBOSE)
+#else
+#define CLAP_LOG_VERBOSE CLAP_LOG_DISCARD
+#endif
+
+#if !defined(CLAP_DISABLE_LOGGING) && CLAP_LOG_COMPILE_LEVEL <= 2
+#define CLAP_LOG_INFO CLAP_LOG_STREAM(logging::Verbosity::VB_INFO)
+#else
+#define CLAP_LOG_INFO CLAP_LOG_DISCARD
+#endif
+
+#if !defined(CLAP_DISABLE_LOGGING) && CLAP_LOG_COMPILE_LEVEL <= 3
+#define CLAP_LOG_WARNING CLAP_LOG_STREAM(logging::Verbosity::VB_WARNING)
+#else
+#define CLAP_LOG_WARNING CLAP_LOG_DISCARD
+#endif
+
+#if !defined(CLAP_DISABLE_LOGGING) && CLAP_LOG_COMPILE_LEVEL <= 4
+#define CLAP_LOG_ERROR CLAP_LOG_STREAM(logging::Verbosity::VB_ERROR)
 #else
-#define CLAP_LOG_DEBUG   logging::GetLogger(logging::Verbosity::VB_NONE)
-#define CLAP_LOG_VERBOSE logging::GetLogger(logging::Verbosity::VB_NONE)
-#define CLAP_LOG_INFO    logging::GetLogger(logging::Verbosity::VB_NONE)
-#define CLAP_LOG_WARNING logging::GetLogger(logging::Verbosity::VB_NONE)
-#define CLAP_LOG_ERROR   logging::GetLogger(logging::Verbosity::VB_NONE)
+#define CLAP_LOG_ERROR CLAP_LOG_DISCARD
 #endif
 
 #define CLAP_CLASS_LOG_DEBUG   CLAP_LOG_DEBUG << CLASS_TAG_AUTO
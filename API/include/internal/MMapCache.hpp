@@ -0,0 +1,381 @@
+/*
+ *  File: MMapCache.hpp
+ *  Copyright (c) 2023 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+/////////////////////////
+// Include for mmap(), munmap()
+#include <sys/mman.h>
+/////////////////////////
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include "CopyKernels.hpp"
+#include "Defines.hpp"
+#include "Exceptions.hpp"
+#include "Logger.hpp"
+#include "Utils.hpp"
+
+namespace clap
+{
+namespace internal
+{
+// Keeps page-aligned windows of a memory device (e.g., /dev/mem) mapped
+// until they are evicted (LRU) or the cache is destroyed, this removes the
+// mmap/munmap syscall pair from every single access.
+class MMapCache
+{
+	DISABLE_COPY_ASSIGN_MOVE(MMapCache)
+
+	struct Window
+	{
+		uint64_t base    = 0;
+		uint8_t* pMem    = nullptr;
+		uint64_t lastUse = 0;
+	};
+
+public:
+	static constexpr uint64_t DEFAULT_WINDOW_SIZE    = 0x10000;
+	static constexpr std::size_t DEFAULT_MAX_WINDOWS = 16;
+
+	MMapCache() :
+		m_windows(),
+		m_mtx()
+	{}
+
+	~MMapCache()
+	{
+		clear();
+	}
+
+	void SetDevice(const DeviceHandle& fd)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		clear();
+		m_fd = fd;
+	}
+
+	void Configure(const uint64_t& windowSize, const std::size_t& maxWindows)
+	{
+		const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+
+		if (windowSize == 0 || (windowSize & (windowSize - 1)) != 0 || (windowSize % pageSize) != 0)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Invalid window size 0x" << std::hex << windowSize << ", the size has to be a power of two and a multiple of the page size (0x" << pageSize << ")" << std::dec;
+			throw CLAPException(ss.str());
+		}
+
+		if (maxWindows == 0)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "The number of windows has to be at least one";
+			throw CLAPException(ss.str());
+		}
+
+		std::lock_guard<std::mutex> lock(m_mtx);
+		clear();
+		m_windowSize = windowSize;
+		m_maxWindows = maxWindows;
+
+		CLAP_CLASS_LOG_DEBUG << "Window size: 0x" << std::hex << m_windowSize << std::dec << ", max windows: " << m_maxWindows << std::endl;
+	}
+
+	void SetCopyKernels(const CopyKernel& readKernel, const CopyKernel& writeKernel)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_readKernel  = readKernel;
+		m_writeKernel = writeKernel;
+	}
+
+	const uint64_t& GetWindowSize() const
+	{
+		return m_windowSize;
+	}
+
+	const std::size_t& GetMaxWindows() const
+	{
+		return m_maxWindows;
+	}
+
+	uint64_t Read(const uint64_t& addr, void* pData, const uint64_t& sizeInByte)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+
+		uint64_t count     = 0;
+		uint8_t* pByteData = reinterpret_cast<uint8_t*>(pData);
+
+		while (count < sizeInByte)
+		{
+			const uint64_t cAddr  = addr + count;
+			const uint64_t offset = cAddr & (m_windowSize - 1);
+			const uint64_t bytes  = std::min(sizeInByte - count, m_windowSize - offset);
+
+			const uint8_t* pMem = getWindow(cAddr) + offset;
+
+			if (!readSingle(pMem, pByteData + count, bytes))
+				CopyFromDevice(pByteData + count, pMem, bytes, m_readKernel);
+
+			count += bytes;
+		}
+
+		return count;
+	}
+
+	uint64_t Write(const uint64_t& addr, const void* pData, const uint64_t& sizeInByte)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+
+		uint64_t count           = 0;
+		const uint8_t* pByteData = reinterpret_cast<const uint8_t*>(pData);
+
+		while (count < sizeInByte)
+		{
+			const uint64_t cAddr  = addr + count;
+			const uint64_t offset = cAddr & (m_windowSize - 1);
+			const uint64_t bytes  = std::min(sizeInByte - count, m_windowSize - offset);
+
+			uint8_t* pMem = getWindow(cAddr) + offset;
+
+			if (!writeSingle(pMem, pByteData + count, bytes))
+				CopyToDevice(pMem, pByteData + count, bytes, m_writeKernel);
+
+			count += bytes;
+		}
+
+		return count;
+	}
+
+	// Calls func(pMem, bytes) for the part of the given range within each window, e.g., to maintain the CPU caches of the range
+	template<typename Func>
+	void ForEachWindow(const uint64_t& addr, const uint64_t& sizeInByte, Func func)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+
+		uint64_t count = 0;
+
+		while (count < sizeInByte)
+		{
+			const uint64_t cAddr  = addr + count;
+			const uint64_t offset = cAddr & (m_windowSize - 1);
+			const uint64_t bytes  = std::min(sizeInByte - count, m_windowSize - offset);
+
+			func(getWindow(cAddr) + offset, bytes);
+
+			count += bytes;
+		}
+	}
+
+	// Maps the given range into a dedicated mapping that is not managed (evicted) by the cache
+	void* MapRange(const uint64_t& addr, const uint64_t& sizeInByte)
+	{
+		uint64_t base;
+		uint64_t length;
+		getPageRange(addr, sizeInByte, base, length);
+
+		std::lock_guard<std::mutex> lock(m_mtx);
+
+		void* pMapBase = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, static_cast<off_t>(base));
+		int32_t errsv  = errno;
+
+		if (pMapBase == MAP_FAILED)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Failed to map 0x" << std::hex << length << " byte at address 0x" << base << std::dec << "; errno: " << errsv;
+			throw CLAPException(ss.str());
+		}
+
+		return reinterpret_cast<uint8_t*>(pMapBase) + (addr - base);
+	}
+
+	void UnmapRange(const uint64_t& addr, void* pMem, const uint64_t& sizeInByte)
+	{
+		uint64_t base;
+		uint64_t length;
+		getPageRange(addr, sizeInByte, base, length);
+
+		munmap(reinterpret_cast<uint8_t*>(pMem) - (addr - base), length);
+	}
+
+private:
+	// Returns the base pointer of the window containing addr, mapping it if required
+	uint8_t* getWindow(const uint64_t& addr)
+	{
+		const uint64_t base = addr & ~(m_windowSize - 1);
+
+		m_useCnt++;
+
+		// Fast path: Consecutive accesses, e.g., register polling, usually hit the same window
+		if (m_lastIdx < m_windows.size() && m_windows[m_lastIdx].base == base)
+		{
+			m_windows[m_lastIdx].lastUse = m_useCnt;
+			return m_windows[m_lastIdx].pMem;
+		}
+
+		for (std::size_t i = 0; i < m_windows.size(); i++)
+		{
+			if (m_windows[i].base == base)
+			{
+				m_lastIdx            = i;
+				m_windows[i].lastUse = m_useCnt;
+				return m_windows[i].pMem;
+			}
+		}
+
+		void* pMapBase = mmap(NULL, m_windowSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, static_cast<off_t>(base));
+		int32_t errsv  = errno;
+
+		if (pMapBase == MAP_FAILED)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Failed to map 0x" << std::hex << m_windowSize << " byte at address 0x" << base << std::dec << "; errno: " << errsv;
+			throw CLAPException(ss.str());
+		}
+
+		Window window;
+		window.base    = base;
+		window.pMem    = reinterpret_cast<uint8_t*>(pMapBase);
+		window.lastUse = m_useCnt;
+
+		if (m_windows.size() < m_maxWindows)
+		{
+			m_windows.push_back(window);
+			m_lastIdx = m_windows.size() - 1;
+		}
+		else
+		{
+			// Evict the least recently used window
+			std::size_t lruIdx = 0;
+			for (std::size_t i = 1; i < m_windows.size(); i++)
+			{
+				if (m_windows[i].lastUse < m_windows[lruIdx].lastUse)
+					lruIdx = i;
+			}
+
+			CLAP_CLASS_LOG_DEBUG << "Evicting window at 0x" << std::hex << m_windows[lruIdx].base << " for 0x" << base << std::dec << std::endl;
+
+			munmap(m_windows[lruIdx].pMem, m_windowSize);
+			m_windows[lruIdx] = window;
+			m_lastIdx         = lruIdx;
+		}
+
+		return window.pMem;
+	}
+
+	// Register sized, aligned accesses are performed as a single volatile load/store
+	static bool readSingle(const uint8_t* pMem, uint8_t* pData, const uint64_t& bytes)
+	{
+		switch (bytes)
+		{
+			case 1:
+				return readSingle<uint8_t>(pMem, pData);
+			case 2:
+				return readSingle<uint16_t>(pMem, pData);
+			case 4:
+				return readSingle<uint32_t>(pMem, pData);
+			case 8:
+				return readSingle<uint64_t>(pMem, pData);
+			default:
+				return false;
+		}
+	}
+
+	template<typename U>
+	static bool readSingle(const uint8_t* pMem, uint8_t* pData)
+	{
+		if (!IS_ALIGNED(pMem, sizeof(U))) return false;
+
+		const U value = *reinterpret_cast<const volatile U*>(pMem);
+		std::memcpy(pData, &value, sizeof(U));
+		return true;
+	}
+
+	static bool writeSingle(uint8_t* pMem, const uint8_t* pData, const uint64_t& bytes)
+	{
+		switch (bytes)
+		{
+			case 1:
+				return writeSingle<uint8_t>(pMem, pData);
+			case 2:
+				return writeSingle<uint16_t>(pMem, pData);
+			case 4:
+				return writeSingle<uint32_t>(pMem, pData);
+			case 8:
+				return writeSingle<uint64_t>(pMem, pData);
+			default:
+				return false;
+		}
+	}
+
+	template<typename U>
+	static bool writeSingle(uint8_t* pMem, const uint8_t* pData)
+	{
+		if (!IS_ALIGNED(pMem, sizeof(U))) return false;
+
+		U value;
+		std::memcpy(&value, pData, sizeof(U));
+		*reinterpret_cast<volatile U*>(pMem) = value;
+		return true;
+	}
+
+	static void getPageRange(const uint64_t& addr, const uint64_t& sizeInByte, uint64_t& base, uint64_t& length)
+	{
+		const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+
+		base   = addr & ~(pageSize - 1);
+		length = ((addr + sizeInByte - base + pageSize - 1) / pageSize) * pageSize;
+	}
+
+	void clear()
+	{
+		for (const Window& window : m_windows)
+			munmap(window.pMem, m_windowSize);
+
+		m_windows.clear();
+		m_lastIdx = 0;
+	}
+
+private:
+	DeviceHandle m_fd             = INVALID_HANDLE;
+	uint64_t m_windowSize         = DEFAULT_WINDOW_SIZE;
+	std::size_t m_maxWindows      = DEFAULT_MAX_WINDOWS;
+	std::vector<Window> m_windows;
+	std::size_t m_lastIdx         = 0;
+	uint64_t m_useCnt             = 0;
+	CopyKernel m_readKernel       = CopyKernel::MemCpy;
+	CopyKernel m_writeKernel      = CopyKernel::MemCpy;
+	std::mutex m_mtx;
+};
+} // namespace internal
+} // namespace clap
@@ -28,13 +28,20 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <iomanip>
+#include <iterator>
 #include <list>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <ostream>
+#include <set>
 #include <sstream>
+#include <unordered_map>
+#include <vector>
 
 #include "Exceptions.hpp"
+#include "SharedAllocator.hpp"
 #include "StdStub.hpp"
 
 namespace clap
@@ -42,14 +49,58 @@ namespace clap
 // Forward declaration is required here to allow for the friend declaration
 // TODO: Find a better way to do this -- maybe a separate header file?
 // TODO: Add a destructor to free the memory on destruction -- This will need to be propagated to the MemoryManager -- MM check for invalid memory objs on alloc and cleanup?
+class MemoryPool;
+class CLAP;
+
 namespace internal
 {
 class MemoryManager;
 }
 
+enum class AllocStrategy
+{
+	FirstFit, // Linear search through an unordered free list, suited for few large allocations
+	BestFit   // Free blocks ordered by address and size, O(log n) allocation and release
+};
+
+// Selects the region of a memory type used by allocations that do not specify a region index
+enum class RegionPolicy
+{
+	FirstFit,   // First region with enough space left, fills the regions one after another
+	RoundRobin, // Cycles through the regions, e.g., to spread the buffers across the HBM pseudo-channels
+	LeastUsed   // Region with the smallest fraction of its space allocated
+};
+
+struct FragmentationReport
+{
+	uint64_t totalSize        = 0;
+	uint64_t freeSize         = 0;
+	uint64_t largestFreeBlock = 0;
+	std::size_t freeBlocks    = 0;
+	std::size_t usedBlocks    = 0;
+
+	// 0.0 if all free memory is contiguous, approaches 1.0 the more the free memory is scattered
+	double GetFragmentation() const
+	{
+		if (freeSize == 0) return 0.0;
+		return 1.0 - static_cast<double>(largestFreeBlock) / static_cast<double>(freeSize);
+	}
+
+	friend std::ostream& operator<<(std::ostream& stream, const FragmentationReport& r)
+	{
+		const std::streamsize precision = stream.precision();
+
+		stream << "Total: " << r.totalSize << " byte; Free: " << r.freeSize << " byte in " << r.freeBlocks << " blocks; Largest free block: "
+			   << r.largestFreeBlock << " byte; Used blocks: " << r.usedBlocks << "; Fragmentation: " << std::fixed << std::setprecision(2)
+			   << r.GetFragmentation() * 100.0 << "%" << std::defaultfloat << std::setprecision(precision);
+		return stream;
+	}
+};
+
 class Memory
 {
 	friend class internal::MemoryManager;
+	friend class MemoryPool;
 
 public:
 	Memory() = default;
@@ -112,6 +163,76 @@ private:
 	bool m_valid        = false;
 };
 
+// Memory block spread across multiple regions (banks), e.g., HBM pseudo-channels.
+// Bank i holds the i-th contiguous part of the block, all parts except the last one are GetStripeSize() byte large.
+class StripedMemory
+{
+	friend class CLAP;
+
+public:
+	StripedMemory() = default;
+
+	const std::vector<Memory>& GetBanks() const
+	{
+		return m_banks;
+	}
+
+	std::size_t GetBankCount() const
+	{
+		return m_banks.size();
+	}
+
+	const Memory& GetBank(const std::size_t& idx) const
+	{
+		if (idx >= m_banks.size())
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "ERROR: Bank " << std::dec << idx << " does not exist, the memory is striped across " << m_banks.size() << " banks.";
+			throw MemoryException(ss.str());
+		}
+
+		return m_banks[idx];
+	}
+
+	const uint64_t& GetSize() const
+	{
+		return m_size;
+	}
+
+	const uint64_t& GetStripeSize() const
+	{
+		return m_stripeSize;
+	}
+
+	bool IsValid() const
+	{
+		return !m_banks.empty() && std::all_of(m_banks.begin(), m_banks.end(), [](const Memory& m) { return m.IsValid(); });
+	}
+
+	friend std::ostream& operator<<(std::ostream& stream, const StripedMemory& m)
+	{
+		stream << "Size=" << std::showbase << std::hex << m.m_size << "; StripeSize=" << m.m_stripeSize << std::dec << std::noshowbase << "; Banks=" << m.m_banks.size();
+
+		for (std::size_t i = 0; i < m.m_banks.size(); i++)
+			stream << std::endl
+				   << "  [" << i << "] " << m.m_banks[i];
+
+		return stream;
+	}
+
+private:
+	StripedMemory(std::vector<Memory> banks, const uint64_t& size, const uint64_t& stripeSize) :
+		m_banks(std::move(banks)),
+		m_size(size),
+		m_stripeSize(stripeSize)
+	{}
+
+private:
+	std::vector<Memory> m_banks = {};
+	uint64_t m_size             = 0;
+	uint64_t m_stripeSize       = 0;
+};
+
 namespace internal
 {
 class MemoryManager
@@ -120,19 +241,40 @@ class MemoryManager
 	static constexpr uint32_t COALESCE_THRESHOLD = 4;
 	static constexpr uint64_t INV_NULL           = ~static_cast<uint64_t>(0);
 	using MemList                                = std::list<std::pair<uint64_t, uint64_t>>;
+	using AddrMap                                = std::map<uint64_t, uint64_t>;          // addr -> size
+	using SizeSet                                = std::set<std::pair<uint64_t, uint64_t>>; // (size, addr)
 
 public:
-	MemoryManager(const uint64_t& baseAddr, const uint64_t& size) :
+	MemoryManager(const uint64_t& baseAddr, const uint64_t& size, const AllocStrategy& strategy = AllocStrategy::FirstFit) :
 		m_baseAddr(baseAddr),
 		m_size(size),
 		m_spaceLeft(size),
+		m_strategy(strategy),
 		m_mutex(),
 		m_freeMemory(),
-		m_usedMemory()
+		m_usedMemory(),
+		m_freeByAddr(),
+		m_freeBySize(),
+		m_usedByAddr()
 	{
-		m_freeMemory.push_back(std::make_pair(m_baseAddr, m_size));
+		initFreeMemory();
 	}
 
+	// Region whose allocations are shared with all processes attaching to the same name, see SharedAllocator
+	MemoryManager(const uint64_t& baseAddr, const uint64_t& size, const std::string& sharedName, const uint32_t& sharedMode = SharedAllocator::DEFAULT_MODE) :
+		m_baseAddr(baseAddr),
+		m_size(size),
+		m_spaceLeft(size),
+		m_strategy(AllocStrategy::FirstFit),
+		m_mutex(),
+		m_freeMemory(),
+		m_usedMemory(),
+		m_freeByAddr(),
+		m_freeBySize(),
+		m_usedByAddr(),
+		m_pShared(std::make_unique<SharedAllocator>(sharedName, baseAddr, size, sharedMode))
+	{}
+
 	DISABLE_COPY_ASSIGN_MOVE(MemoryManager)
 
 	Memory AllocMemory(const uint64_t& size)
@@ -144,7 +286,8 @@ public:
 			throw MemoryException(ss.str());
 		}
 
-		if (size > m_spaceLeft)
+		// Shared regions decide in Alloc, which first reclaims the blocks of terminated processes
+		if (!m_pShared && size > GetAvailableSpace())
 		{
 			std::stringstream ss;
 			ss << CLASS_TAG_AUTO << "Not enough memory left to allocate " << std::dec << size << " byte.";
@@ -160,29 +303,7 @@ public:
 
 		std::lock_guard<std::mutex> lock(m_mutex);
 
-		uint64_t addr = INV_NULL;
-
-		for (auto it = m_freeMemory.begin(); it != m_freeMemory.end(); it++)
-		{
-			// Check if the current element has enough free space
-			if (it->second < alignedSize) continue;
-
-			addr = it->first;
-
-			// If the region is bigger than the amount requested
-			// Update the memory left in the current region
-			if (it->second > alignedSize)
-			{
-				it->first += alignedSize;
-				it->second -= alignedSize;
-			}
-			// Else remove the region from the list and update the iterator
-			else
-			{
-				m_freeMemory.erase(it++);
-				if (it == m_freeMemory.end()) break;
-			}
-		}
+		const uint64_t addr = allocate(alignedSize);
 
 		if (addr == INV_NULL)
 		{
@@ -191,9 +312,6 @@ public:
 			throw MemoryException(ss.str());
 		}
 
-		m_usedMemory.push_back(std::make_pair(addr, alignedSize));
-		m_spaceLeft -= alignedSize;
-
 		return Memory(addr, size);
 	}
 
@@ -201,38 +319,106 @@ public:
 	{
 		std::lock_guard<std::mutex> lock(m_mutex);
 
-		// Search for the given address in the list of used memory regions
-		MemList::iterator it = std::find_if(m_usedMemory.begin(), m_usedMemory.end(), [buffer](const MemList::value_type& p) { return p.first == buffer.m_baseAddr; });
-		// Check if the given address was found
-		if (it == m_usedMemory.end()) return false;
-
-		m_spaceLeft += it->second;
-		m_freeMemory.push_front(std::make_pair(it->first, it->second));
-		m_usedMemory.erase(it);
+		if (m_pShared)
+		{
+			if (!m_pShared->Free(buffer.m_baseAddr))
+				return false;
+		}
+		else if (!(m_strategy == AllocStrategy::BestFit ? freeBestFit(buffer.m_baseAddr) : freeFirstFit(buffer.m_baseAddr)))
+			return false;
 
 		buffer.invalidate();
 
-		if (m_freeMemory.size() > COALESCE_THRESHOLD)
-			coalesce();
-
 		return true;
 	}
 
 	uint64_t GetAvailableSpace() const
 	{
+		if (m_pShared) return m_pShared->GetSpaceLeft();
 		return m_spaceLeft;
 	}
 
+	// Whether at least size byte are left, shared regions reclaim the blocks of terminated processes if required
+	bool HasSpaceLeft(const uint64_t& size)
+	{
+		if (m_pShared) return m_pShared->HasSpaceLeft(size);
+		return (m_spaceLeft >= size);
+	}
+
+	bool IsShared() const
+	{
+		return (m_pShared != nullptr);
+	}
+
+	const uint64_t& GetSize() const
+	{
+		return m_size;
+	}
+
 	void Reset()
 	{
 		std::lock_guard<std::mutex> lock(m_mutex);
 
+		// Only the blocks of this process are freed, the other processes sharing the region keep theirs
+		if (m_pShared)
+		{
+			m_pShared->ReleaseOwned();
+			return;
+		}
+
 		m_freeMemory.clear();
 		m_usedMemory.clear();
-		m_freeMemory.push_back(std::make_pair(m_baseAddr, m_size));
+		m_freeByAddr.clear();
+		m_freeBySize.clear();
+		m_usedByAddr.clear();
+		initFreeMemory();
 		m_spaceLeft = m_size;
 	}
 
+	const AllocStrategy& GetStrategy() const
+	{
+		return m_strategy;
+	}
+
+	FragmentationReport GetFragmentationReport()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		FragmentationReport report;
+		report.totalSize = m_size;
+		report.freeSize  = m_spaceLeft;
+
+		if (m_pShared)
+		{
+			const SharedAllocator::Stats stats = m_pShared->GetStats();
+			report.freeSize                    = stats.spaceLeft;
+			report.freeBlocks                  = stats.freeBlocks;
+			report.usedBlocks                  = stats.usedBlocks;
+			report.largestFreeBlock            = stats.largestFreeBlock;
+		}
+		else if (m_strategy == AllocStrategy::BestFit)
+		{
+			report.freeBlocks = m_freeBySize.size();
+			report.usedBlocks = m_usedByAddr.size();
+
+			if (!m_freeBySize.empty())
+				report.largestFreeBlock = m_freeBySize.rbegin()->first;
+		}
+		else
+		{
+			// Merge adjacent free regions first to not report fragmentation that is only deferred coalescing
+			coalesce();
+
+			report.freeBlocks = m_freeMemory.size();
+			report.usedBlocks = m_usedMemory.size();
+
+			for (const MemList::value_type& region : m_freeMemory)
+				report.largestFreeBlock = std::max(report.largestFreeBlock, region.second);
+		}
+
+		return report;
+	}
+
 	void SetCustomAlignment(const int32_t& alignment)
 	{
 		m_alignment = alignment;
@@ -244,6 +430,140 @@ public:
 	}
 
 private:
+	void initFreeMemory()
+	{
+		if (m_strategy == AllocStrategy::BestFit)
+		{
+			m_freeByAddr.emplace(m_baseAddr, m_size);
+			m_freeBySize.emplace(m_size, m_baseAddr);
+		}
+		else
+			m_freeMemory.push_back(std::make_pair(m_baseAddr, m_size));
+	}
+
+	uint64_t allocate(const uint64_t& alignedSize)
+	{
+		if (m_pShared)
+		{
+			const uint64_t addr = m_pShared->Alloc(alignedSize);
+			return (addr == SharedAllocator::INV_NULL ? INV_NULL : addr);
+		}
+
+		const uint64_t addr = (m_strategy == AllocStrategy::BestFit ? allocBestFit(alignedSize) : allocFirstFit(alignedSize));
+
+		if (addr != INV_NULL)
+			m_spaceLeft -= alignedSize;
+
+		return addr;
+	}
+
+	uint64_t allocFirstFit(const uint64_t& alignedSize)
+	{
+		for (auto it = m_freeMemory.begin(); it != m_freeMemory.end(); it++)
+		{
+			// Check if the current element has enough free space
+			if (it->second < alignedSize) continue;
+
+			const uint64_t addr = it->first;
+
+			// If the region is bigger than the amount requested
+			// Update the memory left in the current region
+			if (it->second > alignedSize)
+			{
+				it->first += alignedSize;
+				it->second -= alignedSize;
+			}
+			// Else remove the region from the list
+			else
+				m_freeMemory.erase(it);
+
+			m_usedMemory.push_back(std::make_pair(addr, alignedSize));
+			return addr;
+		}
+
+		return INV_NULL;
+	}
+
+	bool freeFirstFit(const uint64_t& addr)
+	{
+		// Search for the given address in the list of used memory regions
+		MemList::iterator it = std::find_if(m_usedMemory.begin(), m_usedMemory.end(), [addr](const MemList::value_type& p) { return p.first == addr; });
+		// Check if the given address was found
+		if (it == m_usedMemory.end()) return false;
+
+		m_spaceLeft += it->second;
+		m_freeMemory.push_front(std::make_pair(it->first, it->second));
+		m_usedMemory.erase(it);
+
+		if (m_freeMemory.size() > COALESCE_THRESHOLD)
+			coalesce();
+
+		return true;
+	}
+
+	uint64_t allocBestFit(const uint64_t& alignedSize)
+	{
+		// Smallest free block that is large enough, ties are resolved by the lowest address
+		SizeSet::iterator it = m_freeBySize.lower_bound(std::make_pair(alignedSize, static_cast<uint64_t>(0)));
+		if (it == m_freeBySize.end()) return INV_NULL;
+
+		const uint64_t blockSize = it->first;
+		const uint64_t addr      = it->second;
+
+		m_freeBySize.erase(it);
+		m_freeByAddr.erase(addr);
+
+		if (blockSize > alignedSize)
+			insertFreeBlock(addr + alignedSize, blockSize - alignedSize);
+
+		m_usedByAddr.emplace(addr, alignedSize);
+		return addr;
+	}
+
+	bool freeBestFit(const uint64_t& addr)
+	{
+		std::unordered_map<uint64_t, uint64_t>::iterator it = m_usedByAddr.find(addr);
+		if (it == m_usedByAddr.end()) return false;
+
+		uint64_t blockAddr = it->first;
+		uint64_t blockSize = it->second;
+
+		m_spaceLeft += blockSize;
+		m_usedByAddr.erase(it);
+
+		// Merge with the directly following free block
+		AddrMap::iterator next = m_freeByAddr.lower_bound(blockAddr);
+		if (next != m_freeByAddr.end() && blockAddr + blockSize == next->first)
+		{
+			blockSize += next->second;
+			m_freeBySize.erase(std::make_pair(next->second, next->first));
+			next = m_freeByAddr.erase(next);
+		}
+
+		// Merge with the directly preceding free block
+		if (next != m_freeByAddr.begin())
+		{
+			AddrMap::iterator prev = std::prev(next);
+			if (prev->first + prev->second == blockAddr)
+			{
+				blockAddr = prev->first;
+				blockSize += prev->second;
+				m_freeBySize.erase(std::make_pair(prev->second, prev->first));
+				m_freeByAddr.erase(prev);
+			}
+		}
+
+		insertFreeBlock(blockAddr, blockSize);
+
+		return true;
+	}
+
+	void insertFreeBlock(const uint64_t& addr, const uint64_t& size)
+	{
+		m_freeByAddr.emplace(addr, size);
+		m_freeBySize.emplace(size, addr);
+	}
+
 	void coalesce()
 	{
 		m_freeMemory.sort();
@@ -277,10 +597,18 @@ private:
 	uint64_t m_baseAddr;
 	uint64_t m_size;
 	uint64_t m_spaceLeft;
+	AllocStrategy m_strategy;
 	std::mutex m_mutex;
+	// First-fit
 	MemList m_freeMemory;
 	MemList m_usedMemory;
-	int32_t m_alignment = -1;
+	// Best-fit
+	AddrMap m_freeByAddr;
+	SizeSet m_freeBySize;
+	std::unordered_map<uint64_t, uint64_t> m_usedByAddr;
+	// Shared mode, the metadata of the region lives in a shared-memory segment instead of the lists above
+	std::unique_ptr<SharedAllocator> m_pShared = nullptr;
+	int32_t m_alignment                        = -1;
 };
 } // namespace internal
 } // namespace clap
\ No newline at end of file
@@ -0,0 +1,284 @@
+/*
+ *  File: MemoryPool.hpp
+ *  Copyright (c) 2023 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+
+#include "Exceptions.hpp"
+#include "Memory.hpp"
+#include "Types.hpp"
+#include "Utils.hpp"
+
+namespace clap
+{
+class MemoryPool;
+
+using MemoryPoolPtr = std::shared_ptr<MemoryPool>;
+
+// Slot of a memory pool, the slot is returned to the pool when the object is destroyed
+class PooledMemory
+{
+	friend class MemoryPool;
+
+public:
+	PooledMemory() = default;
+
+	~PooledMemory()
+	{
+		release();
+	}
+
+	PooledMemory(const PooledMemory&)            = delete;
+	PooledMemory& operator=(const PooledMemory&) = delete;
+
+	PooledMemory(PooledMemory&& other) noexcept :
+		m_pPool(std::move(other.m_pPool)),
+		m_mem(other.m_mem),
+		m_slot(other.m_slot)
+	{
+		other.m_mem = Memory();
+	}
+
+	PooledMemory& operator=(PooledMemory&& other) noexcept
+	{
+		if (this != &other)
+		{
+			release();
+			m_pPool     = std::move(other.m_pPool);
+			m_mem       = other.m_mem;
+			m_slot      = other.m_slot;
+			other.m_mem = Memory();
+		}
+
+		return *this;
+	}
+
+	const Memory& Get() const
+	{
+		return m_mem;
+	}
+
+	operator const Memory&() const
+	{
+		return m_mem;
+	}
+
+	const uint64_t& GetBaseAddr() const
+	{
+		return m_mem.GetBaseAddr();
+	}
+
+	const uint64_t& GetSize() const
+	{
+		return m_mem.GetSize();
+	}
+
+	bool IsValid() const
+	{
+		return (m_pPool != nullptr && m_mem.IsValid());
+	}
+
+private:
+	PooledMemory(MemoryPoolPtr pPool, const Memory& mem, const uint32_t& slot) :
+		m_pPool(std::move(pPool)),
+		m_mem(mem),
+		m_slot(slot)
+	{}
+
+	// Defined after MemoryPool
+	void release();
+
+private:
+	MemoryPoolPtr m_pPool = nullptr;
+	Memory m_mem          = {};
+	uint32_t m_slot       = 0;
+};
+
+// Fixed-size slots carved out of a single memory region that is reserved once on creation.
+// Free slots are kept in a lock-free stack, i.e., acquiring and releasing a slot only takes a few atomic operations.
+class MemoryPool : public std::enable_shared_from_this<MemoryPool>
+{
+	DISABLE_COPY_ASSIGN_MOVE(MemoryPool)
+
+	friend class PooledMemory;
+
+	static constexpr uint32_t EMPTY = internal::MINUS_ONE_U;
+
+public:
+	static constexpr uint64_t SLOT_ALIGNMENT = 0x40;
+
+	/// @brief Creates a memory pool on top of an already allocated memory region
+	/// @param pManager Memory manager the region was allocated from, the region is returned to it on destruction
+	/// @param region Memory region backing the pool
+	/// @param slotSize Size of a single slot in bytes
+	/// @param slotCount Number of slots
+	MemoryPool(internal::MemoryManagerPtr pManager, const Memory& region, const uint64_t& slotSize, const uint32_t& slotCount) :
+		m_pManager(std::move(pManager)),
+		m_region(region),
+		m_slotSize(slotSize),
+		m_slotStride(GetSlotStride(slotSize)),
+		m_slotCount(slotCount),
+		m_next(std::make_unique<std::atomic<uint32_t>[]>(slotCount)),
+		m_head(0),
+		m_freeSlots(slotCount)
+	{
+		if (slotCount == 0 || slotCount == EMPTY || m_slotStride * slotCount > m_region.GetSize())
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Memory region of " << m_region.GetSize() << " byte cannot hold " << slotCount << " slots of " << m_slotStride << " byte";
+			throw MemoryException(ss.str());
+		}
+
+		for (uint32_t i = 0; i < slotCount; i++)
+			m_next[i].store(i + 1 < slotCount ? i + 1 : EMPTY, std::memory_order_relaxed);
+
+		m_head.store(pack(0, 0), std::memory_order_release);
+	}
+
+	~MemoryPool()
+	{
+		m_pManager->FreeMemory(m_region);
+	}
+
+	/// @brief Returns the stride of the slots for the given slot size, i.e., the slot size rounded up to SLOT_ALIGNMENT
+	static uint64_t GetSlotStride(const uint64_t& slotSize)
+	{
+		return ((slotSize + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT) * SLOT_ALIGNMENT;
+	}
+
+	/// @brief Acquires a free slot, throws a MemoryException if the pool is exhausted
+	/// @return Slot that is released back into the pool on destruction
+	PooledMemory Acquire()
+	{
+		PooledMemory mem;
+
+		if (!TryAcquire(mem))
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "All " << m_slotCount << " slots of the memory pool are in use";
+			throw MemoryException(ss.str());
+		}
+
+		return mem;
+	}
+
+	/// @brief Tries to acquire a free slot
+	/// @param mem Acquired slot
+	/// @return true if a slot was acquired, false if the pool is exhausted
+	bool TryAcquire(PooledMemory& mem)
+	{
+		uint64_t head = m_head.load(std::memory_order_acquire);
+
+		while (true)
+		{
+			const uint32_t slot = index(head);
+			if (slot == EMPTY) return false;
+
+			// The tag in the upper half of the head prevents ABA issues when a slot is released and acquired concurrently
+			const uint64_t newHead = pack(m_next[slot].load(std::memory_order_relaxed), tag(head) + 1);
+
+			if (m_head.compare_exchange_weak(head, newHead, std::memory_order_acq_rel, std::memory_order_acquire))
+			{
+				m_freeSlots.fetch_sub(1, std::memory_order_relaxed);
+				mem = PooledMemory(shared_from_this(), Memory(m_region.GetBaseAddr() + slot * m_slotStride, m_slotSize), slot);
+				return true;
+			}
+		}
+	}
+
+	const uint64_t& GetSlotSize() const
+	{
+		return m_slotSize;
+	}
+
+	const uint32_t& GetSlotCount() const
+	{
+		return m_slotCount;
+	}
+
+	// Snapshot, the value might already be outdated when the function returns
+	uint32_t GetFreeSlots() const
+	{
+		return m_freeSlots.load(std::memory_order_relaxed);
+	}
+
+	const Memory& GetRegion() const
+	{
+		return m_region;
+	}
+
+private:
+	void release(const uint32_t& slot)
+	{
+		uint64_t head = m_head.load(std::memory_order_relaxed);
+
+		do
+		{
+			m_next[slot].store(index(head), std::memory_order_relaxed);
+		} while (!m_head.compare_exchange_weak(head, pack(slot, tag(head) + 1), std::memory_order_release, std::memory_order_relaxed));
+
+		m_freeSlots.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	static uint64_t pack(const uint32_t& slot, const uint32_t& tag)
+	{
+		return (static_cast<uint64_t>(tag) << 32) | slot;
+	}
+
+	static uint32_t index(const uint64_t& head)
+	{
+		return static_cast<uint32_t>(head & 0xFFFFFFFF);
+	}
+
+	static uint32_t tag(const uint64_t& head)
+	{
+		return static_cast<uint32_t>(head >> 32);
+	}
+
+private:
+	internal::MemoryManagerPtr m_pManager;
+	Memory m_region;
+	uint64_t m_slotSize;
+	uint64_t m_slotStride;
+	uint32_t m_slotCount;
+	std::unique_ptr<std::atomic<uint32_t>[]> m_next;
+	std::atomic<uint64_t> m_head;
+	std::atomic<uint32_t> m_freeSlots;
+};
+
+inline void PooledMemory::release()
+{
+	if (!m_pPool) return;
+
+	m_pPool->release(m_slot);
+	m_pPool.reset();
+	m_mem = Memory();
+}
+} // namespace clap
@@ -0,0 +1,197 @@
+/*
+ *  File: MemoryView.hpp
+ *  Copyright (c) 2023 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <type_traits>
+
+#include "CLAPBackend.hpp"
+#include "Exceptions.hpp"
+#include "Memory.hpp"
+#include "Types.hpp"
+#include "Utils.hpp"
+
+namespace clap
+{
+// Typed view of device memory that is directly mapped into the address space of the host, i.e., the data
+// can be processed in place without copying it into a host buffer. Before reading data written by the device
+// Invalidate has to be called, after writing data that is consumed by the device Flush has to be called.
+template<typename T>
+class MemoryView
+{
+	static_assert(std::is_trivially_copyable<T>::value, "MemoryView requires a trivially copyable type");
+
+public:
+	MemoryView(internal::CLAPBackendPtr pBackend, const Memory& mem) :
+		m_pBackend(std::move(pBackend)),
+		m_addr(mem.GetBaseAddr()),
+		m_byteSize(mem.GetSize()),
+		m_pData(nullptr)
+	{
+		if (m_byteSize % sizeof(T) != 0)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Memory size (" << m_byteSize << ") is not a multiple of the element size (" << sizeof(T) << ")";
+			throw CLAPException(ss.str());
+		}
+
+		m_pData = reinterpret_cast<T*>(m_pBackend->MapMemory(m_addr, m_byteSize));
+
+		if (m_pData == nullptr)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "The " << m_pBackend->GetBackendName() << " backend does not support mapping device memory";
+			throw CLAPException(ss.str());
+		}
+
+		if (!IS_ALIGNED(m_pData, alignof(T)))
+		{
+			m_pBackend->UnmapMemory(m_addr, m_pData, m_byteSize);
+
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Mapped memory at 0x" << std::hex << m_addr << std::dec << " is not aligned to " << alignof(T) << " bytes";
+			throw CLAPException(ss.str());
+		}
+	}
+
+	~MemoryView()
+	{
+		unmap();
+	}
+
+	MemoryView(const MemoryView&)            = delete;
+	MemoryView& operator=(const MemoryView&) = delete;
+
+	MemoryView(MemoryView&& other) noexcept :
+		m_pBackend(std::move(other.m_pBackend)),
+		m_addr(other.m_addr),
+		m_byteSize(other.m_byteSize),
+		m_pData(other.m_pData)
+	{
+		other.m_pData = nullptr;
+	}
+
+	MemoryView& operator=(MemoryView&& other) noexcept
+	{
+		if (this != &other)
+		{
+			unmap();
+			m_pBackend    = std::move(other.m_pBackend);
+			m_addr        = other.m_addr;
+			m_byteSize    = other.m_byteSize;
+			m_pData       = other.m_pData;
+			other.m_pData = nullptr;
+		}
+
+		return *this;
+	}
+
+	/// @brief Makes all host writes to the view visible to the device
+	void Flush()
+	{
+		m_pBackend->FlushMapped(m_pData, m_byteSize);
+	}
+
+	/// @brief Discards cached data, has to be called before reading data that was written by the device
+	void Invalidate()
+	{
+		m_pBackend->InvalidateMapped(m_pData, m_byteSize);
+	}
+
+	T* data()
+	{
+		return m_pData;
+	}
+
+	const T* data() const
+	{
+		return m_pData;
+	}
+
+	std::size_t size() const
+	{
+		return static_cast<std::size_t>(m_byteSize / sizeof(T));
+	}
+
+	T& operator[](const std::size_t& idx)
+	{
+		return m_pData[idx];
+	}
+
+	const T& operator[](const std::size_t& idx) const
+	{
+		return m_pData[idx];
+	}
+
+	T* begin()
+	{
+		return m_pData;
+	}
+
+	T* end()
+	{
+		return m_pData + size();
+	}
+
+	const T* begin() const
+	{
+		return m_pData;
+	}
+
+	const T* end() const
+	{
+		return m_pData + size();
+	}
+
+	const uint64_t& GetBaseAddr() const
+	{
+		return m_addr;
+	}
+
+	const uint64_t& GetByteSize() const
+	{
+		return m_byteSize;
+	}
+
+private:
+	void unmap()
+	{
+		if (m_pData == nullptr) return;
+
+		m_pBackend->UnmapMemory(m_addr, m_pData, m_byteSize);
+		m_pData = nullptr;
+	}
+
+private:
+	internal::CLAPBackendPtr m_pBackend;
+	uint64_t m_addr;
+	uint64_t m_byteSize;
+	T* m_pData;
+};
+} // namespace clap
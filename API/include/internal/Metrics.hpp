@@ -0,0 +1,370 @@
+/*
+ *  File: Metrics.hpp
+ *  Copyright (c) 2024 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "Utils.hpp"
+
+namespace clap
+{
+// Log-linear histogram layout: values below 2^SUB_BITS are counted exactly, above that every power
+// of two is split into 2^SUB_BITS buckets, i.e., each bucket covers at most 12.5% of its value
+static constexpr uint32_t HISTOGRAM_SUB_BITS    = 3;
+static constexpr uint32_t HISTOGRAM_SUB_BUCKETS = 1 << HISTOGRAM_SUB_BITS;
+static constexpr uint32_t HISTOGRAM_BUCKETS     = (64 - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_BUCKETS;
+
+// Snapshot of a latency histogram, all values in nanoseconds
+struct LatencySnapshot
+{
+	uint64_t count                                  = 0;
+	uint64_t totalNS                                = 0;
+	uint64_t minNS                                  = 0;
+	uint64_t maxNS                                  = 0;
+	std::array<uint64_t, HISTOGRAM_BUCKETS> buckets = {};
+
+	static uint32_t BucketIndex(const uint64_t& value)
+	{
+		if (value < HISTOGRAM_SUB_BUCKETS) return static_cast<uint32_t>(value);
+
+		uint32_t exp = 63;
+		while (!(value & (1ULL << exp)))
+			exp--;
+
+		const uint32_t sub = static_cast<uint32_t>(value >> (exp - HISTOGRAM_SUB_BITS)) & (HISTOGRAM_SUB_BUCKETS - 1);
+		return (exp - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_BUCKETS + sub;
+	}
+
+	// Largest value counted by the given bucket
+	static uint64_t BucketUpperBound(const uint32_t& idx)
+	{
+		if (idx < HISTOGRAM_SUB_BUCKETS) return idx;
+
+		const uint32_t exp  = idx / HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BITS - 1;
+		const uint64_t sub  = idx % HISTOGRAM_SUB_BUCKETS;
+		const uint64_t step = 1ULL << (exp - HISTOGRAM_SUB_BITS);
+
+		return ((HISTOGRAM_SUB_BUCKETS + sub) << (exp - HISTOGRAM_SUB_BITS)) + step - 1;
+	}
+
+	double GetMeanNS() const
+	{
+		return (count == 0 ? 0.0 : static_cast<double>(totalNS) / static_cast<double>(count));
+	}
+
+	/// @brief Returns the value below which the given fraction of the samples lies
+	/// @param percentile Percentile in the range [0, 100]
+	/// @return Upper bound of the bucket containing the percentile, clamped to the observed maximum
+	uint64_t GetPercentileNS(const double& percentile) const
+	{
+		if (count == 0) return 0;
+
+		const double p        = std::min(std::max(percentile, 0.0), 100.0);
+		const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(p / 100.0 * static_cast<double>(count) + 0.5));
+		uint64_t seen         = 0;
+
+		for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+		{
+			seen += buckets[i];
+			if (seen >= target)
+				return std::min(BucketUpperBound(i), maxNS);
+		}
+
+		return maxNS;
+	}
+
+	friend std::ostream& operator<<(std::ostream& stream, const LatencySnapshot& snap)
+	{
+		stream << "count=" << snap.count << " mean=" << snap.GetMeanNS() / 1000.0 << "us"
+			   << " min=" << static_cast<double>(snap.minNS) / 1000.0 << "us"
+			   << " p50=" << static_cast<double>(snap.GetPercentileNS(50)) / 1000.0 << "us"
+			   << " p99=" << static_cast<double>(snap.GetPercentileNS(99)) / 1000.0 << "us"
+			   << " max=" << static_cast<double>(snap.maxNS) / 1000.0 << "us";
+		return stream;
+	}
+};
+
+struct TransferMetrics
+{
+	uint64_t ops            = 0;
+	uint64_t bytes          = 0;
+	LatencySnapshot latency = {};
+
+	friend std::ostream& operator<<(std::ostream& stream, const TransferMetrics& metrics)
+	{
+		stream << "ops=" << metrics.ops << " bytes=" << metrics.bytes << " (" << utils::SizeWithSuffix(static_cast<double>(metrics.bytes)) << ") latency: " << metrics.latency;
+		return stream;
+	}
+};
+
+// Completions detected by the WatchDogs of an IP core, the runtime spans from the start of a job to its detected completion
+struct CoreMetrics
+{
+	std::string name        = "";
+	uint64_t runs           = 0;
+	uint64_t interrupts     = 0;
+	uint64_t polls          = 0;
+	LatencySnapshot runtime = {};
+
+	friend std::ostream& operator<<(std::ostream& stream, const CoreMetrics& metrics)
+	{
+		stream << metrics.name << ": runs=" << metrics.runs << " interrupts=" << metrics.interrupts << " polls=" << metrics.polls << " runtime: " << metrics.runtime;
+		return stream;
+	}
+};
+
+struct Metrics
+{
+	TransferMetrics read           = {};
+	TransferMetrics write          = {};
+	TransferMetrics readCtrl       = {};
+	std::vector<CoreMetrics> cores = {};
+
+	friend std::ostream& operator<<(std::ostream& stream, const Metrics& metrics)
+	{
+		stream << "Read:     " << metrics.read << std::endl
+			   << "Write:    " << metrics.write << std::endl
+			   << "ReadCtrl: " << metrics.readCtrl;
+
+		for (const CoreMetrics& core : metrics.cores)
+			stream << std::endl
+				   << core;
+
+		return stream;
+	}
+};
+
+namespace internal
+{
+// Lock-free histogram, recording only uses relaxed atomic increments, hence, taking a snapshot
+// never blocks the recording threads (the snapshot might not be consistent across buckets)
+class LatencyHistogram
+{
+	DISABLE_COPY_ASSIGN_MOVE(LatencyHistogram)
+
+public:
+	LatencyHistogram() :
+		m_buckets()
+	{
+		Reset();
+	}
+
+	void Record(const uint64_t& valueNS)
+	{
+		m_buckets[LatencySnapshot::BucketIndex(valueNS)].fetch_add(1, std::memory_order_relaxed);
+		m_total.fetch_add(valueNS, std::memory_order_relaxed);
+		m_count.fetch_add(1, std::memory_order_relaxed);
+
+		uint64_t cur = m_min.load(std::memory_order_relaxed);
+		while (valueNS < cur && !m_min.compare_exchange_weak(cur, valueNS, std::memory_order_relaxed))
+			;
+
+		cur = m_max.load(std::memory_order_relaxed);
+		while (valueNS > cur && !m_max.compare_exchange_weak(cur, valueNS, std::memory_order_relaxed))
+			;
+	}
+
+	LatencySnapshot Snapshot() const
+	{
+		LatencySnapshot snap;
+		snap.count   = m_count.load(std::memory_order_relaxed);
+		snap.totalNS = m_total.load(std::memory_order_relaxed);
+		snap.maxNS   = m_max.load(std::memory_order_relaxed);
+		snap.minNS   = (snap.count == 0 ? 0 : m_min.load(std::memory_order_relaxed));
+
+		for (uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++)
+			snap.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+
+		return snap;
+	}
+
+	void Reset()
+	{
+		for (std::atomic<uint64_t>& bucket : m_buckets)
+			bucket.store(0, std::memory_order_relaxed);
+
+		m_count.store(0, std::memory_order_relaxed);
+		m_total.store(0, std::memory_order_relaxed);
+		m_min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+		m_max.store(0, std::memory_order_relaxed);
+	}
+
+private:
+	std::array<std::atomic<uint64_t>, HISTOGRAM_BUCKETS> m_buckets;
+	std::atomic<uint64_t> m_count = 0;
+	std::atomic<uint64_t> m_total = 0;
+	std::atomic<uint64_t> m_min   = std::numeric_limits<uint64_t>::max();
+	std::atomic<uint64_t> m_max   = 0;
+};
+
+class TransferRecorder
+{
+	DISABLE_COPY_ASSIGN_MOVE(TransferRecorder)
+
+public:
+	TransferRecorder() :
+		m_latency()
+	{}
+
+	void Record(const uint64_t& bytes, const uint64_t& latencyNS)
+	{
+		m_ops.fetch_add(1, std::memory_order_relaxed);
+		m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+		m_latency.Record(latencyNS);
+	}
+
+	TransferMetrics Snapshot() const
+	{
+		TransferMetrics metrics;
+		metrics.ops     = m_ops.load(std::memory_order_relaxed);
+		metrics.bytes   = m_bytes.load(std::memory_order_relaxed);
+		metrics.latency = m_latency.Snapshot();
+		return metrics;
+	}
+
+	void Reset()
+	{
+		m_ops.store(0, std::memory_order_relaxed);
+		m_bytes.store(0, std::memory_order_relaxed);
+		m_latency.Reset();
+	}
+
+private:
+	std::atomic<uint64_t> m_ops   = 0;
+	std::atomic<uint64_t> m_bytes = 0;
+	LatencyHistogram m_latency;
+};
+
+class CoreMetricsRecorder
+{
+	DISABLE_COPY_ASSIGN_MOVE(CoreMetricsRecorder)
+
+public:
+	explicit CoreMetricsRecorder(const std::string& name) :
+		m_name(name),
+		m_runtime()
+	{}
+
+	void Record(const uint64_t& polls, const uint64_t& runtimeNS, const bool& interrupt)
+	{
+		m_runs.fetch_add(1, std::memory_order_relaxed);
+		m_polls.fetch_add(polls, std::memory_order_relaxed);
+		if (interrupt)
+			m_interrupts.fetch_add(1, std::memory_order_relaxed);
+
+		m_runtime.Record(runtimeNS);
+	}
+
+	CoreMetrics Snapshot() const
+	{
+		CoreMetrics metrics;
+		metrics.name       = m_name;
+		metrics.runs       = m_runs.load(std::memory_order_relaxed);
+		metrics.interrupts = m_interrupts.load(std::memory_order_relaxed);
+		metrics.polls      = m_polls.load(std::memory_order_relaxed);
+		metrics.runtime    = m_runtime.Snapshot();
+		return metrics;
+	}
+
+	void Reset()
+	{
+		m_runs.store(0, std::memory_order_relaxed);
+		m_interrupts.store(0, std::memory_order_relaxed);
+		m_polls.store(0, std::memory_order_relaxed);
+		m_runtime.Reset();
+	}
+
+private:
+	std::string m_name;
+	std::atomic<uint64_t> m_runs       = 0;
+	std::atomic<uint64_t> m_interrupts = 0;
+	std::atomic<uint64_t> m_polls      = 0;
+	LatencyHistogram m_runtime;
+};
+
+// Per CLAP instance collection of the IP core metrics, the mutex is only used when a core is registered
+// or a snapshot is taken, the recorders are accessed through stable pointers without locking
+class MetricsRegistry
+{
+	DISABLE_COPY_ASSIGN_MOVE(MetricsRegistry)
+
+public:
+	MetricsRegistry() :
+		m_cores(),
+		m_mtx()
+	{}
+
+	// WatchDogs sharing a name, e.g., the MM2S channels of multiple AxiDMAs, share their recorder
+	CoreMetricsRecorder* GetCoreRecorder(const std::string& name)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+
+		std::unique_ptr<CoreMetricsRecorder>& pRecorder = m_cores[name];
+		if (!pRecorder)
+			pRecorder = std::make_unique<CoreMetricsRecorder>(name);
+
+		return pRecorder.get();
+	}
+
+	std::vector<CoreMetrics> Snapshot() const
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+
+		std::vector<CoreMetrics> cores;
+		cores.reserve(m_cores.size());
+
+		for (const auto& [name, pRecorder] : m_cores)
+			cores.push_back(pRecorder->Snapshot());
+
+		return cores;
+	}
+
+	void Reset()
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		for (auto& [name, pRecorder] : m_cores)
+			pRecorder->Reset();
+	}
+
+private:
+	std::map<std::string, std::unique_ptr<CoreMetricsRecorder>> m_cores;
+	mutable std::mutex m_mtx;
+};
+
+using MetricsRegistryPtr = std::shared_ptr<MetricsRegistry>;
+} // namespace internal
+} // namespace clap
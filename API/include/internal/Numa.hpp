@@ -0,0 +1,306 @@
+/*
+ *  File: Numa.hpp
+ *  Copyright (c) 2024 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+// NUMA placement of host buffers and of the threads driving the transfers, e.g., to keep both on the socket
+// a PCIe device is attached to. Uses the Linux interfaces directly (sysfs, mbind, thread affinity), therefore,
+// libnuma is not required. On other platforms the placement requests are ignored.
+
+#if defined(__linux__) && !defined(EMBEDDED_XILINX)
+#define CLAP_NUMA_AVAILABLE
+#endif
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef CLAP_NUMA_AVAILABLE
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "AlignmentAllocator.hpp"
+#include "Constants.hpp"
+
+namespace clap
+{
+// List of CPU ids, an empty set does not restrict the threads
+using CpuSet = std::vector<uint32_t>;
+
+static constexpr int32_t NUMA_NODE_UNKNOWN = -1;
+
+#ifdef CLAP_NUMA_AVAILABLE
+namespace internal
+{
+inline bool setAffinity(const pthread_t& handle, const CpuSet& cpus)
+{
+	cpu_set_t set;
+	CPU_ZERO(&set);
+
+	for (const uint32_t& cpu : cpus)
+	{
+		if (cpu < CPU_SETSIZE)
+			CPU_SET(cpu, &set);
+	}
+
+	if (CPU_COUNT(&set) == 0) return false;
+
+	return (pthread_setaffinity_np(handle, sizeof(cpu_set_t), &set) == 0);
+}
+} // namespace internal
+#endif
+
+namespace numa
+{
+// Parses a sysfs CPU list, e.g., "0-7,16-23"
+inline CpuSet ParseCpuList(const std::string& list)
+{
+	CpuSet cpus;
+	std::stringstream ss(list);
+	std::string range;
+
+	while (std::getline(ss, range, ','))
+	{
+		const std::size_t dash = range.find('-');
+
+		try
+		{
+			const uint32_t first = static_cast<uint32_t>(std::stoul(range.substr(0, dash)));
+			const uint32_t last  = (dash == std::string::npos ? first : static_cast<uint32_t>(std::stoul(range.substr(dash + 1))));
+
+			for (uint32_t cpu = first; cpu <= last; cpu++)
+				cpus.push_back(cpu);
+		}
+		catch (const std::exception&)
+		{
+			// Empty or malformed entries, e.g., the trailing newline
+		}
+	}
+
+	return cpus;
+}
+
+inline CpuSet ReadCpuList([[maybe_unused]] const std::string& fileName)
+{
+#ifdef CLAP_NUMA_AVAILABLE
+	std::ifstream file(fileName);
+	std::string list;
+
+	if (file && std::getline(file, list))
+		return ParseCpuList(list);
+#endif
+
+	return CpuSet();
+}
+
+/// @brief Returns the CPUs of the given NUMA node, empty if the node does not exist
+inline CpuSet GetNodeCPUs(const int32_t& node)
+{
+	if (node < 0) return CpuSet();
+	return ReadCpuList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+}
+
+/// @brief Returns all online CPUs of the system
+inline CpuSet GetOnlineCPUs()
+{
+	return ReadCpuList("/sys/devices/system/cpu/online");
+}
+
+/// @brief Returns the number of NUMA nodes, 1 if the system does not report its NUMA topology
+inline uint32_t GetNodeCount()
+{
+	const CpuSet nodes = ReadCpuList("/sys/devices/system/node/online");
+	return (nodes.empty() ? 1 : nodes.back() + 1);
+}
+
+/// @brief Reads a sysfs numa_node file, e.g., of a PCIe device
+/// @return NUMA node, NUMA_NODE_UNKNOWN if the file does not exist or the platform does not report a node
+inline int32_t ReadNumaNode([[maybe_unused]] const std::string& fileName)
+{
+	int32_t node = NUMA_NODE_UNKNOWN;
+
+#ifdef CLAP_NUMA_AVAILABLE
+	std::ifstream file(fileName);
+	if (!(file >> node))
+		node = NUMA_NODE_UNKNOWN;
+#endif
+
+	return node;
+}
+
+/// @brief Restricts the given running thread to the given CPUs, an empty set allows all online CPUs
+/// @return True if the affinity was changed
+inline bool PinThread([[maybe_unused]] std::thread& thread, [[maybe_unused]] const CpuSet& cpus)
+{
+#ifdef CLAP_NUMA_AVAILABLE
+	if (!thread.joinable()) return false;
+	return clap::internal::setAffinity(thread.native_handle(), (cpus.empty() ? GetOnlineCPUs() : cpus));
+#else
+	return false;
+#endif
+}
+
+/// @brief Restricts the calling thread to the given CPUs, an empty set allows all online CPUs
+/// @return True if the affinity was changed
+inline bool PinCurrentThread([[maybe_unused]] const CpuSet& cpus)
+{
+#ifdef CLAP_NUMA_AVAILABLE
+	return clap::internal::setAffinity(pthread_self(), (cpus.empty() ? GetOnlineCPUs() : cpus));
+#else
+	return false;
+#endif
+}
+
+/// @brief Asks the kernel to place the pages of the given page-aligned range on the given node once they are touched
+/// @return True if the policy was applied, placement is a preference, i.e., the pages are taken from other nodes if the node is full
+inline bool BindMemory([[maybe_unused]] void* pMem, [[maybe_unused]] const std::size_t& sizeInByte, [[maybe_unused]] const int32_t& node)
+{
+#ifdef CLAP_NUMA_AVAILABLE
+	static constexpr int32_t MPOL_PREFERRED_MODE = 1;
+	static constexpr std::size_t BITS_PER_LONG   = sizeof(unsigned long) * 8;
+
+	if (node < 0) return false;
+
+	std::vector<unsigned long> mask(static_cast<std::size_t>(node) / BITS_PER_LONG + 1, 0);
+	mask[static_cast<std::size_t>(node) / BITS_PER_LONG] = 1UL << (static_cast<std::size_t>(node) % BITS_PER_LONG);
+
+	// The kernel evaluates maxnode - 1 bits of the mask
+	return (syscall(SYS_mbind, pMem, sizeInByte, MPOL_PREFERRED_MODE, mask.data(), mask.size() * BITS_PER_LONG + 1, 0) == 0);
+#else
+	return false;
+#endif
+}
+} // namespace numa
+
+namespace internal
+{
+// Allocates buffers whose pages are placed on the given NUMA node, buffers without a node use aligned_alloc
+template<typename T>
+class NumaAllocator
+{
+public:
+	using value_type = T;
+
+	explicit NumaAllocator(const int32_t& node = NUMA_NODE_UNKNOWN) noexcept :
+		m_node(node)
+	{}
+
+	template<typename U>
+	NumaAllocator(const NumaAllocator<U>& other) noexcept :
+		m_node(other.GetNode())
+	{}
+
+	T* allocate(const std::size_t& n)
+	{
+		if (n == 0)
+			return nullptr;
+
+		void* p = nullptr;
+
+#ifdef CLAP_NUMA_AVAILABLE
+		if (m_node >= 0)
+		{
+			p = mmap(nullptr, mapSize(n), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+			if (p == MAP_FAILED)
+				throw std::bad_alloc();
+
+			// Without a policy the pages are still usable, they are just placed on the node of the first touching thread
+			numa::BindMemory(p, mapSize(n), m_node);
+			return static_cast<T*>(p);
+		}
+#endif
+
+		p = alignedMalloc(ALIGNMENT, roundUp(n * sizeof(T), ALIGNMENT));
+
+		if (p == nullptr)
+			throw std::bad_alloc();
+
+		return static_cast<T*>(p);
+	}
+
+	void deallocate(T* ptr, const std::size_t& n) noexcept
+	{
+		if (ptr == nullptr) return;
+
+#ifdef CLAP_NUMA_AVAILABLE
+		if (m_node >= 0)
+		{
+			munmap(static_cast<void*>(ptr), mapSize(n));
+			return;
+		}
+#else
+		(void)n;
+#endif
+
+		alignedFree(static_cast<void*>(ptr));
+	}
+
+	const int32_t& GetNode() const noexcept
+	{
+		return m_node;
+	}
+
+private:
+	static std::size_t roundUp(const std::size_t& value, const std::size_t& granularity)
+	{
+		return ((value + granularity - 1) / granularity) * granularity;
+	}
+
+#ifdef CLAP_NUMA_AVAILABLE
+	static std::size_t mapSize(const std::size_t& n)
+	{
+		return roundUp(n * sizeof(T), static_cast<std::size_t>(sysconf(_SC_PAGESIZE)));
+	}
+#endif
+
+private:
+	int32_t m_node;
+};
+
+template<class T, class U>
+inline bool operator==(const NumaAllocator<T>& a, const NumaAllocator<U>& b) noexcept
+{
+	return a.GetNode() == b.GetNode();
+}
+
+template<class T, class U>
+inline bool operator!=(const NumaAllocator<T>& a, const NumaAllocator<U>& b) noexcept
+{
+	return !(a == b);
+}
+} // namespace internal
+} // namespace clap
@@ -32,9 +32,18 @@
 
 #include "Types.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <exception>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
+#ifndef EMBEDDED_XILINX
+#include <thread>
+#endif
+
 #ifdef CLAP_IP_CORE_LOG_ALT_STYLE
 #define CLAP_IP_CORE_LOG_DEBUG   CLAP_CLASS_LOG_WITH_NAME_DEBUG(GetName())
 #define CLAP_IP_CORE_LOG_VERBOSE CLAP_CLASS_LOG_WITH_NAME_VERBOSE(GetName())
@@ -101,14 +110,90 @@ public:
 		m_name(name),
 		m_ctrlOffset(ctrlOffset),
 		m_registers()
+#ifdef CLAP_TRACE_ACTIVE
+		,
+		m_traceNameID(CLAP_TRACE_INTERN(name))
+#endif
 	{
 		// Register the control address as a polling address, causing it to be ignored when printing transfer times
 		// this is done to prevent log flooding when the control register is polled
 		CLAP()->AddPollAddress(ctrlOffset);
+
+		// Resolved once, registers within the window are accessed directly instead of looking up the address on every access.
+		// These accesses are not part of the backend transfer metrics.
+		m_pRegWindow = static_cast<volatile uint8_t*>(CLAP()->GetRegisterWindow(ctrlOffset, m_regWindowSize));
 	}
 
 	virtual ~RegisterControlBase() override = default;
 
+	/// @brief Starts a register transaction, until it is committed all register writes of the calling thread are queued.
+	///        On commit, writes that do not change the last known value of a cacheable register (see registerCacheable)
+	///        are skipped and adjacent 32-bit
+	///        registers are written as a single burst if the backend supports it. Queued writes are unordered with respect
+	///        to each other, writes issued using writeRegisterOrdered (e.g., to trigger a DMA) are kept in order.
+	///        Reading a register flushes all queued writes first. Transactions can be nested.
+	void BeginTransaction()
+	{
+		if (ownsTransaction())
+		{
+			m_txDepth++;
+			return;
+		}
+
+		m_txMtx.lock();
+#ifndef EMBEDDED_XILINX
+		m_txOwner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+#endif
+		m_txDepth.store(1, std::memory_order_release);
+	}
+
+	/// @brief Commits the current register transaction, the queued writes are flushed once the outermost transaction is committed
+	void CommitTransaction()
+	{
+		if (!ownsTransaction()) return;
+
+		if (m_txDepth > 1)
+		{
+			m_txDepth--;
+			return;
+		}
+
+		try
+		{
+			flushPendingWrites();
+		}
+		catch (...)
+		{
+			endTransaction();
+			throw;
+		}
+
+		endTransaction();
+	}
+
+	/// @brief Discards all writes queued by the current register transaction
+	void AbortTransaction()
+	{
+		if (!ownsTransaction()) return;
+
+		if (m_txDepth > 1)
+		{
+			m_txDepth--;
+			return;
+		}
+
+		m_pendingWrites.clear();
+		endTransaction();
+	}
+
+	/// @brief Forgets the last known values of all registers, e.g., after a reset of the IP core
+	void InvalidateRegisterCache()
+	{
+		std::lock_guard<std::mutex> lock(m_cacheMtx);
+		for (auto& [offset, entry] : m_regCache)
+			entry.valid = false;
+	}
+
 	// Method used by the static update callback function to update the given register
 	template<typename T>
 	void UpdateRegister(Register<T>* pReg, const uint64_t& offset, const Direction& dir)
@@ -119,6 +204,15 @@ public:
 			writeRegister<T>(offset, pReg->GetValue());
 	}
 
+	template<typename T, typename... Fields>
+	void UpdateRegister(LayoutRegister<T, Fields...>* pReg, const uint64_t& offset, const Direction& dir)
+	{
+		if (dir == Direction::READ)
+			pReg->Update(readRegister<T>(offset));
+		else
+			writeRegister<T>(offset, pReg->GetValue());
+	}
+
 	// Updates all registered registers
 	void UpdateAllRegisters()
 	{
@@ -135,6 +229,9 @@ public:
 	void SetName(const std::string& name)
 	{
 		m_name = name;
+#ifdef CLAP_TRACE_ACTIVE
+		m_traceNameID = CLAP_TRACE_INTERN(name);
+#endif
 	}
 
 	const std::string& GetName() const
@@ -153,11 +250,20 @@ public:
 		pIPCtrl->UpdateRegister(pReg, offset, dir);
 	}
 
+	template<typename T, typename... Fields>
+	static void UpdateCallBack(LayoutRegister<T, Fields...>* pReg, const uint64_t& offset, const Direction& dir, void* pObj)
+	{
+		RegisterControlBase* pIPCtrl = reinterpret_cast<RegisterControlBase*>(pObj);
+		if (!pIPCtrl) return;
+
+		pIPCtrl->UpdateRegister(pReg, offset, dir);
+	}
+
 protected:
 	// Register a register to the list of known registers and
 	// setup its update callback function
 	template<typename T>
-	void registerReg(Register<T>& reg, const uint64_t& offset = 0x0)
+	void registerReg(Register<T>& reg, const uint64_t& offset = 0x0, const bool& cacheable = false)
 	{
 		if constexpr (sizeof(T) > sizeof(uint64_t))
 		{
@@ -170,6 +276,23 @@ protected:
 
 		reg.SetupCallBackBasedUpdate(reinterpret_cast<void*>(this), offset, UpdateCallBack<T>);
 		m_registers.push_back(&reg);
+
+		if (cacheable)
+			registerCacheable(offset);
+	}
+
+	template<typename T, typename... Fields>
+	void registerReg(LayoutRegister<T, Fields...>& reg, const uint64_t& offset = 0x0, const bool& cacheable = false)
+	{
+		static_assert(sizeof(T) <= sizeof(uint64_t), "Registers with a size > 8 byte are currently not supported");
+
+		CLAP()->AddPollAddress(m_ctrlOffset + offset);
+
+		reg.SetupCallBackBasedUpdate(reinterpret_cast<void*>(this), offset, UpdateCallBack<T, Fields...>);
+		m_registers.push_back(&reg);
+
+		if (cacheable)
+			registerCacheable(offset);
 	}
 
 	void registerPollOffset(const uint64_t& offset)
@@ -177,61 +300,372 @@ protected:
 		CLAP()->AddPollAddress(m_ctrlOffset + offset);
 	}
 
+	// Allows transactions to skip writes that do not change the last known value of the register at the given offset.
+	// Only valid for registers that are exclusively changed by the host, e.g., addresses and sizes, but not for control or
+	// status registers, whose bits are changed by the hardware and where an identical write has an effect (e.g., a re-arm).
+	void registerCacheable(const uint64_t& offset)
+	{
+		std::lock_guard<std::mutex> lock(m_cacheMtx);
+		m_regCache.emplace(offset, CacheEntry());
+		m_cacheUsed.store(true, std::memory_order_relaxed);
+	}
+
 	template<typename T>
 	T readRegister(const uint64_t& regOffset)
 	{
-		switch (sizeof(T))
+		CLAP_TRACE_LABEL(m_traceNameID);
+
+		// Reads have to observe all previously issued writes
+		if (ownsTransaction() && !m_pendingWrites.empty())
+			flushPendingWrites();
+
+		T data;
+
+		if (directAccess(regOffset, sizeof(T)))
+			data = static_cast<T>(readDirect(regOffset, sizeof(T)));
+		else
+		{
+			switch (sizeof(T))
+			{
+				case 8:
+					data = static_cast<T>(CLAP()->Read64(m_ctrlOffset + regOffset));
+					break;
+				case 4:
+					data = static_cast<T>(CLAP()->Read32(m_ctrlOffset + regOffset));
+					break;
+				case 2:
+					data = static_cast<T>(CLAP()->Read16(m_ctrlOffset + regOffset));
+					break;
+				case 1:
+					data = static_cast<T>(CLAP()->Read8(m_ctrlOffset + regOffset));
+					break;
+				default:
+					std::stringstream ss("");
+					ss << CLASS_TAG_AUTO << nameTag() << "Registers with a size > " << sizeof(uint64_t) << " byte are currently not supported";
+					throw std::runtime_error(ss.str());
+			}
+		}
+
+		if constexpr (sizeof(T) <= sizeof(uint64_t))
+			updateRegisterCache(regOffset, static_cast<uint64_t>(data), sizeof(T));
+
+		return data;
+	}
+
+	template<typename T>
+	void writeRegister(const uint64_t& regOffset, const T& regData, const bool& validate = false)
+	{
+		if constexpr (sizeof(T) <= sizeof(uint64_t))
+		{
+			if (ownsTransaction() && !validate)
+			{
+				queueWrite(regOffset, static_cast<uint64_t>(regData), sizeof(T), false);
+				return;
+			}
+		}
+
+		writeRegisterDirect(regOffset, regData);
+
+		if (validate)
+		{
+			const T readData = readRegister<T>(regOffset);
+			if (readData != regData)
+			{
+				std::stringstream ss("");
+				ss << CLASS_TAG_AUTO << nameTag() << "Register write validation failed. Address: 0x" << std::hex << m_ctrlOffset + regOffset << " Expected: 0x" << regData << ", Read: 0x" << readData << std::dec;
+				throw std::runtime_error(ss.str());
+			}
+		}
+	}
+
+	// Same as writeRegister, but within a transaction the write is never skipped and it is issued after all
+	// previously queued writes and before all following ones, e.g., for registers that trigger an operation
+	template<typename T>
+	void writeRegisterOrdered(const uint64_t& regOffset, const T& regData)
+	{
+		static_assert(sizeof(T) <= sizeof(uint64_t), "Registers with a size > 8 byte are currently not supported");
+
+		if (ownsTransaction())
+			queueWrite(regOffset, static_cast<uint64_t>(regData), sizeof(T), true);
+		else
+			writeRegisterDirect(regOffset, regData);
+	}
+
+private:
+	struct PendingWrite
+	{
+		uint64_t offset = 0;
+		uint64_t data   = 0;
+		uint32_t size   = 0;
+		bool ordered    = false;
+	};
+
+	struct CacheEntry
+	{
+		uint64_t data = 0;
+		uint32_t size = 0;
+		bool valid    = false;
+	};
+
+	bool ownsTransaction() const
+	{
+#ifndef EMBEDDED_XILINX
+		return m_txDepth.load(std::memory_order_acquire) > 0 && m_txOwner.load(std::memory_order_relaxed) == std::this_thread::get_id();
+#else
+		return m_txDepth.load(std::memory_order_acquire) > 0;
+#endif
+	}
+
+	void endTransaction()
+	{
+		m_txDepth.store(0, std::memory_order_release);
+#ifndef EMBEDDED_XILINX
+		m_txOwner.store(std::thread::id(), std::memory_order_relaxed);
+#endif
+		m_txMtx.unlock();
+	}
+
+	template<typename T>
+	void writeRegisterDirect(const uint64_t& regOffset, const T& regData)
+	{
+		CLAP_TRACE_LABEL(m_traceNameID);
+
+		if (directAccess(regOffset, sizeof(T)))
+			writeDirect(regOffset, static_cast<uint64_t>(regData), sizeof(T));
+		else
+		{
+			switch (sizeof(T))
+			{
+				case 8:
+					CLAP()->Write64(m_ctrlOffset + regOffset, static_cast<uint64_t>(regData));
+					break;
+				case 4:
+					CLAP()->Write32(m_ctrlOffset + regOffset, static_cast<uint32_t>(regData));
+					break;
+				case 2:
+					CLAP()->Write16(m_ctrlOffset + regOffset, static_cast<uint16_t>(regData));
+					break;
+				case 1:
+					CLAP()->Write8(m_ctrlOffset + regOffset, static_cast<uint8_t>(regData));
+					break;
+				default:
+					std::stringstream ss("");
+					ss << CLASS_TAG_AUTO << nameTag() << "Registers with a size > " << sizeof(uint64_t) << " byte are currently not supported";
+					throw std::runtime_error(ss.str());
+			}
+		}
+
+		if constexpr (sizeof(T) <= sizeof(uint64_t))
+			updateRegisterCache(regOffset, static_cast<uint64_t>(regData), sizeof(T));
+	}
+
+	bool directAccess(const uint64_t& regOffset, const std::size_t& size) const
+	{
+		if (m_pRegWindow == nullptr) return false;
+
+		// The window is unmapped together with the CLAP instance, hence, the same validity check as for the backend accesses applies
+		CLAP();
+
+		return (regOffset % std::min(size, sizeof(uint32_t)) == 0 && regOffset <= m_regWindowSize && size <= m_regWindowSize - regOffset);
+	}
+
+	// 64-bit registers are accessed as two 32-bit words, lower word first, matching the width of the AXI-Lite interfaces
+	uint64_t readDirect(const uint64_t& regOffset, const std::size_t& size) const
+	{
+		CLAP_TRACE_SCOPE(trace::EventType::Read, m_ctrlOffset + regOffset, size);
+
+		const volatile uint8_t* pReg = m_pRegWindow + regOffset;
+
+		switch (size)
 		{
 			case 8:
-				return static_cast<T>(CLAP()->Read64(m_ctrlOffset + regOffset));
+			{
+				const uint64_t low = *reinterpret_cast<const volatile uint32_t*>(pReg);
+				return low | (static_cast<uint64_t>(*reinterpret_cast<const volatile uint32_t*>(pReg + sizeof(uint32_t))) << 32);
+			}
 			case 4:
-				return static_cast<T>(CLAP()->Read32(m_ctrlOffset + regOffset));
+				return *reinterpret_cast<const volatile uint32_t*>(pReg);
 			case 2:
-				return static_cast<T>(CLAP()->Read16(m_ctrlOffset + regOffset));
-			case 1:
-				return static_cast<T>(CLAP()->Read8(m_ctrlOffset + regOffset));
+				return *reinterpret_cast<const volatile uint16_t*>(pReg);
 			default:
-				std::stringstream ss("");
-				ss << CLASS_TAG_AUTO << nameTag() << "Registers with a size > " << sizeof(uint64_t) << " byte are currently not supported";
-				throw std::runtime_error(ss.str());
+				return *pReg;
 		}
 	}
 
-	template<typename T>
-	void writeRegister(const uint64_t& regOffset, const T& regData, const bool& validate = false)
+	void writeDirect(const uint64_t& regOffset, const uint64_t& data, const std::size_t& size)
 	{
-		switch (sizeof(T))
+		CLAP_TRACE_SCOPE(trace::EventType::Write, m_ctrlOffset + regOffset, size);
+
+		volatile uint8_t* pReg = m_pRegWindow + regOffset;
+
+		switch (size)
 		{
 			case 8:
-				CLAP()->Write64(m_ctrlOffset + regOffset, static_cast<uint64_t>(regData));
+				*reinterpret_cast<volatile uint32_t*>(pReg)                    = static_cast<uint32_t>(data);
+				*reinterpret_cast<volatile uint32_t*>(pReg + sizeof(uint32_t)) = static_cast<uint32_t>(data >> 32);
 				break;
 			case 4:
-				CLAP()->Write32(m_ctrlOffset + regOffset, static_cast<uint32_t>(regData));
+				*reinterpret_cast<volatile uint32_t*>(pReg) = static_cast<uint32_t>(data);
 				break;
 			case 2:
-				CLAP()->Write16(m_ctrlOffset + regOffset, static_cast<uint16_t>(regData));
-				break;
-			case 1:
-				CLAP()->Write8(m_ctrlOffset + regOffset, static_cast<uint8_t>(regData));
+				*reinterpret_cast<volatile uint16_t*>(pReg) = static_cast<uint16_t>(data);
 				break;
 			default:
-				std::stringstream ss("");
-				ss << CLASS_TAG_AUTO << nameTag() << "Registers with a size > " << sizeof(uint64_t) << " byte are currently not supported";
-				throw std::runtime_error(ss.str());
+				*pReg = static_cast<uint8_t>(data);
+				break;
 		}
+	}
 
-		if (validate)
+	// Only cacheable registers are tracked, all other accesses skip the cache
+	void updateRegisterCache(const uint64_t& regOffset, const uint64_t& data, const uint32_t& size)
+	{
+		if (!m_cacheUsed.load(std::memory_order_relaxed)) return;
+
+		std::lock_guard<std::mutex> lock(m_cacheMtx);
+		auto it = m_regCache.find(regOffset);
+		if (it != m_regCache.end())
+			it->second = { data, size, true };
+	}
+
+	void queueWrite(const uint64_t& regOffset, const uint64_t& data, const uint32_t& size, const bool& ordered)
+	{
+		if (!ordered)
 		{
-			const T readData = readRegister<T>(regOffset);
-			if (readData != regData)
+			// Coalesce with a queued write to the same register, as long as no ordered write lies in between
+			for (auto it = m_pendingWrites.rbegin(); it != m_pendingWrites.rend() && !it->ordered; ++it)
 			{
-				std::stringstream ss("");
-				ss << CLASS_TAG_AUTO << nameTag() << "Register write validation failed. Address: 0x" << std::hex << m_ctrlOffset + regOffset << " Expected: 0x" << regData << ", Read: 0x" << readData << std::dec;
-				throw std::runtime_error(ss.str());
+				if (it->offset == regOffset && it->size == size)
+				{
+					it->data = data;
+					return;
+				}
 			}
+
+			std::lock_guard<std::mutex> lock(m_cacheMtx);
+			auto it = m_regCache.find(regOffset);
+			if (it != m_regCache.end() && it->second.valid && it->second.size == size && it->second.data == data)
+				return;
+		}
+
+		m_pendingWrites.push_back({ regOffset, data, size, ordered });
+	}
+
+	void flushPendingWrites()
+	{
+		CLAP_TRACE_LABEL(m_traceNameID);
+
+		std::vector<PendingWrite> writes;
+		std::swap(writes, m_pendingWrites);
+
+		const bool bursts = CLAP()->SupportsRegisterBursts();
+
+		auto begin = writes.begin();
+		while (begin != writes.end())
+		{
+			auto end = std::find_if(begin, writes.end(), [](const PendingWrite& w) { return w.ordered; });
+
+			// Unordered writes are issued in ascending address order to form bursts
+			std::stable_sort(begin, end, [](const PendingWrite& a, const PendingWrite& b) { return a.offset < b.offset; });
+			issueWrites(begin, end, bursts);
+
+			if (end == writes.end()) break;
+
+			issueWrites(end, end + 1, false);
+			begin = end + 1;
 		}
 	}
 
+	void issueWrites(std::vector<PendingWrite>::iterator begin, std::vector<PendingWrite>::iterator end, const bool& bursts)
+	{
+		std::vector<uint32_t> words;
+
+		for (auto it = begin; it != end;)
+		{
+			const bool burstable = bursts && (it->size == 4 || it->size == 8) && (it->offset % sizeof(uint32_t) == 0);
+
+			if (!burstable)
+			{
+				issueWrite(*it);
+				++it;
+				continue;
+			}
+
+			// Collect the run of adjacent 32/64-bit registers starting at it
+			const uint64_t start = it->offset;
+			uint64_t next        = start;
+			auto runEnd          = it;
+
+			words.clear();
+
+			while (runEnd != end && runEnd->offset == next && (runEnd->size == 4 || runEnd->size == 8))
+			{
+				words.push_back(static_cast<uint32_t>(runEnd->data));
+				if (runEnd->size == 8)
+					words.push_back(static_cast<uint32_t>(runEnd->data >> 32));
+
+				next += runEnd->size;
+				++runEnd;
+			}
+
+			if (runEnd - it == 1)
+				issueWrite(*it);
+			else
+			{
+				if (directAccess(start, words.size() * sizeof(uint32_t)))
+				{
+					for (std::size_t i = 0; i < words.size(); i++)
+						writeDirect(start + i * sizeof(uint32_t), words[i], sizeof(uint32_t));
+				}
+				else
+					CLAP()->WriteRegisters(m_ctrlOffset + start, words.data(), words.size());
+
+				for (auto w = it; w != runEnd; ++w)
+					trackWrite(*w);
+			}
+
+			it = runEnd;
+		}
+	}
+
+	void issueWrite(const PendingWrite& write)
+	{
+		if (directAccess(write.offset, write.size))
+		{
+			writeDirect(write.offset, write.data, write.size);
+			trackWrite(write);
+			return;
+		}
+
+		switch (write.size)
+		{
+			case 8:
+				CLAP()->Write64(m_ctrlOffset + write.offset, write.data);
+				break;
+			case 4:
+				CLAP()->Write32(m_ctrlOffset + write.offset, static_cast<uint32_t>(write.data));
+				break;
+			case 2:
+				CLAP()->Write16(m_ctrlOffset + write.offset, static_cast<uint16_t>(write.data));
+				break;
+			default:
+				CLAP()->Write8(m_ctrlOffset + write.offset, static_cast<uint8_t>(write.data));
+				break;
+		}
+
+		trackWrite(write);
+	}
+
+	void trackWrite(const PendingWrite& write)
+	{
+		if (!m_cacheUsed.load(std::memory_order_relaxed)) return;
+
+		std::lock_guard<std::mutex> lock(m_cacheMtx);
+		auto it = m_regCache.find(write.offset);
+		if (it != m_regCache.end())
+			it->second = { write.data, write.size, true };
+	}
+
+protected:
 	virtual bool detectInterruptID()
 	{
 		Expected<uint32_t> res = CLAP()->GetUIOID(m_ctrlOffset);
@@ -276,6 +710,78 @@ protected:
 	uint64_t m_ctrlOffset;
 	std::vector<RegisterIntf*> m_registers;
 	int32_t m_detectedInterruptID = INTR_UNDEFINED;
+
+private:
+	std::vector<PendingWrite> m_pendingWrites           = {};
+	std::unordered_map<uint64_t, CacheEntry> m_regCache = {};
+	std::mutex m_txMtx                                  = {};
+	std::mutex m_cacheMtx                               = {};
+	std::atomic<uint32_t> m_txDepth                     = 0;
+	std::atomic<bool> m_cacheUsed                       = false;
+	volatile uint8_t* m_pRegWindow                      = nullptr;
+	uint64_t m_regWindowSize                            = 0;
+#ifndef EMBEDDED_XILINX
+	std::atomic<std::thread::id> m_txOwner = std::thread::id();
+#endif
+#ifdef CLAP_TRACE_ACTIVE
+	uint32_t m_traceNameID = 0;
+#endif
+};
+
+// Scoped register transaction, commits on destruction unless the scope is left by an exception,
+// in which case the queued writes are discarded to avoid triggering a partially configured core
+class RegisterTransaction
+{
+	DISABLE_COPY_ASSIGN_MOVE(RegisterTransaction)
+
+public:
+	explicit RegisterTransaction(RegisterControlBase& ctrl) :
+		m_ctrl(ctrl),
+		m_exceptions(std::uncaught_exceptions())
+	{
+		m_ctrl.BeginTransaction();
+	}
+
+	~RegisterTransaction()
+	{
+		if (m_done) return;
+
+		if (std::uncaught_exceptions() > m_exceptions)
+		{
+			m_ctrl.AbortTransaction();
+			return;
+		}
+
+		try
+		{
+			m_ctrl.CommitTransaction();
+		}
+		catch (const std::exception& ex)
+		{
+			CLAP_CLASS_LOG_ERROR << "Failed to commit register transaction: " << ex.what() << std::endl;
+		}
+	}
+
+	void Commit()
+	{
+		if (m_done) return;
+
+		m_done = true;
+		m_ctrl.CommitTransaction();
+	}
+
+	void Abort()
+	{
+		if (m_done) return;
+
+		m_done = true;
+		m_ctrl.AbortTransaction();
+	}
+
+private:
+	RegisterControlBase& m_ctrl;
+	int m_exceptions = 0;
+	bool m_done      = false;
 };
 } // namespace internal
 } // namespace clap
@@ -27,13 +27,14 @@
 #pragma once
 
 #include <algorithm>
-#include <cmath>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include "Constants.hpp"
@@ -59,16 +60,12 @@ public:
 		if (m_endBit == SAME_AS_START_BIT)
 			m_endBit = startBit;
 
-		uint32_t cnt = m_endBit - m_startBit + 1;
+		const uint32_t cnt = m_endBit - m_startBit + 1;
 
-		// Calculate the base shift value, for boolean values it is 1, for all other
-		// it is determined based on the number of bits, using the formular:
-		// shiftValue = 2^CNT - 1
+		// Calculate the base shift value, i.e., CNT set bits: 2^CNT - 1
 		// For a count value of 4 this would result in 15 (2^4 = 16; 16 - 1 = 15) or 0xF
 		// which after being shifted returns the 4 bits starting at the given start bit position.
-		if (cnt != 1)
-			m_shiftVal = static_cast<uint32_t>(std::pow(2, cnt)) - 1;
-
+		m_shiftVal = (cnt >= 32 ? 0xFFFFFFFF : (1u << cnt) - 1);
 		m_shiftVal <<= m_startBit;
 	}
 
@@ -197,6 +194,63 @@ enum class Direction
 	WRITE
 };
 
+inline const std::string RESERVED_STRING = "Reserved";
+
+// Adds a row for every block of bits that is not covered by the given usage mask
+inline void addReservedRows(std::map<uint32_t, std::string>& map, const uint64_t& usage, const uint32_t& bitCount, const std::size_t& nameSpacing)
+{
+	bool reserved          = false;
+	uint8_t reserverdStart = 0;
+
+	for (uint32_t i = 0; i <= bitCount; i++)
+	{
+		// Bit position has not been registerd, the position after the last bit closes a trailing block
+		if (i < bitCount && ((usage >> i) & 0x1) == 0)
+		{
+			// First bit position that has not been registered
+			if (!reserved)
+			{
+				reserved       = true;
+				reserverdStart = static_cast<uint8_t>(i);
+			}
+		}
+		// Bit position has been registered,
+		// check if a reserved block has been encounterd
+		else if (reserved)
+		{
+			// Create a string to the reserved block
+			// It ends at i - 1 because the current i has already been registered
+			map[reserverdStart] = RegIntf<uint64_t>::CreateString(reserverdStart, static_cast<uint8_t>(i - 1), RESERVED_STRING, static_cast<uint32_t>(nameSpacing));
+			// Reset the reserved flag
+			reserved = false;
+		}
+	}
+}
+
+// Prints a register address map, the rows are keyed by their start bit
+inline void printRegisterMap(const std::string& name, const std::map<uint32_t, std::string>& map, const std::size_t& nameSpacing)
+{
+	// Build up the register address map header string
+	std::stringstream header("");
+	header << std::left << std::setfill(' ') << std::setw(5) << "Bits"
+		   << " - " << std::setfill(' ') << std::setw(static_cast<int>(nameSpacing)) << "Field Name"
+		   << " - "
+		   << "Value";
+
+	// Print the registers name
+	CLAP_LOG_INFO << name << ":" << std::endl;
+	// Print the header
+	CLAP_LOG_INFO << header.str() << std::endl;
+	// Print the divider
+	CLAP_LOG_INFO << std::left << std::setfill('-') << std::setw(static_cast<int>(header.str().length())) << "-" << std::endl;
+
+	// Print the actuall register address map
+	for (auto it = map.rbegin(); it != map.rend(); ++it)
+		CLAP_LOG_INFO << it->second << std::endl;
+
+	CLAP_LOG_INFO << std::endl;
+}
+
 // Template less base class for a register to easily store
 // registers in a vector and execute callback based operations
 // such as Update
@@ -222,9 +276,6 @@ public:
 template<typename T>
 class Register : public RegisterIntf
 {
-	static const std::string RESERVED_STRING;
-	const std::size_t RESERVED_STRING_LENGTH = RESERVED_STRING.length();
-
 	using RegIntfPtr = std::shared_ptr<class RegIntf<T>>;
 
 	DISABLE_COPY_ASSIGN_MOVE(Register)
@@ -335,68 +386,19 @@ public:
 		// Search for the max name length
 		const RegIntfPtr maxElem = *std::max_element(m_regElems.begin(), m_regElems.end(), [](const RegIntfPtr lhs, const RegIntfPtr rhs) { return lhs->GetName().length() < rhs->GetName().length(); });
 
-		std::size_t maxLength = maxElem->GetName().length();
-
-		if (maxLength < RESERVED_STRING_LENGTH)
-			maxLength = RESERVED_STRING_LENGTH;
+		const std::size_t maxLength = std::max(maxElem->GetName().length(), RESERVED_STRING.length());
 
 		// Store the register address map strings in a map,
 		// using the start bit position as the key this ensures
 		// that the map will be in the right order
 		std::map<uint32_t, std::string> map;
-
-		bool reserved          = false;
-		uint8_t reserverdStart = 0;
-		for (uint32_t i = 0; i < 32; i++)
-		{
-			// Bit position has not been registerd
-			if (((m_regUsage >> i) & 0x1) == 0)
-			{
-				// First bit position that has not been registered
-				if (!reserved)
-				{
-					reserved       = true;
-					reserverdStart = i;
-				}
-			}
-			// Bit position has been registered,
-			// check if a reserved block has been encounterd
-			else
-			{
-				if (reserved)
-				{
-					// Create a string to the reserved block
-					// It ends at i - 1 because the current i has already been registered
-					map[reserverdStart] = RegIntf<T>::CreateString(reserverdStart, i - 1, RESERVED_STRING, maxLength);
-					// Reset the reserved flag
-					reserved = false;
-				}
-			}
-		}
+		addReservedRows(map, m_regUsage, 32, maxLength);
 
 		// Add strings for all registered elements to the map
 		for (const RegIntfPtr& pElem : m_regElems)
-			map[pElem->GetStartBit()] = pElem->ToString(maxLength);
-
-		// Build up the register address map header string
-		std::stringstream header("");
-		header << std::left << std::setfill(' ') << std::setw(5) << "Bits"
-			   << " - " << std::setfill(' ') << std::setw(maxLength) << "Field Name"
-			   << " - "
-			   << "Value";
-
-		// Print the registers name
-		CLAP_LOG_INFO << m_name << ":" << std::endl;
-		// Print the header
-		CLAP_LOG_INFO << header.str() << std::endl;
-		// Print the divider
-		CLAP_LOG_INFO << std::left << std::setfill('-') << std::setw(header.str().length()) << "-" << std::endl;
+			map[pElem->GetStartBit()] = pElem->ToString(static_cast<uint32_t>(maxLength));
 
-		// Print the actuall register address map
-		for (const std::pair<uint32_t, std::string> p : utils::ReverseIterate(map))
-			CLAP_LOG_INFO << p.second << std::endl;
-
-		CLAP_LOG_INFO << std::endl;
+		printRegisterMap(m_name, map, maxLength);
 	}
 
 private:
@@ -411,8 +413,174 @@ private:
 	void* m_pCallBackObject = nullptr;
 };
 
-template<typename T>
-const std::string Register<T>::RESERVED_STRING = "Reserved";
+// Compile-time description of a register field spanning the bits START to END (inclusive).
+// Fields are declared using CLAP_REG_FIELD, which adds the name used when printing the register.
+template<uint8_t START, uint8_t END = START>
+struct RegField
+{
+	static_assert(START <= END, "The start bit of a register field has to be less or equal to its end bit");
+	static_assert(END < 64, "Register fields have to be located within the lower 64 bits");
+
+	static constexpr uint8_t START_BIT = START;
+	static constexpr uint8_t END_BIT   = END;
+	static constexpr uint8_t WIDTH     = END - START + 1;
+	static constexpr uint64_t MASK     = (WIDTH == 64 ? ~0ULL : ((1ULL << WIDTH) - 1)) << START;
+
+	template<typename T>
+	static constexpr T Decode(const T& regVal)
+	{
+		return static_cast<T>((regVal & static_cast<T>(MASK)) >> START);
+	}
+
+	template<typename T>
+	static constexpr T Encode(const T& regVal, const T& fieldVal)
+	{
+		return static_cast<T>((regVal & static_cast<T>(~MASK)) | ((static_cast<uint64_t>(fieldVal) << START) & MASK));
+	}
+};
+
+#define CLAP_REG_FIELD(TYPE, NAME, START, END)                \
+	struct TYPE : public clap::internal::RegField<START, END> \
+	{                                                         \
+		static constexpr const char* FIELD_NAME = NAME;       \
+	}
+
+// Register whose fields are described at compile time, e.g., LayoutRegister<uint8_t, ApStart, ApDone>.
+// In contrast to Register, the raw value is stored and the fields are decoded on access using
+// constant masks and shifts, i.e., an update is a single store, independent of the number of fields.
+template<typename T, typename... Fields>
+class LayoutRegister : public RegisterIntf
+{
+	static_assert(std::is_unsigned<T>::value, "The base type of a register has to be an unsigned integer");
+	static_assert(((Fields::END_BIT < sizeof(T) * 8) && ...), "A field exceeds the bit size of the register");
+
+	static constexpr bool fieldsDisjoint()
+	{
+		constexpr uint64_t MASKS[] = { Fields::MASK..., 0 };
+		uint64_t used              = 0;
+
+		for (const uint64_t& mask : MASKS)
+		{
+			if ((used & mask) != 0) return false;
+			used |= mask;
+		}
+
+		return true;
+	}
+
+	static_assert(fieldsDisjoint(), "The bit ranges of the register fields overlap");
+
+	DISABLE_COPY_ASSIGN_MOVE(LayoutRegister)
+
+public:
+	using UpdateCB = void(LayoutRegister*, const uint64_t&, const Direction&, void*);
+
+	static constexpr T USED_BITS = static_cast<T>((Fields::MASK | ... | 0));
+
+public:
+	explicit LayoutRegister(const std::string& name) :
+		m_name(name)
+	{}
+
+	// Set the variables required for callback based updating
+	void SetupCallBackBasedUpdate(void* pObj, const uint64_t& offset, UpdateCB* cb)
+	{
+		m_pCallBackObject = pObj;
+		m_offset          = offset;
+		m_pUpdateCB       = cb;
+	}
+
+	// Triggers the callback based update process for the given direction
+	void Update(const Direction& dir = Direction::READ) override
+	{
+		if (m_pCallBackObject == nullptr) return;
+		m_pUpdateCB(this, m_offset, dir, m_pCallBackObject);
+	}
+
+	// Update all fields using the given value, bits not covered by a field are ignored
+	void Update(const T& val)
+	{
+		m_value = static_cast<T>(val & USED_BITS);
+	}
+
+	T GetValue() const
+	{
+		return m_value;
+	}
+
+	template<typename F>
+	T Get() const
+	{
+		static_assert(hasField<F>(), "The field is not part of the register layout");
+		return F::Decode(m_value);
+	}
+
+	template<typename F>
+	bool IsSet() const
+	{
+		return Get<F>() != 0;
+	}
+
+	// Sets the value of the field, the register is written on the next Update(Direction::WRITE)
+	template<typename F>
+	void Set(const T& fieldVal)
+	{
+		static_assert(hasField<F>(), "The field is not part of the register layout");
+		m_value = F::Encode(m_value, fieldVal);
+	}
+
+	template<typename F>
+	std::string FieldToString(const uint32_t& nameSpacing = 0) const
+	{
+		std::stringstream ss("");
+		ss << RegIntf<T>::CreateString(F::START_BIT, F::END_BIT, F::FIELD_NAME, nameSpacing) << " - 0x" << std::hex << std::uppercase << static_cast<uint64_t>(Get<F>());
+		return ss.str();
+	}
+
+	// Returns one line per field, e.g., for debug output
+	std::string ToString(const uint32_t& nameSpacing = 0) const
+	{
+		std::stringstream ss("");
+		((ss << FieldToString<Fields>(nameSpacing) << std::endl), ...);
+		return ss.str();
+	}
+
+	friend std::ostream& operator<<(std::ostream& stream, const LayoutRegister& reg)
+	{
+		stream << reg.ToString();
+		return stream;
+	}
+
+	// Print the register in a register address map
+	void Print(const RegisterIntf::RegUpdate& update = RegisterIntf::RegUpdate::Update)
+	{
+		if (update == RegisterIntf::RegUpdate::Update) Update();
+
+		const std::size_t maxLength = std::max({ RESERVED_STRING.length(), std::char_traits<char>::length(Fields::FIELD_NAME)... });
+
+		std::map<uint32_t, std::string> map;
+		addReservedRows(map, USED_BITS, sizeof(T) * 8, maxLength);
+		((map[Fields::START_BIT] = FieldToString<Fields>(static_cast<uint32_t>(maxLength))), ...);
+
+		printRegisterMap(m_name, map, maxLength);
+	}
+
+private:
+	template<typename F>
+	static constexpr bool hasField()
+	{
+		return (std::is_same<F, Fields>::value || ...);
+	}
+
+private:
+	T m_value = 0;
+	std::string m_name;
+
+	// Member used for callback based updating
+	UpdateCB* m_pUpdateCB   = nullptr;
+	uint64_t m_offset       = 0;
+	void* m_pCallBackObject = nullptr;
+};
 
 class HasStatus
 {
@@ -446,6 +614,26 @@ protected:
 	bool m_done = false;
 };
 
+// Status whose done state is determined by a callback, allows a WatchDog to drive a software state machine
+class CallbackStatus : public HasStatus
+{
+public:
+	using PollFunc = std::function<bool(void)>;
+
+	explicit CallbackStatus(PollFunc func) :
+		m_func(std::move(func))
+	{}
+
+protected:
+	void getStatus() override
+	{
+		m_done = m_func();
+	}
+
+private:
+	PollFunc m_func;
+};
+
 class HasInterrupt
 {
 public:
@@ -0,0 +1,131 @@
+/*
+ *  File: SPSCRing.hpp
+ *  Copyright (c) 2024 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "Utils.hpp"
+
+namespace clap
+{
+namespace internal
+{
+// Bounded lock-free ring for exactly one producer and one consumer thread.
+// The capacity is rounded up to a power of two, items pushed while the ring is full are dropped and counted.
+template<typename T>
+class SPSCRing
+{
+	DISABLE_COPY_ASSIGN_MOVE(SPSCRing)
+
+	static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+public:
+	SPSCRing() {}
+
+	// Discards all items and reallocates the slots, must not be called while either side is active
+	void Reset(const std::size_t& capacity)
+	{
+		std::size_t size = 1;
+		while (size < capacity)
+			size <<= 1;
+
+		m_slots.assign(capacity == 0 ? 0 : size, T());
+		m_mask       = m_slots.empty() ? 0 : m_slots.size() - 1;
+		m_cachedTail = 0;
+		m_head.store(0, std::memory_order_relaxed);
+		m_tail.store(0, std::memory_order_relaxed);
+		m_drops.store(0, std::memory_order_relaxed);
+	}
+
+	std::size_t Capacity() const
+	{
+		return m_slots.size();
+	}
+
+	// Producer side
+	bool Push(const T& item)
+	{
+		const uint64_t head = m_head.load(std::memory_order_relaxed);
+
+		// Only reload the consumer position once the cached one indicates a full ring
+		if (head - m_cachedTail >= m_slots.size())
+		{
+			m_cachedTail = m_tail.load(std::memory_order_acquire);
+
+			if (head - m_cachedTail >= m_slots.size())
+			{
+				m_drops.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+		}
+
+		m_slots[head & m_mask] = item;
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side, appends up to maxItems items to the given vector and returns their number
+	std::size_t Pop(std::vector<T>& items, const std::size_t& maxItems)
+	{
+		const uint64_t tail   = m_tail.load(std::memory_order_relaxed);
+		const uint64_t head   = m_head.load(std::memory_order_acquire);
+		const std::size_t cnt = static_cast<std::size_t>(std::min<uint64_t>(head - tail, maxItems));
+
+		items.reserve(items.size() + cnt);
+
+		for (std::size_t i = 0; i < cnt; i++)
+			items.push_back(m_slots[(tail + i) & m_mask]);
+
+		m_tail.store(tail + cnt, std::memory_order_release);
+		return cnt;
+	}
+
+	std::size_t Size() const
+	{
+		return static_cast<std::size_t>(m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire));
+	}
+
+	uint64_t Drops() const
+	{
+		return m_drops.load(std::memory_order_relaxed);
+	}
+
+private:
+	std::vector<T> m_slots = {};
+	uint64_t m_mask        = 0;
+
+	// Producer and consumer positions are kept on separate cache lines to avoid false sharing
+	alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_head = { 0 };
+	uint64_t m_cachedTail                                 = 0;
+	std::atomic<uint64_t> m_drops                         = { 0 };
+	alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_tail = { 0 };
+};
+} // namespace internal
+} // namespace clap
@@ -0,0 +1,678 @@
+/*
+ *  File: SharedAllocator.hpp
+ *  Copyright (c) 2024 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+// Allocation metadata of a memory region shared by multiple processes. The blocks of the region are stored in a
+// named shared-memory segment and guarded by a robust process-shared mutex, i.e., processes using the same device
+// allocate from a common pool. Blocks owned by terminated processes are reclaimed, either when a process dies while
+// holding the mutex or when an allocation would otherwise fail.
+
+#if defined(__linux__) && !defined(EMBEDDED_XILINX)
+#define CLAP_SHARED_ALLOC_AVAILABLE
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#ifdef CLAP_SHARED_ALLOC_AVAILABLE
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Exceptions.hpp"
+#include "Logger.hpp"
+#include "Utils.hpp"
+
+#ifndef CLAP_SHM_DIR
+#define CLAP_SHM_DIR "/dev/shm"
+#endif
+
+// Maximum number of free and used blocks of a shared memory region
+#ifndef CLAP_SHARED_ALLOC_MAX_BLOCKS
+#define CLAP_SHARED_ALLOC_MAX_BLOCKS 4096
+#endif
+
+namespace clap
+{
+namespace internal
+{
+class SharedAllocator
+{
+	DISABLE_COPY_ASSIGN_MOVE(SharedAllocator)
+
+	static constexpr uint64_t MAGIC   = 0x434C41505348414DULL; // "CLAPSHAM"
+	static constexpr uint32_t VERSION = 2;
+
+public:
+	static constexpr uint64_t INV_NULL = ~static_cast<uint64_t>(0);
+	// By default only processes of the same user can attach, 0660 shares the segment with the group of the creator
+	static constexpr uint32_t DEFAULT_MODE = 0600;
+
+	struct Stats
+	{
+		uint64_t spaceLeft        = 0;
+		std::size_t freeBlocks    = 0;
+		std::size_t usedBlocks    = 0;
+		uint64_t largestFreeBlock = 0;
+	};
+
+#ifdef CLAP_SHARED_ALLOC_AVAILABLE
+	// Attaches to the segment of the given name, the first process creates and initializes it with the given permissions.
+	// All processes have to use the same base address and size for the same name.
+	SharedAllocator(const std::string& name, const uint64_t& baseAddr, const uint64_t& size, const uint32_t& mode = DEFAULT_MODE) :
+		m_fileName(std::string(CLAP_SHM_DIR) + "/" + name)
+	{
+		openSegment(mode);
+
+		// Serializes the initialization, the file lock is released by the kernel if the process dies
+		flock(m_fd, LOCK_EX);
+
+		try
+		{
+			attach(baseAddr, size);
+		}
+		catch (...)
+		{
+			flock(m_fd, LOCK_UN);
+			detach();
+			throw;
+		}
+
+		flock(m_fd, LOCK_UN);
+
+		// The segment might be left over from processes that terminated without freeing their blocks
+		Lock lock(this);
+		reclaim();
+	}
+
+	~SharedAllocator()
+	{
+		// The blocks of this process are returned, other processes might still use the segment, hence, it is not removed
+		try
+		{
+			ReleaseOwned();
+		}
+		catch (...)
+		{
+		}
+
+		detach();
+	}
+
+	// Returns the address of a block of the given size, INV_NULL if no free block is large enough
+	uint64_t Alloc(const uint64_t& alignedSize)
+	{
+		Lock lock(this);
+
+		Table& next       = beginUpdate();
+		uint64_t addr     = allocBlock(next, alignedSize);
+		uint32_t released = 0;
+
+		// Blocks of terminated processes are only reclaimed when needed, as checking the owners requires a syscall per block
+		if (addr == INV_NULL)
+		{
+			released = reclaimDead(next);
+			if (released > 0)
+				addr = allocBlock(next, alignedSize);
+		}
+
+		if (addr != INV_NULL || released > 0)
+			commitUpdate();
+
+		return addr;
+	}
+
+	// Frees the block at the given address, returns false if it is not owned by this process
+	bool Free(const uint64_t& addr)
+	{
+		Lock lock(this);
+
+		const Table& cur   = current();
+		const uint32_t idx = findBlock(cur, addr);
+		if (idx == cur.blockCount || blocksOf(cur)[idx].owner != currentPID()) return false;
+
+		Table& next    = beginUpdate();
+		Block* pBlocks = blocksOf(next);
+
+		pBlocks[idx].owner = 0;
+		next.spaceLeft += pBlocks[idx].size;
+		merge(next, idx);
+
+		commitUpdate();
+
+		return true;
+	}
+
+	// Frees all blocks owned by this process
+	void ReleaseOwned()
+	{
+		Lock lock(this);
+
+		Table& next = beginUpdate();
+		if (releaseIf(next, [](const int64_t& owner) { return owner == currentPID(); }) > 0)
+			commitUpdate();
+	}
+
+	// Whether at least sizeInByte are left, the blocks of terminated processes are reclaimed first if required
+	bool HasSpaceLeft(const uint64_t& sizeInByte)
+	{
+		Lock lock(this);
+
+		if (current().spaceLeft < sizeInByte)
+			reclaim();
+
+		return (current().spaceLeft >= sizeInByte);
+	}
+
+	Stats GetStats() const
+	{
+		Lock lock(this);
+
+		const Table& cur     = current();
+		const Block* pBlocks = blocksOf(cur);
+
+		Stats stats;
+		stats.spaceLeft = cur.spaceLeft;
+
+		for (uint32_t i = 0; i < cur.blockCount; i++)
+		{
+			if (pBlocks[i].owner != 0)
+			{
+				stats.usedBlocks++;
+				continue;
+			}
+
+			stats.freeBlocks++;
+			stats.largestFreeBlock = std::max(stats.largestFreeBlock, pBlocks[i].size);
+		}
+
+		return stats;
+	}
+
+	uint64_t GetSpaceLeft() const
+	{
+		Lock lock(this);
+		return current().spaceLeft;
+	}
+
+	const std::string& GetFileName() const
+	{
+		return m_fileName;
+	}
+
+private:
+	// Blocks cover the entire region and are ordered by address, adjacent free blocks are always merged
+	struct Block
+	{
+		uint64_t addr = 0;
+		uint64_t size = 0;
+		int64_t owner = 0; // PID of the owning process, 0 if the block is free
+	};
+
+	// Followed by capacity blocks, the segment holds two tables, see beginUpdate
+	struct Table
+	{
+		uint64_t spaceLeft;
+		uint32_t blockCount;
+		uint32_t reserved;
+	};
+
+	struct Header
+	{
+		uint64_t magic;
+		uint32_t version;
+		uint32_t capacity;
+		uint64_t baseAddr;
+		uint64_t size;
+		std::atomic<uint32_t> active; // Index of the table describing the blocks
+		uint32_t reserved;
+		pthread_mutex_t mutex;
+	};
+
+	static_assert(std::atomic<uint32_t>::is_always_lock_free, "The active table index has to be lock-free to be shared between processes");
+
+	class Lock
+	{
+		DISABLE_COPY_ASSIGN_MOVE(Lock)
+
+	public:
+		explicit Lock(const SharedAllocator* pAlloc) :
+			m_pAlloc(pAlloc)
+		{
+			const int32_t res = pthread_mutex_lock(&m_pAlloc->m_pHeader->mutex);
+
+			// The previous owner died while holding the mutex, modifications only become visible when the
+			// active table is switched, hence, the active table is consistent and only the blocks are reclaimed
+			if (res == EOWNERDEAD)
+			{
+				pthread_mutex_consistent(&m_pAlloc->m_pHeader->mutex);
+				const_cast<SharedAllocator*>(m_pAlloc)->reclaim();
+			}
+			else if (res != 0)
+			{
+				std::stringstream ss;
+				ss << CLASS_TAG("SharedAllocator") << "Unable to lock " << m_pAlloc->m_fileName << " (" << std::strerror(res) << ")";
+				throw MemoryException(ss.str());
+			}
+		}
+
+		~Lock()
+		{
+			pthread_mutex_unlock(&m_pAlloc->m_pHeader->mutex);
+		}
+
+	private:
+		const SharedAllocator* m_pAlloc;
+	};
+
+	static int64_t currentPID()
+	{
+		return static_cast<int64_t>(getpid());
+	}
+
+	static bool isAlive(const int64_t& pid)
+	{
+		return (kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM);
+	}
+
+	static std::size_t tableSize(const uint32_t& capacity)
+	{
+		return sizeof(Table) + static_cast<std::size_t>(capacity) * sizeof(Block);
+	}
+
+	static std::size_t segmentSize(const uint32_t& capacity)
+	{
+		return sizeof(Header) + 2 * tableSize(capacity);
+	}
+
+	static Block* blocksOf(Table& table)
+	{
+		return reinterpret_cast<Block*>(&table + 1);
+	}
+
+	static const Block* blocksOf(const Table& table)
+	{
+		return reinterpret_cast<const Block*>(&table + 1);
+	}
+
+	Table& tableAt(const uint32_t& idx) const
+	{
+		return *reinterpret_cast<Table*>(reinterpret_cast<uint8_t*>(m_pHeader) + sizeof(Header) + idx * tableSize(m_pHeader->capacity));
+	}
+
+	// Has to be called with the mutex locked
+	const Table& current() const
+	{
+		return tableAt(m_pHeader->active.load(std::memory_order_acquire));
+	}
+
+	// Has to be called with the mutex locked. Modifications are applied to a copy of the current table, which is
+	// published by commitUpdate. A process dying during a modification therefore never leaves an inconsistent table.
+	Table& beginUpdate()
+	{
+		const Table& cur = current();
+		Table& next      = tableAt(1 - m_pHeader->active.load(std::memory_order_relaxed));
+
+		next = cur;
+		std::memcpy(blocksOf(next), blocksOf(cur), cur.blockCount * sizeof(Block));
+
+		return next;
+	}
+
+	void commitUpdate()
+	{
+		m_pHeader->active.store(1 - m_pHeader->active.load(std::memory_order_relaxed), std::memory_order_release);
+	}
+
+	// Every process trusts the allocation tables and the mutex of the segment, therefore symbolic links are never followed
+	// and an existing segment is only used if it is a regular file with a single link whose permissions do not exceed
+	// the requested mode, owned by the effective user or, for a group-writable mode, by the effective group
+	void openSegment(const uint32_t& mode)
+	{
+		const mode_t perm = static_cast<mode_t>(mode & 0777);
+		bool created      = true;
+
+		m_fd = open(m_fileName.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC | O_NOFOLLOW, perm);
+		if (m_fd < 0 && errno == EEXIST)
+		{
+			created = false;
+			m_fd    = open(m_fileName.c_str(), O_RDWR | O_CLOEXEC | O_NOFOLLOW);
+		}
+
+		if (m_fd < 0)
+			throwError("Unable to open the shared allocation segment " + m_fileName);
+
+		if (created)
+		{
+			// Independent of the umask of the creating process
+			fchmod(m_fd, perm);
+			return;
+		}
+
+		struct stat st = {};
+		if (fstat(m_fd, &st) != 0)
+		{
+			const int32_t err = errno;
+			detach();
+			errno = err;
+			throwError("Unable to query " + m_fileName);
+		}
+
+		const bool owned = (st.st_uid == geteuid() || ((perm & S_IWGRP) != 0 && st.st_gid == getegid()));
+
+		if (!S_ISREG(st.st_mode) || st.st_nlink != 1 || (st.st_mode & 0777 & ~perm) != 0 || !owned)
+		{
+			detach();
+
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Refusing to attach to the shared allocation segment " << m_fileName << ", it is not a regular file with a single link"
+			   << ", its permissions exceed 0" << std::oct << perm << std::dec << ", or it is not owned by the effective user or group";
+			throw MemoryException(ss.str());
+		}
+	}
+
+	// Has to be called with the file lock held
+	void attach(const uint64_t& baseAddr, const uint64_t& size)
+	{
+		struct stat st;
+		if (fstat(m_fd, &st) != 0)
+			throwError("Unable to query the size of " + m_fileName);
+
+		const bool create = (st.st_size == 0);
+
+		if (create)
+		{
+			m_mapSize = segmentSize(CLAP_SHARED_ALLOC_MAX_BLOCKS);
+			if (ftruncate(m_fd, static_cast<off_t>(m_mapSize)) != 0)
+				throwError("Unable to resize " + m_fileName);
+		}
+		else
+			m_mapSize = static_cast<std::size_t>(st.st_size);
+
+		void* pMem = mmap(nullptr, m_mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+		if (pMem == MAP_FAILED)
+		{
+			m_mapSize = 0;
+			throwError("Unable to map " + m_fileName);
+		}
+
+		m_pHeader = static_cast<Header*>(pMem);
+
+		if (create)
+		{
+			initSegment(baseAddr, size);
+			return;
+		}
+
+		if (m_mapSize < sizeof(Header) || m_pHeader->magic != MAGIC || m_pHeader->version != VERSION || m_mapSize < segmentSize(m_pHeader->capacity) || m_pHeader->active > 1)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << m_fileName << " is not a shared allocation segment of this CLAP version";
+			throw MemoryException(ss.str());
+		}
+
+		if (m_pHeader->baseAddr != baseAddr || m_pHeader->size != size)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << m_fileName << " describes the region 0x" << std::hex << m_pHeader->baseAddr << " (0x" << m_pHeader->size << " byte)"
+			   << ", which differs from the requested region 0x" << baseAddr << " (0x" << size << " byte)" << std::dec;
+			throw MemoryException(ss.str());
+		}
+	}
+
+	void initSegment(const uint64_t& baseAddr, const uint64_t& size)
+	{
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+		pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+		pthread_mutex_init(&m_pHeader->mutex, &attr);
+		pthread_mutexattr_destroy(&attr);
+
+		m_pHeader->version  = VERSION;
+		m_pHeader->capacity = CLAP_SHARED_ALLOC_MAX_BLOCKS;
+		m_pHeader->baseAddr = baseAddr;
+		m_pHeader->size     = size;
+		m_pHeader->reserved = 0;
+		m_pHeader->active.store(0);
+
+		Table& table       = tableAt(0);
+		table.spaceLeft    = size;
+		table.blockCount   = 1;
+		table.reserved     = 0;
+		blocksOf(table)[0] = { baseAddr, size, 0 };
+
+		// Written last, a segment of a process that died during the initialization is rejected instead of used
+		m_pHeader->magic = MAGIC;
+	}
+
+	void detach()
+	{
+		if (m_pHeader)
+			munmap(static_cast<void*>(m_pHeader), m_mapSize);
+
+		if (m_fd >= 0)
+			close(m_fd);
+
+		m_pHeader = nullptr;
+		m_fd      = -1;
+	}
+
+	uint64_t allocBlock(Table& table, const uint64_t& alignedSize)
+	{
+		Block* pBlocks = blocksOf(table);
+
+		for (uint32_t i = 0; i < table.blockCount; i++)
+		{
+			Block& block = pBlocks[i];
+			if (block.owner != 0 || block.size < alignedSize) continue;
+
+			if (block.size > alignedSize)
+			{
+				if (table.blockCount == m_pHeader->capacity)
+				{
+					std::stringstream ss;
+					ss << CLASS_TAG_AUTO << "The shared allocation segment " << m_fileName << " is limited to " << m_pHeader->capacity << " blocks, increase CLAP_SHARED_ALLOC_MAX_BLOCKS";
+					throw MemoryException(ss.str());
+				}
+
+				// Split the block, the remainder stays free
+				std::memmove(&pBlocks[i + 2], &pBlocks[i + 1], (table.blockCount - i - 1) * sizeof(Block));
+				pBlocks[i + 1] = { block.addr + alignedSize, block.size - alignedSize, 0 };
+				block.size     = alignedSize;
+				table.blockCount++;
+			}
+
+			block.owner = currentPID();
+			table.spaceLeft -= alignedSize;
+
+			return block.addr;
+		}
+
+		return INV_NULL;
+	}
+
+	// Returns blockCount if no block starts at the given address
+	static uint32_t findBlock(const Table& table, const uint64_t& addr)
+	{
+		const Block* pBlocks = blocksOf(table);
+
+		uint32_t lo = 0;
+		uint32_t hi = table.blockCount;
+
+		while (lo < hi)
+		{
+			const uint32_t mid = lo + (hi - lo) / 2;
+
+			if (pBlocks[mid].addr < addr)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		return (lo < table.blockCount && pBlocks[lo].addr == addr ? lo : table.blockCount);
+	}
+
+	// Merges the free block at idx with its free neighbours
+	static void merge(Table& table, const uint32_t& idx)
+	{
+		Block* pBlocks = blocksOf(table);
+
+		if (idx + 1 < table.blockCount && pBlocks[idx + 1].owner == 0)
+		{
+			pBlocks[idx].size += pBlocks[idx + 1].size;
+			erase(table, idx + 1);
+		}
+
+		if (idx > 0 && pBlocks[idx - 1].owner == 0)
+		{
+			pBlocks[idx - 1].size += pBlocks[idx].size;
+			erase(table, idx);
+		}
+	}
+
+	static void erase(Table& table, const uint32_t& idx)
+	{
+		Block* pBlocks = blocksOf(table);
+
+		std::memmove(&pBlocks[idx], &pBlocks[idx + 1], (table.blockCount - idx - 1) * sizeof(Block));
+		table.blockCount--;
+	}
+
+	// Frees all blocks whose owner matches the predicate
+	template<typename Pred>
+	static uint32_t releaseIf(Table& table, const Pred& pred)
+	{
+		Block* pBlocks    = blocksOf(table);
+		uint32_t released = 0;
+		uint32_t out      = 0;
+
+		for (uint32_t i = 0; i < table.blockCount; i++)
+		{
+			Block block = pBlocks[i];
+
+			if (block.owner != 0 && pred(block.owner))
+			{
+				table.spaceLeft += block.size;
+				block.owner = 0;
+				released++;
+			}
+
+			// Compact the list while merging adjacent free blocks
+			if (out > 0 && block.owner == 0 && pBlocks[out - 1].owner == 0)
+				pBlocks[out - 1].size += block.size;
+			else
+				pBlocks[out++] = block;
+		}
+
+		table.blockCount = out;
+
+		return released;
+	}
+
+	uint32_t reclaimDead(Table& table)
+	{
+		const uint32_t released = releaseIf(table, [](const int64_t& owner) { return owner != currentPID() && !isAlive(owner); });
+
+		if (released > 0)
+			CLAP_CLASS_LOG_INFO << "Reclaimed " << released << " block(s) of terminated processes in " << m_fileName << std::endl;
+
+		return released;
+	}
+
+	// Has to be called with the mutex locked
+	uint32_t reclaim()
+	{
+		Table& next             = beginUpdate();
+		const uint32_t released = reclaimDead(next);
+
+		if (released > 0)
+			commitUpdate();
+
+		return released;
+	}
+
+	[[noreturn]] void throwError(const std::string& msg) const
+	{
+		std::stringstream ss;
+		ss << CLASS_TAG_AUTO << msg << " (" << std::strerror(errno) << ")";
+		throw MemoryException(ss.str());
+	}
+
+private:
+	std::string m_fileName;
+	int32_t m_fd          = -1;
+	std::size_t m_mapSize = 0;
+	Header* m_pHeader     = nullptr;
+#else
+	SharedAllocator(const std::string&, const uint64_t&, const uint64_t&, const uint32_t& = DEFAULT_MODE)
+	{
+		std::stringstream ss;
+		ss << CLASS_TAG("SharedAllocator") << "Shared memory regions are only supported on Linux";
+		throw MemoryException(ss.str());
+	}
+
+	uint64_t Alloc(const uint64_t&)
+	{
+		return INV_NULL;
+	}
+
+	bool Free(const uint64_t&)
+	{
+		return false;
+	}
+
+	void ReleaseOwned() {}
+
+	bool HasSpaceLeft(const uint64_t&)
+	{
+		return false;
+	}
+
+	Stats GetStats() const
+	{
+		return Stats();
+	}
+
+	uint64_t GetSpaceLeft() const
+	{
+		return 0;
+	}
+#endif
+};
+} // namespace internal
+} // namespace clap
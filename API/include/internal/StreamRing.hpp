@@ -0,0 +1,524 @@
+/*
+ *  File: StreamRing.hpp
+ *  Copyright (c) 2023 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "CLAPBackend.hpp"
+#include "Constants.hpp"
+#include "Defines.hpp"
+#include "Exceptions.hpp"
+#include "Logger.hpp"
+#include "Numa.hpp"
+#include "Timer.hpp"
+#include "Types.hpp"
+#include "Utils.hpp"
+
+namespace clap
+{
+enum class StreamDirection
+{
+	Read, // Card to host (C2H)
+	Write // Host to card (H2C)
+};
+
+// Ring of pre-registered, aligned buffers that are transferred back-to-back by a dedicated
+// worker thread, keeping the XDMA stream channel of the given direction busy.
+// Completed buffers are either reported via the buffer callback or, if no callback is set,
+// queued until they are retrieved using WaitForBuffer.
+class StreamRing
+{
+	DISABLE_COPY_ASSIGN_MOVE(StreamRing)
+
+	enum class State
+	{
+		Free,
+		Queued,
+		InFlight,
+		Done
+	};
+
+	struct Buffer
+	{
+		uint8_t* pData      = nullptr;
+		uint64_t size       = 0;
+		uint64_t submitSize = 0;
+		State state         = State::Free;
+	};
+
+public:
+	static constexpr uint64_t USE_BUFFER_SIZE = 0;
+
+	// Called from the worker thread once the buffer has been transferred
+	using BufferCallback = std::function<void(const std::size_t& bufferIdx, const uint64_t& sizeInByte)>;
+
+	/// @brief Creates a stream ring
+	/// @param pBackend Backend used for the transfers
+	/// @param direction Direction of the stream
+	/// @param chunkSize Maximum size of a single transfer in bytes, has to be a multiple of ALIGNMENT, USE_BUFFER_SIZE transfers each buffer at once
+	StreamRing(internal::CLAPBackendPtr pBackend, const StreamDirection& direction, const uint64_t& chunkSize = USE_BUFFER_SIZE) :
+		m_pBackend(std::move(pBackend)),
+		m_direction(direction),
+		m_chunkSize(chunkSize),
+		m_buffers(),
+		m_queued(),
+		m_completed(),
+		m_timer(),
+		m_worker(),
+		m_mtx(),
+		m_cv()
+	{
+		// Every chunk starts at a multiple of the chunk size within the buffer, so each of them has to stay aligned
+		if (m_chunkSize != USE_BUFFER_SIZE && m_chunkSize % ALIGNMENT != 0)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Chunk size (" << m_chunkSize << ") is not a multiple of the buffer alignment (" << ALIGNMENT << ").";
+			throw CLAPException(ss.str());
+		}
+	}
+
+	~StreamRing()
+	{
+		Stop();
+	}
+
+	/// @brief Registers a buffer with the ring, buffers can only be added while the ring is idle
+	/// @param pData Pointer to the buffer, has to be aligned to ALIGNMENT bytes
+	/// @param sizeInByte Size of the buffer in bytes, has to be a multiple of the XDMA AXI data width
+	/// @return Index of the buffer within the ring
+	std::size_t AddBuffer(void* pData, const uint64_t& sizeInByte)
+	{
+		if (!IS_ALIGNED(pData, ALIGNMENT))
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Buffer is not aligned to " << ALIGNMENT << " bytes.";
+			throw CLAPException(ss.str());
+		}
+
+		checkSize(sizeInByte);
+
+		std::lock_guard<std::mutex> lock(m_mtx);
+
+		if (!isIdle())
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Buffers can only be added while the ring is idle";
+			throw CLAPException(ss.str());
+		}
+
+		Buffer buffer;
+		buffer.pData = reinterpret_cast<uint8_t*>(pData);
+		buffer.size  = sizeInByte;
+		m_buffers.push_back(buffer);
+
+		return m_buffers.size() - 1;
+	}
+
+	/// @brief Registers a buffer containing data to write with the ring
+	/// @param pData Pointer to the buffer, has to be aligned to ALIGNMENT bytes
+	/// @param sizeInByte Size of the buffer in bytes, has to be a multiple of the XDMA AXI data width
+	/// @return Index of the buffer within the ring
+	std::size_t AddBuffer(const void* pData, const uint64_t& sizeInByte)
+	{
+		if (m_direction != StreamDirection::Write)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Read streams require writable buffers";
+			throw CLAPException(ss.str());
+		}
+
+		// Write streams never modify the buffer
+		return AddBuffer(const_cast<void*>(pData), sizeInByte);
+	}
+
+	template<typename T>
+	std::size_t AddBuffer(CLAPBuffer<T>& buffer)
+	{
+		return AddBuffer(reinterpret_cast<void*>(buffer.data()), buffer.size() * sizeof(T));
+	}
+
+	template<typename T>
+	std::size_t AddBuffer(const CLAPBuffer<T>& buffer)
+	{
+		return AddBuffer(reinterpret_cast<const void*>(buffer.data()), buffer.size() * sizeof(T));
+	}
+
+	/// @brief Sets the callback called for each completed buffer, completed buffers are no longer queued for WaitForBuffer
+	/// @param callback Callback receiving the index and the transferred size of the buffer
+	void SetBufferCallback(const BufferCallback& callback)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_callback = callback;
+	}
+
+	/// @brief Restricts the transfer thread of the ring to the given CPUs, takes effect immediately if the thread is already running
+	/// @param cpus CPUs to run on, an empty set allows all online CPUs
+	void SetThreadAffinity(const CpuSet& cpus)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_affinity = cpus;
+
+		if (m_worker.joinable())
+			numa::PinThread(m_worker, m_affinity);
+	}
+
+	/// @brief Queues the specified buffer for transfer, the buffer must not be modified until it has been completed
+	/// @param bufferIdx Index of the buffer
+	/// @param sizeInByte Number of bytes to transfer, USE_BUFFER_SIZE transfers the entire buffer
+	void Submit(const std::size_t& bufferIdx, const uint64_t& sizeInByte = USE_BUFFER_SIZE)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+
+		rethrowException();
+
+		if (bufferIdx >= m_buffers.size())
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Buffer index " << bufferIdx << " is out of range (" << m_buffers.size() << " buffers)";
+			throw CLAPException(ss.str());
+		}
+
+		Buffer& buffer = m_buffers[bufferIdx];
+
+		if (buffer.state == State::Queued || buffer.state == State::InFlight)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Buffer " << bufferIdx << " is still owned by the ring";
+			throw CLAPException(ss.str());
+		}
+
+		const uint64_t size = (sizeInByte == USE_BUFFER_SIZE ? buffer.size : sizeInByte);
+
+		if (size > buffer.size)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Size (" << size << ") exceeds the size of buffer " << bufferIdx << " (" << buffer.size << ")";
+			throw CLAPException(ss.str());
+		}
+
+		checkSize(size);
+
+		// A completed buffer that is resubmitted without being retrieved is no longer reported
+		m_completed.erase(std::remove(m_completed.begin(), m_completed.end(), bufferIdx), m_completed.end());
+
+		buffer.submitSize = size;
+		buffer.state      = State::Queued;
+		m_queued.push_back(bufferIdx);
+
+		if (!m_worker.joinable())
+		{
+			m_worker = std::thread(&StreamRing::run, this);
+
+			if (!m_affinity.empty())
+				numa::PinThread(m_worker, m_affinity);
+		}
+
+		m_cv.notify_all();
+	}
+
+	/// @brief Queues all buffers of the ring in the order they were added
+	void SubmitAll()
+	{
+		for (std::size_t i = 0; i < GetBufferCount(); i++)
+			Submit(i);
+	}
+
+	/// @brief Waits for the next completed buffer
+	/// @param bufferIdx Index of the completed buffer
+	/// @param timeoutMS Timeout in milliseconds
+	/// @return true if a buffer completed, false if the timeout expired or no buffer is queued or in flight
+	bool WaitForBuffer(std::size_t& bufferIdx, const int32_t& timeoutMS = WAIT_INFINITE)
+	{
+		std::unique_lock<std::mutex> lock(m_mtx);
+
+		const auto ready = [this] { return !m_completed.empty() || m_pExcept || isIdle(); };
+
+		if (timeoutMS == WAIT_INFINITE)
+			m_cv.wait(lock, ready);
+		else if (!m_cv.wait_for(lock, std::chrono::milliseconds(timeoutMS), ready))
+			return false;
+
+		rethrowException();
+
+		if (m_completed.empty()) return false;
+
+		bufferIdx = m_completed.front();
+		m_completed.pop_front();
+		m_buffers[bufferIdx].state = State::Free;
+
+		return true;
+	}
+
+	/// @brief Waits until all queued buffers have been transferred
+	/// @param timeoutMS Timeout in milliseconds
+	/// @return true if all buffers have been transferred, false if the timeout expired
+	bool WaitForAll(const int32_t& timeoutMS = WAIT_INFINITE)
+	{
+		std::unique_lock<std::mutex> lock(m_mtx);
+
+		const auto ready = [this] { return m_pExcept || isIdle(); };
+
+		if (timeoutMS == WAIT_INFINITE)
+			m_cv.wait(lock, ready);
+		else if (!m_cv.wait_for(lock, std::chrono::milliseconds(timeoutMS), ready))
+			return false;
+
+		rethrowException();
+
+		return true;
+	}
+
+	/// @brief Stops the ring, buffers that have not been started yet are dropped.
+	///        A transfer that is currently in flight is finished first, must not be called from the buffer callback.
+	void Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			m_stop = true;
+
+			for (const std::size_t& idx : m_queued)
+				m_buffers[idx].state = State::Free;
+
+			m_queued.clear();
+		}
+
+		m_cv.notify_all();
+
+		if (m_worker.joinable())
+			m_worker.join();
+
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_stop = false;
+	}
+
+	bool IsBusy() const
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		return !isIdle();
+	}
+
+	std::size_t GetBufferCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		return m_buffers.size();
+	}
+
+	const StreamDirection& GetDirection() const
+	{
+		return m_direction;
+	}
+
+	/// @brief Returns the number of bytes transferred since the ring was created
+	uint64_t GetTransferredBytes() const
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		return m_transferredBytes;
+	}
+
+	/// @brief Returns the time the ring was continuously busy, i.e., from the start of the first transfer
+	///        after being idle until the ring was idle again, in milliseconds
+	double GetRuntime() const
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		return m_timer.GetElapsedTimeInMilliSec();
+	}
+
+private:
+	void checkSize(const uint64_t& sizeInByte) const
+	{
+		// Due to the AXI data width of the XDMA the size has to be a multiple of 512-Bit (64-Byte)
+		if (sizeInByte % internal::XDMA_AXI_DATA_WIDTH != 0)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Size (" << sizeInByte << ") is not a multiple of the XDMA AXI data width (" << internal::XDMA_AXI_DATA_WIDTH << ").";
+			throw CLAPException(ss.str());
+		}
+	}
+
+	bool isIdle() const
+	{
+		return (m_queued.empty() && !m_inFlight);
+	}
+
+	void rethrowException()
+	{
+		if (!m_pExcept) return;
+
+		std::exception_ptr pExcept = m_pExcept;
+		m_pExcept                  = nullptr;
+		std::rethrow_exception(pExcept);
+	}
+
+	void run()
+	{
+		while (true)
+		{
+			std::size_t idx = 0;
+			uint8_t* pData  = nullptr;
+			uint64_t size   = 0;
+
+			{
+				std::unique_lock<std::mutex> lock(m_mtx);
+				m_cv.wait(lock, [this] { return m_stop || !m_queued.empty(); });
+
+				if (m_stop) return;
+
+				idx = m_queued.front();
+				m_queued.pop_front();
+
+				if (m_idleSinceLast)
+				{
+					m_timer.Start();
+					m_idleSinceLast = false;
+				}
+
+				m_inFlight           = true;
+				m_buffers[idx].state = State::InFlight;
+				pData                = m_buffers[idx].pData;
+				size                 = m_buffers[idx].submitSize;
+			}
+
+			std::exception_ptr pExcept = nullptr;
+
+			try
+			{
+				transfer(pData, size);
+			}
+			catch (...)
+			{
+				pExcept = std::current_exception();
+			}
+
+			BufferCallback callback = nullptr;
+
+			if (!pExcept)
+			{
+				std::lock_guard<std::mutex> lock(m_mtx);
+				m_transferredBytes += size;
+
+				// With a callback the buffer is handed back to the user right away, allowing it to be
+				// resubmitted from within the callback, otherwise it is owned by the completion queue
+				if (m_callback)
+				{
+					callback             = m_callback;
+					m_buffers[idx].state = State::Free;
+				}
+				else
+				{
+					m_buffers[idx].state = State::Done;
+					m_completed.push_back(idx);
+				}
+			}
+
+			// The callback is called while the ring is still busy, i.e., WaitForAll returns after the last callback
+			if (callback)
+			{
+				try
+				{
+					callback(idx, size);
+				}
+				catch (...)
+				{
+					pExcept = std::current_exception();
+				}
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_mtx);
+
+				m_inFlight = false;
+
+				if (pExcept)
+				{
+					m_pExcept = pExcept;
+
+					if (m_buffers[idx].state == State::InFlight)
+						m_buffers[idx].state = State::Free;
+				}
+
+				if (m_queued.empty())
+				{
+					m_timer.Stop();
+					m_idleSinceLast = true;
+				}
+			}
+
+			m_cv.notify_all();
+		}
+	}
+
+	void transfer(uint8_t* pData, const uint64_t& size)
+	{
+		const uint64_t chunkSize = (m_chunkSize == USE_BUFFER_SIZE ? static_cast<uint64_t>(internal::RW_MAX_SIZE) : m_chunkSize);
+		uint64_t count           = 0;
+
+		while (count < size)
+		{
+			const uint64_t bytes = std::min(size - count, chunkSize);
+
+			if (m_direction == StreamDirection::Read)
+				m_pBackend->ReadStream(pData + count, bytes);
+			else
+				m_pBackend->WriteStream(pData + count, bytes);
+
+			count += bytes;
+		}
+	}
+
+private:
+	internal::CLAPBackendPtr m_pBackend;
+	StreamDirection m_direction;
+	uint64_t m_chunkSize;
+	std::vector<Buffer> m_buffers;
+	std::deque<std::size_t> m_queued;
+	std::deque<std::size_t> m_completed;
+	Timer m_timer;
+	std::thread m_worker;
+	mutable std::mutex m_mtx;
+	std::condition_variable m_cv;
+	BufferCallback m_callback    = nullptr;
+	CpuSet m_affinity            = {};
+	std::exception_ptr m_pExcept = nullptr;
+	uint64_t m_transferredBytes  = 0;
+	bool m_inFlight              = false;
+	bool m_idleSinceLast         = true;
+	bool m_stop                  = false;
+};
+
+using StreamRingPtr = std::shared_ptr<StreamRing>;
+} // namespace clap
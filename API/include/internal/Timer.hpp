@@ -79,6 +79,10 @@ public:
 	{
 		return 0;
 	}
+	uint64_t GetElapsedTimeInNanoSec() const
+	{
+		return 0;
+	}
 	double GetElapsedTime() const
 	{
 		return 0.0;
@@ -143,6 +147,11 @@ public:
 		return getElapsedTime<std::chrono::microseconds>().count();
 	}
 
+	uint64_t GetElapsedTimeInNanoSec() const
+	{
+		return getElapsedTime<std::chrono::nanoseconds>().count();
+	}
+
 	double GetElapsedTime() const
 	{
 		return GetElapsedTimeInSec();
@@ -0,0 +1,360 @@
+/*
+ *  File: Trace.hpp
+ *  Copyright (c) 2024 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+// Compile-time optional tracing of backend transfers, IP core register accesses and WatchDog jobs.
+// When CLAP_ENABLE_TRACE is not defined all trace macros expand to nothing.
+// Bare-metal builds are not supported, as they lack threads and a steady clock.
+
+#if defined(CLAP_ENABLE_TRACE) && !defined(EMBEDDED_XILINX)
+#define CLAP_TRACE_ACTIVE
+#endif
+
+#ifdef CLAP_TRACE_ACTIVE
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Exceptions.hpp"
+#include "Utils.hpp"
+
+// Number of events stored per thread, older events are overwritten once the ring is full
+#ifndef CLAP_TRACE_RING_SIZE
+#define CLAP_TRACE_RING_SIZE 65536
+#endif
+
+namespace clap
+{
+namespace trace
+{
+static_assert((CLAP_TRACE_RING_SIZE & (CLAP_TRACE_RING_SIZE - 1)) == 0, "CLAP_TRACE_RING_SIZE has to be a power of two");
+
+enum class EventType : uint8_t
+{
+	Read,
+	Write,
+	ReadStream,
+	WriteStream,
+	WatchDogRun,
+	WatchDogWait
+};
+
+inline const char* ToString(const EventType& type)
+{
+	switch (type)
+	{
+		case EventType::Read:
+			return "Read";
+		case EventType::Write:
+			return "Write";
+		case EventType::ReadStream:
+			return "ReadStream";
+		case EventType::WriteStream:
+			return "WriteStream";
+		case EventType::WatchDogRun:
+			return "Run";
+		case EventType::WatchDogWait:
+			return "WaitForFinish";
+	}
+
+	return "Unknown";
+}
+
+struct Event
+{
+	uint64_t startNS = 0;
+	uint64_t endNS   = 0;
+	uint64_t addr    = 0;
+	uint64_t size    = 0;
+	uint32_t nameID  = 0; // Interned name of the IP core / WatchDog, 0 if none
+	EventType type   = EventType::Read;
+};
+
+// Single producer ring, only the owning thread writes, the tracer reads the events on export
+struct ThreadRing
+{
+	explicit ThreadRing(const uint32_t& id) :
+		tid(id),
+		events(CLAP_TRACE_RING_SIZE)
+	{}
+
+	uint32_t tid;
+	std::vector<Event> events;
+	std::atomic<uint64_t> head = 0;
+};
+
+class Tracer
+{
+	DISABLE_COPY_ASSIGN_MOVE(Tracer)
+
+public:
+	static Tracer& Get()
+	{
+		static Tracer tracer;
+		return tracer;
+	}
+
+	// Nanoseconds since the creation of the tracer
+	static uint64_t Now()
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Get().m_epoch).count());
+	}
+
+	void SetEnabled(const bool& enabled)
+	{
+		m_enabled.store(enabled, std::memory_order_relaxed);
+	}
+
+	bool IsEnabled() const
+	{
+		return m_enabled.load(std::memory_order_relaxed);
+	}
+
+	// Maps a name to an id stored in the events, intended to be called once per IP core / WatchDog, not on the hot path
+	uint32_t InternName(const std::string& name)
+	{
+		if (name.empty()) return 0;
+
+		std::lock_guard<std::mutex> lock(m_mtx);
+		auto it = m_nameIDs.find(name);
+		if (it != m_nameIDs.end())
+			return it->second;
+
+		m_names.push_back(name);
+		const uint32_t id = static_cast<uint32_t>(m_names.size() - 1);
+		m_nameIDs[name]   = id;
+
+		return id;
+	}
+
+	void Record(const Event& event)
+	{
+		if (!IsEnabled()) return;
+
+		ThreadRing& ring    = localRing();
+		const uint64_t head = ring.head.load(std::memory_order_relaxed);
+		ring.events[head & (CLAP_TRACE_RING_SIZE - 1)] = event;
+		ring.head.store(head + 1, std::memory_order_release);
+	}
+
+	// Discards all recorded events, should only be called while no traced operation is in flight
+	void Clear()
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		for (auto& pRing : m_rings)
+			pRing->head.store(0, std::memory_order_release);
+	}
+
+	// Writes all recorded events in the Chrome trace event format (chrome://tracing, ui.perfetto.dev).
+	// Should be called once the traced operations finished, events recorded concurrently might be torn.
+	void WriteChromeTrace(std::ostream& os)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+
+		os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+		bool first = true;
+		for (const auto& pRing : m_rings)
+		{
+			os << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << pRing->tid
+			   << ",\"args\":{\"name\":\"CLAP Thread " << pRing->tid << "\"}}";
+			first = false;
+
+			const uint64_t head  = pRing->head.load(std::memory_order_acquire);
+			const uint64_t count = std::min<uint64_t>(head, CLAP_TRACE_RING_SIZE);
+
+			for (uint64_t i = head - count; i < head; i++)
+			{
+				os << ",\n";
+				writeEvent(os, pRing->tid, pRing->events[i & (CLAP_TRACE_RING_SIZE - 1)]);
+			}
+		}
+
+		os << "\n]}\n";
+	}
+
+	void ExportChromeTrace(const std::string& fileName)
+	{
+		std::ofstream ofs(fileName);
+		if (!ofs.is_open())
+			throw CLAPException("Unable to open trace file \"" + fileName + "\"");
+
+		WriteChromeTrace(ofs);
+	}
+
+private:
+	Tracer() :
+		m_epoch(std::chrono::steady_clock::now())
+	{
+		m_names.push_back("");
+	}
+
+	ThreadRing& localRing()
+	{
+		// The rings are owned by the tracer, keeping the events of threads that already terminated
+		thread_local ThreadRing* pRing = nullptr;
+
+		if (pRing == nullptr)
+		{
+			std::lock_guard<std::mutex> lock(m_mtx);
+			m_rings.push_back(std::make_unique<ThreadRing>(static_cast<uint32_t>(m_rings.size() + 1)));
+			pRing = m_rings.back().get();
+		}
+
+		return *pRing;
+	}
+
+	void writeEvent(std::ostream& os, const uint32_t& tid, const Event& event) const
+	{
+		const std::string& name = m_names[event.nameID < m_names.size() ? event.nameID : 0];
+		const bool isJob        = (event.type == EventType::WatchDogRun || event.type == EventType::WatchDogWait);
+
+		os << "{\"name\":\"";
+		if (!name.empty())
+		{
+			for (const char& c : name)
+				os << (c == '"' || c == '\\' ? "\\" : "") << c;
+			os << " ";
+		}
+		os << ToString(event.type) << "\",\"cat\":\"" << (isJob ? "job" : "transfer") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+		   << std::fixed << std::setprecision(3) << ",\"ts\":" << static_cast<double>(event.startNS) / 1000.0
+		   << ",\"dur\":" << static_cast<double>(event.endNS - event.startNS) / 1000.0;
+
+		if (!isJob)
+			os << ",\"args\":{\"addr\":\"0x" << std::hex << event.addr << std::dec << "\",\"size\":" << event.size << "}";
+
+		os << "}";
+	}
+
+private:
+	std::chrono::steady_clock::time_point m_epoch;
+	std::atomic<bool> m_enabled                         = true;
+	std::mutex m_mtx                                    = {};
+	std::vector<std::unique_ptr<ThreadRing>> m_rings    = {};
+	std::vector<std::string> m_names                    = {};
+	std::unordered_map<std::string, uint32_t> m_nameIDs = {};
+};
+
+// Name of the IP core whose register accesses are currently executed by this thread
+inline uint32_t& CurrentLabel()
+{
+	thread_local uint32_t label = 0;
+	return label;
+}
+
+// Records an event spanning the lifetime of the scope
+class Scope
+{
+	DISABLE_COPY_ASSIGN_MOVE(Scope)
+
+public:
+	Scope(const EventType& type, const uint64_t& addr = 0, const uint64_t& size = 0, const uint32_t& nameID = 0)
+	{
+		m_event.type    = type;
+		m_event.addr    = addr;
+		m_event.size    = size;
+		m_event.nameID  = (nameID == 0 ? CurrentLabel() : nameID);
+		m_event.startNS = Tracer::Now();
+	}
+
+	~Scope()
+	{
+		m_event.endNS = Tracer::Now();
+		Tracer::Get().Record(m_event);
+	}
+
+private:
+	Event m_event = {};
+};
+
+// Attributes all backend events of this thread within the scope to the given name
+class Label
+{
+	DISABLE_COPY_ASSIGN_MOVE(Label)
+
+public:
+	explicit Label(const uint32_t& nameID) :
+		m_prev(CurrentLabel())
+	{
+		CurrentLabel() = nameID;
+	}
+
+	~Label()
+	{
+		CurrentLabel() = m_prev;
+	}
+
+private:
+	uint32_t m_prev;
+};
+
+inline void SetEnabled(const bool& enabled)
+{
+	Tracer::Get().SetEnabled(enabled);
+}
+
+inline void Clear()
+{
+	Tracer::Get().Clear();
+}
+
+inline void WriteChromeTrace(std::ostream& os)
+{
+	Tracer::Get().WriteChromeTrace(os);
+}
+
+inline void ExportChromeTrace(const std::string& fileName)
+{
+	Tracer::Get().ExportChromeTrace(fileName);
+}
+} // namespace trace
+} // namespace clap
+
+#define CLAP_TRACE_CONCAT_INNER(_A_, _B_) _A_##_B_
+#define CLAP_TRACE_CONCAT(_A_, _B_)       CLAP_TRACE_CONCAT_INNER(_A_, _B_)
+
+#define CLAP_TRACE_SCOPE(...)      clap::trace::Scope CLAP_TRACE_CONCAT(_clapTraceScope, __LINE__)(__VA_ARGS__)
+#define CLAP_TRACE_LABEL(_ID_)     clap::trace::Label CLAP_TRACE_CONCAT(_clapTraceLabel, __LINE__)(_ID_)
+#define CLAP_TRACE_INTERN(_NAME_)  clap::trace::Tracer::Get().InternName(_NAME_)
+#define CLAP_TRACE_NOW()           clap::trace::Tracer::Now()
+#define CLAP_TRACE_RECORD(_EVENT_) clap::trace::Tracer::Get().Record(_EVENT_)
+#else
+#define CLAP_TRACE_SCOPE(...)
+#define CLAP_TRACE_LABEL(_ID_)
+#define CLAP_TRACE_INTERN(_NAME_) 0
+#define CLAP_TRACE_NOW()          0
+#define CLAP_TRACE_RECORD(_EVENT_)
+#endif
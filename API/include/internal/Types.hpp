@@ -34,6 +34,8 @@
 
 #ifndef EMBEDDED_XILINX
 #include "AlignmentAllocator.hpp"
+#include "HugePageAllocator.hpp"
+#include "Numa.hpp"
 #endif
 
 namespace clap
@@ -41,6 +43,9 @@ namespace clap
 #ifdef EMBEDDED_XILINX
 template<class T>
 using CLAPBufferAllocator = std::allocator<T>;
+#elif defined(CLAP_USE_HUGEPAGE_BUFFERS) && defined(CLAP_HUGEPAGES_AVAILABLE)
+template<class T>
+using CLAPBufferAllocator = clap::internal::HugePageAllocator<T>;
 #else
 template<class T>
 using CLAPBufferAllocator = clap::internal::AlignmentAllocator<T, ALIGNMENT>;
@@ -49,6 +54,41 @@ using CLAPBufferAllocator = clap::internal::AlignmentAllocator<T, ALIGNMENT>;
 template<class T>
 using CLAPBuffer = std::vector<T, CLAPBufferAllocator<T>>;
 
+#ifdef CLAP_HUGEPAGES_AVAILABLE
+// Buffer backed by the recycling hugepage pool, intended for large transfers that are repeated many times
+template<class T>
+using CLAPHugeBuffer = std::vector<T, clap::internal::HugePageAllocator<T>>;
+#endif
+
+#ifndef EMBEDDED_XILINX
+// Buffer whose pages are placed on the NUMA node of its allocator, see CLAP::CreateNodeLocalBuffer
+template<class T>
+using CLAPNumaBuffer = std::vector<T, clap::internal::NumaAllocator<T>>;
+#endif
+
+// Access of a CLAP instance to its device, enforced across processes using a lock file per device
+enum class DeviceAccess
+{
+	Exclusive, // No other process can open the device
+	Shared,    // Other processes can open the device in shared mode, each locking the address ranges it uses
+	Unlocked   // No lock is taken, the device is not protected against concurrent use
+};
+
+// Coherency of a memory region with the CPU caches, determines the cache maintenance of backends accessing the memory through the caches (BareMetal, PetaLinux /dev/mem)
+enum class Coherency
+{
+	NonCoherent, // The caches are maintained by every transfer
+	Explicit,    // Not coherent, the caches are maintained by the application using CLAP::Sync, e.g., once for all buffers of a kernel launch
+	Coherent     // Connected through a coherent port (e.g., ACP or HPC), no maintenance is required
+};
+
+// Direction of the cache maintenance performed by CLAP::Sync
+enum class SyncDirection
+{
+	ToDevice,  // Flushes the caches, required before the device reads data written by the host
+	FromDevice // Invalidates the caches, required before the host reads data written by the device
+};
+
 using CLAPPtr  = std::shared_ptr<class CLAP>;
 using Bit32Arr = std::array<bool, 32>;
 
@@ -26,16 +26,24 @@
 
 #pragma once
 
+#include <algorithm>
 #include <arpa/inet.h>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
 #include <sys/mman.h>
+#include <sys/utsname.h>
+#include <unistd.h>
 #include <vector>
 
+#include "CopyKernels.hpp"
 #include "Exceptions.hpp"
 #include "Expected.hpp"
 #include "FileOps.hpp"
@@ -65,9 +73,14 @@ static constexpr uint32_t MINOR_BITS      = 20;
 static constexpr uint32_t UIO_MAX_DEVICES = 1U << MINOR_BITS;
 static constexpr uint32_t UIO_MAX_MAPS    = 5;
 
+template<typename T>
+class UioManager;
+
 template<typename T>
 class UioDev
 {
+	friend class UioManager<T>;
+
 	static inline const std::string UIO_SYS_PATH_MAP_BASE = "/maps/map";
 	static inline const std::string UIO_DEV_PATH          = "/dev/uio";
 	static inline const std::string UIO_OF_NODE_PATH      = "/device/of_node/";
@@ -187,6 +200,15 @@ class UioDev
 
 	using UioMaps = std::vector<UioMap<T>>;
 
+	using PropertyMap = std::map<std::string, std::vector<uint8_t>>;
+
+	// Shared by all copies of the device, the properties are read once on first use
+	struct PropertyCache
+	{
+		std::once_flag loaded = {};
+		PropertyMap values    = {};
+	};
+
 public:
 	UioDev(const std::string& name, const std::string& path, const uint32_t& id) :
 		m_name(name),
@@ -221,7 +243,7 @@ public:
 		return m_valid;
 	}
 
-	T Read(const T& addr, void* pData, const T& sizeInByte) const
+	T Read(const T& addr, void* pData, const T& sizeInByte, const CopyKernel& kernel = CopyKernel::MemCpy) const
 	{
 		if (!m_valid)
 		{
@@ -271,7 +293,7 @@ public:
 			if (bytes > RW_MAX_SIZE)
 				bytes = RW_MAX_SIZE;
 
-			std::memcpy(pByteData + count, reinterpret_cast<const void*>(pMem + count), bytes);
+			CopyFromDevice(pByteData + count, pMem + count, bytes, kernel);
 
 			count += bytes;
 		}
@@ -285,7 +307,7 @@ public:
 		return count;
 	}
 
-	T Write(const T& addr, const void* pData, const T& sizeInByte) const
+	T Write(const T& addr, const void* pData, const T& sizeInByte, const CopyKernel& kernel = CopyKernel::MemCpy) const
 	{
 		if (!m_valid)
 		{
@@ -334,7 +356,7 @@ public:
 			if (bytes > RW_MAX_SIZE)
 				bytes = RW_MAX_SIZE;
 
-			std::memcpy(reinterpret_cast<void*>(pMem + count), pByteData + count, bytes);
+			CopyToDevice(pMem + count, pByteData + count, bytes, kernel);
 
 			count += bytes;
 		}
@@ -352,19 +374,18 @@ public:
 
 	Expected<std::string> ReadStringProperty(const std::string& name) const
 	{
-		std::ifstream file(m_devTreePropPath + name);
-		if (!file.is_open())
+		const PropertyMap& props = properties();
+		auto it                  = props.find(name);
+		if (it == props.end())
 		{
 			CLAP_CLASS_LOG_ERROR << "Could not open property \"" << name << "\" - path=" << m_devTreePropPath + name << std::endl;
 			return MakeUnexpected();
 		}
 
-		std::string value;
-		std::getline(file, value);
-		file.close();
+		std::string value(it->second.begin(), std::find(it->second.begin(), it->second.end(), '\n'));
 
 		// Remove trailing null character (\0) if present
-		if (value.back() == '\0')
+		if (!value.empty() && value.back() == '\0')
 			value.pop_back();
 
 		return value;
@@ -372,12 +393,14 @@ public:
 
 	Expected<T> ReadHexStringProperty(const std::string& name) const
 	{
-		std::ifstream file(m_devTreePropPath + name, std::ios::binary);
-		if (!file.is_open()) return MakeUnexpected();
+		const PropertyMap& props = properties();
+		auto it                  = props.find(name);
+		if (it == props.end()) return MakeUnexpected();
+
+		std::istringstream iss(std::string(it->second.begin(), it->second.end()));
 
 		T value;
-		file >> std::hex >> value;
-		file.close();
+		iss >> std::hex >> value;
 
 		return value;
 	}
@@ -385,8 +408,8 @@ public:
 	template<typename U>
 	Expected<U> ReadBinaryProperty(const std::string& property) const
 	{
-		std::vector<uint8_t> propValues = readProperty(property);
-		U propValue                     = 0;
+		const std::vector<uint8_t> propValues = cachedProperty(property);
+		U propValue                           = 0;
 
 		if (propValues.empty()) return MakeUnexpected();
 
@@ -402,7 +425,7 @@ public:
 	template<typename U>
 	Expected<std::vector<U>> ReadBinaryPropertyVec(const std::string& property) const
 	{
-		std::vector<uint8_t> propValues = readProperty(property);
+		const std::vector<uint8_t> propValues = cachedProperty(property);
 		std::vector<U> resValues;
 
 		if (propValues.empty()) return MakeUnexpected();
@@ -422,7 +445,7 @@ public:
 
 	bool CheckPropertyExists(const std::string& property) const
 	{
-		return fs::exists(m_devTreePropPath + property);
+		return (properties().count(property) != 0);
 	}
 
 	const std::string& GetName() const
@@ -450,6 +473,19 @@ public:
 		return m_maps;
 	}
 
+	// Returns a pointer into the mapped memory of the device, the entire range has to be part of the first map
+	void* GetPtr(const T& addr, const T& sizeInByte) const
+	{
+		if (!m_valid || sizeInByte == 0 || !m_maps[0].AddrInRange(addr) || !m_maps[0].AddrInRange(addr + sizeInByte - 1))
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Range 0x" << std::hex << addr << " - 0x" << addr + sizeInByte << std::dec << " is not mapped by device \"" << m_name << "\"";
+			throw UIOException(ss.str());
+		}
+
+		return reinterpret_cast<uint8_t*>(m_mmDev->GetPtr()) + (addr - m_maps[0].GetAddr());
+	}
+
 	bool HasAddr(const T& addr) const
 	{
 		return std::any_of(m_maps.begin(), m_maps.end(), [addr](const UioMap<T>& map) { return map.AddrInRange(addr); });
@@ -506,6 +542,46 @@ private:
 		m_mmDev = std::make_shared<MMDev>(path, m_maps.front().GetSize());
 	}
 
+	// Used when restoring a device from a discovery snapshot, the maps and properties are not read from sysfs
+	UioDev(const std::string& name, const std::string& path, const uint32_t& id, UioMaps maps, PropertyMap props) :
+		m_name(name),
+		m_path(path),
+		m_devTreePropPath(path + UIO_OF_NODE_PATH),
+		m_id(id),
+		m_maps(std::move(maps))
+	{
+		std::call_once(m_pProps->loaded, [this, &props] { m_pProps->values = std::move(props); });
+
+		if (m_maps.empty()) return;
+
+		openDevice();
+		m_valid = true;
+	}
+
+	// Reads all properties of the device tree node at once, instead of opening a file for every lookup
+	const PropertyMap& properties() const
+	{
+		std::call_once(m_pProps->loaded, [this] {
+			std::error_code ec;
+			for (const fs::directory_entry& entry : fs::directory_iterator(m_devTreePropPath, ec))
+			{
+				// Sub-directories are child nodes, not properties
+				if (entry.is_regular_file(ec))
+					m_pProps->values[entry.path().filename().string()] = readProperty(entry.path().filename().string());
+			}
+		});
+
+		return m_pProps->values;
+	}
+
+	std::vector<uint8_t> cachedProperty(const std::string& property) const
+	{
+		const PropertyMap& props = properties();
+		auto it                  = props.find(property);
+
+		return (it == props.end() ? std::vector<uint8_t>() : it->second);
+	}
+
 	std::vector<uint8_t> readProperty(const std::string& property) const
 	{
 		const std::string propertyPath = m_devTreePropPath + property;
@@ -709,24 +785,30 @@ private:
 	std::string m_path;
 	std::string m_devTreePropPath;
 	uint32_t m_id;
-	UioMaps m_maps   = {};
-	bool m_valid     = false;
-	MMDevPtr m_mmDev = nullptr;
+	UioMaps m_maps                          = {};
+	bool m_valid                            = false;
+	MMDevPtr m_mmDev                        = nullptr;
+	std::shared_ptr<PropertyCache> m_pProps = std::make_shared<PropertyCache>();
 };
 
 template<typename T>
 using UioDevs = std::vector<UioDev<T>>;
 
 // TODO:
-//    - Store valid address ranges for each device
 //    - Add read / write methods that check the address ranges and use the correct device
 //
 
 template<typename T>
 class UioManager
 {
-	static inline const std::string UIO_SYS_PATH_BASE = "/sys/class/uio/uio";
-	static inline const std::string UIO_NAME_FILE     = "/name";
+	static inline const std::string UIO_SYS_PATH_BASE  = "/sys/class/uio/uio";
+	static inline const std::string UIO_SYS_CLASS_PATH = "/sys/class/uio";
+	static inline const std::string UIO_NAME_FILE      = "/name";
+	static inline const std::string FDT_PATH           = "/sys/firmware/fdt";
+	static inline const std::string DT_OVERLAYS_PATH   = "/sys/kernel/config/device-tree/overlays";
+	static inline const std::string SNAPSHOT_MAGIC     = "CLAPUIO1";
+	static constexpr uint64_t FNV_OFFSET_BASIS         = 0xcbf29ce484222325ULL;
+	static constexpr uint64_t FNV_PRIME                = 0x100000001b3ULL;
 
 public:
 	UioManager() {}
@@ -735,21 +817,32 @@ public:
 
 	bool Init()
 	{
-		for (uint32_t uio = 0; uio < UIO_MAX_DEVICES; uio++)
-		{
-			std::string basePath = UIO_SYS_PATH_BASE + std::to_string(uio);
+#ifdef CLAP_UIO_SNAPSHOT_FILE
+		return Init(CLAP_UIO_SNAPSHOT_FILE);
+#else
+		return Init("");
+#endif
+	}
 
-			std::ifstream file(basePath + UIO_NAME_FILE);
-			if (!file.is_open()) break;
+	// When a snapshot file is given, the discovered devices including their device tree properties are stored in it.
+	// Later runs restore the devices from the snapshot without scanning sysfs, as long as the device tree is unchanged.
+	bool Init(const std::string& snapshotFile)
+	{
+		m_uioDevs.clear();
 
-			std::string name;
+		uint64_t key       = 0;
+		const bool useSnap = (!snapshotFile.empty() && snapshotKey(key));
 
-			std::getline(file, name);
-			file.close();
+		if (!useSnap || !loadSnapshot(snapshotFile, key))
+		{
+			scan();
 
-			m_uioDevs.push_back(UioDev<T>(name, basePath, uio));
+			if (useSnap)
+				saveSnapshot(snapshotFile, key);
 		}
 
+		buildAddrIndex();
+
 		m_initialized = !m_uioDevs.empty();
 
 		return m_initialized;
@@ -785,12 +878,13 @@ public:
 		return m_invalidUioDev;
 	}
 
+	// Binary search over the address ranges of all maps, as this is done for every access
 	const UioDev<T>& FindUioDevByAddr(const T& addr) const
 	{
-		auto it = std::find_if(m_uioDevs.begin(), m_uioDevs.end(), [&addr](const UioDev<T>& uioDev) { return uioDev.HasAddr(addr); });
+		auto it = std::upper_bound(m_addrIndex.begin(), m_addrIndex.end(), addr, [](const T& a, const AddrRange& range) { return a < range.addr; });
 
-		if (it != m_uioDevs.end())
-			return *it;
+		if (it != m_addrIndex.begin() && addr - std::prev(it)->addr < std::prev(it)->size)
+			return m_uioDevs[std::prev(it)->devIdx];
 
 		return m_invalidUioDev;
 	}
@@ -807,10 +901,259 @@ public:
 	}
 
 private:
+	void scan()
+	{
+		for (uint32_t uio = 0; uio < UIO_MAX_DEVICES; uio++)
+		{
+			std::string basePath = UIO_SYS_PATH_BASE + std::to_string(uio);
+
+			std::ifstream file(basePath + UIO_NAME_FILE);
+			if (!file.is_open()) break;
+
+			std::string name;
+
+			std::getline(file, name);
+			file.close();
+
+			m_uioDevs.push_back(UioDev<T>(name, basePath, uio));
+		}
+	}
+
+	static void fnv1a(uint64_t& hash, const std::string& data)
+	{
+		for (const char& c : data)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= FNV_PRIME;
+		}
+	}
+
+	static bool readFile(const std::string& fileName, std::string& content)
+	{
+		std::ifstream file(fileName, std::ios::binary);
+		if (!file.is_open()) return false;
+
+		content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		return true;
+	}
+
+	// Hash of the boot device tree, the applied overlays, the kernel, and the registered UIO devices.
+	// Without access to the flattened device tree (requires root) no snapshot is used.
+	static bool snapshotKey(uint64_t& key)
+	{
+		std::string content;
+		if (!readFile(FDT_PATH, content))
+		{
+			CLAP_LOG_VERBOSE << CLASS_TAG("UioManager") << "Unable to read " << FDT_PATH << ", not using the UIO snapshot" << std::endl;
+			return false;
+		}
+
+		key = FNV_OFFSET_BASIS;
+		fnv1a(key, content);
+
+		std::vector<std::string> entries;
+		std::error_code ec;
+
+		for (const fs::directory_entry& entry : fs::directory_iterator(DT_OVERLAYS_PATH, ec))
+		{
+			std::string dtbo;
+			readFile(entry.path().string() + "/dtbo", dtbo);
+			entries.push_back(entry.path().filename().string() + dtbo);
+		}
+
+		for (const fs::directory_entry& entry : fs::directory_iterator(UIO_SYS_CLASS_PATH, ec))
+			entries.push_back(entry.path().filename().string());
+
+		// Directory iteration order is unspecified
+		std::sort(entries.begin(), entries.end());
+
+		for (const std::string& entry : entries)
+			fnv1a(key, entry);
+
+		struct utsname uts = {};
+		if (uname(&uts) == 0)
+		{
+			fnv1a(key, uts.release);
+			fnv1a(key, uts.version);
+		}
+
+		return true;
+	}
+
+	static void writeU64(std::ostream& os, const uint64_t& value)
+	{
+		os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+
+	static void writeStr(std::ostream& os, const std::string& str)
+	{
+		writeU64(os, str.size());
+		os.write(str.data(), static_cast<std::streamsize>(str.size()));
+	}
+
+	static uint64_t readU64(std::istream& is)
+	{
+		uint64_t value = 0;
+		is.read(reinterpret_cast<char*>(&value), sizeof(value));
+		return value;
+	}
+
+	static std::string readStr(std::istream& is)
+	{
+		const uint64_t size = readU64(is);
+
+		// Properties are small, larger sizes indicate a corrupted snapshot
+		if (!is || size > (1ULL << 24))
+		{
+			is.setstate(std::ios::failbit);
+			return "";
+		}
+
+		std::string str(size, '\0');
+		is.read(str.data(), static_cast<std::streamsize>(size));
+		return str;
+	}
+
+	void saveSnapshot(const std::string& fileName, const uint64_t& key) const
+	{
+		// Written to a temporary file and renamed, so concurrently starting processes never read a partial snapshot
+		const std::string tmpName = fileName + ".tmp" + std::to_string(getpid());
+		std::ofstream os(tmpName, std::ios::binary | std::ios::trunc);
+
+		os.write(SNAPSHOT_MAGIC.data(), static_cast<std::streamsize>(SNAPSHOT_MAGIC.size()));
+		writeU64(os, key);
+		writeU64(os, m_uioDevs.size());
+
+		for (const UioDev<T>& dev : m_uioDevs)
+		{
+			writeStr(os, dev.GetName());
+			writeStr(os, dev.GetPath());
+			writeU64(os, dev.GetId());
+			writeU64(os, dev.GetMaps().size());
+
+			for (const auto& map : dev.GetMaps())
+			{
+				writeU64(os, map.GetId());
+				writeU64(os, map.GetAddr());
+				writeU64(os, map.GetSize());
+				writeU64(os, map.GetOffset());
+				writeStr(os, map.GetName());
+				writeStr(os, map.GetPath());
+			}
+
+			const typename UioDev<T>::PropertyMap& props = dev.properties();
+			writeU64(os, props.size());
+
+			for (const auto& [name, value] : props)
+			{
+				writeStr(os, name);
+				writeStr(os, std::string(value.begin(), value.end()));
+			}
+		}
+
+		os.close();
+
+		if (!os || std::rename(tmpName.c_str(), fileName.c_str()) != 0)
+		{
+			CLAP_LOG_WARNING << CLASS_TAG("UioManager") << "Unable to write the UIO snapshot " << fileName << std::endl;
+			std::remove(tmpName.c_str());
+		}
+	}
+
+	bool loadSnapshot(const std::string& fileName, const uint64_t& key)
+	{
+		std::ifstream is(fileName, std::ios::binary);
+		if (!is.is_open()) return false;
+
+		std::string magic(SNAPSHOT_MAGIC.size(), '\0');
+		is.read(magic.data(), static_cast<std::streamsize>(magic.size()));
+
+		if (!is || magic != SNAPSHOT_MAGIC || readU64(is) != key)
+		{
+			CLAP_LOG_VERBOSE << CLASS_TAG("UioManager") << "UIO snapshot " << fileName << " is outdated, rescanning the UIO devices" << std::endl;
+			return false;
+		}
+
+		const uint64_t devCnt = readU64(is);
+
+		for (uint64_t i = 0; i < devCnt && is; i++)
+		{
+			const std::string name = readStr(is);
+			const std::string path = readStr(is);
+			const uint32_t id      = static_cast<uint32_t>(readU64(is));
+			const uint64_t mapCnt  = readU64(is);
+
+			if (!is || mapCnt > UIO_MAX_MAPS)
+			{
+				is.setstate(std::ios::failbit);
+				break;
+			}
+
+			typename UioDev<T>::UioMaps maps;
+			for (uint64_t m = 0; m < mapCnt; m++)
+			{
+				const uint32_t mapId      = static_cast<uint32_t>(readU64(is));
+				const T addr              = static_cast<T>(readU64(is));
+				const T size              = static_cast<T>(readU64(is));
+				const T offset            = static_cast<T>(readU64(is));
+				const std::string mapName = readStr(is);
+				const std::string mapPath = readStr(is);
+				maps.push_back({ mapId, addr, size, offset, mapName, mapPath });
+			}
+
+			typename UioDev<T>::PropertyMap props;
+			const uint64_t propCnt = readU64(is);
+			for (uint64_t p = 0; p < propCnt && is; p++)
+			{
+				const std::string propName  = readStr(is);
+				const std::string propValue = readStr(is);
+				props[propName]             = std::vector<uint8_t>(propValue.begin(), propValue.end());
+			}
+
+			if (!is) break;
+
+			m_uioDevs.push_back(UioDev<T>(name, path, id, std::move(maps), std::move(props)));
+		}
+
+		if (!is)
+		{
+			CLAP_LOG_WARNING << CLASS_TAG("UioManager") << "UIO snapshot " << fileName << " is corrupted, rescanning the UIO devices" << std::endl;
+			m_uioDevs.clear();
+			return false;
+		}
+
+		CLAP_LOG_VERBOSE << CLASS_TAG("UioManager") << "Restored " << m_uioDevs.size() << " UIO devices from " << fileName << std::endl;
+		return true;
+	}
+
+	struct AddrRange
+	{
+		T addr             = 0;
+		T size             = 0;
+		std::size_t devIdx = 0;
+	};
+
+	// The maps of the devices are sorted by their start address, ranges of different devices are not expected to overlap
+	void buildAddrIndex()
+	{
+		m_addrIndex.clear();
+
+		for (std::size_t i = 0; i < m_uioDevs.size(); i++)
+		{
+			if (!m_uioDevs[i]) continue;
+
+			for (const auto& map : m_uioDevs[i].GetMaps())
+				m_addrIndex.push_back({ map.GetAddr(), map.GetSize(), i });
+		}
+
+		std::sort(m_addrIndex.begin(), m_addrIndex.end(), [](const AddrRange& a, const AddrRange& b) { return a.addr < b.addr; });
+	}
+
 private:
-	bool m_initialized        = false;
-	UioDevs<T> m_uioDevs      = {};
-	UioDev<T> m_invalidUioDev = UioDev<T>("", "", -1);
+	bool m_initialized                 = false;
+	UioDevs<T> m_uioDevs               = {};
+	std::vector<AddrRange> m_addrIndex = {};
+	UioDev<T> m_invalidUioDev          = UioDev<T>("", "", -1);
 };
 
 } // namespace internal
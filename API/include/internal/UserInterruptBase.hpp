@@ -47,7 +47,9 @@
 #endif
 
 #include <cstdint>
+#include <functional>
 #include <iostream>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -81,6 +83,23 @@ public:
 
 	virtual bool WaitForInterrupt([[maybe_unused]] const int32_t& timeout = WAIT_INFINITE, [[maybe_unused]] const bool& runCallbacks = true) = 0;
 
+	// Handle that signals pending interrupts when polled (poll/epoll), INVALID_HANDLE if not available
+	virtual DeviceHandle GetPollHandle() const
+	{
+		return INVALID_HANDLE;
+	}
+
+	// Re-enables the interrupt after it has been handled, for interrupts that are masked by the driver when triggered
+	virtual void Arm() {}
+
+	// Sets a function that is called whenever a non-pollable interrupt is triggered,
+	// once this returns the previous notifier is neither running nor called anymore
+	void SetTriggerNotifier(const std::function<void()>& notifier)
+	{
+		std::lock_guard<std::mutex> lock(m_notifierMtx);
+		m_triggerNotifier = notifier;
+	}
+
 	void RegisterCallback([[maybe_unused]] const IntrCallback& callback)
 	{
 		m_callbacks.push_back(callback);
@@ -104,12 +123,24 @@ public:
 		return m_instantForward;
 	}
 
+protected:
+	// Called by the interrupt threads, the lock is held during the call, hence, the notifier must not change itself
+	void notifyTrigger() const
+	{
+		std::lock_guard<std::mutex> lock(m_notifierMtx);
+		if (m_triggerNotifier)
+			m_triggerNotifier();
+	}
+
 protected:
 	std::string m_devName                 = "";
 	HasInterrupt* m_pReg                  = nullptr;
 	std::vector<IntrCallback> m_callbacks = {};
 	uint32_t m_interruptNum               = 0;
 	bool m_instantForward                 = false;
+
+	std::function<void()> m_triggerNotifier = nullptr;
+	mutable std::mutex m_notifierMtx        = {};
 };
 } // namespace internal
 } // namespace clap
\ No newline at end of file
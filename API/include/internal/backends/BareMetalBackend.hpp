@@ -205,6 +205,9 @@ private:
 
 class BareMetalBackend : virtual public CLAPBackend
 {
+	// Roughly the size of the last level cache, above it a flush by set/way outperforms a flush by address
+	static constexpr uint64_t FULL_FLUSH_THRESHOLD = 1024 * 1024;
+
 public:
 	explicit BareMetalBackend([[maybe_unused]] const uint32_t& deviceNum = 0, [[maybe_unused]] const uint32_t& channelNum = 0)
 	{
@@ -225,6 +228,13 @@ public:
 			throw CLAPException(ss.str());
 		}
 
+		Timer timer;
+		timer.Start();
+
+		// Discard stale lines before the data written by the device is read, addresses outside of the memory regions are not maintained
+		if (maintainOnTransfer(addr, false))
+			Xil_DCacheInvalidateRange(static_cast<UINTPTR>(addr), sizeInByte);
+
 		uint64_t count      = 0;
 		uint64_t offset     = addr;
 		uint64_t bytes2Read = sizeInByte;
@@ -256,7 +266,7 @@ public:
 			if (bytes > RW_MAX_SIZE)
 				bytes = RW_MAX_SIZE;
 
-			std::memcpy(pByteData + count, reinterpret_cast<const void*>(pMem + count), bytes);
+			CopyFromDevice(pByteData + count, pMem + count, bytes, m_readKernel);
 
 			count += bytes;
 		}
@@ -267,12 +277,16 @@ public:
 			count += unalignedBytes;
 		}
 
+		timer.Stop();
+
 		if (count != sizeInByte)
 		{
 			std::stringstream ss;
 			ss << CLASS_TAG_AUTO << ", failed to read 0x" << std::hex << sizeInByte << " byte from offset 0x" << offset << " (read: 0x" << count << " byte)" << std::dec;
 			throw CLAPException(ss.str());
 		}
+
+		recordTransfer(TYPE::READ, sizeInByte, timer);
 	}
 
 	void Write(const uint64_t& addr, const void* pData, const uint64_t& sizeInByte) override
@@ -286,6 +300,9 @@ public:
 			throw CLAPException(ss.str());
 		}
 
+		Timer timer;
+		timer.Start();
+
 		uint64_t count           = 0;
 		const uint8_t* pByteData = reinterpret_cast<const uint8_t*>(pData);
 		uint64_t offset          = addr;
@@ -317,7 +334,7 @@ public:
 			if (bytes > RW_MAX_SIZE)
 				bytes = RW_MAX_SIZE;
 
-			std::memcpy(reinterpret_cast<void*>(pMem + count), pByteData + count, bytes);
+			CopyToDevice(pMem + count, pByteData + count, bytes, m_writeKernel);
 
 			count += bytes;
 		}
@@ -336,7 +353,106 @@ public:
 			throw CLAPException(ss.str());
 		}
 
-		Xil_DCacheFlushRange(static_cast<UINTPTR>(addr), sizeInByte);
+		// Addresses outside of the memory regions are flushed as well, as they might be cached memory not managed by CLAP
+		if (maintainOnTransfer(addr, true))
+			Xil_DCacheFlushRange(static_cast<UINTPTR>(addr), sizeInByte);
+
+		timer.Stop();
+		recordTransfer(TYPE::WRITE, sizeInByte, timer);
+	}
+
+	void ReadScalar(const uint64_t& addr, void* pData, const std::size_t& byteCnt) override
+	{
+		checkScalarSize(byteCnt);
+
+		Timer timer;
+		timer.Start();
+
+		// Scalar accesses are mostly register accesses, only memory of non-coherent regions is maintained
+		if (maintainOnTransfer(addr, false))
+			Xil_DCacheInvalidateRange(static_cast<UINTPTR>(addr), byteCnt);
+
+		if (byteCnt == sizeof(uint64_t))
+			readSingle<uint64_t>(addr, reinterpret_cast<uint64_t*>(pData));
+		else
+			readSingle(addr, pData, byteCnt);
+
+		timer.Stop();
+		recordTransfer(TYPE::READ, byteCnt, timer);
+	}
+
+	void WriteScalar(const uint64_t& addr, const void* pData, const std::size_t& byteCnt) override
+	{
+		checkScalarSize(byteCnt);
+
+		Timer timer;
+		timer.Start();
+
+		if (byteCnt == sizeof(uint64_t))
+			writeSingle<uint64_t>(addr, *reinterpret_cast<const uint64_t*>(pData));
+		else
+			writeSingle(addr, pData, byteCnt);
+
+		if (maintainOnTransfer(addr, false))
+			Xil_DCacheFlushRange(static_cast<UINTPTR>(addr), byteCnt);
+
+		timer.Stop();
+		recordTransfer(TYPE::WRITE, byteCnt, timer);
+	}
+
+	// Registers are directly addressable, allowing IP cores to bypass the backend
+	void* GetRegisterWindow(const uint64_t& addr, uint64_t& sizeInByte) override
+	{
+		sizeInByte = UINT64_MAX - addr;
+		return reinterpret_cast<void*>(static_cast<UINTPTR>(addr));
+	}
+
+	// The memory is directly addressable, no mapping is required
+	void* MapMemory(const uint64_t& addr, [[maybe_unused]] const uint64_t& sizeInByte) override
+	{
+		return reinterpret_cast<void*>(static_cast<UINTPTR>(addr));
+	}
+
+	void FlushMapped(void* pMem, const uint64_t& sizeInByte) override
+	{
+		if (GetCoherency(reinterpret_cast<UINTPTR>(pMem)) == Coherency::Coherent)
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+		else
+			Xil_DCacheFlushRange(reinterpret_cast<UINTPTR>(pMem), sizeInByte);
+	}
+
+	void InvalidateMapped(void* pMem, const uint64_t& sizeInByte) override
+	{
+		if (GetCoherency(reinterpret_cast<UINTPTR>(pMem)) == Coherency::Coherent)
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+		else
+			Xil_DCacheInvalidateRange(reinterpret_cast<UINTPTR>(pMem), sizeInByte);
+	}
+
+	// Above the threshold flushing the whole data cache is cheaper than flushing the ranges line by line. Invalidation is
+	// always performed per range, as invalidating the whole cache would discard dirty lines of unrelated data.
+	void SyncRanges(const std::vector<DeviceRange>& ranges, const SyncDirection& dir) override
+	{
+		if (dir == SyncDirection::ToDevice)
+		{
+			uint64_t totalSize = 0;
+			for (const DeviceRange& range : ranges)
+				totalSize += range.size;
+
+			if (totalSize >= FULL_FLUSH_THRESHOLD)
+			{
+				Xil_DCacheFlush();
+				return;
+			}
+
+			for (const DeviceRange& range : ranges)
+				Xil_DCacheFlushRange(static_cast<UINTPTR>(range.addr), range.size);
+		}
+		else
+		{
+			for (const DeviceRange& range : ranges)
+				Xil_DCacheInvalidateRange(static_cast<UINTPTR>(range.addr), range.size);
+		}
 	}
 
 	UserInterruptPtr MakeUserInterrupt() const override
@@ -344,6 +460,15 @@ public:
 		return std::make_unique<BareMetalUserInterrupt>();
 	}
 
+	void ConfigureCopyKernels(const CopyKernel& readKernel, const CopyKernel& writeKernel) override
+	{
+		checkCopyKernel(readKernel);
+		checkCopyKernel(writeKernel);
+
+		m_readKernel  = readKernel;
+		m_writeKernel = writeKernel;
+	}
+
 private:
 	void readSingle(const uint64_t& addr, void* pData, const uint64_t& bytes) const
 	{
@@ -396,8 +521,8 @@ private:
 	template<typename T>
 	void readSingle(const uint64_t& addr, T* pData) const
 	{
-		const T* pMem = reinterpret_cast<const T*>(reinterpret_cast<uint8_t*>(addr));
-		*pData        = *pMem;
+		const volatile T* pMem = reinterpret_cast<const volatile T*>(reinterpret_cast<uint8_t*>(addr));
+		*pData                 = *pMem;
 	}
 
 	void writeSingle(const uint64_t& addr, const void* pData, const uint64_t& bytes) const
@@ -451,9 +576,13 @@ private:
 	template<typename T>
 	void writeSingle(const uint64_t& addr, const T data) const
 	{
-		T* pMem = reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(addr));
-		*pMem   = data;
+		volatile T* pMem = reinterpret_cast<volatile T*>(reinterpret_cast<uint8_t*>(addr));
+		*pMem            = data;
 	}
+
+private:
+	CopyKernel m_readKernel  = CopyKernel::MemCpy;
+	CopyKernel m_writeKernel = CopyKernel::MemCpy;
 };
 
 inline void interruptHandler(void* p)
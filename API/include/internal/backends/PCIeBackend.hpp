@@ -25,17 +25,34 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <cstring>
+#include <exception>
 #include <fcntl.h>
+#include <functional>
+#include <future>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
+#include <vector>
+
+#ifndef _WIN32
+// Include for mmap(), munmap()
+#include <sys/mman.h>
+#endif
 
 #include "../CLAPBackend.hpp"
 #include "../Constants.hpp"
 #include "../Defines.hpp"
 #include "../FileOps.hpp"
+#include "../IoCompletionPort.hpp"
 #include "../Logger.hpp"
+#include "../Numa.hpp"
 #include "../Timer.hpp"
 #include "../UserInterruptBase.hpp"
 #include "../Utils.hpp"
@@ -55,6 +72,11 @@ public:
 #ifndef _WIN32
 		:
 		m_pollFd()
+#else
+		:
+		m_op(),
+		m_mtx(),
+		m_cv()
 #endif
 	{}
 
@@ -71,8 +93,14 @@ public:
 		m_devName = "/dev/xdma" + std::to_string(devNum) + "_events_" + std::to_string(interruptNum);
 		m_pReg    = pReg;
 
+#ifdef _WIN32
+		// Reading the event device completes once the interrupt occurred, the read is kept pending on the shared completion port
+		m_fd                = IoCompletionPort::Get().Open(m_devName, READ_ONLY_FLAG);
+		const int32_t errsv = static_cast<int32_t>(GetLastError());
+#else
 		m_fd          = OPEN_DEVICE(m_devName.c_str(), READ_ONLY_FLAG);
 		int32_t errsv = errno;
+#endif
 
 		if (!DEVICE_HANDLE_VALID(m_fd))
 		{
@@ -84,6 +112,13 @@ public:
 #ifndef _WIN32
 		m_pollFd.fd     = m_fd;
 		m_pollFd.events = POLLIN;
+#else
+		m_op.onComplete = [this](const DWORD& bytes, const DWORD& error) { onEvent(bytes, error); };
+
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_closing  = false;
+		m_pending  = false;
+		m_inFlight = startEventRead();
 #endif
 		m_interruptNum = interruptNum;
 	}
@@ -98,12 +133,15 @@ public:
 		return (DEVICE_HANDLE_VALID(m_fd));
 	}
 
+#ifndef _WIN32
+	DeviceHandle GetPollHandle() const override
+	{
+		return m_fd;
+	}
+#endif
+
 	bool WaitForInterrupt([[maybe_unused]] const int32_t& timeout = WAIT_INFINITE, [[maybe_unused]] const bool& runCallbacks = true) override
 	{
-#ifdef _WIN32
-		CLAP_CLASS_LOG_ERROR << " Currently not implemented for Windows" << std::endl;
-		return false;
-#else
 		if (!IsSet())
 		{
 			std::stringstream ss("");
@@ -111,6 +149,37 @@ public:
 			throw UserInterruptException(ss.str());
 		}
 
+#ifdef _WIN32
+		{
+			std::unique_lock<std::mutex> lock(m_mtx);
+			const auto ready = [this] { return m_pending || m_closing; };
+
+			if (timeout < 0)
+				m_cv.wait(lock, ready);
+			else
+				m_cv.wait_for(lock, std::chrono::milliseconds(timeout), ready);
+
+			if (!m_pending) return false;
+			m_pending = false;
+		}
+
+		if (m_pReg)
+			m_pReg->ClearInterrupts();
+
+		uint32_t lastIntr = UNSET_INTR_MASK;
+		if (m_pReg)
+			lastIntr = m_pReg->GetLastInterrupt();
+
+		if (runCallbacks)
+		{
+			for (const auto& callback : m_callbacks)
+				callback(lastIntr);
+		}
+
+		CLAP_CLASS_LOG_DEBUG << "Interrupt present on " << m_devName << ", Interrupt Mask: " << (m_pReg ? std::to_string(lastIntr) : "No Status Register Specified") << std::endl;
+		return true;
+#else
+
 		// Poll checks whether an interrupt was generated.
 		uint32_t rd = poll(&m_pollFd, 1, timeout);
 		if ((rd > 0) && (m_pollFd.revents & POLLIN))
@@ -152,10 +221,61 @@ public:
 	}
 
 private:
+#ifdef _WIN32
+	// Has to be called with the mutex held, returns whether the read is in flight
+	bool startEventRead()
+	{
+		if (m_closing) return false;
+
+		DWORD error;
+		if (IoCompletionPort::Start(m_fd, m_op, true, &m_events, sizeof(m_events), 0, error))
+			return true;
+
+		CLAP_CLASS_LOG_ERROR << m_devName << ", failed to wait for the interrupt, Error: " << error << std::endl;
+		return false;
+	}
+
+	// Called by the service thread of the completion port, the read is re-issued to detect the next interrupt
+	void onEvent([[maybe_unused]] const DWORD& bytes, const DWORD& error)
+	{
+		if (error == ERROR_SUCCESS)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mtx);
+				m_pending = true;
+			}
+
+			m_cv.notify_all();
+			notifyTrigger();
+		}
+		else if (error != ERROR_OPERATION_ABORTED)
+		{
+			CLAP_CLASS_LOG_ERROR << m_devName << ", waiting for the interrupt failed, Error: " << error << std::endl;
+		}
+
+		// The object must not be accessed after m_inFlight is cleared, as unset might destroy it right away
+		std::lock_guard<std::mutex> lock(m_mtx);
+		m_inFlight = (error == ERROR_SUCCESS && startEventRead());
+		m_cv.notify_all();
+	}
+#endif
+
 	void unset()
 	{
 		if (!DEVICE_HANDLE_VALID(m_fd)) return;
 
+#ifdef _WIN32
+		{
+			std::unique_lock<std::mutex> lock(m_mtx);
+			m_closing = true;
+
+			if (m_inFlight)
+				CancelIoEx(m_fd, &m_op);
+
+			m_cv.wait(lock, [this] { return !m_inFlight; });
+		}
+#endif
+
 		CLOSE_DEVICE(m_fd);
 		m_fd = INVALID_HANDLE;
 
@@ -169,6 +289,14 @@ private:
 	DeviceHandle m_fd = INVALID_HANDLE;
 #ifndef _WIN32
 	struct pollfd m_pollFd;
+#else
+	IoCompletionPort::Operation m_op;
+	std::mutex m_mtx;
+	std::condition_variable m_cv;
+	uint32_t m_events = 0;
+	bool m_inFlight   = false;
+	bool m_pending    = false;
+	bool m_closing    = false;
 #endif
 };
 
@@ -176,39 +304,84 @@ class PCIeBackend : virtual public CLAPBackend
 {
 	DISABLE_COPY_ASSIGN_MOVE(PCIeBackend)
 
+	// A single H2C or C2H DMA channel, each channel is a separate DMA engine, therefore,
+	// transfers on different channels run in parallel while each channel is used exclusively
+	struct Channel
+	{
+		explicit Channel(const std::string& devName) :
+			name(devName),
+			fd(INVALID_HANDLE),
+			mtx(),
+			posFds(),
+			nextFd(0)
+		{}
+
+		std::string name;
+		DeviceHandle fd;
+		std::mutex mtx;
+		// Handles used by the positional I/O mode, the first one is fd
+		std::vector<DeviceHandle> posFds;
+		std::atomic<std::size_t> nextFd;
+	};
+
+	using ChannelPtr = std::unique_ptr<Channel>;
+	using Channels   = std::vector<ChannelPtr>;
+
 public:
 	explicit PCIeBackend(const uint32_t& deviceNum = 0, const uint32_t& channelNum = 0) :
-		m_h2cDeviceName("/dev/xdma" + std::to_string(deviceNum) + "_h2c_" + std::to_string(channelNum)),
-		m_c2hDeviceName("/dev/xdma" + std::to_string(deviceNum) + "_c2h_" + std::to_string(channelNum)),
 		m_ctrlDeviceName("/dev/xdma" + std::to_string(deviceNum) + "_control"),
 		m_devNum(deviceNum),
-		m_readMutex(),
-		m_writeMutex(),
+		m_h2cChannels(),
+		m_c2hChannels(),
 		m_ctrlMutex()
 	{
-		m_nameRead    = m_c2hDeviceName;
-		m_nameWrite   = m_h2cDeviceName;
-		m_nameCtrl    = m_ctrlDeviceName;
 		m_backendName = "XDMA PCIe";
 
-		m_h2cFd  = OpenDevice(m_h2cDeviceName);
-		m_c2hFd  = OpenDevice(m_c2hDeviceName);
+		if (channelNum == XDMA_ALL_CHANNELS)
+		{
+			// Channel 0 is always present, the remaining channels depend on the XDMA configuration
+			openChannel(m_h2cChannels, "h2c", 0, true);
+			openChannel(m_c2hChannels, "c2h", 0, true);
+
+			for (uint32_t i = 1; i < XDMA_MAX_CHANNELS && openChannel(m_h2cChannels, "h2c", i, false); i++) {}
+			for (uint32_t i = 1; i < XDMA_MAX_CHANNELS && openChannel(m_c2hChannels, "c2h", i, false); i++) {}
+
+			CLAP_CLASS_LOG_VERBOSE << "Opened " << m_h2cChannels.size() << " H2C and " << m_c2hChannels.size() << " C2H channels" << std::endl;
+		}
+		else
+		{
+			openChannel(m_h2cChannels, "h2c", channelNum, true);
+			openChannel(m_c2hChannels, "c2h", channelNum, true);
+		}
+
+		m_nameRead  = m_c2hChannels.front()->name;
+		m_nameWrite = m_h2cChannels.front()->name;
+		m_nameCtrl  = m_ctrlDeviceName;
+
+#ifdef _WIN32
+		m_ctrlFd = openOverlapped(m_ctrlDeviceName, true);
+#else
 		m_ctrlFd = OpenDevice(m_ctrlDeviceName, CTRL_OPEN_FLAGS);
-		m_valid  = (DEVICE_HANDLE_VALID(m_h2cFd) && DEVICE_HANDLE_VALID(m_c2hFd) && DEVICE_HANDLE_VALID(m_ctrlFd));
+#endif
+		m_valid  = (DEVICE_HANDLE_VALID(m_h2cChannels.front()->fd) && DEVICE_HANDLE_VALID(m_c2hChannels.front()->fd) && DEVICE_HANDLE_VALID(m_ctrlFd));
+
+		// The XDMA class devices link to the PCIe function, which reports the node of its root complex
+		m_numaNode = numa::ReadNumaNode("/sys/class/xdma/xdma" + std::to_string(deviceNum) + "_control/device/numa_node");
+		CLAP_CLASS_LOG_VERBOSE << "NUMA node: " << (m_numaNode == NUMA_NODE_UNKNOWN ? "unknown" : std::to_string(m_numaNode)) << std::endl;
 	}
 
 	~PCIeBackend() override
 	{
-		// Try to lock the read, write and ctrl mutex in order to prevent read, write or ctrl access
+		// Try to lock all channel and the ctrl mutex in order to prevent read, write or ctrl access
 		// while the XDMA object is being destroyed and also to prevent the destruction
 		// of the object while a read, write or ctrl access is still in progress
-		std::lock_guard<std::mutex> lockRd(m_readMutex);
-		std::lock_guard<std::mutex> lockWd(m_writeMutex);
 		std::lock_guard<std::mutex> lockCtrl(m_ctrlMutex);
 
-		CLOSE_DEVICE(m_h2cFd);
-		CLOSE_DEVICE(m_c2hFd);
+		closeChannels(m_c2hChannels);
+		closeChannels(m_h2cChannels);
+
 		CLOSE_DEVICE(m_ctrlFd);
+		unmapRegisterBAR();
 	}
 
 	uint32_t GetDevNum() const override
@@ -216,157 +389,381 @@ public:
 		return m_devNum;
 	}
 
-	void Read(const uint64_t& addr, void* pData, const uint64_t& sizeInByte) override
+	bool SupportsRegisterBursts() const override
 	{
-		// CLAP_CLASS_LOG_DEBUG << "addr=0x" << std::hex << addr << " pData=0x" << pData << " sizeInByte=0x" << sizeInByte << std::dec << std::endl;
-
-		std::lock_guard<std::mutex> lock(m_readMutex);
+		return true;
+	}
 
-		if (!m_valid)
+	// Within the register BAR the registers are written one by one, otherwise they
+	// are staged in an aligned buffer and written with a single transfer
+	void WriteRegisters(const uint64_t& addr, const uint32_t* pData, const std::size_t& count) override
+	{
+		if (inRegisterBAR(addr, count * sizeof(uint32_t), sizeof(uint32_t)))
 		{
-			std::stringstream ss;
-			ss << CLASS_TAG_AUTO << "CLAP Instance is not valid, an error probably occurred during device initialization.";
-			throw CLAPException(ss.str());
+			CLAP_TRACE_SCOPE(trace::EventType::Write, addr, count * sizeof(uint32_t));
+
+			Timer timer;
+			timer.Start();
+
+			volatile uint32_t* pMem = reinterpret_cast<volatile uint32_t*>(m_pRegBAR + (addr - m_regBARBase));
+			for (std::size_t i = 0; i < count; i++)
+				pMem[i] = pData[i];
+
+			timer.Stop();
+			recordTransfer(TYPE::WRITE, count * sizeof(uint32_t), timer);
+			return;
 		}
 
-		if (!IS_ALIGNED(pData, ALIGNMENT))
+		const CLAPBuffer<uint32_t> buffer(pData, pData + count);
+		Write(addr, buffer.data(), count * sizeof(uint32_t));
+	}
+
+	// Register sized accesses within the register BAR are direct MMIO loads, all others use the DMA channels
+	void ReadScalar(const uint64_t& addr, void* pData, const std::size_t& byteCnt) override
+	{
+		checkScalarSize(byteCnt);
+
+		if (!inRegisterBAR(addr, byteCnt, byteCnt))
 		{
-			std::stringstream ss;
-			ss << CLASS_TAG_AUTO << "pData is not aligned to " << ALIGNMENT << " bytes.";
-			throw CLAPException(ss.str());
+			CLAPBackend::ReadScalar(addr, pData, byteCnt);
+			return;
 		}
 
-		uint64_t count     = 0;
-		OffsetType offset  = static_cast<OffsetType>(addr);
-		uint8_t* pByteData = reinterpret_cast<uint8_t*>(pData);
+		CLAP_TRACE_SCOPE(trace::EventType::Read, addr, byteCnt);
 
-		FileOpType rc;
 		Timer timer;
-
 		timer.Start();
 
-		while (count < sizeInByte)
+		const volatile uint8_t* pMem = m_pRegBAR + (addr - m_regBARBase);
+
+		switch (byteCnt)
 		{
-			ByteCntType bytes = (sizeInByte - count) > RW_MAX_SIZE ? RW_MAX_SIZE : static_cast<ByteCntType>(sizeInByte - count);
+			case 1:
+				readMMIO<uint8_t>(pMem, pData, 0);
+				break;
+			case 2:
+				readMMIO<uint16_t>(pMem, pData, 0);
+				break;
+			default:
+				// The AXI-Lite master of the XDMA is 32-bit wide, 64-bit registers are read as two words, lower word first
+				for (std::size_t i = 0; i < byteCnt; i += sizeof(uint32_t))
+					readMMIO<uint32_t>(pMem, pData, i);
+		}
 
-			rc = SEEK(m_c2hFd, offset);
-			if (SEEK_INVALID(rc, offset))
-			{
-				std::stringstream ss;
-				ss << CLASS_TAG_AUTO << m_c2hDeviceName << ", failed to seek to offset 0x" << std::hex << offset << " (rc: 0x" << rc << ")" << std::dec;
-				throw CLAPException(ss.str());
-			}
+		timer.Stop();
+		recordTransfer(TYPE::READ, byteCnt, timer);
+	}
 
-#if _WIN32
-			if (!ReadFile(m_c2hFd, pByteData + count, bytes, &rc, NULL))
-			{
-				std::stringstream ss;
-				ss << CLASS_TAG_AUTO << m_c2hDeviceName << ", failed to read 0x" << std::hex << bytes << " byte from offset 0x" << offset << " Error: " << GetLastError() << std::dec;
-				throw CLAPException(ss.str());
-			}
-#else
-			rc = ::read(m_c2hFd, pByteData + count, bytes);
-#endif
+	void WriteScalar(const uint64_t& addr, const void* pData, const std::size_t& byteCnt) override
+	{
+		checkScalarSize(byteCnt);
 
-			int32_t errsv = errno;
+		if (!inRegisterBAR(addr, byteCnt, byteCnt))
+		{
+			CLAPBackend::WriteScalar(addr, pData, byteCnt);
+			return;
+		}
 
-			if (static_cast<ByteCntType>(rc) != bytes)
-			{
-				std::stringstream ss;
-				ss << CLASS_TAG_AUTO << m_c2hDeviceName << ", failed to read 0x" << std::hex << bytes << " byte from offset 0x" << offset << " (rc: 0x" << rc << ") errno: " << std::dec << errsv << " (" << strerror(errsv) << ")";
-				throw CLAPException(ss.str());
-			}
+		CLAP_TRACE_SCOPE(trace::EventType::Write, addr, byteCnt);
 
-			count += bytes;
-			offset += bytes; // TODO: this might cause problems in streaming mode
+		Timer timer;
+		timer.Start();
+
+		volatile uint8_t* pMem = m_pRegBAR + (addr - m_regBARBase);
+
+		switch (byteCnt)
+		{
+			case 1:
+				writeMMIO<uint8_t>(pMem, pData, 0);
+				break;
+			case 2:
+				writeMMIO<uint16_t>(pMem, pData, 0);
+				break;
+			default:
+				for (std::size_t i = 0; i < byteCnt; i += sizeof(uint32_t))
+					writeMMIO<uint32_t>(pMem, pData, i);
 		}
 
 		timer.Stop();
+		recordTransfer(TYPE::WRITE, byteCnt, timer);
+	}
 
-		if (count != sizeInByte)
+	void* GetRegisterWindow(const uint64_t& addr, uint64_t& sizeInByte) override
+	{
+		if (!inRegisterBAR(addr, 1, 1)) return nullptr;
+
+		sizeInByte = m_regBARSize - (addr - m_regBARBase);
+		return const_cast<uint8_t*>(m_pRegBAR + (addr - m_regBARBase));
+	}
+
+	// Maps the AXI-Lite master (or DMA bypass) BAR, offset 0 of the BAR corresponds to axiBaseAddr.
+	// Has to be configured before any register is accessed, as the accesses do not synchronize with the configuration.
+	// Can only be configured once, as IP cores keep pointers into the mapped window.
+	void ConfigureRegisterBAR(const uint64_t& axiBaseAddr, const uint64_t& sizeInByte, const bool& bypass) override
+	{
+#ifdef _WIN32
+		CLAP_CLASS_LOG_WARNING << "Memory-mapping the register BAR is currently not supported on Windows, ignoring configuration" << std::endl;
+#else
+		if (sizeInByte == 0)
 		{
 			std::stringstream ss;
-			ss << CLASS_TAG_AUTO << m_c2hDeviceName << ", failed to read 0x" << std::hex << sizeInByte << " byte from offset 0x" << offset << " (read: 0x" << count << " byte)" << std::dec;
+			ss << CLASS_TAG_AUTO << "Size of the register BAR window has to be non-zero";
 			throw CLAPException(ss.str());
 		}
 
-		logTransferTime(addr, sizeInByte, timer, true);
+		if (m_pRegBAR != nullptr)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << m_regBARName << " is already mapped, remapping would invalidate the register windows of existing IP cores";
+			throw CLAPException(ss.str());
+		}
+
+		m_regBARName = "/dev/xdma" + std::to_string(m_devNum) + (bypass ? "_bypass" : "_user");
+		m_regBARFd   = OpenDevice(m_regBARName, O_RDWR | O_SYNC);
+
+		void* pMapBase = mmap(NULL, sizeInByte, PROT_READ | PROT_WRITE, MAP_SHARED, m_regBARFd, 0);
+		int32_t errsv  = errno;
+
+		if (pMapBase == MAP_FAILED)
+		{
+			CLOSE_DEVICE(m_regBARFd);
+			m_regBARFd = INVALID_HANDLE;
+
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << m_regBARName << ", failed to map 0x" << std::hex << sizeInByte << " byte into userspace" << std::dec << ", errno: " << errsv << " (" << strerror(errsv) << ")";
+			throw CLAPException(ss.str());
+		}
+
+		m_pRegBAR    = static_cast<uint8_t*>(pMapBase);
+		m_regBARBase = axiBaseAddr;
+		m_regBARSize = sizeInByte;
+
+		CLAP_CLASS_LOG_VERBOSE << "Mapped " << m_regBARName << " to AXI address range 0x" << std::hex << m_regBARBase << " - 0x" << m_regBARBase + m_regBARSize << std::dec << std::endl;
+#endif
 	}
 
-	void Write(const uint64_t& addr, const void* pData, const uint64_t& sizeInByte) override
+	std::size_t GetTransferConcurrency() const override
 	{
-		// CLAP_CLASS_LOG_DEBUG << "addr=0x" << std::hex << addr << " pData=0x" << pData << " sizeInByte=0x" << sizeInByte << std::dec << std::endl;
+		return m_h2cChannels.size() + m_c2hChannels.size();
+	}
 
-		std::lock_guard<std::mutex> lock(m_writeMutex);
+	int32_t GetNumaNode() const override
+	{
+		return m_numaNode;
+	}
 
-		if (!m_valid)
+	// Applies to the stripe threads of transfers started afterwards
+	void ConfigureThreadAffinity(const CpuSet& cpus) override
+	{
+		m_stripeAffinity = cpus;
+	}
+
+	void ConfigureStriping(const uint64_t& minStripeSize) override
+	{
+		if (minStripeSize == 0 || minStripeSize % ALIGNMENT != 0)
 		{
 			std::stringstream ss;
-			ss << CLASS_TAG_AUTO << "CLAP Instance is not valid, an error probably occurred during device initialization.";
+			ss << CLASS_TAG_AUTO << "Minimum stripe size (" << minStripeSize << ") has to be a non-zero multiple of " << ALIGNMENT << " bytes";
 			throw CLAPException(ss.str());
 		}
 
-		if (!IS_ALIGNED(pData, ALIGNMENT))
+		m_minStripeSize = minStripeSize;
+	}
+
+	// Switches the DMA channels to positional I/O (pread/pwrite), transfers no longer lock the channels and can be issued
+	// concurrently by multiple threads, each channel is opened fdsPerChannel times and the handles are used round-robin.
+	// Has to be configured once before any transfer is issued, streams are not affected and keep using the locked first channel.
+	void ConfigurePositionalIO(const uint32_t& fdsPerChannel) override
+	{
+		// All channels stay locked during the configuration, serializing it with concurrent calls and locked transfers
+		std::vector<std::unique_lock<std::mutex>> locks;
+		for (Channels* pChannels : { &m_c2hChannels, &m_h2cChannels })
+		{
+			for (ChannelPtr& pChannel : *pChannels)
+				locks.emplace_back(pChannel->mtx);
+		}
+
+		// Positional transfers use the handles without locking the channels, replacing them afterwards could close a handle in use
+		if (m_positionalIO || m_transferIssued)
 		{
 			std::stringstream ss;
-			ss << CLASS_TAG_AUTO << "pData is not aligned to " << ALIGNMENT << " bytes.";
+			ss << CLASS_TAG_AUTO << "Positional I/O has to be configured once before the first transfer is issued";
 			throw CLAPException(ss.str());
 		}
 
-		uint64_t count           = 0;
-		const uint8_t* pByteData = reinterpret_cast<const uint8_t*>(pData);
-		OffsetType offset        = static_cast<OffsetType>(addr);
+#ifdef _WIN32
+		// Overlapped transfers carry their offset, a single handle per channel already accepts concurrent transfers
+		m_positionalIO = true;
+		CLAP_CLASS_LOG_VERBOSE << "Using overlapped I/O without locking the channels, ignoring the number of handles per channel (" << fdsPerChannel << ")" << std::endl;
+#else
+		if (fdsPerChannel == 0)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Number of handles per channel has to be non-zero";
+			throw CLAPException(ss.str());
+		}
+
+		for (Channels* pChannels : { &m_c2hChannels, &m_h2cChannels })
+		{
+			for (ChannelPtr& pChannel : *pChannels)
+			{
+				try
+				{
+					pChannel->posFds.push_back(pChannel->fd);
+					for (uint32_t i = 1; i < fdsPerChannel; i++)
+						pChannel->posFds.push_back(OpenDevice(pChannel->name));
+				}
+				catch (...)
+				{
+					// Leaves the channels unconfigured, allowing the configuration to be retried
+					for (Channels* pCleanup : { &m_c2hChannels, &m_h2cChannels })
+					{
+						for (ChannelPtr& pOpened : *pCleanup)
+							closePositionalFds(*pOpened);
+					}
+
+					throw;
+				}
+			}
+		}
+
+		// Published after all handles are open, transfers only access the handles once they observe the flag
+		m_positionalIO = true;
+
+		CLAP_CLASS_LOG_VERBOSE << "Using positional I/O with " << fdsPerChannel << " handle(s) per channel" << std::endl;
+#endif
+	}
+
+	void Read(const uint64_t& addr, void* pData, const uint64_t& sizeInByte) override
+	{
+		// CLAP_CLASS_LOG_DEBUG << "addr=0x" << std::hex << addr << " pData=0x" << pData << " sizeInByte=0x" << sizeInByte << std::dec << std::endl;
+
+		checkTransfer(pData);
+		m_transferIssued = true;
+
+		CLAP_TRACE_SCOPE(trace::EventType::Read, addr, sizeInByte);
+
+		Timer timer;
+		timer.Start();
+
+		transfer(m_c2hChannels, m_nextC2H, addr, reinterpret_cast<uint8_t*>(pData), sizeInByte,
+				 [this](Channel& channel, const uint64_t& a, uint8_t* pD, const uint64_t& s) { readChannel(channel, a, pD, s); });
+
+		timer.Stop();
+
+		recordTransfer(TYPE::READ, sizeInByte, timer);
+		logTransferTime(addr, sizeInByte, timer, true);
+	}
+
+	void Write(const uint64_t& addr, const void* pData, const uint64_t& sizeInByte) override
+	{
+		// CLAP_CLASS_LOG_DEBUG << "addr=0x" << std::hex << addr << " pData=0x" << pData << " sizeInByte=0x" << sizeInByte << std::dec << std::endl;
+
+		checkTransfer(pData);
+		m_transferIssued = true;
+
+		CLAP_TRACE_SCOPE(trace::EventType::Write, addr, sizeInByte);
 
-		FileOpType rc;
 		Timer timer;
+		timer.Start();
 
+		// The data is never modified, the cast only allows sharing the striping code with Read
+		transfer(m_h2cChannels, m_nextH2C, addr, const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(pData)), sizeInByte,
+				 [this](Channel& channel, const uint64_t& a, uint8_t* pD, const uint64_t& s) { writeChannel(channel, a, pD, s); });
+
+		timer.Stop();
+
+		recordTransfer(TYPE::WRITE, sizeInByte, timer);
+		logTransferTime(addr, sizeInByte, timer, false);
+	}
+
+	// Stream transfers always target offset 0, therefore the seek is skipped by using pread/pwrite, furthermore,
+	// the transfer time is not logged as streams are transferred in many small chunks.
+	// Each channel is connected to a separate AXI stream, hence, streams always use the first channel.
+	void ReadStream(void* pData, const uint64_t& sizeInByte) override
+	{
+		Channel& channel = *m_c2hChannels.front();
+		std::lock_guard<std::mutex> lock(channel.mtx);
+
+		checkTransfer(pData);
+
+		CLAP_TRACE_SCOPE(trace::EventType::ReadStream, XDMA_STREAM_OFFSET, sizeInByte);
+
+		Timer timer;
 		timer.Start();
 
+		uint8_t* pByteData = reinterpret_cast<uint8_t*>(pData);
+		uint64_t count     = 0;
+		FileOpType rc;
+
 		while (count < sizeInByte)
 		{
 			ByteCntType bytes = (sizeInByte - count) > RW_MAX_SIZE ? RW_MAX_SIZE : static_cast<ByteCntType>(sizeInByte - count);
 
-			rc = SEEK(m_h2cFd, offset);
-			if (SEEK_INVALID(rc, offset))
+#ifdef _WIN32
+			IoCompletionPort::Get().Read(channel.fd, channel.name, pByteData + count, bytes, XDMA_STREAM_OFFSET);
+			rc = bytes;
+#else
+			rc = ::pread(channel.fd, pByteData + count, bytes, static_cast<OffsetType>(XDMA_STREAM_OFFSET));
+#endif
+
+			int32_t errsv = errno;
+
+			if (static_cast<ByteCntType>(rc) != bytes)
 			{
 				std::stringstream ss;
-				ss << CLASS_TAG_AUTO << m_h2cDeviceName << ", failed to seek to offset 0x" << std::hex << offset << " (rc: 0x" << rc << ")" << std::dec;
+				ss << CLASS_TAG_AUTO << channel.name << ", failed to read 0x" << std::hex << bytes << " byte from stream (rc: 0x" << rc << ") errno: " << std::dec << errsv << " (" << strerror(errsv) << ")";
 				throw CLAPException(ss.str());
 			}
 
+			count += bytes;
+		}
+
+		timer.Stop();
+		recordTransfer(TYPE::READ, sizeInByte, timer);
+	}
+
+	void WriteStream(const void* pData, const uint64_t& sizeInByte) override
+	{
+		Channel& channel = *m_h2cChannels.front();
+		std::lock_guard<std::mutex> lock(channel.mtx);
+
+		checkTransfer(pData);
+
+		CLAP_TRACE_SCOPE(trace::EventType::WriteStream, XDMA_STREAM_OFFSET, sizeInByte);
+
+		Timer timer;
+		timer.Start();
+
+		const uint8_t* pByteData = reinterpret_cast<const uint8_t*>(pData);
+		uint64_t count           = 0;
+		FileOpType rc;
+
+		while (count < sizeInByte)
+		{
+			ByteCntType bytes = (sizeInByte - count) > RW_MAX_SIZE ? RW_MAX_SIZE : static_cast<ByteCntType>(sizeInByte - count);
+
 #ifdef _WIN32
-			if (!WriteFile(m_h2cFd, pByteData + count, bytes, &rc, NULL))
-			{
-				std::stringstream ss;
-				ss << CLASS_TAG_AUTO << m_h2cDeviceName << ", failed to write 0x" << std::hex << bytes << " byte to offset 0x" << offset << " Error: " << GetLastError() << std::dec;
-				throw CLAPException(ss.str());
-			}
+			IoCompletionPort::Get().Write(channel.fd, channel.name, pByteData + count, bytes, XDMA_STREAM_OFFSET);
+			rc = bytes;
 #else
-			rc = ::write(m_h2cFd, pByteData + count, bytes);
+			rc = ::pwrite(channel.fd, pByteData + count, bytes, static_cast<OffsetType>(XDMA_STREAM_OFFSET));
 #endif
+
 			int32_t errsv = errno;
 
 			if (static_cast<ByteCntType>(rc) != bytes)
 			{
 				std::stringstream ss;
-				ss << CLASS_TAG_AUTO << m_h2cDeviceName << ", failed to write 0x" << std::hex << bytes << " byte to offset 0x" << offset << " (rc: 0x" << rc << ") errno: " << std::dec << errsv << " (" << strerror(errsv) << ")";
+				ss << CLASS_TAG_AUTO << channel.name << ", failed to write 0x" << std::hex << bytes << " byte to stream (rc: 0x" << rc << ") errno: " << std::dec << errsv << " (" << strerror(errsv) << ")";
 				throw CLAPException(ss.str());
 			}
 
 			count += bytes;
-			offset += bytes; // TODO: This might casue problems in streaming mode
 		}
 
 		timer.Stop();
-
-		if (count != sizeInByte)
-		{
-			std::stringstream ss;
-			ss << CLASS_TAG_AUTO << m_h2cDeviceName << ", failed to write 0x" << std::hex << sizeInByte << " byte to offset 0x" << offset << " (wrote: 0x" << count << " byte)" << std::dec;
-			throw CLAPException(ss.str());
-		}
-
-		logTransferTime(addr, sizeInByte, timer, false);
+		recordTransfer(TYPE::WRITE, sizeInByte, timer);
 	}
 
 	void ReadCtrl(const uint64_t& addr, uint64_t& data, const std::size_t& byteCnt) override
@@ -393,17 +790,12 @@ public:
 		OffsetType offset = static_cast<OffsetType>(addr);
 		FileOpType rc;
 
-#ifdef _WIN32
-		OVERLAPPED ol = { 0 };
-		ol.Offset     = addr & 0xFFFFFFFF;
-		ol.OffsetHigh = addr >> 32;
+		Timer timer;
+		timer.Start();
 
-		if (!ReadFile(m_ctrlFd, &data, bytes, &rc, NULL))
-		{
-			std::stringstream ss;
-			ss << CLASS_TAG_AUTO << m_ctrlDeviceName << ", failed to read 0x" << std::hex << bytes << " byte from offset 0x" << addr << " Error: " << GetLastError() << std::dec;
-			throw CLAPException(ss.str());
-		}
+#ifdef _WIN32
+		IoCompletionPort::Get().Read(m_ctrlFd, m_ctrlDeviceName, &data, bytes, addr);
+		rc = bytes;
 #else
 		rc = ::pread(m_ctrlFd, &data, bytes, offset);
 #endif
@@ -415,6 +807,9 @@ public:
 			ss << CLASS_TAG_AUTO << m_ctrlDeviceName << ", failed to read 0x" << std::hex << bytes << " byte to offset 0x" << offset << " (rc: 0x" << rc << ") errno: " << std::dec << errsv << " (" << strerror(errsv) << ")";
 			throw CLAPException(ss.str());
 		}
+
+		timer.Stop();
+		recordTransfer(TYPE::CONTROL, byteCnt, timer);
 	}
 
 	UserInterruptPtr MakeUserInterrupt() const override
@@ -423,16 +818,379 @@ public:
 	}
 
 private:
-	std::string m_h2cDeviceName;
-	std::string m_c2hDeviceName;
+	using ChannelFunc = std::function<void(Channel&, const uint64_t&, uint8_t*, const uint64_t&)>;
+
+	bool openChannel(Channels& channels, const std::string& dir, const uint32_t& channelNum, const bool& required)
+	{
+		ChannelPtr pChannel = std::make_unique<Channel>("/dev/xdma" + std::to_string(m_devNum) + "_" + dir + "_" + std::to_string(channelNum));
+
+#ifdef _WIN32
+		pChannel->fd = openOverlapped(pChannel->name, required);
+		if (!DEVICE_HANDLE_VALID(pChannel->fd)) return false;
+#else
+		if (required)
+			pChannel->fd = OpenDevice(pChannel->name);
+		else
+		{
+			// Optional channels are probed, a missing device simply ends the channel list
+			pChannel->fd = OPEN_DEVICE(pChannel->name.c_str(), DEFAULT_OPEN_FLAGS);
+			if (!DEVICE_HANDLE_VALID(pChannel->fd)) return false;
+		}
+#endif
+
+		channels.push_back(std::move(pChannel));
+		return true;
+	}
+
+#ifdef _WIN32
+	// Overlapped handles associated with the shared completion port, missing optional devices return INVALID_HANDLE
+	static DeviceHandle openOverlapped(const std::string& name, const bool& required)
+	{
+		const DeviceHandle fd = IoCompletionPort::Get().Open(name, DEFAULT_OPEN_FLAGS);
+
+		if (!DEVICE_HANDLE_VALID(fd) && required)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Unable to open device " << name << "; Error: " << GetLastError();
+			throw CLAPException(ss.str());
+		}
+
+		return fd;
+	}
+#endif
+
+	// Naturally aligned accesses that lie completely within the mapped register BAR
+	bool inRegisterBAR(const uint64_t& addr, const uint64_t& sizeInByte, const uint64_t& alignment) const
+	{
+		if (m_pRegBAR == nullptr || addr < m_regBARBase || addr % alignment != 0) return false;
+		return (addr - m_regBARBase <= m_regBARSize && sizeInByte <= m_regBARSize - (addr - m_regBARBase));
+	}
+
+	template<typename T>
+	static void readMMIO(const volatile uint8_t* pMem, void* pData, const std::size_t& offset)
+	{
+		const T value = *reinterpret_cast<const volatile T*>(pMem + offset);
+		std::memcpy(static_cast<uint8_t*>(pData) + offset, &value, sizeof(T));
+	}
+
+	template<typename T>
+	static void writeMMIO(volatile uint8_t* pMem, const void* pData, const std::size_t& offset)
+	{
+		T value;
+		std::memcpy(&value, static_cast<const uint8_t*>(pData) + offset, sizeof(T));
+		*reinterpret_cast<volatile T*>(pMem + offset) = value;
+	}
+
+	void unmapRegisterBAR()
+	{
+#ifndef _WIN32
+		if (m_pRegBAR == nullptr) return;
+
+		munmap(const_cast<uint8_t*>(m_pRegBAR), m_regBARSize);
+		CLOSE_DEVICE(m_regBARFd);
+
+		m_pRegBAR  = nullptr;
+		m_regBARFd = INVALID_HANDLE;
+#endif
+	}
+
+	void closeChannels(Channels& channels)
+	{
+		for (ChannelPtr& pChannel : channels)
+		{
+			std::lock_guard<std::mutex> lock(pChannel->mtx);
+			closePositionalFds(*pChannel);
+			CLOSE_DEVICE(pChannel->fd);
+		}
+	}
+
+	// The first positional handle is the regular channel handle, which is closed separately
+	void closePositionalFds(Channel& channel)
+	{
+		for (std::size_t i = 1; i < channel.posFds.size(); i++)
+			CLOSE_DEVICE(channel.posFds[i]);
+
+		channel.posFds.clear();
+	}
+
+	void checkTransfer(const void* pData) const
+	{
+		if (!m_valid)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "CLAP Instance is not valid, an error probably occurred during device initialization.";
+			throw CLAPException(ss.str());
+		}
+
+		if (!IS_ALIGNED(pData, ALIGNMENT))
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "pData is not aligned to " << ALIGNMENT << " bytes.";
+			throw CLAPException(ss.str());
+		}
+	}
+
+	void transfer(Channels& channels, std::atomic<std::size_t>& next, const uint64_t& addr, uint8_t* pData, const uint64_t& sizeInByte, const ChannelFunc& func)
+	{
+		const std::size_t maxStripeCnt = static_cast<std::size_t>(std::min(static_cast<uint64_t>(channels.size()), sizeInByte / m_minStripeSize));
+
+		if (maxStripeCnt < 2)
+		{
+			// Positional transfers do not share a file offset, hence, the channels are used round-robin without locking them
+			if (m_positionalIO)
+			{
+				func(*channels[next++ % channels.size()], addr, pData, sizeInByte);
+				return;
+			}
+
+			// Small transfers use the first idle channel, allowing independent transfers from multiple threads to run in parallel
+			Channel& channel = acquireChannel(channels, next);
+			std::lock_guard<std::mutex> lock(channel.mtx, std::adopt_lock);
+			func(channel, addr, pData, sizeInByte);
+			return;
+		}
+
+		// The stripes are aligned to retain the alignment of the data pointer
+		const uint64_t stripeSize = ((sizeInByte / maxStripeCnt + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+		// Rounding up the stripe size might leave fewer stripes than channels, e.g., 16448 byte on four channels
+		const std::size_t stripeCnt = static_cast<std::size_t>(ROUND_UP_DIV(sizeInByte, stripeSize));
+
+		const auto runStripe = [&](const std::size_t& idx) {
+			const uint64_t offset = idx * stripeSize;
+			Channel& channel      = *channels[idx];
+
+			if (m_positionalIO)
+			{
+				func(channel, addr + offset, pData + offset, std::min(stripeSize, sizeInByte - offset));
+				return;
+			}
+
+			std::lock_guard<std::mutex> lock(channel.mtx);
+			func(channel, addr + offset, pData + offset, std::min(stripeSize, sizeInByte - offset));
+		};
+
+		std::vector<std::future<void>> futures;
+
+		const auto runPinnedStripe = [&](const std::size_t& idx) {
+			if (!m_stripeAffinity.empty())
+				numa::PinCurrentThread(m_stripeAffinity);
+
+			runStripe(idx);
+		};
+
+		for (std::size_t i = 1; i < stripeCnt; i++)
+			futures.push_back(std::async(std::launch::async, runPinnedStripe, i));
+
+		std::exception_ptr pExcept = nullptr;
+
+		try
+		{
+			runStripe(0);
+		}
+		catch (...)
+		{
+			pExcept = std::current_exception();
+		}
+
+		// Wait for all stripes before rethrowing, as they reference the user buffer
+		for (std::future<void>& f : futures)
+		{
+			try
+			{
+				f.get();
+			}
+			catch (...)
+			{
+				if (!pExcept) pExcept = std::current_exception();
+			}
+		}
+
+		if (pExcept) std::rethrow_exception(pExcept);
+	}
+
+	// Returns the locked channel
+	Channel& acquireChannel(Channels& channels, std::atomic<std::size_t>& next)
+	{
+		if (channels.size() == 1)
+		{
+			channels.front()->mtx.lock();
+			return *channels.front();
+		}
+
+		const std::size_t start = next++;
+
+		for (std::size_t i = 0; i < channels.size(); i++)
+		{
+			Channel& channel = *channels[(start + i) % channels.size()];
+			if (channel.mtx.try_lock()) return channel;
+		}
+
+		// All channels are busy, queue on the round-robin channel
+		Channel& channel = *channels[start % channels.size()];
+		channel.mtx.lock();
+		return channel;
+	}
+
+	void readChannel(Channel& channel, const uint64_t& addr, uint8_t* pByteData, const uint64_t& sizeInByte)
+	{
+#ifdef _WIN32
+		// Overlapped transfers carry their offset, no seek is required and all chunks are in flight at once
+		IoCompletionPort::Get().Read(channel.fd, channel.name, pByteData, sizeInByte, addr);
+#else
+		uint64_t count    = 0;
+		OffsetType offset = static_cast<OffsetType>(addr);
+		FileOpType rc;
+
+		if (m_positionalIO)
+		{
+			const DeviceHandle fd = channel.posFds[channel.nextFd++ % channel.posFds.size()];
+
+			while (count < sizeInByte)
+			{
+				ByteCntType bytes = (sizeInByte - count) > RW_MAX_SIZE ? RW_MAX_SIZE : static_cast<ByteCntType>(sizeInByte - count);
+
+				rc            = ::pread(fd, pByteData + count, bytes, offset);
+				int32_t errsv = errno;
+
+				if (static_cast<ByteCntType>(rc) != bytes)
+				{
+					std::stringstream ss;
+					ss << CLASS_TAG_AUTO << channel.name << ", failed to read 0x" << std::hex << bytes << " byte from offset 0x" << offset << " (rc: 0x" << rc << ") errno: " << std::dec << errsv << " (" << strerror(errsv) << ")";
+					throw CLAPException(ss.str());
+				}
+
+				count += bytes;
+				offset += bytes;
+			}
+
+			return;
+		}
+
+		while (count < sizeInByte)
+		{
+			ByteCntType bytes = (sizeInByte - count) > RW_MAX_SIZE ? RW_MAX_SIZE : static_cast<ByteCntType>(sizeInByte - count);
+
+			rc = SEEK(channel.fd, offset);
+			if (SEEK_INVALID(rc, offset))
+			{
+				std::stringstream ss;
+				ss << CLASS_TAG_AUTO << channel.name << ", failed to seek to offset 0x" << std::hex << offset << " (rc: 0x" << rc << ")" << std::dec;
+				throw CLAPException(ss.str());
+			}
+
+			rc = ::read(channel.fd, pByteData + count, bytes);
+
+			int32_t errsv = errno;
+
+			if (static_cast<ByteCntType>(rc) != bytes)
+			{
+				std::stringstream ss;
+				ss << CLASS_TAG_AUTO << channel.name << ", failed to read 0x" << std::hex << bytes << " byte from offset 0x" << offset << " (rc: 0x" << rc << ") errno: " << std::dec << errsv << " (" << strerror(errsv) << ")";
+				throw CLAPException(ss.str());
+			}
+
+			count += bytes;
+			offset += bytes;
+		}
+
+		if (count != sizeInByte)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << channel.name << ", failed to read 0x" << std::hex << sizeInByte << " byte from offset 0x" << offset << " (read: 0x" << count << " byte)" << std::dec;
+			throw CLAPException(ss.str());
+		}
+#endif
+	}
+
+	void writeChannel(Channel& channel, const uint64_t& addr, const uint8_t* pByteData, const uint64_t& sizeInByte)
+	{
+#ifdef _WIN32
+		// Overlapped transfers carry their offset, no seek is required and all chunks are in flight at once
+		IoCompletionPort::Get().Write(channel.fd, channel.name, pByteData, sizeInByte, addr);
+#else
+		uint64_t count    = 0;
+		OffsetType offset = static_cast<OffsetType>(addr);
+		FileOpType rc;
+
+		if (m_positionalIO)
+		{
+			const DeviceHandle fd = channel.posFds[channel.nextFd++ % channel.posFds.size()];
+
+			while (count < sizeInByte)
+			{
+				ByteCntType bytes = (sizeInByte - count) > RW_MAX_SIZE ? RW_MAX_SIZE : static_cast<ByteCntType>(sizeInByte - count);
+
+				rc            = ::pwrite(fd, pByteData + count, bytes, offset);
+				int32_t errsv = errno;
+
+				if (static_cast<ByteCntType>(rc) != bytes)
+				{
+					std::stringstream ss;
+					ss << CLASS_TAG_AUTO << channel.name << ", failed to write 0x" << std::hex << bytes << " byte to offset 0x" << offset << " (rc: 0x" << rc << ") errno: " << std::dec << errsv << " (" << strerror(errsv) << ")";
+					throw CLAPException(ss.str());
+				}
+
+				count += bytes;
+				offset += bytes;
+			}
+
+			return;
+		}
+
+		while (count < sizeInByte)
+		{
+			ByteCntType bytes = (sizeInByte - count) > RW_MAX_SIZE ? RW_MAX_SIZE : static_cast<ByteCntType>(sizeInByte - count);
+
+			rc = SEEK(channel.fd, offset);
+			if (SEEK_INVALID(rc, offset))
+			{
+				std::stringstream ss;
+				ss << CLASS_TAG_AUTO << channel.name << ", failed to seek to offset 0x" << std::hex << offset << " (rc: 0x" << rc << ")" << std::dec;
+				throw CLAPException(ss.str());
+			}
+
+			rc = ::write(channel.fd, pByteData + count, bytes);
+			int32_t errsv = errno;
+
+			if (static_cast<ByteCntType>(rc) != bytes)
+			{
+				std::stringstream ss;
+				ss << CLASS_TAG_AUTO << channel.name << ", failed to write 0x" << std::hex << bytes << " byte to offset 0x" << offset << " (rc: 0x" << rc << ") errno: " << std::dec << errsv << " (" << strerror(errsv) << ")";
+				throw CLAPException(ss.str());
+			}
+
+			count += bytes;
+			offset += bytes;
+		}
+
+		if (count != sizeInByte)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << channel.name << ", failed to write 0x" << std::hex << sizeInByte << " byte to offset 0x" << offset << " (wrote: 0x" << count << " byte)" << std::dec;
+			throw CLAPException(ss.str());
+		}
+#endif
+	}
+
+private:
 	std::string m_ctrlDeviceName;
-	DeviceHandle m_h2cFd  = INVALID_HANDLE;
-	DeviceHandle m_c2hFd  = INVALID_HANDLE;
 	DeviceHandle m_ctrlFd = INVALID_HANDLE;
 	uint32_t m_devNum;
-	std::mutex m_readMutex;
-	std::mutex m_writeMutex;
+	Channels m_h2cChannels;
+	Channels m_c2hChannels;
+	std::atomic<std::size_t> m_nextH2C = { 0 };
+	std::atomic<std::size_t> m_nextC2H = { 0 };
+	uint64_t m_minStripeSize           = XDMA_DEFAULT_MIN_STRIPE_SIZE;
+	std::atomic<bool> m_positionalIO   = { false };
+	std::atomic<bool> m_transferIssued = { false };
+	int32_t m_numaNode                 = NUMA_NODE_UNKNOWN;
+	CpuSet m_stripeAffinity            = {};
 	std::mutex m_ctrlMutex;
+	std::string m_regBARName           = "";
+	DeviceHandle m_regBARFd            = INVALID_HANDLE;
+	volatile uint8_t* m_pRegBAR        = nullptr;
+	uint64_t m_regBARBase              = 0;
+	uint64_t m_regBARSize              = 0;
 };
 
 } // namespace backends
@@ -25,11 +25,7 @@
 
 #pragma once
 
-/////////////////////////
-// Include for mmap(), munmap()
-#include <sys/mman.h>
-/////////////////////////
-
+#include <atomic>
 #include <cstring>
 #include <fstream>
 #include <mutex>
@@ -40,6 +36,7 @@
 #include "../Defines.hpp"
 #include "../FileOps.hpp"
 #include "../Logger.hpp"
+#include "../MMapCache.hpp"
 #include "../Timer.hpp"
 #include "../Uio.hpp"
 #include "../UserInterruptBase.hpp"
@@ -100,6 +97,17 @@ public:
 		return (DEVICE_HANDLE_VALID(m_fd));
 	}
 
+	DeviceHandle GetPollHandle() const override
+	{
+		return m_fd;
+	}
+
+	// The UIO driver masks the interrupt once it was triggered
+	void Arm() override
+	{
+		unmask();
+	}
+
 	bool WaitForInterrupt([[maybe_unused]] const int32_t& timeout = WAIT_INFINITE, [[maybe_unused]] const bool& runCallbacks = true) override
 	{
 		if (!IsSet())
@@ -189,7 +197,8 @@ class PetaLinuxBackend : virtual public CLAPBackend
 public:
 	explicit PetaLinuxBackend([[maybe_unused]] const uint32_t& deviceNum = 0, [[maybe_unused]] const uint32_t& channelNum = 0) :
 		m_readMutex(),
-		m_writeMutex()
+		m_writeMutex(),
+		m_mapCache()
 	{
 		m_backendName = "PetaLinux";
 
@@ -200,9 +209,17 @@ public:
 			m_nameWrite = m_devMem;
 			m_fd        = OpenDevice(m_devMem);
 			m_valid     = (m_fd >= 0);
+			m_mapCache.SetDevice(m_fd);
 		}
 	}
 
+	~PetaLinuxBackend() override
+	{
+		// Unmap all cached windows before closing the device
+		m_mapCache.SetDevice(INVALID_HANDLE);
+		CloseDevice(m_fd);
+	}
+
 	void Read(const uint64_t& addr, void* pData, const uint64_t& sizeInByte) override
 	{
 		// CLAP_CLASS_LOG_DEBUG << "addr=0x" << std::hex << addr << " pData=0x" << pData << " sizeInByte=0x" << sizeInByte << std::dec << std::endl;
@@ -218,11 +235,19 @@ public:
 
 		uint64_t count = 0;
 
+		CLAP_TRACE_SCOPE(trace::EventType::Read, addr, sizeInByte);
+
 		Timer timer;
 		timer.Start();
 
 		if (m_mode == Mode::DevMem)
+		{
+			// Discard stale lines before the data written by the device is read, UIO maps the memory uncached
+			if (maintainOnTransfer(addr, false))
+				maintainDevMem(addr, sizeInByte, true);
+
 			count = readDevMem(addr, pData, sizeInByte);
+		}
 		else
 			count = readUIO(addr, pData, sizeInByte);
 
@@ -235,6 +260,7 @@ public:
 			throw CLAPException(ss.str());
 		}
 
+		recordTransfer(TYPE::READ, sizeInByte, timer);
 		logTransferTime(addr, sizeInByte, timer, true);
 	}
 
@@ -253,11 +279,18 @@ public:
 
 		uint64_t count = 0;
 
+		CLAP_TRACE_SCOPE(trace::EventType::Write, addr, sizeInByte);
+
 		Timer timer;
 		timer.Start();
 
 		if (m_mode == Mode::DevMem)
+		{
 			count = writeDevMem(addr, pData, sizeInByte);
+
+			if (maintainOnTransfer(addr, false))
+				maintainDevMem(addr, sizeInByte, false);
+		}
 		else
 			count = writeUIO(addr, pData, sizeInByte);
 
@@ -270,15 +303,144 @@ public:
 			throw CLAPException(ss.str());
 		}
 
+		recordTransfer(TYPE::WRITE, sizeInByte, timer);
 		logTransferTime(addr, sizeInByte, timer, false);
 	}
 
+	// Both modes access the mapped memory directly, no aligned staging buffer is required
+	void ReadScalar(const uint64_t& addr, void* pData, const std::size_t& byteCnt) override
+	{
+		checkScalarSize(byteCnt);
+		Read(addr, pData, byteCnt);
+	}
+
+	void WriteScalar(const uint64_t& addr, const void* pData, const std::size_t& byteCnt) override
+	{
+		checkScalarSize(byteCnt);
+		Write(addr, pData, byteCnt);
+	}
+
+	void* MapMemory(const uint64_t& addr, const uint64_t& sizeInByte) override
+	{
+		if (m_mode == Mode::DevMem)
+			return m_mapCache.MapRange(addr, sizeInByte);
+
+		const UioDev<UIOAddrType>& dev = m_uioManager.FindUioDevByAddr(addr);
+		if (!dev)
+		{
+			std::stringstream ss;
+			ss << CLASS_TAG_AUTO << "Failed to find UIO device for address 0x" << std::hex << addr << std::dec;
+			throw CLAPException(ss.str());
+		}
+
+		return dev.GetPtr(addr, sizeInByte);
+	}
+
+	// UIO devices are mapped for the lifetime of the backend, the map cache used in /dev/mem mode might evict windows
+	void* GetRegisterWindow(const uint64_t& addr, uint64_t& sizeInByte) override
+	{
+		if (m_mode == Mode::DevMem) return nullptr;
+
+		const UioDev<UIOAddrType>& dev = m_uioManager.FindUioDevByAddr(addr);
+		if (!dev || !dev.GetMaps().front().AddrInRange(addr)) return nullptr;
+
+		const auto& map = dev.GetMaps().front();
+		sizeInByte      = map.GetAddr() + map.GetSize() - addr;
+
+		return dev.GetPtr(addr, 1);
+	}
+
+	void UnmapMemory(const uint64_t& addr, void* pMem, const uint64_t& sizeInByte) override
+	{
+		// UIO devices stay mapped for the lifetime of the backend
+		if (m_mode == Mode::DevMem)
+			m_mapCache.UnmapRange(addr, pMem, sizeInByte);
+	}
+
+	// /dev/mem maps normal memory cacheable, whereas UIO maps device memory uncached
+	void FlushMapped(void* pMem, const uint64_t& sizeInByte) override
+	{
+		if (m_mode == Mode::DevMem)
+			cacheMaintenance(pMem, sizeInByte, false);
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+
+	void InvalidateMapped(void* pMem, const uint64_t& sizeInByte) override
+	{
+		if (m_mode == Mode::DevMem)
+			cacheMaintenance(pMem, sizeInByte, true);
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+
+	void SyncRanges(const std::vector<DeviceRange>& ranges, const SyncDirection& dir) override
+	{
+		if (m_mode == Mode::DevMem)
+		{
+			for (const DeviceRange& range : ranges)
+				maintainDevMem(range.addr, range.size, dir == SyncDirection::FromDevice);
+		}
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+	}
+
 	UserInterruptPtr MakeUserInterrupt() const override
 	{
 		return std::make_unique<PetaLinuxUserInterrupt>();
 	}
 
+	// Applies to bulk transfers in both modes, register sized accesses always use a single access of the respective width
+	void ConfigureCopyKernels(const CopyKernel& readKernel, const CopyKernel& writeKernel) override
+	{
+		checkCopyKernel(readKernel);
+		checkCopyKernel(writeKernel);
+
+		m_readKernel  = readKernel;
+		m_writeKernel = writeKernel;
+		m_mapCache.SetCopyKernels(readKernel, writeKernel);
+	}
+
+	void ConfigureMapCache(const uint64_t& windowSize, const std::size_t& maxWindows) override
+	{
+		if (m_mode != Mode::DevMem)
+		{
+			CLAP_CLASS_LOG_WARNING << "The map cache is only used in /dev/mem mode, ignoring configuration" << std::endl;
+			return;
+		}
+
+		m_mapCache.Configure(windowSize, maxWindows);
+	}
+
 private:
+	// Cleans (flush) or cleans and invalidates (invalidate) the data cache lines of the given range, EL0 is not allowed
+	// to invalidate without cleaning, this is not an issue as the host is not supposed to write to the range meanwhile
+	static void cacheMaintenance([[maybe_unused]] void* pMem, [[maybe_unused]] const uint64_t& sizeInByte, [[maybe_unused]] const bool& invalidate)
+	{
+#if defined(__aarch64__)
+		uint64_t ctr;
+		asm volatile("mrs %0, ctr_el0" : "=r"(ctr));
+
+		const uintptr_t lineSize = static_cast<uintptr_t>(4) << ((ctr >> 16) & 0xF);
+		const uintptr_t end      = reinterpret_cast<uintptr_t>(pMem) + sizeInByte;
+
+		for (uintptr_t line = reinterpret_cast<uintptr_t>(pMem) & ~(lineSize - 1); line < end; line += lineSize)
+		{
+			if (invalidate)
+				asm volatile("dc civac, %0" : : "r"(line) : "memory");
+			else
+				asm volatile("dc cvac, %0" : : "r"(line) : "memory");
+		}
+
+		asm volatile("dsb sy" : : : "memory");
+#endif
+	}
+
+	void maintainDevMem(const uint64_t& addr, const uint64_t& sizeInByte, const bool& invalidate)
+	{
+		m_mapCache.ForEachWindow(addr, sizeInByte, [&invalidate](uint8_t* pMem, const uint64_t& bytes) { cacheMaintenance(pMem, bytes, invalidate); });
+	}
+
 	bool initUIO()
 	{
 		if (m_uioManager.Init())
@@ -303,7 +465,7 @@ private:
 			throw CLAPException(ss.str());
 		}
 
-		return dev.Read(addr, pData, sizeInByte);
+		return dev.Read(addr, pData, sizeInByte, m_readKernel);
 	}
 
 	uint64_t writeUIO(const uint64_t& addr, const void* pData, const uint64_t& sizeInByte)
@@ -316,67 +478,17 @@ private:
 			throw CLAPException(ss.str());
 		}
 
-		return dev.Write(addr, pData, sizeInByte);
+		return dev.Write(addr, pData, sizeInByte, m_writeKernel);
 	}
 
 	uint64_t readDevMem(const uint64_t& addr, void* pData, const uint64_t& sizeInByte)
 	{
-		// Split the address into a rough base address and the specific offset
-		// this is required to prevent alignment problems when performing the mapping with mmap
-		uint64_t addrBase   = addr & 0xFFFFFFFFFFFF0000;
-		uint64_t addrOffset = addr & 0xFFFF;
-
-		uint64_t count     = 0;
-		off_t offset       = addr;
-		uint8_t* pByteData = reinterpret_cast<uint8_t*>(pData);
-
-		void* pMapBase = mmap(NULL, 0x10000 + sizeInByte, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, addrBase);
-
-		while (count < sizeInByte)
-		{
-			uint64_t bytes = sizeInByte - count;
-
-			if (bytes > RW_MAX_SIZE)
-				bytes = RW_MAX_SIZE;
-
-			std::memcpy(pByteData + count, reinterpret_cast<void*>(reinterpret_cast<uint8_t*>(pMapBase) + addrOffset + count), bytes);
-
-			count += bytes;
-			offset += bytes;
-		}
-
-		munmap(pMapBase, 0x10000 + sizeInByte);
-
-		return count;
+		return m_mapCache.Read(addr, pData, sizeInByte);
 	}
 
 	uint64_t writeDevMem(const uint64_t& addr, const void* pData, const uint64_t& sizeInByte)
 	{
-		uint64_t addrBase   = addr & 0xFFFFFFFFFFFF0000;
-		uint64_t addrOffset = addr & 0xFFFF;
-
-		uint64_t count           = 0;
-		const uint8_t* pByteData = reinterpret_cast<const uint8_t*>(pData);
-		off_t offset             = addr;
-
-		void* pMapBase = mmap(NULL, 0x10000 + sizeInByte, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, addrBase);
-
-		while (count < sizeInByte)
-		{
-			uint64_t bytes = sizeInByte - count;
-
-			if (bytes > RW_MAX_SIZE)
-				bytes = RW_MAX_SIZE;
-
-			std::memcpy(reinterpret_cast<void*>(reinterpret_cast<uint8_t*>(pMapBase) + addrOffset + count), pByteData + count, bytes);
-
-			count += bytes;
-			offset += bytes;
-		}
-
-		munmap(pMapBase, 0x10000 + sizeInByte);
-
-		return count;
+		return m_mapCache.Write(addr, pData, sizeInByte);
 	}
 
 	Expected<uint64_t> ReadUIOProperty(const uint64_t& addr, const std::string& propName) const override
@@ -439,6 +551,9 @@ private:
 	std::mutex m_writeMutex;
 	Mode m_mode                          = Mode::DevMem;
 	UioManager<UIOAddrType> m_uioManager = {};
+	MMapCache m_mapCache;
+	CopyKernel m_readKernel  = CopyKernel::MemCpy;
+	CopyKernel m_writeKernel = CopyKernel::MemCpy;
 };
 
 } // namespace backends
@@ -0,0 +1,339 @@
+/*
+ *  File: BenchmarkSuite.hpp
+ *  Copyright (c) 2024 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef EMBEDDED_XILINX
+#include <xtime_l.h>
+#else
+#include <chrono>
+#endif
+
+#include <CLAP.hpp>
+
+namespace bench
+{
+// Monotonic time in microseconds, the CLAP Timer is only a stub on bare-metal
+inline double NowUS()
+{
+#ifdef EMBEDDED_XILINX
+	XTime t;
+	XTime_GetTime(&t);
+	return static_cast<double>(t) * 1000000.0 / static_cast<double>(COUNTS_PER_SECOND);
+#else
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+struct Config
+{
+	std::string backend    = "pcie";
+	uint32_t deviceNum     = 0;
+	uint64_t ddrBase       = 0x0;
+	uint64_t ddrSize       = 0x10000000;
+	uint64_t regAddr       = UINT64_MAX; // Defaults to the DDR base address
+	uint64_t hlsAddr       = UINT64_MAX; // HLS core benchmarks are skipped if not set
+	uint64_t dmaAddr       = UINT64_MAX; // AxiDMA benchmarks are skipped if not set
+	bool stream            = false;      // XDMA stream benchmarks require the XDMA in streaming mode
+	uint32_t iterations    = 1000;
+	uint32_t warmup        = 10;
+	uint64_t minSize       = 4 * 1024;
+	uint64_t maxSize       = 64 * 1024 * 1024;
+	std::string filter     = "";
+	std::string outputFile = "";
+};
+
+// Summary of the samples of a single benchmark, all times in microseconds
+struct Stats
+{
+	uint64_t samples = 0;
+	double min       = 0.0;
+	double mean      = 0.0;
+	double median    = 0.0;
+	double p99       = 0.0;
+	double max       = 0.0;
+	double stddev    = 0.0;
+
+	static Stats FromSamples(std::vector<double> values)
+	{
+		Stats stats;
+
+		if (values.empty()) return stats;
+
+		std::sort(values.begin(), values.end());
+
+		double sum = 0.0;
+		for (const double& v : values)
+			sum += v;
+
+		stats.samples = values.size();
+		stats.min     = values.front();
+		stats.max     = values.back();
+		stats.mean    = sum / static_cast<double>(values.size());
+		stats.median  = values[values.size() / 2];
+		stats.p99     = values[std::min(values.size() - 1, static_cast<std::size_t>(std::ceil(0.99 * static_cast<double>(values.size()))) - 1)];
+
+		double var = 0.0;
+		for (const double& v : values)
+			var += (v - stats.mean) * (v - stats.mean);
+
+		stats.stddev = std::sqrt(var / static_cast<double>(values.size()));
+
+		return stats;
+	}
+};
+
+struct Result
+{
+	std::string name                          = "";
+	std::map<std::string, std::string> params = {};
+	Stats timeUS                              = {};
+	uint64_t bytesPerSample                   = 0; // Bytes moved per sample, used to derive the throughput
+	std::map<std::string, double> metrics     = {};
+	bool skipped                              = false;
+	std::string reason                        = "";
+
+	double GetThroughputMBs() const
+	{
+		return (bytesPerSample == 0 || timeUS.mean <= 0.0 ? 0.0 : static_cast<double>(bytesPerSample) / timeUS.mean);
+	}
+
+	static Result Skipped(const std::string& name, const std::string& reason)
+	{
+		Result res;
+		res.name    = name;
+		res.skipped = true;
+		res.reason  = reason;
+		return res;
+	}
+};
+
+using Results = std::vector<Result>;
+
+struct Context
+{
+	Config cfg          = {};
+	clap::CLAPPtr pClap = nullptr;
+};
+
+// Runs op for the configured number of iterations (after a warmup) and records the duration of every call
+template<typename Op>
+Stats Measure(const Config& cfg, Op op, const uint32_t& iterations = 0)
+{
+	const uint32_t iters = (iterations == 0 ? cfg.iterations : iterations);
+	std::vector<double> samples;
+	samples.reserve(iters);
+
+	for (uint32_t i = 0; i < cfg.warmup; i++)
+		op();
+
+	for (uint32_t i = 0; i < iters; i++)
+	{
+		const double start = NowUS();
+		op();
+		samples.push_back(NowUS() - start);
+	}
+
+	return Stats::FromSamples(samples);
+}
+
+// Sizes between the configured minimum and maximum, increasing by factors of 4
+inline std::vector<uint64_t> TransferSizes(const Config& cfg, const uint64_t& limit)
+{
+	std::vector<uint64_t> sizes;
+
+	for (uint64_t size = cfg.minSize; size <= std::min(cfg.maxSize, limit); size *= 4)
+		sizes.push_back(size);
+
+	return sizes;
+}
+
+class JsonWriter
+{
+public:
+	static std::string Escape(const std::string& str)
+	{
+		std::stringstream ss;
+
+		for (const char& c : str)
+		{
+			switch (c)
+			{
+				case '"':
+					ss << "\\\"";
+					break;
+				case '\\':
+					ss << "\\\\";
+					break;
+				case '\n':
+					ss << "\\n";
+					break;
+				case '\t':
+					ss << "\\t";
+					break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20)
+						ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int32_t>(c) << std::dec;
+					else
+						ss << c;
+			}
+		}
+
+		return ss.str();
+	}
+
+	static void Write(std::ostream& os, const Config& cfg, const Results& results)
+	{
+		os << std::setprecision(6) << std::fixed;
+		os << "{\n";
+		os << "  \"backend\": \"" << Escape(cfg.backend) << "\",\n";
+		os << "  \"device\": " << cfg.deviceNum << ",\n";
+		os << "  \"iterations\": " << cfg.iterations << ",\n";
+		os << "  \"warmup\": " << cfg.warmup << ",\n";
+		os << "  \"results\": [";
+
+		for (std::size_t i = 0; i < results.size(); i++)
+		{
+			os << (i == 0 ? "\n" : ",\n");
+			writeResult(os, results[i]);
+		}
+
+		os << "\n  ]\n}\n";
+	}
+
+private:
+	static void writeResult(std::ostream& os, const Result& res)
+	{
+		os << "    {\n";
+		os << "      \"name\": \"" << Escape(res.name) << "\",\n";
+		os << "      \"params\": {";
+
+		bool first = true;
+		for (const auto& [key, value] : res.params)
+		{
+			os << (first ? "" : ", ") << "\"" << Escape(key) << "\": \"" << Escape(value) << "\"";
+			first = false;
+		}
+
+		os << "},\n";
+
+		if (res.skipped)
+		{
+			os << "      \"skipped\": true,\n";
+			os << "      \"reason\": \"" << Escape(res.reason) << "\"\n";
+			os << "    }";
+			return;
+		}
+
+		os << "      \"skipped\": false,\n";
+		os << "      \"time_us\": {"
+		   << "\"samples\": " << res.timeUS.samples
+		   << ", \"min\": " << res.timeUS.min
+		   << ", \"mean\": " << res.timeUS.mean
+		   << ", \"median\": " << res.timeUS.median
+		   << ", \"p99\": " << res.timeUS.p99
+		   << ", \"max\": " << res.timeUS.max
+		   << ", \"stddev\": " << res.timeUS.stddev << "},\n";
+		os << "      \"bytes_per_sample\": " << res.bytesPerSample << ",\n";
+		os << "      \"throughput_mbs\": " << res.GetThroughputMBs() << ",\n";
+		os << "      \"metrics\": {";
+
+		first = true;
+		for (const auto& [key, value] : res.metrics)
+		{
+			os << (first ? "" : ", ") << "\"" << Escape(key) << "\": " << value;
+			first = false;
+		}
+
+		os << "}\n";
+		os << "    }";
+	}
+};
+
+// Named benchmarks, each producing one or more results, e.g., one per transfer size
+class Suite
+{
+public:
+	using BenchFunc = std::function<Results(Context&)>;
+
+	void Add(const std::string& name, BenchFunc func)
+	{
+		m_benchmarks.push_back({ name, std::move(func) });
+	}
+
+	// Runs all benchmarks whose name contains the filter, failing benchmarks are reported as skipped
+	Results Run(Context& ctx) const
+	{
+		Results results;
+
+		for (const auto& [name, func] : m_benchmarks)
+		{
+			if (!ctx.cfg.filter.empty() && name.find(ctx.cfg.filter) == std::string::npos)
+				continue;
+
+			std::cerr << "Running " << name << " ..." << std::endl;
+
+			try
+			{
+				for (Result& res : func(ctx))
+				{
+					res.name = name;
+					results.push_back(std::move(res));
+				}
+			}
+			catch (const std::exception& e)
+			{
+				results.push_back(Result::Skipped(name, e.what()));
+			}
+		}
+
+		return results;
+	}
+
+	std::vector<std::string> GetNames() const
+	{
+		std::vector<std::string> names;
+		for (const auto& bench : m_benchmarks)
+			names.push_back(bench.first);
+
+		return names;
+	}
+
+private:
+	std::vector<std::pair<std::string, BenchFunc>> m_benchmarks = {};
+};
+} // namespace bench
@@ -0,0 +1,354 @@
+/*
+ *  File: Benchmarks.hpp
+ *  Copyright (c) 2024 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <CLAP.hpp>
+#include <IP_Cores/AxiDMA.hpp>
+#include <IP_Cores/HLSCore.hpp>
+
+#include "BenchmarkSuite.hpp"
+
+namespace bench
+{
+inline void addCompletionMetrics(Result& res, const clap::CompletionStats& stats)
+{
+	res.metrics["completions"]   = static_cast<double>(stats.completions);
+	res.metrics["polls"]         = static_cast<double>(stats.polls);
+	res.metrics["avg_wait_us"]   = stats.GetAvgWaitUS();
+	res.metrics["avg_detect_us"] = stats.GetAvgDetectUS();
+	res.metrics["max_detect_us"] = stats.maxDetectUS;
+}
+
+inline Results RegisterRead32(Context& ctx)
+{
+	const uint64_t addr    = (ctx.cfg.regAddr == UINT64_MAX ? ctx.cfg.ddrBase : ctx.cfg.regAddr);
+	volatile uint32_t sink = 0;
+
+	Result res;
+	res.params["addr"] = std::to_string(addr);
+	res.timeUS         = Measure(ctx.cfg, [&]() { sink = ctx.pClap->Read32(addr); });
+	res.bytesPerSample = sizeof(uint32_t);
+	static_cast<void>(sink);
+
+	return { res };
+}
+
+inline Results RegisterWrite32(Context& ctx)
+{
+	const uint64_t addr = (ctx.cfg.regAddr == UINT64_MAX ? ctx.cfg.ddrBase : ctx.cfg.regAddr);
+	uint32_t value      = 0;
+
+	Result res;
+	res.params["addr"] = std::to_string(addr);
+	res.timeUS         = Measure(ctx.cfg, [&]() { ctx.pClap->Write32(addr, value++); });
+	res.bytesPerSample = sizeof(uint32_t);
+
+	return { res };
+}
+
+// Bulk transfers to / from the DDR with increasing sizes, the number of iterations is scaled down
+// for large transfers to keep the runtime of the benchmark bounded
+template<bool IsRead>
+Results BulkTransfer(Context& ctx)
+{
+	Results results;
+
+	for (const uint64_t& size : TransferSizes(ctx.cfg, ctx.cfg.ddrSize / 2))
+	{
+		const uint32_t iters = std::max<uint32_t>(1, static_cast<uint32_t>(std::min<uint64_t>(ctx.cfg.iterations, (256ULL * 1024 * 1024) / size)));
+
+		clap::Memory mem = ctx.pClap->AllocMemoryDDR(size);
+		clap::CLAPBuffer<uint8_t> buffer(size, 0xA5);
+
+		Result res;
+		res.params["size"] = std::to_string(size);
+
+		if constexpr (IsRead)
+			res.timeUS = Measure(ctx.cfg, [&]() { ctx.pClap->Read(mem, buffer); }, iters);
+		else
+			res.timeUS = Measure(ctx.cfg, [&]() { ctx.pClap->Write(mem, buffer); }, iters);
+
+		res.bytesPerSample = size;
+
+		ctx.pClap->FreeMemory(mem);
+		results.push_back(res);
+	}
+
+	return results;
+}
+
+// Bulk transfers through the memory mapping of the PetaLinux / bare-metal backend for every copy kernel supported by the CPU
+inline Results CopyKernels(Context& ctx)
+{
+	if (ctx.cfg.backend == "pcie")
+		throw std::runtime_error("The PCIe backend does not copy data through a memory mapping");
+
+	const uint64_t size  = std::min<uint64_t>(ctx.cfg.ddrSize / 2, 1024 * 1024);
+	const uint32_t iters = std::max<uint32_t>(1, std::min<uint32_t>(ctx.cfg.iterations, 256));
+
+	Results results;
+
+	clap::Memory mem = ctx.pClap->AllocMemoryDDR(size);
+	clap::CLAPBuffer<uint8_t> buffer(size, 0xA5);
+
+	for (const clap::CopyKernel& kernel : clap::internal::AvailableCopyKernels())
+	{
+		ctx.pClap->ConfigureCopyKernels(kernel, kernel);
+
+		for (const bool& isRead : { true, false })
+		{
+			Result res;
+			res.params["kernel"]    = clap::ToString(kernel);
+			res.params["direction"] = (isRead ? "read" : "write");
+			res.params["size"]      = std::to_string(size);
+
+			if (isRead)
+				res.timeUS = Measure(ctx.cfg, [&]() { ctx.pClap->Read(mem, buffer); }, iters);
+			else
+				res.timeUS = Measure(ctx.cfg, [&]() { ctx.pClap->Write(mem, buffer); }, iters);
+
+			res.bytesPerSample = size;
+			results.push_back(res);
+		}
+	}
+
+	ctx.pClap->ConfigureCopyKernels(clap::CopyKernel::MemCpy, clap::CopyKernel::MemCpy);
+	ctx.pClap->FreeMemory(mem);
+
+	return results;
+}
+
+// Alternately writes and reads the XDMA AXI-Stream channel, requires a loopback in the design
+inline Results StreamThroughput(Context& ctx)
+{
+	if (!ctx.cfg.stream)
+		return { Result::Skipped("", "Streaming not enabled (--stream)") };
+
+	Results results;
+
+	for (const uint64_t& size : TransferSizes(ctx.cfg, ctx.cfg.maxSize))
+	{
+		const uint32_t iters = std::max<uint32_t>(1, static_cast<uint32_t>(std::min<uint64_t>(ctx.cfg.iterations, (256ULL * 1024 * 1024) / size)));
+
+		clap::CLAPBuffer<uint8_t> out(size, 0x5A);
+		clap::CLAPBuffer<uint8_t> in(size, 0);
+
+		double readRuntime  = 0.0;
+		double writeRuntime = 0.0;
+
+		const auto op = [&]() {
+			ctx.pClap->StartReadStream(in);
+			ctx.pClap->StartWriteStream(out);
+			ctx.pClap->WaitForStreams();
+			readRuntime += ctx.pClap->GetReadStreamRuntime();
+			writeRuntime += ctx.pClap->GetWriteStreamRuntime();
+		};
+
+		Result res;
+		res.params["size"] = std::to_string(size);
+		res.timeUS         = Measure(ctx.cfg, op, iters);
+		res.bytesPerSample = 2 * size;
+
+		const double samples        = static_cast<double>(iters + ctx.cfg.warmup);
+		res.metrics["avg_read_ms"]  = readRuntime / samples;
+		res.metrics["avg_write_ms"] = writeRuntime / samples;
+
+		results.push_back(res);
+	}
+
+	return results;
+}
+
+// Pure host-side cost of the allocator, every sample allocates and frees a batch of buffers
+inline Results MemoryAllocFree(Context& ctx)
+{
+	static constexpr uint32_t BATCH = 64;
+
+	Results results;
+
+	for (const clap::AllocStrategy& strategy : { clap::AllocStrategy::FirstFit, clap::AllocStrategy::BestFit })
+	{
+		clap::internal::MemoryManager mm(0x0, 0x40000000, strategy);
+		std::vector<clap::Memory> mems;
+		mems.reserve(BATCH);
+
+		uint64_t sizeSeed = 1;
+
+		const auto op = [&]() {
+			for (uint32_t i = 0; i < BATCH; i++)
+			{
+				// Varying sizes between 4 KiB and 1 MiB to fragment the free list
+				sizeSeed = sizeSeed * 6364136223846793005ULL + 1442695040888963407ULL;
+				mems.push_back(mm.AllocMemory(4096 * (1 + (sizeSeed >> 56))));
+			}
+
+			// Free every other buffer first to create holes
+			for (std::size_t i = 0; i < mems.size(); i += 2)
+				mm.FreeMemory(mems[i]);
+			for (std::size_t i = 1; i < mems.size(); i += 2)
+				mm.FreeMemory(mems[i]);
+
+			mems.clear();
+		};
+
+		Result res;
+		res.params["strategy"] = (strategy == clap::AllocStrategy::FirstFit ? "FirstFit" : "BestFit");
+		res.params["batch"]    = std::to_string(BATCH);
+		res.timeUS             = Measure(ctx.cfg, op);
+
+		results.push_back(res);
+	}
+
+	return results;
+}
+
+#ifndef EMBEDDED_XILINX
+// Time between starting a WatchDog on an already completed status and WaitForFinish returning,
+// i.e., the software overhead of the completion path for the different poll strategies
+inline Results WatchDogCompletion(Context& ctx)
+{
+	Results results;
+
+	const std::vector<std::pair<std::string, clap::PollStrategy>> strategies = {
+		{ "FixedSleep(10us)", clap::PollStrategy::FixedSleep(10) },
+		{ "FixedSleep(100us)", clap::PollStrategy::FixedSleep(100) },
+		{ "Adaptive", clap::PollStrategy::Adaptive() }
+	};
+
+	for (const auto& [name, strategy] : strategies)
+	{
+		clap::internal::CallbackStatus status([]() { return true; });
+		clap::internal::WatchDog watchDog("bench", ctx.pClap->MakeUserInterrupt(), ctx.pClap->GetCompletionReactor());
+		watchDog.SetStatusRegister(&status);
+		watchDog.SetFinishCallback([]() { return true; });
+		watchDog.SetPollStrategy(strategy);
+
+		const auto op = [&]() {
+			status.Reset();
+			watchDog.Start();
+			watchDog.WaitForFinish();
+		};
+
+		Result res;
+		res.params["strategy"] = name;
+		res.timeUS             = Measure(ctx.cfg, op);
+
+		addCompletionMetrics(res, watchDog.GetCompletionStats());
+		results.push_back(res);
+	}
+
+	return results;
+}
+#endif
+
+// Start to finish of an HLS core without arguments, e.g., an empty kernel, includes the completion detection
+inline Results HLSRoundTrip(Context& ctx)
+{
+	if (ctx.cfg.hlsAddr == UINT64_MAX)
+		return { Result::Skipped("", "No HLS core address given (--hls-addr)") };
+
+	clap::HLSCore hls(ctx.pClap, ctx.cfg.hlsAddr, "BenchHLS");
+	hls.SetPollStrategy(clap::PollStrategy::Adaptive());
+
+	const auto op = [&]() {
+		hls.Start();
+		hls.WaitForFinish();
+	};
+
+	Result res;
+	res.params["addr"] = std::to_string(ctx.cfg.hlsAddr);
+	res.timeUS         = Measure(ctx.cfg, op);
+
+	addCompletionMetrics(res, hls.GetCompletionStats());
+
+	return { res };
+}
+
+// MM2S to S2MM round trip of an AxiDMA, requires the DMA's stream ports to be looped back
+inline Results AxiDMARoundTrip(Context& ctx)
+{
+	if (ctx.cfg.dmaAddr == UINT64_MAX)
+		return { Result::Skipped("", "No AxiDMA address given (--dma-addr)") };
+
+	Results results;
+
+	clap::AxiDMA<uint64_t> dma(ctx.pClap, ctx.cfg.dmaAddr);
+	dma.SetPollStrategy(clap::PollStrategy::Adaptive());
+
+	// A simple transfer is limited by the width of the buffer length register
+	const uint64_t maxSize = std::min<uint64_t>(ctx.cfg.ddrSize / 4, std::min(dma.GetMaxTransferLength(DMAChannel::MM2S), dma.GetMaxTransferLength(DMAChannel::S2MM)));
+
+	for (const uint64_t& size : TransferSizes(ctx.cfg, maxSize))
+	{
+		const uint32_t iters = std::max<uint32_t>(1, static_cast<uint32_t>(std::min<uint64_t>(ctx.cfg.iterations, (256ULL * 1024 * 1024) / size)));
+
+		clap::Memory src = ctx.pClap->AllocMemoryDDR(size);
+		clap::Memory dst = ctx.pClap->AllocMemoryDDR(size);
+
+		const auto op = [&]() {
+			dma.Start(src, dst);
+			dma.WaitForFinish();
+		};
+
+		Result res;
+		res.params["size"] = std::to_string(size);
+		res.timeUS         = Measure(ctx.cfg, op, iters);
+		res.bytesPerSample = size;
+
+		ctx.pClap->FreeMemory(dst);
+		ctx.pClap->FreeMemory(src);
+		results.push_back(res);
+	}
+
+	return results;
+}
+
+inline Suite CreateSuite()
+{
+	Suite suite;
+	suite.Add("register_read32", RegisterRead32);
+	suite.Add("register_write32", RegisterWrite32);
+	suite.Add("bulk_read", BulkTransfer<true>);
+	suite.Add("bulk_write", BulkTransfer<false>);
+	suite.Add("copy_kernels", CopyKernels);
+	suite.Add("stream_throughput", StreamThroughput);
+	suite.Add("memory_alloc_free", MemoryAllocFree);
+#ifndef EMBEDDED_XILINX
+	suite.Add("watchdog_completion", WatchDogCompletion);
+#endif
+	suite.Add("hls_roundtrip", HLSRoundTrip);
+	suite.Add("axidma_roundtrip", AxiDMARoundTrip);
+
+	return suite;
+}
+} // namespace bench
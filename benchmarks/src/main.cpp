@@ -0,0 +1,235 @@
+/*
+ *  File: main.cpp
+ *  Copyright (c) 2024 Florian Porrmann
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <CLAP.hpp>
+
+#include "Benchmarks.hpp"
+
+#ifdef EMBEDDED_XILINX
+// Bare-metal builds have no command line, the platform is configured at compile time
+#ifndef BENCH_DDR_BASE
+#define BENCH_DDR_BASE 0x10000000
+#endif
+#ifndef BENCH_DDR_SIZE
+#define BENCH_DDR_SIZE 0x10000000
+#endif
+#ifndef BENCH_HLS_ADDR
+#define BENCH_HLS_ADDR UINT64_MAX
+#endif
+#ifndef BENCH_DMA_ADDR
+#define BENCH_DMA_ADDR UINT64_MAX
+#endif
+
+int main()
+{
+	bench::Context ctx;
+	ctx.cfg.backend    = "baremetal";
+	ctx.cfg.ddrBase    = BENCH_DDR_BASE;
+	ctx.cfg.ddrSize    = BENCH_DDR_SIZE;
+	ctx.cfg.hlsAddr    = BENCH_HLS_ADDR;
+	ctx.cfg.dmaAddr    = BENCH_DMA_ADDR;
+	ctx.cfg.iterations = 100;
+	ctx.cfg.maxSize    = 4 * 1024 * 1024;
+
+	ctx.pClap = clap::CLAP::Create<clap::backends::BareMetalBackend>();
+	ctx.pClap->AddMemoryRegion(clap::CLAP::MemoryType::DDR, ctx.cfg.ddrBase, ctx.cfg.ddrSize);
+
+	const bench::Results results = bench::CreateSuite().Run(ctx);
+	bench::JsonWriter::Write(std::cout, ctx.cfg, results);
+
+	return 0;
+}
+#else
+static void printUsage(const char* pName, const bench::Suite& suite)
+{
+	std::cout << "Usage: " << pName << " [options]" << std::endl
+			  << std::endl
+			  << "Options:" << std::endl
+			  << "  --backend <pcie|petalinux>  Backend used to access the device (default: pcie)" << std::endl
+			  << "  --device <num>              Device number (default: 0)" << std::endl
+			  << "  --ddr-base <addr>           Base address of the DDR used for bulk transfers (default: 0x0)" << std::endl
+			  << "  --ddr-size <bytes>          Size of the DDR region (default: 0x10000000)" << std::endl
+			  << "  --reg-addr <addr>           Address used for the Read32/Write32 benchmarks (default: DDR base)" << std::endl
+			  << "  --hls-addr <addr>           Control address of an HLS core (enables hls_roundtrip)" << std::endl
+			  << "  --dma-addr <addr>           Control address of a looped back AxiDMA (enables axidma_roundtrip)" << std::endl
+			  << "  --stream                    Run the XDMA stream benchmarks, requires a looped back stream" << std::endl
+			  << "  --iterations <num>          Samples per benchmark (default: 1000)" << std::endl
+			  << "  --warmup <num>              Unrecorded iterations before sampling (default: 10)" << std::endl
+			  << "  --min-size <bytes>          Smallest transfer size (default: 4096)" << std::endl
+			  << "  --max-size <bytes>          Largest transfer size (default: 67108864)" << std::endl
+			  << "  --filter <substr>           Only run benchmarks whose name contains substr" << std::endl
+			  << "  --output <file>             Write the JSON results to file instead of stdout" << std::endl
+			  << "  --list                      List the available benchmarks" << std::endl
+			  << std::endl
+			  << "Available benchmarks:" << std::endl;
+
+	for (const std::string& name : suite.GetNames())
+		std::cout << "  " << name << std::endl;
+}
+
+static uint64_t parseNumber(const std::string& opt, const std::string& str)
+{
+	try
+	{
+		std::size_t idx      = 0;
+		const uint64_t value = std::stoull(str, &idx, 0);
+
+		if (idx != str.size())
+			throw std::invalid_argument(str);
+
+		return value;
+	}
+	catch (const std::exception&)
+	{
+		throw std::runtime_error("Invalid value \"" + str + "\" for option " + opt);
+	}
+}
+
+static bool parseArgs(int argc, char** argv, bench::Config& cfg, const bench::Suite& suite)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string opt = argv[i];
+
+		if (opt == "--help" || opt == "-h")
+		{
+			printUsage(argv[0], suite);
+			return false;
+		}
+
+		if (opt == "--list")
+		{
+			for (const std::string& name : suite.GetNames())
+				std::cout << name << std::endl;
+			return false;
+		}
+
+		if (opt == "--stream")
+		{
+			cfg.stream = true;
+			continue;
+		}
+
+		if (i + 1 >= argc)
+			throw std::runtime_error("Missing value for option " + opt);
+
+		const std::string value = argv[++i];
+
+		if (opt == "--backend")
+			cfg.backend = value;
+		else if (opt == "--device")
+			cfg.deviceNum = static_cast<uint32_t>(parseNumber(opt, value));
+		else if (opt == "--ddr-base")
+			cfg.ddrBase = parseNumber(opt, value);
+		else if (opt == "--ddr-size")
+			cfg.ddrSize = parseNumber(opt, value);
+		else if (opt == "--reg-addr")
+			cfg.regAddr = parseNumber(opt, value);
+		else if (opt == "--hls-addr")
+			cfg.hlsAddr = parseNumber(opt, value);
+		else if (opt == "--dma-addr")
+			cfg.dmaAddr = parseNumber(opt, value);
+		else if (opt == "--iterations")
+			cfg.iterations = static_cast<uint32_t>(parseNumber(opt, value));
+		else if (opt == "--warmup")
+			cfg.warmup = static_cast<uint32_t>(parseNumber(opt, value));
+		else if (opt == "--min-size")
+			cfg.minSize = parseNumber(opt, value);
+		else if (opt == "--max-size")
+			cfg.maxSize = parseNumber(opt, value);
+		else if (opt == "--filter")
+			cfg.filter = value;
+		else if (opt == "--output")
+			cfg.outputFile = value;
+		else
+			throw std::runtime_error("Unknown option " + opt);
+	}
+
+	if (cfg.iterations == 0)
+		throw std::runtime_error("The number of iterations has to be greater than 0");
+
+	if (cfg.minSize == 0 || cfg.minSize > cfg.maxSize)
+		throw std::runtime_error("Invalid transfer size range");
+
+	return true;
+}
+
+static clap::CLAPPtr createCLAP(const bench::Config& cfg)
+{
+	// The PetaLinux backend automatically uses UIO for devices listed in the device tree and /dev/mem otherwise
+	if (cfg.backend == "pcie")
+		return clap::CLAP::Create<clap::backends::PCIeBackend>(cfg.deviceNum);
+	else if (cfg.backend == "petalinux")
+		return clap::CLAP::Create<clap::backends::PetaLinuxBackend>(cfg.deviceNum);
+
+	throw std::runtime_error("Unknown backend \"" + cfg.backend + "\"");
+}
+
+int main(int argc, char** argv)
+{
+	const bench::Suite suite = bench::CreateSuite();
+	bench::Context ctx;
+
+	try
+	{
+		if (!parseArgs(argc, argv, ctx.cfg, suite))
+			return 0;
+
+		ctx.pClap = createCLAP(ctx.cfg);
+		ctx.pClap->AddMemoryRegion(clap::CLAP::MemoryType::DDR, ctx.cfg.ddrBase, ctx.cfg.ddrSize);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Error: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	const bench::Results results = suite.Run(ctx);
+
+	if (ctx.cfg.outputFile.empty())
+		bench::JsonWriter::Write(std::cout, ctx.cfg, results);
+	else
+	{
+		std::ofstream ofs(ctx.cfg.outputFile);
+
+		if (!ofs.is_open())
+		{
+			std::cerr << "Error: Unable to open output file \"" << ctx.cfg.outputFile << "\"" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		bench::JsonWriter::Write(ofs, ctx.cfg, results);
+		std::cerr << "Results written to " << ctx.cfg.outputFile << std::endl;
+	}
+
+	return 0;
+}
+#endif